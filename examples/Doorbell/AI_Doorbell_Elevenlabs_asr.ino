@@ -1,10 +1,19 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <Preferences.h>
+#include <LittleFS.h>
 #include <ArduinoASRChat.h>
 #include <ArduinoGPTChat.h>
 #include <PubSubClient.h>
 #include "Audio.h"
+#include "event_feed/event_feed.h"
+#include "html_template/html_template.h"
+#include "conversation_store/conversation_store.h"
+#include "mqtt_outbox/mqtt_outbox.h"
+#include "log_ring/log_ring.h"
+#include "json_stream/json_stream.h"
+#include <StreamString.h>
+#include "dashboard_assets.h" // gzip CSS/JS, regenerate with dashboard/make_assets.py
 
 // ==========================================
 // CONFIGURATION & GLOBALS
@@ -13,6 +22,15 @@
 // Enable conversation memory
 #define ENABLE_CONVERSATION_MEMORY 1
 
+// Ask the LLM while the guest is still talking, once the partial transcript is stable
+#define ENABLE_SPECULATIVE_LLM 1
+
+// Keep what the doorbell said (TTS and chimes as played) in LittleFS /said, ADPCM at 14.7 kHz, about 7 KB/s
+#define ENABLE_SPEECH_ARCHIVE 0
+
+// Keep the visitor's voice per session (with 2 s before the button press) in LittleFS /visits, ADPCM, about 8 KB/s
+#define ENABLE_VISITOR_ARCHIVE 0
+
 // Hardware Pin Definitions
 #define I2S_DOUT 47
 #define I2S_BCLK 46
@@ -31,12 +49,22 @@
 // Objects
 Preferences preferences;
 WebServer server(80);
+EventFeed feed(81);   // dashboard push channel (Server-Sent Events)
 WiFiClient espClient;
 PubSubClient mqttClient(espClient);
+MqttOutbox outbox(mqttClient); // owns mqttClient after setupMQTT(), publishes from its own task
+ConversationStore conversation(48, 8192); // bounded turns of the current visitor, last sessions in LittleFS
 
 ArduinoASRChat *asrChat = NULL;
 ArduinoGPTChat *gptChat = NULL;
+uint32_t speculatedRevision = 0; // partial revision the last speculative request was started for
 Audio audio;
+#if ENABLE_SPEECH_ARCHIVE
+PcmRecorder speechArchive;
+#endif
+#if ENABLE_VISITOR_ARCHIVE
+PcmRecorder visitorArchive;
+#endif
 
 // Settings Variables
 String wifi_ssid, wifi_pass;
@@ -51,14 +79,13 @@ String mqtt_topic_history;
 String mqtt_topic_sub;    
 
 // Web Logging Buffer & Chat State
-String webLogBuffer = "";
 String lastUserText = "(Waiting for guest...)";
 String lastAIText = "(Waiting for AI...)";
-String sessionHistoryJSON = "[]"; 
 
 // Button Pulse State
 unsigned long mqttButtonPressTime = 0;
 bool mqttButtonActive = false;
+volatile bool mqttTrigger = false; // set by the MQTT task, handled in loop()
 
 // Default System Prompt
 const char* default_prompt = 
@@ -79,29 +106,31 @@ bool buttonPressed = false;
 bool wasButtonPressed = false;
 unsigned long ttsStartTime = 0;
 unsigned long ttsCheckTime = 0;
+uint16_t ttsLoadMax = 0; // highest audio task load (permille) while a reply plays
 bool isAPMode = false;
-unsigned long lastMqttReconnectAttempt = 0;
 
 // ==========================================
 // HELPERS
 // ==========================================
 
+void pumpLogs();
+
 void sysLog(String msg) {
-  webLogBuffer += msg; 
-  if (webLogBuffer.length() > 4000) {
-    webLogBuffer = webLogBuffer.substring(webLogBuffer.length() - 2000);
-  }
+  logRing.text(LogRing::LVL_INFO, "App", msg.c_str(), msg.length());
+  pumpLogs(); // push it to the page right away, loop() may block for seconds after this
 }
 
 void sysLogLn(String msg) {
   sysLog(msg + "\n");
 }
 
-String jsonEscape(String s) {
-  s.replace("\"", "\\\"");
-  s.replace("\n", " ");
-  s.replace("\r", "");
-  return s;
+void setState(ConversationState s) {
+  currentState = s;
+  feed.publish("state", (int32_t)s);
+}
+
+void addTurn(ConversationStore::role_t role, const String& text) {
+  if (conversation.add(role, text)) feed.publish("turn", conversation.turnJSON(conversation.count() - 1));
 }
 
 void setLedColor(uint8_t r, uint8_t g, uint8_t b) {
@@ -124,46 +153,45 @@ boolean reconnectMQTT();
 // MQTT FUNCTIONS
 // ==========================================
 
+// Runs in the outbox task, the session itself is started/stopped by loop()
 void mqttCallback(char* topic, uint8_t* payload, unsigned int length) {
   String message;
   for (int i = 0; i < length; i++) {
     message += (char)payload[i];
   }
-  sysLogLn("[MQTT] Rx on " + String(topic) + ": " + message);
+  LOGR_I("MQTT", "Rx on %s: %s", topic, message.c_str());
 
   if (message.indexOf("trigger") >= 0 || message.indexOf("press") >= 0) {
-    sysLogLn("[MQTT] Trigger command received!");
-    if (!continuousMode) {
-      startContinuousMode(true); 
-    } else {
-      stopContinuousMode();
-    }
+    mqttTrigger = true;
   }
 }
 
-void setupMQTT() {
+void setupMQTT(fs::FS* spool) {
   if (mqtt_server.length() > 0) {
     int port = mqtt_port.toInt();
     if (port == 0) port = 1883; 
     mqttClient.setServer(mqtt_server.c_str(), port);
     mqttClient.setCallback(mqttCallback);
-    mqttClient.setBufferSize(8192); 
-    sysLogLn("MQTT Configured: " + mqtt_server + ":" + String(port));
+    mqttClient.setBufferSize(512); // payloads are streamed, the buffer only holds headers and incoming commands
+    outbox.setSpoolSpace([]() { return LittleFS.totalBytes() - LittleFS.usedBytes(); }); // recordings share the flash
+    outbox.begin([](PubSubClient&) { return reconnectMQTT(); }, spool);
+    sysLogLn("MQTT Configured: " + mqtt_server + ":" + String(port) + (spool ? " (queue in flash)" : ""));
   }
 }
 
+// Called by the outbox task with back-off, never from loop()
 boolean reconnectMQTT() {
   if (mqtt_server.length() == 0) return false;
    
   if (WiFi.status() != WL_CONNECTED) {
-    sysLogLn("[WiFi] Connection lost. Reconnecting WiFi...");
+    LOGR_W("WiFi", "Connection lost. Reconnecting WiFi...");
     WiFi.reconnect();
     int w = 0;
     while (WiFi.status() != WL_CONNECTED && w < 10) { delay(500); w++; }
   }
 
   if (mqttClient.connect("EscherDoorbell", mqtt_user.c_str(), mqtt_pass.c_str())) {
-    sysLogLn("[MQTT] Connected");
+    LOGR_I("MQTT", "Connected");
     if (mqtt_topic_sub.length() > 0) {
       mqttClient.subscribe(mqtt_topic_sub.c_str());
     }
@@ -172,154 +200,48 @@ boolean reconnectMQTT() {
   return false;
 }
 
+// Queued for the outbox task, returns at once
 bool publishToTopic(String topic, String message) {
-  if (!mqttClient.connected()) {
-    sysLogLn("[MQTT] Connecting...");
-    if (!reconnectMQTT()) {
-       sysLogLn("[MQTT ERROR] Reconnect failed.");
-       return false;
-    }
-  }
-  mqttClient.loop();
-  if (mqttClient.publish(topic.c_str(), message.c_str())) {
-    return true;
-  } else {
-    sysLogLn("[MQTT ERROR] Publish failed. Len: " + String(message.length()));
-    return false;
+  return outbox.publish(topic.c_str(), message.c_str()) != 0;
+}
+
+// The session JSON is written straight from the conversation store into the outbox spool (flash)
+bool publishHistory() {
+  return outbox.publish(mqtt_topic_history.c_str(), [](Print& out) { return conversation.writeJSON(out); }) != 0;
+}
+
+// Log readers, each with its own cursor in the log ring. Audio, ASR and the MQTT task write to the ring too.
+LogRing::cursor_t feedLog   = {0, 0, LogRing::LVL_INFO, true};
+LogRing::cursor_t serialLog = {0, 0, LogRing::LVL_DEBUG, true};
+LogRing::cursor_t mqttLog   = {0, 0, LogRing::LVL_WARN, true};
+
+void pumpLogs() {
+  char line[LogRing::LOG_MAX_REC + 32]; // one whole record
+  size_t n;
+  while ((n = logRing.read(feedLog, line, sizeof(line), false)) > 0) feed.publish("log", line);
+  while ((n = logRing.read(serialLog, line, sizeof(line))) > 0) {
+    if (Serial.availableForWrite() >= (int)n) Serial.write(line, n); // dropped instead of blocking without USB host
   }
+  while ((n = logRing.read(mqttLog, line, sizeof(line))) > 0) outbox.publish("escher/doorbell/log", line, false, MqttOutbox::PRIO_LOW);
+}
+
+// Status lines of the Audio library, called from the audio task
+void audio_info(const char* info) {
+  LOGR_D("Audio", "%s", info);
 }
 
 // ==========================================
 // HTML PAGE TEMPLATE
 // ==========================================
-const char* html_template = R"rawliteral(
+const char html_template[] PROGMEM = R"rawliteral(
 <!DOCTYPE html>
 <html lang="en">
 <head>
 <meta charset="UTF-8">
 <meta name="viewport" content="width=device-width, initial-scale=1.0">
 <title>Escher Doorbell AI</title>
-<style>
-  :root {
-    --bg-body: #f2f2f2; --bg-card: #ffffff; --text-main: #333333; --text-label: #555555;
-    --input-bg: #ffffff; --input-border: #ddd; --heading-color: #007bff; --divider-color: #eee;
-    --chat-guest-bg: #007bff; --chat-guest-text: #ffffff;
-    --chat-ai-bg: #f1f0f0; --chat-ai-text: #333333;
-    --chat-sys-bg: #e9ecef; --chat-sys-text: #6c757d;
-  }
-  body.dark-mode {
-    --bg-body: #121212; --bg-card: #1e1e1e; --text-main: #e0e0e0; --text-label: #bbbbbb;
-    --input-bg: #2d2d2d; --input-border: #444; --heading-color: #4dabf7; --divider-color: #333;
-    --chat-guest-bg: #0d6efd; --chat-guest-text: #ffffff;
-    --chat-ai-bg: #333333; --chat-ai-text: #e0e0e0;
-    --chat-sys-bg: #343a40; --chat-sys-text: #adb5bd;
-  }
-  body { font-family: -apple-system, BlinkMacSystemFont, "Segoe UI", Roboto, sans-serif; background: var(--bg-body); color: var(--text-main); padding: 20px; margin: 0; transition: background 0.3s, color 0.3s; }
-  .container { display: flex; flex-wrap: wrap; gap: 20px; max-width: 1000px; margin: 0 auto; }
-  .header-bar { width: 100%; display: flex; justify-content: space-between; align-items: center; margin-bottom: 20px; }
-  h1.main-title { margin: 0; color: var(--heading-color); font-size: 24px; }
-  .theme-toggle-btn { background: var(--bg-card); border: 1px solid var(--input-border); color: var(--text-main); padding: 8px 15px; border-radius: 20px; cursor: pointer; font-size: 14px; font-weight: bold; display: flex; align-items: center; gap: 5px; }
-  .card { background: var(--bg-card); flex: 1; min-width: 300px; padding: 20px; border-radius: 10px; box-shadow: 0 4px 6px rgba(0,0,0,0.1); display: flex; flex-direction: column; transition: background 0.3s; }
-  h2 { color: var(--heading-color); margin-top: 0; margin-bottom: 20px; border-bottom: 2px solid var(--divider-color); padding-bottom: 10px; }
-  label { font-weight: bold; display: block; margin-top: 15px; font-size: 13px; color: var(--text-label); }
-  input[type=text], input[type=password], input[type=number], textarea { width: 100%; padding: 10px; margin-top: 5px; border: 1px solid var(--input-border); background: var(--input-bg); color: var(--text-main); border-radius: 5px; box-sizing: border-box; font-size: 14px; }
-  input:focus, textarea:focus { border-color: var(--heading-color); outline: none; }
-  textarea.config { height: 150px; font-family: 'Courier New', monospace; font-size: 12px; line-height: 1.4; }
-  button.save-btn { width: 100%; background-color: var(--heading-color); color: white; padding: 12px; border: none; border-radius: 5px; cursor: pointer; margin-top: 20px; font-size: 16px; font-weight: bold; }
-   
-  .chat-container { height: 350px; overflow-y: auto; background: var(--bg-card); border: 1px solid var(--input-border); border-radius: 8px; padding: 15px; display: flex; flex-direction: column; gap: 12px; margin-bottom: 15px; }
-  .msg { display: flex; width: 100%; }
-  .msg.guest { justify-content: flex-end; }
-  .msg.ai { justify-content: flex-start; }
-  .msg.system { justify-content: center; margin: 5px 0; }
-  
-  .bubble { max-width: 75%; padding: 10px 15px; border-radius: 18px; font-size: 15px; line-height: 1.4; position: relative; word-wrap: break-word; }
-  .msg.guest .bubble { background-color: var(--chat-guest-bg); color: var(--chat-guest-text); border-bottom-right-radius: 4px; }
-  .msg.ai .bubble { background-color: var(--chat-ai-bg); color: var(--chat-ai-text); border-bottom-left-radius: 4px; }
-  .msg.system .bubble { background-color: var(--chat-sys-bg); color: var(--chat-sys-text); border-radius: 20px; font-size: 12px; padding: 5px 15px; font-weight: bold; max-width: 90%; }
-  .chat-label-small { font-size: 10px; margin-bottom: 2px; opacity: 0.6; padding: 0 5px; }
-  .msg.guest .chat-label-small { text-align: right; }
-  
-  /* Animations */
-  .listening-wave { display: inline-block; position: relative; width: 40px; height: 15px; display: flex; align-items: center; justify-content: space-between; }
-  .listening-wave div { background-color: #fff; width: 6px; height: 100%; animation: wave 1.2s infinite ease-in-out; }
-  .listening-wave div:nth-child(1) { animation-delay: -1.2s; }
-  .listening-wave div:nth-child(2) { animation-delay: -1.1s; }
-  .listening-wave div:nth-child(3) { animation-delay: -1.0s; }
-  @keyframes wave { 0%, 40%, 100% { transform: scaleY(0.4); } 20% { transform: scaleY(1.0); } }
-
-  .typing-dots { display: inline-block; width: 40px; }
-  .typing-dots div { display: inline-block; width: 6px; height: 6px; border-radius: 50%; background-color: var(--text-main); animation: bounce 1.4s infinite ease-in-out both; margin: 0 2px; }
-  .typing-dots div:nth-child(1) { animation-delay: -0.32s; }
-  .typing-dots div:nth-child(2) { animation-delay: -0.16s; }
-  @keyframes bounce { 0%, 80%, 100% { transform: scale(0); } 40% { transform: scale(1.0); } }
-
-  .speaking-bars { display: flex; align-items: center; height: 15px; }
-  .speaking-bars div { background-color: var(--text-main); width: 4px; height: 100%; margin: 0 2px; animation: speak 0.8s infinite ease-in-out; }
-  .speaking-bars div:nth-child(1) { animation-delay: 0.1s; }
-  .speaking-bars div:nth-child(2) { animation-delay: 0.2s; }
-  .speaking-bars div:nth-child(3) { animation-delay: 0.3s; }
-  @keyframes speak { 0%, 100% { height: 4px; } 50% { height: 15px; } }
-
-  #terminal { background-color: #1e1e1e; color: #00ff00; font-family: 'Courier New', monospace; padding: 15px; height: 150px; overflow-y: auto; border-radius: 5px; font-size: 11px; white-space: pre-wrap; line-height: 1.3; border: 1px solid var(--input-border); }
-  .clear-btn { background: #6c757d; color: white; border: none; padding: 6px 15px; border-radius: 4px; cursor: pointer; font-size: 12px; margin-top: 10px; }
-  .toggle-btn { background: #28a745; color: white; border: none; padding: 6px 15px; border-radius: 20px; cursor: pointer; font-size: 13px; font-weight: bold; }
-  .status-badge { display:inline-block; padding: 6px 12px; border-radius: 20px; background: #e9ecef; color: #495057; font-weight: bold; font-size: 12px; border: 1px solid #ced4da; }
-  .status-badge.live { background: #d4edda; color: #155724; border-color: #c3e6cb; }
-  .status-badge.live::before { content: "● "; color: #28a745; }
-  .stream-box { width: 100%; height: 0; padding-bottom: 56.25%; position: relative; background: #000; border-radius: 8px; margin-bottom: 15px; overflow: hidden; }
-  .stream-box iframe { position: absolute; top:0; left: 0; width: 100%; height: 100%; border: none; }
-</style>
-<script>
-  function toggleTheme() {
-    document.body.classList.toggle('dark-mode');
-    const isDark = document.body.classList.contains('dark-mode');
-    document.getElementById('theme-icon').innerText = isDark ? '☀️' : '🌙';
-    document.getElementById('theme-text').innerText = isDark ? 'Light Mode' : 'Dark Mode';
-  }
-
-  let lastChatHTML = "";
-  let lastState = -1;
-
-  setInterval(function() {
-    fetch('/logs').then(r => r.text()).then(data => {
-      var term = document.getElementById("terminal");
-      if(term.innerHTML !== data) { term.innerHTML = data; term.scrollTop = term.scrollHeight; }
-    });
-    
-    fetch('/conversation').then(r => r.json()).then(data => {
-      const chatBox = document.getElementById("chat-container");
-      let html = "";
-      let history = data.history || [];
-      let state = data.state || 0; 
-      
-      if (history.length === 0 && state === 0) {
-        html = '<div style="text-align:center; color:gray; font-size:13px; padding-top:20px;">No conversation yet.<br>Press "Toggle Talk" to start.</div>';
-      } else {
-          history.forEach(msg => {
-            if(msg.role === 'guest') {
-                 html += `<div class="msg guest"><div><div class="chat-label-small">Guest</div><div class="bubble">${msg.text}</div></div></div>`;
-            } else if(msg.role === 'ai') {
-                 html += `<div class="msg ai"><div><div class="chat-label-small">AI</div><div class="bubble">${msg.text}</div></div></div>`;
-            } else if(msg.role === 'system') {
-                 html += `<div class="msg system"><div class="bubble">${msg.text}</div></div>`;
-            }
-          });
-      }
-      
-      if (state === 1) html += `<div class="msg guest"><div><div class="chat-label-small">Listening...</div><div class="bubble"><div class="listening-wave"><div></div><div></div><div></div></div></div></div></div>`;
-      else if (state === 2) html += `<div class="msg ai"><div><div class="chat-label-small">Thinking...</div><div class="bubble"><div class="typing-dots"><div></div><div></div><div></div></div></div></div></div>`;
-      else if (state === 3 || state === 4) html += `<div class="msg ai"><div><div class="chat-label-small">Speaking...</div><div class="bubble"><div class="speaking-bars"><div></div><div></div><div></div></div></div></div></div>`;
-      
-      if(lastChatHTML !== html || lastState !== state) {
-          chatBox.innerHTML = html;
-          chatBox.scrollTop = chatBox.scrollHeight;
-          lastChatHTML = html;
-          lastState = state;
-      }
-    });
-  }, 1000);
-</script>
+<link rel="stylesheet" href="/dashboard.css">
+<script src="/dashboard.js"></script>
 </head>
 <body>
 <div class="container">
@@ -333,31 +255,31 @@ const char* html_template = R"rawliteral(
   <div class="card">
     <h2>Configuration</h2>
     <form action="/save" method="POST">
-      <label>WiFi SSID</label><input type="text" name="ssid" id="ssid">
-      <label>WiFi Password</label><input type="password" name="pass" id="pass">
+      <label>WiFi SSID</label><input type="text" name="ssid" id="ssid" value="{{ssid}}">
+      <label>WiFi Password</label><input type="password" name="pass" id="pass" value="{{pass}}">
       
       <div style="margin: 20px 0; border-top: 1px solid var(--divider-color);"></div>
       <h3>AI Settings</h3>
-      <label>ElevenLabs API Key</label><input type="text" name="asrkey" id="asrkey">
-      <label>ElevenLabs Model ID</label><input type="text" name="asrclus" id="asrclus" placeholder="scribe_v2">
-      <label>OpenAI Key</label><input type="password" name="apikey" id="apikey">
-      <label>Base URL</label><input type="text" name="apiurl" id="apiurl">
-      <label>System Prompt</label><textarea class="config" name="prompt" id="prompt"></textarea>
+      <label>ElevenLabs API Key</label><input type="text" name="asrkey" id="asrkey" value="{{asrkey}}">
+      <label>ElevenLabs Model ID</label><input type="text" name="asrclus" id="asrclus" value="{{asrclus}}" placeholder="scribe_v2">
+      <label>OpenAI Key</label><input type="password" name="apikey" id="apikey" value="{{apikey}}">
+      <label>Base URL</label><input type="text" name="apiurl" id="apiurl" value="{{apiurl}}">
+      <label>System Prompt</label><textarea class="config" name="prompt" id="prompt">{{prompt}}</textarea>
       
-      <label>No Speech Timeout (sec)</label><input type="number" name="timeout" id="timeout">
+      <label>No Speech Timeout (sec)</label><input type="number" name="timeout" id="timeout" value="{{timeout}}">
 
       <div style="margin: 20px 0; border-top: 1px solid var(--divider-color);"></div>
       <h3>IoT Settings</h3>
-      <label>Broker IP/URL</label><input type="text" name="mqserver" id="mqserver">
-      <label>Port (Default 1883)</label><input type="text" name="mqport" id="mqport">
-      <label>Username (Optional)</label><input type="text" name="mquser" id="mquser">
-      <label>Password (Optional)</label><input type="password" name="mqpass" id="mqpass">
+      <label>Broker IP/URL</label><input type="text" name="mqserver" id="mqserver" value="{{mqserver}}">
+      <label>Port (Default 1883)</label><input type="text" name="mqport" id="mqport" value="{{mqport}}">
+      <label>Username (Optional)</label><input type="text" name="mquser" id="mquser" value="{{mquser}}">
+      <label>Password (Optional)</label><input type="password" name="mqpass" id="mqpass" value="{{mqpass}}">
       
-      <label>History Topic (JSON)</label><input type="text" name="mqpub_hist" id="mqpub_hist">
-      <label>Subscribe Topic</label><input type="text" name="mqsub" id="mqsub">
+      <label>History Topic (JSON)</label><input type="text" name="mqpub_hist" id="mqpub_hist" value="{{mqpub_hist}}">
+      <label>Subscribe Topic</label><input type="text" name="mqsub" id="mqsub" value="{{mqsub}}">
       
       <label style="color:#28a745;">Camera Stream URL</label>
-      <input type="text" name="stream" id="stream">
+      <input type="text" name="stream" id="stream" value="{{stream}}">
       
       <button class="save-btn" type="submit">Save & Restart Device</button>
     </form>
@@ -365,7 +287,7 @@ const char* html_template = R"rawliteral(
 
   <div class="card">
     <h2>Live Interaction</h2>
-    <div class="stream-box"><iframe src="STREAM_URL_PLACEHOLDER" allowfullscreen></iframe></div>
+    <div class="stream-box"><iframe src="{{stream}}" allowfullscreen></iframe></div>
 
     <div style="display:flex; justify-content:space-between; align-items:center; margin-bottom:15px;">
       <div class="status-badge live">System Active</div>
@@ -383,28 +305,35 @@ const char* html_template = R"rawliteral(
 </body></html>
 )rawliteral";
 
+// values for the {{name}} placeholders of html_template
+const char* dashboardValue(const char* name) {
+  static char num[12];
+  if (!strcmp(name, "ssid"))       return wifi_ssid.c_str();
+  if (!strcmp(name, "pass"))       return wifi_pass.c_str();
+  if (!strcmp(name, "asrkey"))     return asr_key.c_str();
+  if (!strcmp(name, "asrclus"))    return asr_model.c_str();
+  if (!strcmp(name, "apikey"))     return openai_key.c_str();
+  if (!strcmp(name, "apiurl"))     return openai_url.c_str();
+  if (!strcmp(name, "prompt"))     return sys_prompt.c_str();
+  if (!strcmp(name, "timeout"))    { itoa(asr_max_duration, num, 10); return num; }
+  if (!strcmp(name, "mqserver"))   return mqtt_server.c_str();
+  if (!strcmp(name, "mqport"))     return mqtt_port.c_str();
+  if (!strcmp(name, "mquser"))     return mqtt_user.c_str();
+  if (!strcmp(name, "mqpass"))     return mqtt_pass.c_str();
+  if (!strcmp(name, "mqpub_hist")) return mqtt_topic_history.c_str();
+  if (!strcmp(name, "mqsub"))      return mqtt_topic_sub.c_str();
+  if (!strcmp(name, "stream"))     return stream_url.c_str();
+  return NULL;
+}
+
 void handleRoot() {
-  String html = html_template;
-  html.replace("id=\"ssid\">", "id=\"ssid\" value=\"" + wifi_ssid + "\">");
-  html.replace("id=\"pass\">", "id=\"pass\" value=\"" + wifi_pass + "\">"); 
-  html.replace("id=\"asrkey\">", "id=\"asrkey\" value=\"" + asr_key + "\">");
-  html.replace("id=\"asrclus\">", "id=\"asrclus\" value=\"" + asr_model + "\">");
-  html.replace("id=\"apikey\">", "id=\"apikey\" value=\"" + openai_key + "\">");
-  html.replace("id=\"apiurl\">", "id=\"apiurl\" value=\"" + openai_url + "\">");
-  html.replace("id=\"prompt\"></textarea>", "id=\"prompt\">" + sys_prompt + "</textarea>");
-  html.replace("id=\"timeout\">", "id=\"timeout\" value=\"" + String(asr_max_duration) + "\">");
-  html.replace("id=\"mqserver\">", "id=\"mqserver\" value=\"" + mqtt_server + "\">");
-  html.replace("id=\"mqport\">", "id=\"mqport\" value=\"" + mqtt_port + "\">");
-  html.replace("id=\"mquser\">", "id=\"mquser\" value=\"" + mqtt_user + "\">");
-  html.replace("id=\"mqpass\">", "id=\"mqpass\" value=\"" + mqtt_pass + "\">");
-  html.replace("id=\"mqpub_hist\">", "id=\"mqpub_hist\" value=\"" + mqtt_topic_history + "\">");
-  html.replace("id=\"mqsub\">", "id=\"mqsub\" value=\"" + mqtt_topic_sub + "\">");
-  html.replace("id=\"stream\">", "id=\"stream\" value=\"" + stream_url + "\">");
-  html.replace("STREAM_URL_PLACEHOLDER", stream_url);
-
-  server.send(200, "text/html", html);
+  // streamed from flash in chunks, the values are HTML escaped on the fly, 304 if nothing changed
+  HtmlTemplate::render(server, html_template, dashboardValue);
 }
 
+void handleCss() { HtmlTemplate::sendGzip(server, "text/css", dashboard_css_gz, sizeof(dashboard_css_gz), dashboard_css_etag); }
+void handleJs()  { HtmlTemplate::sendGzip(server, "application/javascript", dashboard_js_gz, sizeof(dashboard_js_gz), dashboard_js_etag); }
+
 void handleSave() {
   if (server.hasArg("ssid")) {
     preferences.putString("ssid", server.arg("ssid"));
@@ -436,15 +365,58 @@ void handleSave() {
   }
 }
 
-void handleLogs() { server.send(200, "text/plain", webLogBuffer); }
-void handleClearLogs() { webLogBuffer = ""; sysLogLn("--- Logs Cleared ---"); server.send(200, "text/plain", "Cleared"); }
+void handleLogs() {
+  LogRing::cursor_t c = logRing.cursor(LogRing::LVL_INFO);
+  char buf[1024];
+  size_t used = 0, n;
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain", "");
+  while (true) {
+    if (sizeof(buf) - used < LogRing::LOG_MAX_REC + 32) { server.sendContent(buf, used); used = 0; }
+    if ((n = logRing.read(c, buf + used, sizeof(buf) - used, false)) == 0) break;
+    used += n;
+  }
+  if (used) server.sendContent(buf, used);
+  server.sendContent("", 0);
+}
+void handleClearLogs() { logRing.clear(); feed.publish("clear", ""); sysLogLn("--- Logs Cleared ---"); server.send(200, "text/plain", "Cleared"); }
 
 void handleConversation() {
-  String safeJSON = sessionHistoryJSON;
-  if (safeJSON.endsWith(",")) safeJSON.remove(safeJSON.length() - 1);
-  if (!safeJSON.endsWith("]")) safeJSON += "]";
-  String response = "{\"history\":" + safeJSON + ",\"state\":" + String(currentState) + "}";
-  server.send(200, "application/json", response);
+  // ?session=1 is the last stored session, 2 the one before ... (default: the current one)
+  uint8_t back = server.hasArg("session") ? server.arg("session").toInt() : 0;
+  size_t  len = back ? conversation.storedJSONLength(back) : conversation.jsonLength();
+  if (back && len == 0) { server.send(404, "application/json", "{}"); return; }
+  char tail[24];
+  snprintf(tail, sizeof(tail), ",\"state\":%d}", (int)currentState);
+  server.setContentLength(11 + len + strlen(tail));
+  server.send(200, "application/json", "");
+  WiFiClient client = server.client();
+  client.print("{\"history\":");
+  if (back) conversation.writeStoredJSON(client, back);
+  else conversation.writeJSON(client);
+  client.print(tail);
+}
+
+void handleMqttStats() {
+  MqttOutbox::stats_t s = outbox.stats();
+  StreamString body; // grows with the topics, they are escaped on the way
+  JsonWriter w(&body);
+  char num[192];
+  snprintf(num, sizeof(num), "{\"connected\":%s,\"queued\":%u,\"delivered\":%u,\"retries\":%u,\"dropped\":%u,\"rejected\":%u,\"pending\":%u,\"connects\":%u,\"recent\":[",
+           s.connected ? "true" : "false", s.queued, s.delivered, s.retries, s.dropped, s.rejected, s.pending, s.connects);
+  w.raw(num);
+  MqttOutbox::delivery_t d;
+  for (uint8_t i = 0; outbox.recent(i, d); i++) {
+    snprintf(num, sizeof(num), "%s{\"id\":%u,\"topic\":", i ? "," : "", d.id);
+    w.raw(num);
+    w.string(d.topic);
+    snprintf(num, sizeof(num), ",\"bytes\":%u,\"attempts\":%u,\"ms\":%u,\"ok\":%s}",
+             d.bytes, d.attempts, d.latency, d.ok ? "true" : "false");
+    w.raw(num);
+  }
+  w.raw("]}");
+  w.flush();
+  server.send(200, "application/json", body);
 }
 
 void handleToggle() {
@@ -522,16 +494,23 @@ void setup() {
   }
 
   server.on("/", handleRoot);
+  server.on("/dashboard.css", HTTP_GET, handleCss);
+  server.on("/dashboard.js", HTTP_GET, handleJs);
   server.on("/save", HTTP_POST, handleSave);
   server.on("/logs", HTTP_GET, handleLogs);
   server.on("/clearlogs", HTTP_GET, handleClearLogs);
   server.on("/conversation", HTTP_GET, handleConversation);
   server.on("/toggle", HTTP_GET, handleToggle);
+  server.on("/mqtt", HTTP_GET, handleMqttStats);
+  HtmlTemplate::collectHeaders(server); // If-None-Match for the ETags
   server.begin();
+  feed.begin(); // own task on core 0, loop() only queues the events
+  fs::FS* flash = LittleFS.begin(true) ? &LittleFS : NULL;
+  conversation.begin(flash); // last 4 sessions survive a restart
   sysLogLn("Web Server running.");
 
   if (!isAPMode) {
-    setupMQTT();
+    setupMQTT(flash);
 
     // Init ElevenLabs ASR with Model ID
     asrChat = new ArduinoASRChat(asr_key.c_str(), asr_model.c_str());
@@ -539,6 +518,16 @@ void setup() {
 
     audio.setPinout(I2S_BCLK, I2S_LRC, I2S_DOUT);
     audio.setVolume(100);
+    audio.setOutputSampleRate(44100); // TTS and chimes are resampled, I2S is never reconfigured
+    #if ENABLE_SPEECH_ARCHIVE
+      if (flash) {
+        PcmRecorder::config_t rec = PcmRecorder::defaultConfig();
+        rec.decimate = 3;
+        rec.rotateSec = 30;
+        rec.keepFiles = 4; // about 1 MB of flash
+        if (speechArchive.begin(*flash, "/said", rec)) audio.setRecorder(&speechArchive);
+      }
+    #endif
 
     gptChat->setSystemPrompt(sys_prompt.c_str());
     #if ENABLE_CONVERSATION_MEMORY
@@ -555,6 +544,15 @@ void setup() {
     }
 
     asrChat->setAudioParams(SAMPLE_RATE, 16, 1);
+    #if ENABLE_VISITOR_ARCHIVE
+      if (flash) { // SD (SD.begin()) works the same and holds far more visits
+        PcmRecorder::config_t rec = PcmRecorder::defaultConfig();
+        rec.queueBlocks = 128; // 4 s of mic audio in PSRAM, the pre-roll is queued at once
+        rec.keepFiles = 5;
+        rec.prefix = "visit";
+        if (visitorArchive.begin(*flash, "/visits", rec)) asrChat->setArchive(&visitorArchive, 2000);
+      }
+    #endif
     asrChat->setSilenceDuration(1000);
     asrChat->setMaxRecordingSeconds(asr_max_duration);
     
@@ -578,14 +576,17 @@ void startContinuousMode(bool isInitialTrigger) {
   continuousMode = true;
   
   if (isInitialTrigger) {
-    sessionHistoryJSON = "["; 
+    conversation.startSession();
+    feed.publish("session", "start");
+    if (asrChat) asrChat->beginArchiveSession(conversation.session()); // no-op without an archive
     publishToTopic("escher/doorbell/button", "pressed");
     sysLogLn("[MQTT] Doorbell Event: Pressed");
+    audio.playTone(880, 120); // earcon, mixed on top of whatever is playing
     mqttButtonActive = true;
     mqttButtonPressTime = millis();
   }
 
-  currentState = STATE_LISTENING;
+  setState(STATE_LISTENING);
   sysLogLn("\n--- START ---");
   sysLogLn("Listening...");
   publishToTopic("escher/doorbell/status", "Started Listening");
@@ -609,7 +610,7 @@ void startContinuousMode(bool isInitialTrigger) {
     sysLogLn("Failed. Check Mic (L/R->GND) and WiFi.");
     setLedColor(50, 0, 0); 
     continuousMode = false;
-    currentState = STATE_IDLE;
+    setState(STATE_IDLE);
   }
 }
 
@@ -618,42 +619,24 @@ void stopContinuousMode() {
   sysLogLn("\n--- STOP ---");
   
   if (asrChat && asrChat->isRecording()) asrChat->stopRecording();
+  if (asrChat) asrChat->endArchiveSession();
+  if (gptChat) gptChat->cancelSpeculative();
   
-  sessionHistoryJSON += "{\"role\":\"system\",\"text\":\"--- Session Ended ---\"},";
+  addTurn(ConversationStore::ROLE_SYSTEM, "--- Session Ended ---");
 
-  if (sessionHistoryJSON.endsWith(",")) {
-    sessionHistoryJSON.remove(sessionHistoryJSON.length() - 1); 
-  }
-  sessionHistoryJSON += "]";
+  conversation.endSession();
   
-  sysLogLn("[MQTT] Final History Size: " + String(sessionHistoryJSON.length()) + " bytes");
+  sysLogLn("[MQTT] Final History Size: " + String(conversation.jsonLength()) + " bytes, " + String(conversation.count()) + " turns");
   
-  if (publishToTopic(mqtt_topic_history, sessionHistoryJSON)) {
-    sysLogLn("[MQTT] History SENT successfully.");
+  if (publishHistory()) {
+    sysLogLn("[MQTT] History queued.");
   } else {
-    sysLogLn("[MQTT WARN] First send failed. Forcing reconnect and retrying...");
-    mqttClient.disconnect();
-    delay(500); 
-    
-    if (reconnectMQTT()) {
-        mqttClient.loop(); 
-        delay(200);        
-        
-        if (publishToTopic(mqtt_topic_history, sessionHistoryJSON)) {
-            sysLogLn("[MQTT] History SENT on retry.");
-        } else {
-            sysLogLn("[MQTT ERROR] Failed on retry.");
-        }
-    } else {
-        sysLogLn("[MQTT ERROR] Could not reconnect for retry.");
-    }
+    sysLogLn("[MQTT ERROR] History could not be queued.");
   }
 
-  delay(250); 
-  mqttClient.loop();
   publishToTopic("escher/doorbell/status", "Stopped Listening");
 
-  currentState = STATE_IDLE;
+  setState(STATE_IDLE);
   setLedColor(0, 0, 0); 
 }
 
@@ -667,55 +650,54 @@ void handleASRResult() {
     sysLogLn("\n[User]: " + transcribedText);
     lastUserText = transcribedText;
     
-    sessionHistoryJSON += "{\"role\":\"guest\",\"text\":\"" + jsonEscape(transcribedText) + "\"},";
+    addTurn(ConversationStore::ROLE_GUEST, transcribedText);
 
-    mqttClient.loop(); 
-    delay(10); 
 
-    currentState = STATE_PROCESSING_LLM;
+    setState(STATE_PROCESSING_LLM);
     sysLog("[AI]: Thinking...");
     setLedColor(0, 50, 0); 
     
-    String response = gptChat->sendMessage(transcribedText);
+    // The speculative answer if it was asked with the same words, otherwise a blocking call
+    String response = gptChat->takeSpeculative(transcribedText);
+    if (response.length() == 0) response = gptChat->sendMessage(transcribedText);
     
     if (response.length() > 0) {
       sysLogLn(" " + response);
       lastAIText = response;
 
-      sessionHistoryJSON += "{\"role\":\"ai\",\"text\":\"" + jsonEscape(response) + "\"},";
+      addTurn(ConversationStore::ROLE_AI, response);
 
-      if (!mqttClient.connected()) {
-        reconnectMQTT();
-      }
-      mqttClient.loop(); 
 
-      currentState = STATE_PLAYING_TTS;
+      setState(STATE_PLAYING_TTS);
       sysLog("[TTS]: Speaking...");
       
       if (gptChat->textToSpeech(response)) {
-        currentState = STATE_WAIT_TTS_COMPLETE;
+        setState(STATE_WAIT_TTS_COMPLETE);
         ttsStartTime = millis();
         ttsCheckTime = millis();
+        ttsLoadMax = 0;
       } else {
         sysLogLn("Error: TTS Failed");
         setLedColor(50, 0, 0); 
         if (continuousMode) { delay(500); startContinuousMode(false); } 
-        else { currentState = STATE_IDLE; setLedColor(0,0,0); }
+        else { setState(STATE_IDLE); setLedColor(0,0,0); }
       }
     } else {
       sysLogLn("Error: LLM Failed");
       setLedColor(50, 0, 0); 
       if (continuousMode) { delay(500); startContinuousMode(false); }
-      else { currentState = STATE_IDLE; setLedColor(0,0,0); }
+      else { setState(STATE_IDLE); setLedColor(0,0,0); }
     }
   } else {
+    gptChat->cancelSpeculative();
     if (continuousMode) { delay(500); startContinuousMode(false); }
-    else { currentState = STATE_IDLE; setLedColor(0,0,0); }
+    else { setState(STATE_IDLE); setLedColor(0,0,0); }
   }
 }
 
 void loop() {
   server.handleClient();
+  pumpLogs();
   if (isAPMode) return;
 
   audio.loop();
@@ -726,17 +708,13 @@ void loop() {
     mqttButtonActive = false;
   }
   
-  if (mqtt_server.length() > 0) {
-    if (!mqttClient.connected()) {
-      unsigned long now = millis();
-      if (now - lastMqttReconnectAttempt > 5000) {
-        lastMqttReconnectAttempt = now;
-        if (reconnectMQTT()) {
-          lastMqttReconnectAttempt = 0;
-        }
-      }
+  if (mqttTrigger) {
+    mqttTrigger = false;
+    sysLogLn("[MQTT] Trigger command received!");
+    if (!continuousMode) {
+      startContinuousMode(true); 
     } else {
-      mqttClient.loop();
+      stopContinuousMode();
     }
   }
 
@@ -758,19 +736,26 @@ void loop() {
     case STATE_IDLE: break;
     case STATE_LISTENING:
       if (asrChat->hasNewResult()) handleASRResult();
+#if ENABLE_SPECULATIVE_LLM
+      else if (asrChat->isPartialStable() && asrChat->getPartialRevision() != speculatedRevision) {
+        speculatedRevision = asrChat->getPartialRevision(); // once per partial, not on every pass
+        gptChat->beginSpeculative(asrChat->getPartialText());
+      }
+#endif
       break;
     case STATE_PROCESSING_LLM: break;
     case STATE_PLAYING_TTS: break;
     case STATE_WAIT_TTS_COMPLETE:
       if (millis() - ttsCheckTime > 100) {
         ttsCheckTime = millis();
+        ttsLoadMax = max(ttsLoadMax, audio.getAudioTaskLoad());
         if (!audio.isRunning()) {
-          sysLogLn("[TTS]: Done.");
+          sysLogLn("[TTS]: Done, audio task load max " + String(ttsLoadMax / 10.0, 1) + " %");
           if (continuousMode) {
             delay(500);
             startContinuousMode(false); 
           } else {
-            currentState = STATE_IDLE;
+            setState(STATE_IDLE);
             setLedColor(0, 0, 0); 
             stopContinuousMode(); 
           }
@@ -0,0 +1,570 @@
+#!/usr/bin/env python3
+# Local stand-in for the cloud side of a doorbell conversation, plain ws:// and http://, standard library only:
+# the streaming ASR providers of ArduinoASRChat (ElevenLabs, ByteDance, Whisper), the chat completions and the speech
+# endpoint of ArduinoGPTChat. It replays the responses of a script with a set latency, the ASR trigger is the amount
+# of audio received (not the wall clock), so a run gives the same timings every time and endpointing / end-to-end
+# latency can be compared without the cloud. Each stage is printed with its time since the end of the visitor audio.
+#
+#   python3 asr_mock.py script.json [--port 8765]             server, one line per stage on stdout
+#   python3 asr_mock.py script.json --client --seconds 3      one visit against a running server (self test)
+#
+# On the device:  asr.setEndpoint("192.168.1.10", 8765, false);  before connectWebSocket(),
+#                 gpt base URL "http://192.168.1.10:8765"         completions and speech (every response_format)
+#
+# Script (see hello.json):
+#   {"connect_delay_ms": 300,              wait before the 101 answer, stands in for DNS + TCP + TLS
+#    "close_after_turn": false,            true: close the socket after each final (providers without session reuse)
+#    "turns": [{"events": [                one entry per utterance, the last one repeats
+#       {"at_audio_ms": 400, "delay_ms": 120, "text": "hello"},                      partial once 400 ms arrived
+#       {"on_end": true, "delay_ms": 250, "text": "hello there", "final": true}]}],   after the end of the audio
+#    "llm": {"first_token_ms": 450, "token_ms": 35, "replies": ["..."]},   streamed (SSE) if the request asks for it
+#    "tts": {"first_byte_ms": 300, "ms_per_char": 65,                      a quiet tone at 24 kHz in the requested format
+#            "pace": 3,                    sent at 3 x real time as it is "generated", 0 / missing: all at once
+#            "files": {"mp3": "a.mp3"}}}   per format, or "file": one file for every format
+#
+# Speech formats: wav and flac carry the tone. mp3 (MPEG-2 layer III, 64 kbit/s), aac (ADTS, 64 kbit/s) and opus
+# (Ogg, CELT 20 ms, 32 kbit/s) are silent frames of that bitrate, Python has no encoder for them: the same bytes per
+# second and the same parsing as the service's audio, enough for the time to the first audio.
+import argparse, asyncio, base64, hashlib, http.client, json, math, os, struct, sys, time
+
+GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC11B85"
+
+
+def now_ms():
+    return time.monotonic() * 1000.0
+
+
+VISIT = {"end": None}  # end of the visitor audio of the last turn, the stages after it are printed relative to it
+
+
+def stage(what):
+    since = " (+%.0f ms after the end of the audio)" % (now_ms() - VISIT["end"]) if VISIT["end"] else ""
+    print("  %s%s" % (what, since))
+    sys.stdout.flush()
+
+
+# --------------------------------------------------------------------------------------------------------------------
+# WebSocket framing (RFC 6455), frames from a client are masked, ours are not
+
+async def read_frame(reader):
+    b0, b1 = await reader.readexactly(2)
+    n = b1 & 0x7F
+    if n == 126:
+        n = struct.unpack(">H", await reader.readexactly(2))[0]
+    elif n == 127:
+        n = struct.unpack(">Q", await reader.readexactly(8))[0]
+    mask = await reader.readexactly(4) if b1 & 0x80 else None
+    data = bytearray(await reader.readexactly(n))
+    if mask:
+        for i in range(n):
+            data[i] ^= mask[i & 3]
+    return b0 & 0x80, b0 & 0x0F, bytes(data)
+
+
+async def read_message(reader, writer):
+    # continuation frames appended, pings answered in between
+    opcode, parts = None, []
+    while True:
+        fin, op, data = await read_frame(reader)
+        if op == 0x9:
+            send_frame(writer, 0xA, data)
+            continue
+        if op in (0x8, 0xA):
+            if op == 0x8:
+                return 0x8, data
+            continue
+        if op != 0:
+            opcode = op
+        parts.append(data)
+        if fin:
+            return opcode, b"".join(parts)
+
+
+def send_frame(writer, opcode, data, mask=False):
+    head = bytearray([0x80 | opcode])
+    m = 0x80 if mask else 0
+    if len(data) < 126:
+        head.append(m | len(data))
+    elif len(data) < 65536:
+        head += bytes([m | 126]) + struct.pack(">H", len(data))
+    else:
+        head += bytes([m | 127]) + struct.pack(">Q", len(data))
+    if mask:
+        key = os.urandom(4)
+        data = bytes(b ^ key[i & 3] for i, b in enumerate(data))
+        head += key
+    writer.write(bytes(head) + data)
+
+
+# --------------------------------------------------------------------------------------------------------------------
+# Providers: what a message means (start / audio bytes / end) and how a result is sent back
+
+class ElevenLabs:
+    rate = 16000
+
+    def classify(self, opcode, data):
+        msg = json.loads(data)
+        if msg.get("type") == "start":
+            return "start", 0
+        audio = base64.b64decode(msg.get("audio_base_64", ""))
+        return ("audio", len(audio)) if audio else ("end", 0)
+
+    def result(self, writer, text, final, seq):
+        send_frame(writer, 0x1, json.dumps({"text": text, "is_final": final}).encode())
+
+
+class ByteDance:
+    rate = 16000
+
+    def classify(self, opcode, data):
+        kind, flags = data[1] >> 4, data[1] & 0x0F
+        size = struct.unpack(">I", data[4:8])[0]
+        if kind == 0x1:
+            self.rate = json.loads(data[8:8 + size])["audio"]["rate"]
+            return "start", 0
+        if size:
+            return "audio", size
+        return ("end", 0) if flags & 0x2 else ("audio", 0)
+
+    def result(self, writer, text, final, seq):
+        body = json.dumps({"reqid": "mock", "code": 1000, "message": "Success", "sequence": -seq if final else seq,
+                           "result": [{"text": text, "confidence": 0}]}).encode()
+        send_frame(writer, 0x2, bytes([0x11, 0x90, 0x10, 0x00]) + struct.pack(">I", len(body)) + body)
+
+
+class Whisper:
+    rate = 24000
+
+    def __init__(self):
+        self.said = ""
+
+    def classify(self, opcode, data):
+        msg = json.loads(data)
+        t = msg.get("type")
+        if t == "transcription_session.update":
+            self.said = ""
+            return "start", 0
+        if t == "input_audio_buffer.append":
+            return "audio", len(base64.b64decode(msg.get("audio", "")))
+        return ("end", 0) if t == "input_audio_buffer.commit" else ("other", 0)
+
+    def result(self, writer, text, final, seq):
+        if final:
+            ev = {"type": "conversation.item.input_audio_transcription.completed", "item_id": "mock", "transcript": text}
+            self.said = ""
+        else:
+            delta = text[len(self.said):] if text.startswith(self.said) else text
+            self.said = text
+            ev = {"type": "conversation.item.input_audio_transcription.delta", "item_id": "mock", "delta": delta}
+        send_frame(writer, 0x1, json.dumps(ev).encode())
+
+
+def provider_for(path):
+    if path.startswith("/api/v2/asr"):
+        return ByteDance()
+    if path.startswith("/v1/realtime"):
+        return Whisper()
+    return ElevenLabs()
+
+
+# --------------------------------------------------------------------------------------------------------------------
+# Server
+
+class Session:
+    def __init__(self, script, writer, provider, peer):
+        self.script, self.writer, self.p, self.peer = script, writer, provider, peer
+        self.turn = -1
+        self.tasks = []
+
+    def start_turn(self):
+        self.turn += 1
+        turns = self.script.get("turns") or [{"events": []}]
+        self.events = list(turns[min(self.turn, len(turns) - 1)]["events"])
+        self.audio_bytes, self.seq, self.partials = 0, 0, 0
+        self.t_start, self.t_first, self.t_end, self.t_final = now_ms(), None, None, None
+
+    def audio_ms(self):
+        return self.audio_bytes * 1000.0 / (self.p.rate * 2)
+
+    def fire(self, ev):
+        async def later():
+            await asyncio.sleep(ev.get("delay_ms", 0) / 1000.0)
+            self.seq += 1
+            self.p.result(self.writer, ev["text"], ev.get("final", False), self.seq)
+            await self.writer.drain()
+            if ev.get("final"):
+                self.t_final = now_ms()
+                self.report()
+                if self.script.get("close_after_turn"):
+                    send_frame(self.writer, 0x8, struct.pack(">H", 1000))
+                    self.writer.close()
+            else:
+                self.partials += 1
+        self.tasks.append(asyncio.ensure_future(later()))
+
+    def on_audio(self, n):
+        if self.t_first is None:
+            self.t_first = now_ms()
+        self.audio_bytes += n
+        for ev in [e for e in self.events if "at_audio_ms" in e and e["at_audio_ms"] <= self.audio_ms()]:
+            self.events.remove(ev)
+            self.fire(ev)
+
+    def on_end(self):
+        self.t_end = VISIT["end"] = now_ms()
+        for ev in [e for e in self.events if e.get("on_end")]:
+            self.events.remove(ev)
+            self.fire(ev)
+
+    def report(self):
+        first = self.t_first - self.t_start if self.t_first else -1
+        endlat = self.t_final - self.t_end if self.t_end else -1
+        print("%s turn %d: %s, audio %.0f ms, first audio after %.0f ms, %d partials, end -> final %.0f ms"
+              % (self.peer, self.turn + 1, type(self.p).__name__, self.audio_ms(), first, self.partials, endlat))
+        sys.stdout.flush()
+
+
+async def handle(reader, writer, script):
+    peer = "%s:%d" % writer.get_extra_info("peername")[:2]
+    head = (await reader.readuntil(b"\r\n\r\n")).decode(errors="replace").split("\r\n")
+    path = head[0].split(" ")[1] if len(head[0].split(" ")) > 1 else "/"
+    headers = {l.split(":", 1)[0].strip().lower(): l.split(":", 1)[1].strip() for l in head[1:] if ":" in l}
+    if headers.get("upgrade", "").lower() != "websocket":
+        try:
+            await handle_http(reader, writer, script, path, headers)
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        writer.close()
+        return
+    await asyncio.sleep(script.get("connect_delay_ms", 0) / 1000.0)
+    accept = base64.b64encode(hashlib.sha1((headers.get("sec-websocket-key", "") + GUID).encode()).digest()).decode()
+    writer.write(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: %s\r\n\r\n" % accept).encode())
+    s = Session(script, writer, provider_for(path), peer)
+    print("%s connected, %s %s" % (peer, type(s.p).__name__, path))
+    try:
+        while True:
+            opcode, data = await read_message(reader, writer)
+            if opcode == 0x8:
+                break
+            kind, n = s.p.classify(opcode, data)
+            if kind == "start":
+                s.start_turn()
+            elif s.turn < 0:
+                s.start_turn()  # audio without a start message
+            if kind == "audio":
+                s.on_audio(n)
+            elif kind == "end":
+                s.on_end()
+    except (asyncio.IncompleteReadError, ConnectionError):
+        pass
+    for t in s.tasks:
+        t.cancel()
+    print("%s closed" % peer)
+    writer.close()
+
+
+# --------------------------------------------------------------------------------------------------------------------
+# HTTP: chat completions and speech, one request per connection (Connection: close, the body ends with the socket)
+
+REQUESTS = {"llm": 0}
+
+
+def tone_wav(ms, rate=24000):
+    n = rate * ms // 1000
+    pcm = bytearray()
+    for i in range(n):
+        fade = min(1.0, i / 480.0, (n - i) / 480.0)
+        pcm += struct.pack("<h", int(2000 * fade * math.sin(2 * math.pi * 220 * i / rate)))
+    return (b"RIFF" + struct.pack("<I", 36 + len(pcm)) + b"WAVEfmt " + struct.pack("<IHHIIHH", 16, 1, 1, rate, rate * 2,
+            2, 16) + b"data" + struct.pack("<I", len(pcm)) + bytes(pcm))
+
+
+def tone_pcm(ms, rate=24000):
+    n = rate * ms // 1000
+    return [int(2000 * min(1.0, i / 480.0, (n - i) / 480.0) * math.sin(2 * math.pi * 220 * i / rate)) for i in range(n)]
+
+
+class Bits:
+    def __init__(self):
+        self.out, self.acc, self.n = bytearray(), 0, 0
+
+    def put(self, value, bits):
+        self.acc = (self.acc << bits) | (value & ((1 << bits) - 1))
+        self.n += bits
+        while self.n >= 8:
+            self.n -= 8
+            self.out.append((self.acc >> self.n) & 0xFF)
+        self.acc &= (1 << self.n) - 1
+
+    def align(self):
+        if self.n:
+            self.put(0, 8 - self.n)
+        return self.out
+
+
+def crc(data, poly, bits, init=0):  # MSB first, FLAC crc-8 / crc-16 and the Ogg crc-32
+    top, mask = 1 << (bits - 1), (1 << bits) - 1
+    for b in data:
+        init ^= b << (bits - 8)
+        for _ in range(8):
+            init = ((init << 1) ^ poly) & mask if init & top else (init << 1) & mask
+    return init
+
+
+def flac(pcm, rate=24000, block=4096):
+    # fixed predictor of order 2, one Rice partition per frame
+    out = bytearray(b"fLaC") + bytes([0x80, 0, 0, 34])
+    info = Bits()
+    for v, b in ((block, 16), (block, 16), (0, 24), (0, 24), (rate, 20), (0, 3), (15, 5), (len(pcm), 36)):
+        info.put(v, b)
+    out += info.align() + bytes(16)  # no MD5
+    for f, start in enumerate(range(0, len(pcm), block)):
+        x = pcm[start:start + block]
+        h = Bits()
+        h.put(0xFFF8, 16)
+        h.put(0b0111 if len(x) != block else 0b1100, 4)  # 4096, or 16 bit count at the end of the header
+        h.put(0b0111, 4)                                  # 24 kHz
+        h.put(0, 4)                                       # mono
+        h.put(0b100, 3)                                   # 16 bit
+        h.put(0, 1)
+        h.put(f, 8) if f < 128 else (h.put(0xC0 | f >> 6, 8), h.put(0x80 | (f & 0x3F), 8))
+        if len(x) != block:
+            h.put(len(x) - 1, 16)
+        head = h.align()
+        b = Bits()
+        for c in head:
+            b.put(c, 8)
+        b.put(crc(head, 0x07, 8), 8)
+        order = min(2, len(x))
+        b.put(0, 1)
+        b.put(0b001000 | order, 6)
+        b.put(0, 1)
+        for v in x[:order]:
+            b.put(v, 16)
+        res = [x[i] - 2 * x[i - 1] + x[i - 2] for i in range(order, len(x))]
+        u = [r << 1 if r >= 0 else (-r << 1) - 1 for r in res]  # zigzag
+        k = max(0, min(14, int(math.log2(sum(u) / len(u) + 1)))) if u else 0
+        b.put(0, 2)  # Rice, 4 bit parameters
+        b.put(0, 4)  # one partition
+        b.put(k, 4)
+        for v in u:
+            b.put(0, v >> k) if v >> k else None
+            b.put(1, 1)
+            b.put(v, k) if k else None
+        frame = b.align()
+        out += frame + struct.pack(">H", crc(frame, 0x8005, 16))
+    return bytes(out)
+
+
+def mp3_silence(ms, kbps=64, rate=24000):
+    # MPEG-2 layer III mono, 576 samples per frame, side info and main data zero: every granule is silent
+    size = 72 * kbps * 1000 // rate
+    frame = bytes([0xFF, 0xF3, 8 << 4 | 1 << 2, 0xC0]) + bytes(size - 4)
+    return frame * max(1, ms * rate // 1000 // 576)
+
+
+def aac_silence(ms, kbps=64, rate=24000):
+    # ADTS, AAC-LC mono, a single channel element without bands, fill elements up to the bitrate
+    size = kbps * 1000 * 1024 // rate // 8
+    raw = Bits()
+    raw.put(0, 3 + 4)      # ID_SCE, tag
+    raw.put(100, 8)        # global gain
+    raw.put(0, 1 + 2 + 1)  # ics reserved, ONLY_LONG, window shape
+    raw.put(0, 6 + 1)      # max_sfb 0, no prediction
+    raw.put(0, 3)          # no pulse, tns, gain control
+    fill = size - 7 - 4 - 1
+    while fill > 0:
+        count = min(fill - 2, 269)  # payload bytes, the element header takes one or two
+        raw.put(6, 3)               # ID_FIL
+        if count < 15:
+            raw.put(count, 4)
+        else:
+            raw.put(15, 4)
+            raw.put(count - 14, 8)
+        for _ in range(count):
+            raw.put(0, 8)           # EXT_FILL
+        fill -= count + 2
+    raw.put(7, 3)          # ID_END
+    data = raw.align()
+    h = Bits()
+    for v, b in ((0xFFF, 12), (0, 1), (0, 2), (1, 1), (1, 2), (6, 4), (0, 1), (1, 3), (0, 4), (7 + len(data), 13),
+                 (0x7FF, 11), (0, 2)):
+        h.put(v, b)
+    return (bytes(h.align()) + bytes(data)) * max(1, ms * rate // 1000 // 1024)
+
+
+def ogg_page(packets, serial, seq, granule, flags=0):
+    lacing = bytearray()
+    for p in packets:
+        lacing += bytes([255] * (len(p) // 255) + [len(p) % 255])
+    head = b"OggS" + struct.pack("<BBqIIIB", 0, flags, granule, serial, seq, 0, len(lacing)) + lacing
+    page = bytearray(head + b"".join(packets))
+    page[22:26] = struct.pack("<I", crc(page, 0x04C11DB7, 32))
+    return bytes(page)
+
+
+def opus_silence(ms, kbps=32, rate=24000):
+    # Ogg Opus, CELT-only fullband 20 ms frames, a payload of 0xff decodes the silence flag
+    frame = bytes([31 << 3]) + b"\xff" * (kbps * 1000 // 50 // 8 - 1)
+    head = b"OpusHead" + struct.pack("<BBHIhB", 1, 1, 312, rate, 0, 0)
+    tags = b"OpusTags" + struct.pack("<I", 4) + b"mock" + struct.pack("<I", 0)
+    out = ogg_page([head], 1, 0, 0, 0x02) + ogg_page([tags], 1, 1, 0)
+    frames = max(1, ms // 20)
+    for seq, first in enumerate(range(0, frames, 50)):
+        n = min(50, frames - first)
+        out += ogg_page([frame] * n, 1, seq + 2, 312 + (first + n) * 960, 0x04 if first + n == frames else 0)
+    return out
+
+
+SPEECH = {"wav": "audio/wav", "flac": "audio/flac", "mp3": "audio/mpeg", "aac": "audio/aac", "opus": "audio/ogg"}
+
+
+def speech(fmt, ms):
+    if fmt == "wav":
+        return tone_wav(ms)
+    if fmt == "flac":
+        return flac(tone_pcm(ms))
+    return {"mp3": mp3_silence, "aac": aac_silence, "opus": opus_silence}[fmt](ms)
+
+
+def http_head(status, ctype, length=None):
+    head = "HTTP/1.1 %s\r\nContent-Type: %s\r\nConnection: close\r\n" % (status, ctype)
+    if length is not None:
+        head += "Content-Length: %d\r\n" % length
+    return (head + "\r\n").encode()
+
+
+async def handle_http(reader, writer, script, path, headers):
+    t0 = now_ms()
+    body = await reader.readexactly(int(headers.get("content-length", "0")))
+    req = json.loads(body or b"{}")
+    if path.startswith("/v1/chat/completions"):
+        llm = script.get("llm", {})
+        replies = llm.get("replies") or ["Hello, how can I help you?"]
+        reply = replies[REQUESTS["llm"] % len(replies)]
+        REQUESTS["llm"] += 1
+        stage("LLM request, %d messages" % len(req.get("messages", [])))
+        await asyncio.sleep(llm.get("first_token_ms", 0) / 1000.0)
+        if req.get("stream"):
+            writer.write(http_head("200 OK", "text/event-stream"))
+            for i, word in enumerate(reply.split(" ")):
+                delta = {"choices": [{"index": 0, "delta": {"content": word if i == 0 else " " + word}}]}
+                writer.write(("data: %s\n\n" % json.dumps(delta)).encode())
+                await writer.drain()
+                if i == 0:
+                    stage("LLM first token after %.0f ms" % (now_ms() - t0))
+                await asyncio.sleep(llm.get("token_ms", 0) / 1000.0)
+            writer.write(b"data: [DONE]\n\n")
+        else:
+            data = json.dumps({"choices": [{"index": 0, "message": {"role": "assistant", "content": reply}}]}).encode()
+            writer.write(http_head("200 OK", "application/json", len(data)) + data)
+        await writer.drain()
+        stage("LLM done after %.0f ms, %d chars" % (now_ms() - t0, len(reply)))
+    elif path.startswith("/v1/audio/speech"):
+        tts = script.get("tts", {})
+        fmt = req.get("response_format", "mp3")
+        ms = len(req.get("input", "")) * tts.get("ms_per_char", 65)
+        stage("TTS request, %d chars, %s" % (len(req.get("input", "")), fmt))
+        path = tts.get("files", {}).get(fmt) or tts.get("file")
+        if path:
+            data, ctype = open(path, "rb").read(), SPEECH.get(fmt, "application/octet-stream")
+        elif fmt in SPEECH:
+            data, ctype = speech(fmt, ms), SPEECH[fmt]
+        else:
+            data = json.dumps({"error": {"message": "response_format %s is not supported" % fmt}}).encode()
+            writer.write(http_head("400 Bad Request", "application/json", len(data)) + data)
+            return
+        await asyncio.sleep(max(0, tts.get("first_byte_ms", 0) - (now_ms() - t0)) / 1000.0)  # encoding time included
+        writer.write(http_head("200 OK", ctype, len(data)))
+        pace = tts.get("pace", 0)
+        step = max(1, len(data) * 100 // max(1, ms)) if pace else len(data)  # 100 ms of audio per piece
+        for pos in range(0, len(data), step):
+            writer.write(data[pos:pos + step])
+            await writer.drain()
+            if pos == 0:
+                stage("TTS first byte after %.0f ms, %d bytes" % (now_ms() - t0, len(data)))
+            if pace:
+                await asyncio.sleep(0.1 / pace)
+    else:
+        writer.write(http_head("404 Not Found", "text/plain", 0))
+    await writer.drain()
+
+
+# --------------------------------------------------------------------------------------------------------------------
+# Self test client: ElevenLabs protocol, silence in 200 ms chunks at real time, prints what comes back
+
+async def client(port, seconds):
+    reader, writer = await asyncio.open_connection("127.0.0.1", port)
+    key = base64.b64encode(os.urandom(16)).decode()
+    writer.write(("GET /v1/speech-to-text/stream-input?model_id=mock HTTP/1.1\r\nHost: localhost\r\n"
+                  "Upgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: %s\r\n"
+                  "Sec-WebSocket-Version: 13\r\n\r\n" % key).encode())
+    t0 = now_ms()
+    await reader.readuntil(b"\r\n\r\n")
+    print("connected after %.0f ms" % (now_ms() - t0))
+
+    async def receive():
+        while True:
+            fin, op, data = await read_frame(reader)
+            print("%7.0f ms  %s" % (now_ms() - t0, data.decode(errors="replace")))
+            if op == 0x8 or json.loads(data).get("is_final"):
+                return
+    rx = asyncio.ensure_future(receive())
+    send_frame(writer, 0x1, b'{"type":"start"}', True)
+    chunk = base64.b64encode(bytes(6400)).decode()
+    for _ in range(int(seconds * 5)):
+        send_frame(writer, 0x1, json.dumps({"audio_event": "audio_chunk", "audio_base_64": chunk}).encode(), True)
+        await writer.drain()
+        await asyncio.sleep(0.2)
+    t_end = now_ms()
+    send_frame(writer, 0x1, b'{"audio_event":"audio_chunk","audio_base_64":""}', True)
+    await asyncio.wait_for(rx, 10)
+    print("end -> final %.0f ms" % (now_ms() - t_end))
+    send_frame(writer, 0x8, struct.pack(">H", 1000), True)
+    writer.close()
+    await asyncio.get_running_loop().run_in_executor(None, http_client, port, t_end)
+
+
+def http_client(port, t_end):
+    # the next two stages as ArduinoGPTChat runs them: streamed completion, then the reply as speech
+    conn = http.client.HTTPConnection("127.0.0.1", port)
+    conn.request("POST", "/v1/chat/completions", json.dumps({"stream": True, "messages": [{"role": "user",
+                 "content": "Hello, is anybody home?"}]}), {"Content-Type": "application/json"})
+    reply = ""
+    for line in conn.getresponse().read().decode().split("\n"):
+        if line.startswith("data: {"):
+            reply += json.loads(line[6:])["choices"][0]["delta"].get("content", "")
+    print("%7.0f ms  reply: %s" % (now_ms() - t_end, reply))
+    conn = http.client.HTTPConnection("127.0.0.1", port)
+    conn.request("POST", "/v1/audio/speech", json.dumps({"input": reply, "response_format": "wav"}),
+                 {"Content-Type": "application/json"})
+    data = conn.getresponse().read()
+    print("%7.0f ms  speech: %d bytes" % (now_ms() - t_end, len(data)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description="scripted ASR / LLM / TTS stand-in")
+    ap.add_argument("script")
+    ap.add_argument("--port", type=int, default=8765)
+    ap.add_argument("--client", action="store_true", help="self test against a running server")
+    ap.add_argument("--seconds", type=float, default=3)
+    a = ap.parse_args()
+    if a.client:
+        asyncio.run(client(a.port, a.seconds))
+        return
+    script = json.load(open(a.script))
+
+    async def serve():
+        server = await asyncio.start_server(lambda r, w: handle(r, w, script), "0.0.0.0", a.port)
+        print("ASR mock on ws://0.0.0.0:%d, completions and speech on http://0.0.0.0:%d" % (a.port, a.port))
+        async with server:
+            await server.serve_forever()
+    try:
+        asyncio.run(serve())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
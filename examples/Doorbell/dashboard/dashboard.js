@@ -0,0 +1,57 @@
+function toggleTheme() {
+  document.body.classList.toggle('dark-mode');
+  const isDark = document.body.classList.contains('dark-mode');
+  document.getElementById('theme-icon').innerText = isDark ? '☀️' : '🌙';
+  document.getElementById('theme-text').innerText = isDark ? 'Light Mode' : 'Dark Mode';
+}
+
+// Snapshot once per (re)connect, after that the device pushes every log line, state change and chat turn
+// over Server-Sent Events (EventFeed on port 81, served by its own task)
+let history = [];
+let state = 0; // 0=Idle, 1=Listening, 2=Thinking, 3=Speaking, 4=WaitTTS
+
+function renderChat() {
+  const chatBox = document.getElementById("chat-container");
+  let html = "";
+  if (history.length === 0 && state === 0) {
+    html = '<div style="text-align:center; color:gray; font-size:13px; padding-top:20px;">No conversation yet.<br>Press "Toggle Talk" to start.</div>';
+  } else {
+    history.forEach(msg => {
+      if(msg.role === 'guest') {
+           html += `<div class="msg guest"><div><div class="chat-label-small">Guest</div><div class="bubble">${msg.text}</div></div></div>`;
+      } else if(msg.role === 'ai') {
+           html += `<div class="msg ai"><div><div class="chat-label-small">AI</div><div class="bubble">${msg.text}</div></div></div>`;
+      } else if(msg.role === 'system') {
+           html += `<div class="msg system"><div class="bubble">${msg.text}</div></div>`;
+      }
+    });
+  }
+  if (state === 1) html += `<div class="msg guest"><div><div class="chat-label-small">Listening...</div><div class="bubble"><div class="listening-wave"><div></div><div></div><div></div></div></div></div></div>`;
+  else if (state === 2) html += `<div class="msg ai"><div><div class="chat-label-small">Thinking...</div><div class="bubble"><div class="typing-dots"><div></div><div></div><div></div></div></div></div></div>`;
+  else if (state === 3 || state === 4) html += `<div class="msg ai"><div><div class="chat-label-small">Speaking...</div><div class="bubble"><div class="speaking-bars"><div></div><div></div><div></div></div></div></div></div>`;
+  chatBox.innerHTML = html;
+  chatBox.scrollTop = chatBox.scrollHeight;
+}
+
+function appendLog(text) {
+  const term = document.getElementById("terminal");
+  term.textContent += text;
+  if (term.textContent.length > 8000) term.textContent = term.textContent.slice(-4000);
+  term.scrollTop = term.scrollHeight;
+}
+
+function loadSnapshot() {
+  fetch('/logs').then(r => r.text()).then(data => { document.getElementById("terminal").textContent = ""; appendLog(data); });
+  fetch('/conversation').then(r => r.json()).then(data => { history = data.history || []; state = data.state || 0; renderChat(); });
+}
+
+window.addEventListener('load', function() {
+  const feed = new EventSource('http://' + location.hostname + ':81/events');
+  feed.onopen = loadSnapshot;
+  feed.addEventListener('log', e => appendLog(e.data));
+  feed.addEventListener('clear', e => { document.getElementById("terminal").textContent = ""; });
+  feed.addEventListener('state', e => { state = parseInt(e.data); renderChat(); });
+  feed.addEventListener('turn', e => { history.push(JSON.parse(e.data)); renderChat(); });
+  feed.addEventListener('session', e => { history = []; renderChat(); });
+  loadSnapshot();
+});
@@ -0,0 +1,28 @@
+#!/usr/bin/env python3
+# Regenerates ../dashboard_assets.h from dashboard.css and dashboard.js: gzip level 9, byte arrays for flash,
+# the ETag is the FNV-1a hash of the compressed bytes. Run it after editing one of the files.
+import gzip, os
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ASSETS = [("dashboard_css", "dashboard.css"), ("dashboard_js", "dashboard.js")]
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+out = ["// generated by dashboard/make_assets.py, do not edit", "#pragma once", "#include <Arduino.h>", ""]
+for name, fn in ASSETS:
+    raw = open(os.path.join(HERE, fn), "rb").read()
+    gz = gzip.compress(raw, compresslevel=9, mtime=0)
+    out.append("// %s: %d bytes, gzip %d bytes" % (fn, len(raw), len(gz)))
+    out.append('const char    %s_etag[] = "\\"%08x\\"";' % (name, fnv1a(gz)))
+    out.append("const uint8_t %s_gz[] PROGMEM = {" % name)
+    for i in range(0, len(gz), 24):
+        out.append("    " + ", ".join("0x%02x" % b for b in gz[i:i + 24]) + ",")
+    out.append("};")
+    out.append("")
+open(os.path.join(HERE, "..", "dashboard_assets.h"), "w").write("\n".join(out))
@@ -0,0 +1,137 @@
+// generated by dashboard/make_assets.py, do not edit
+#pragma once
+#include <Arduino.h>
+
+// dashboard.css: 6347 bytes, gzip 1811 bytes
+const char    dashboard_css_etag[] = "\"982bffcd\"";
+const uint8_t dashboard_css_gz[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x58, 0xcb, 0x6e, 0xe3, 0x36, 0x14, 0xdd, 0xfb, 0x2b, 0x88, 0x09, 0x06, 0x93,
+    0x0c, 0x2c, 0x8f, 0x24, 0x4b, 0x76, 0xc6, 0x46, 0x81, 0x3e, 0x80, 0x02, 0x5d, 0xb4, 0x8b, 0x0e, 0xba, 0x28, 0x8a, 0x2e, 0x28, 0x91, 0xb2, 0xd9,
+    0xc8, 0xa2, 0xa1, 0x47, 0x9c, 0xcc, 0xc0, 0xdf, 0xd0, 0x65, 0xff, 0xaf, 0x5f, 0xd2, 0x7b, 0x49, 0xea, 0x4d, 0xd9, 0x2e, 0x5a, 0x0b, 0x31, 0x62,
+    0x8a, 0xbc, 0xaf, 0x73, 0xee, 0x43, 0xda, 0xe4, 0x52, 0x96, 0xe4, 0xcb, 0x8c, 0x10, 0xc7, 0x89, 0x76, 0x4e, 0x24, 0xd9, 0xeb, 0x86, 0xdc, 0x25,
+    0x3e, 0x5e, 0x5b, 0xbd, 0x16, 0xd3, 0x9c, 0xe1, 0x9a, 0xfa, 0xe0, 0x5a, 0xc9, 0x5f, 0x4a, 0xe7, 0x40, 0x45, 0x06, 0xab, 0x4b, 0xf5, 0x69, 0x56,
+    0x53, 0x1a, 0xf1, 0x14, 0x96, 0x43, 0xf5, 0xd9, 0x2a, 0xb1, 0x22, 0x3b, 0x56, 0x25, 0x08, 0xea, 0xc9, 0x30, 0x8b, 0x32, 0x67, 0x3c, 0x87, 0x1b,
+    0x8c, 0x31, 0x5c, 0xdd, 0x73, 0xca, 0x44, 0x06, 0x2a, 0x65, 0x2a, 0x71, 0xd9, 0x75, 0xd7, 0x91, 0xde, 0xcf, 0xc4, 0xb3, 0x80, 0xad, 0xcd, 0x1d,
+    0xce, 0xb9, 0x96, 0x1e, 0xef, 0x69, 0xe9, 0xec, 0x2a, 0x5e, 0x18, 0x15, 0xed, 0x91, 0xce, 0x1d, 0xb4, 0xad, 0x55, 0xdf, 0x9e, 0xa3, 0xc2, 0xd8,
+    0xe5, 0x25, 0x6e, 0xe2, 0x6e, 0x3b, 0xcb, 0xe6, 0x84, 0x71, 0xaf, 0x3d, 0x51, 0xbc, 0x16, 0xfa, 0x08, 0xff, 0xc8, 0x63, 0xde, 0xea, 0xc1, 0x75,
+    0x73, 0x66, 0x15, 0xaf, 0xc3, 0x35, 0xdb, 0xce, 0xce, 0x33, 0x8c, 0xe6, 0x82, 0xd1, 0xfc, 0xc9, 0x39, 0x48, 0xc6, 0x47, 0x51, 0xf6, 0x7c, 0xbc,
+    0xfa, 0x51, 0xf6, 0x38, 0x5e, 0xc3, 0x28, 0x73, 0x17, 0xaf, 0x51, 0x94, 0x23, 0xf5, 0x19, 0x45, 0xd9, 0x67, 0x78, 0x59, 0xa2, 0x1c, 0x04, 0x81,
+    0x2d, 0xca, 0x01, 0xa3, 0x51, 0xb2, 0xb6, 0x45, 0xb9, 0xef, 0x7b, 0x37, 0xca, 0x6c, 0xc5, 0x13, 0xf6, 0x2f, 0xa3, 0xdc, 0x72, 0x65, 0x10, 0x65,
+    0xe3, 0x9e, 0x25, 0xca, 0xcb, 0x60, 0x49, 0x03, 0xd7, 0x16, 0x65, 0xca, 0xa2, 0x30, 0x6a, 0xa2, 0x4c, 0xbe, 0x90, 0x44, 0x66, 0xa5, 0x93, 0xd0,
+    0x83, 0x48, 0x21, 0xb6, 0x0e, 0x3d, 0x1e, 0x53, 0x8e, 0xfb, 0x4b, 0x7e, 0x98, 0x93, 0x6f, 0x53, 0x91, 0x3d, 0xfd, 0x48, 0xe3, 0x4f, 0xea, 0xf7,
+    0xf7, 0xb0, 0x73, 0x4e, 0xde, 0x7c, 0xe2, 0x3b, 0xc9, 0xc9, 0x2f, 0x3f, 0xbc, 0x99, 0x93, 0x9f, 0x65, 0x24, 0x4b, 0x39, 0x27, 0x05, 0xcd, 0x0a,
+    0xa7, 0xe0, 0xb9, 0x00, 0x60, 0x23, 0x1a, 0x3f, 0xed, 0x72, 0x59, 0x65, 0x00, 0xcb, 0x33, 0xcd, 0xef, 0x1b, 0xe4, 0x1e, 0xb6, 0xc4, 0xc4, 0x47,
+    0x2f, 0x37, 0x40, 0xc1, 0x8d, 0x23, 0x65, 0x18, 0xda, 0x0d, 0xf1, 0xdd, 0xe3, 0xcb, 0x96, 0x1c, 0x68, 0xbe, 0x43, 0x00, 0xc1, 0x83, 0x32, 0x07,
+    0xd9, 0xa2, 0x14, 0x12, 0x7e, 0xb6, 0xa2, 0x89, 0xbb, 0x58, 0x16, 0x73, 0x2d, 0x4f, 0xfd, 0xbf, 0x25, 0xe7, 0xd9, 0x22, 0x06, 0x03, 0x41, 0x1e,
+    0xcf, 0xc1, 0x2d, 0x26, 0x8a, 0x63, 0x4a, 0xc1, 0xa5, 0x24, 0xe5, 0x20, 0x11, 0xbf, 0x9d, 0x53, 0x4e, 0x8f, 0x1b, 0x82, 0xdf, 0x5b, 0xb2, 0xc3,
+    0x7f, 0x6b, 0x6d, 0x70, 0x4b, 0xb0, 0x72, 0xbf, 0x21, 0x9e, 0xeb, 0xf6, 0x0d, 0x20, 0xb4, 0x2a, 0xa5, 0x12, 0x8e, 0xe8, 0x03, 0xc4, 0x11, 0x45,
+    0xe9, 0xed, 0xf6, 0xb7, 0xdb, 0xa1, 0xaa, 0x3f, 0xaa, 0xa2, 0x14, 0xc9, 0xab, 0x83, 0xd6, 0xf0, 0x0c, 0x62, 0x5e, 0x1c, 0x69, 0xcc, 0x9d, 0x88,
+    0x97, 0x27, 0xce, 0xb3, 0x2d, 0xa1, 0xa9, 0xd8, 0x65, 0x8e, 0x80, 0x80, 0x16, 0x1b, 0x12, 0xc3, 0x0e, 0x9e, 0xd7, 0x0a, 0x21, 0x4e, 0x65, 0x29,
+    0x0f, 0xb5, 0x61, 0xe7, 0xd9, 0xde, 0x5b, 0x60, 0x84, 0x9c, 0x52, 0x94, 0x29, 0x24, 0x42, 0x37, 0x30, 0xbd, 0x58, 0xf6, 0xa8, 0x09, 0xf1, 0x54,
+    0xa0, 0x16, 0xe2, 0x33, 0x07, 0x51, 0x81, 0x16, 0xb5, 0x28, 0xf7, 0xfc, 0xc0, 0x9d, 0x52, 0xee, 0x76, 0x80, 0x70, 0x54, 0x66, 0x20, 0xce, 0x8a,
+    0x15, 0x66, 0x14, 0x88, 0xa8, 0xd9, 0xef, 0x1d, 0x5f, 0x48, 0x21, 0x53, 0xc1, 0xcc, 0x8e, 0x6e, 0x6e, 0xdc, 0x04, 0xe9, 0x23, 0x08, 0xf0, 0x42,
+    0x34, 0x42, 0x1f, 0x72, 0x72, 0xb0, 0xb5, 0x2a, 0x6a, 0x27, 0xe3, 0x2a, 0x2f, 0x50, 0xc2, 0x51, 0x0a, 0x1d, 0x8a, 0x8e, 0xed, 0x9e, 0xb2, 0x5d,
+    0x2d, 0x9c, 0xb8, 0xd8, 0xed, 0x21, 0x98, 0x91, 0x4c, 0xd9, 0x28, 0xe4, 0xd6, 0x90, 0x2a, 0x84, 0x43, 0xe3, 0x3c, 0x3a, 0x75, 0xc5, 0x61, 0x14,
+    0x05, 0x2a, 0x01, 0x0b, 0x08, 0xb8, 0x01, 0x78, 0xa9, 0xe9, 0x30, 0xa0, 0xe7, 0xc0, 0x0f, 0xcf, 0x2c, 0xbe, 0x38, 0xc5, 0x9e, 0x32, 0x79, 0x42,
+    0xda, 0x80, 0xe1, 0x64, 0x05, 0x7f, 0xf9, 0x2e, 0xa2, 0xf7, 0xee, 0x5c, 0x5d, 0x0b, 0xef, 0x61, 0x6b, 0xe5, 0x25, 0x13, 0x39, 0x8f, 0x35, 0xc5,
+    0x21, 0x9c, 0xd5, 0x21, 0xbb, 0x48, 0x7b, 0xc5, 0x0b, 0x1f, 0x9c, 0xb9, 0xc8, 0x00, 0x43, 0xa8, 0x52, 0x1e, 0x15, 0x5b, 0xac, 0xfc, 0x32, 0x7e,
+    0x34, 0x8b, 0x03, 0xa4, 0x7b, 0x55, 0xad, 0x45, 0xb4, 0xd9, 0xef, 0x19, 0x92, 0xaa, 0xb2, 0x5a, 0x57, 0x92, 0x09, 0x9c, 0xa2, 0x54, 0xc6, 0x4f,
+    0x7d, 0xab, 0x34, 0x27, 0xba, 0x68, 0x2f, 0x15, 0x1f, 0x46, 0x84, 0x52, 0xf2, 0x1f, 0x50, 0x93, 0xe2, 0xde, 0x6f, 0xe5, 0xeb, 0x91, 0x7f, 0x85,
+    0x77, 0x7e, 0x9f, 0x93, 0xce, 0xca, 0x91, 0x16, 0xc5, 0x09, 0x3c, 0xea, 0xaf, 0x66, 0xd5, 0x21, 0xe2, 0x39, 0xac, 0xe1, 0x01, 0x9a, 0x73, 0x3a,
+    0xcc, 0xde, 0x06, 0x5b, 0xaf, 0x93, 0xf9, 0xda, 0xc2, 0x0e, 0x69, 0xaf, 0xe6, 0xc1, 0x98, 0x59, 0x75, 0x67, 0xb9, 0x94, 0x24, 0x03, 0x26, 0x85,
+    0x0d, 0x91, 0xc4, 0x67, 0x65, 0x53, 0x83, 0xd0, 0x8b, 0x25, 0x2f, 0x4c, 0x3c, 0x36, 0x89, 0x8c, 0xab, 0xa2, 0x75, 0x50, 0xff, 0x46, 0xb2, 0xeb,
+    0xc3, 0x17, 0x69, 0x22, 0xab, 0x12, 0x6a, 0x3c, 0x88, 0xcc, 0x64, 0xc6, 0x51, 0x64, 0x2d, 0x05, 0x8b, 0x69, 0x22, 0x76, 0x20, 0x66, 0x6f, 0x10,
+    0xf5, 0x42, 0xb7, 0x01, 0xac, 0xee, 0x17, 0xef, 0xbe, 0x93, 0x55, 0x2e, 0xa0, 0xe0, 0xfe, 0xc4, 0x4f, 0xef, 0xe6, 0xe4, 0x20, 0x33, 0xa9, 0xaa,
+    0x5d, 0xdf, 0x5a, 0x1f, 0xcf, 0xa1, 0x1a, 0xa7, 0x91, 0xb5, 0x08, 0x50, 0x59, 0x54, 0x01, 0x93, 0xb2, 0x45, 0x41, 0x9f, 0xeb, 0x8a, 0xd4, 0x83,
+    0xa6, 0x8d, 0xe9, 0x65, 0x27, 0xcc, 0xcd, 0xd3, 0x1e, 0x2a, 0x40, 0x17, 0x50, 0xbf, 0x8b, 0x9f, 0x76, 0xd0, 0x16, 0xf0, 0x51, 0x05, 0xea, 0x72,
+    0xc0, 0x77, 0x87, 0x2c, 0x5d, 0x4d, 0xd4, 0xa4, 0xf3, 0x0c, 0xca, 0x0c, 0x76, 0xdb, 0x6e, 0x1b, 0xaa, 0x1d, 0x5e, 0xea, 0xe0, 0xc9, 0x67, 0x9e,
+    0x27, 0xa9, 0x3c, 0x39, 0x10, 0x3b, 0xdd, 0x59, 0xfe, 0x87, 0x12, 0x3c, 0xf0, 0xe9, 0xb1, 0x57, 0xb1, 0x74, 0x96, 0xdd, 0x58, 0x75, 0x54, 0xc9,
+    0xd4, 0x61, 0x1b, 0x14, 0x0c, 0xaf, 0x2e, 0xa4, 0x87, 0x62, 0x37, 0xee, 0xae, 0x3d, 0xd4, 0xf4, 0xa6, 0x85, 0x9a, 0x6d, 0x60, 0xeb, 0xa8, 0x1d,
+    0x2a, 0xe5, 0x3c, 0x63, 0xcd, 0x4e, 0x2a, 0x26, 0xb7, 0x15, 0xc0, 0xc5, 0xb2, 0xd9, 0xa8, 0xc7, 0x12, 0xdb, 0xe6, 0x7e, 0x1b, 0x55, 0xb8, 0x62,
+    0xd5, 0x43, 0x48, 0xa2, 0x2a, 0x8a, 0x4c, 0xef, 0x6c, 0xda, 0xfc, 0x3a, 0x1c, 0x26, 0xbe, 0xbd, 0x43, 0x79, 0x8f, 0x43, 0xf0, 0x43, 0x3b, 0x95,
+    0x8f, 0xb2, 0x2e, 0xd6, 0x39, 0x4f, 0x69, 0x29, 0x9e, 0x81, 0x6a, 0x58, 0x8b, 0xcc, 0xc8, 0x11, 0x41, 0x42, 0x3d, 0x39, 0xb8, 0x30, 0x08, 0x4f,
+    0x6b, 0xdd, 0x14, 0xd7, 0x7b, 0x13, 0xe4, 0xb0, 0x94, 0x0c, 0x86, 0xc8, 0x87, 0x41, 0x49, 0x77, 0x72, 0x34, 0xb1, 0xf1, 0x26, 0x68, 0x21, 0xc4,
+    0x98, 0xdf, 0xa8, 0x5b, 0x4d, 0xa1, 0x56, 0xc5, 0x66, 0x10, 0x1d, 0x69, 0x4d, 0x79, 0x62, 0x57, 0x6a, 0xf0, 0xbb, 0x51, 0xb1, 0x1e, 0x66, 0xad,
+    0x9a, 0xeb, 0x79, 0xf6, 0x61, 0x62, 0xa6, 0x18, 0x15, 0x9f, 0x06, 0xeb, 0xb0, 0x81, 0xda, 0x92, 0xc1, 0x1d, 0x86, 0x7c, 0x34, 0x4c, 0x56, 0xea,
+    0x54, 0x03, 0x72, 0x8a, 0x03, 0x4d, 0x9b, 0x36, 0x67, 0x84, 0xbb, 0x96, 0x54, 0x51, 0x0a, 0x25, 0x54, 0x41, 0x51, 0x42, 0x82, 0xb8, 0x8b, 0x55,
+    0x47, 0xbd, 0x4b, 0x3a, 0x79, 0x54, 0x73, 0xc0, 0xa2, 0x43, 0xf5, 0x08, 0x35, 0xd5, 0x00, 0xa3, 0xd0, 0x44, 0xc5, 0xe5, 0x0f, 0xef, 0xc9, 0x37,
+    0x99, 0x38, 0x50, 0x64, 0x5a, 0x41, 0xde, 0x7f, 0x98, 0x2d, 0x52, 0x01, 0x11, 0xcd, 0xb0, 0x16, 0x9e, 0xa0, 0x86, 0x76, 0x13, 0x53, 0x64, 0x8a,
+    0xa5, 0xa6, 0xef, 0x5a, 0xf9, 0xa9, 0x3d, 0x0d, 0x94, 0x0f, 0x6d, 0x91, 0xb7, 0x94, 0x0b, 0xeb, 0x78, 0x75, 0x6d, 0xcc, 0x3d, 0x8f, 0xac, 0x83,
+    0x79, 0xc2, 0x8a, 0xf9, 0x9d, 0x7a, 0xb6, 0x35, 0xe6, 0xac, 0x7a, 0xd6, 0xa8, 0x82, 0x42, 0x6b, 0x9f, 0xa1, 0xc4, 0xa3, 0x1c, 0x6f, 0xe1, 0x17,
+    0xe0, 0x5f, 0x22, 0x32, 0x30, 0x89, 0x70, 0x5a, 0x70, 0xa8, 0x88, 0x0e, 0x74, 0xb2, 0x09, 0xa5, 0x9b, 0xac, 0xdc, 0x03, 0x6f, 0x44, 0xca, 0xee,
+    0xbd, 0x07, 0xb0, 0xa0, 0x91, 0xe7, 0x30, 0xae, 0xbc, 0x74, 0x50, 0xe2, 0xf5, 0xc3, 0xfe, 0xd4, 0x61, 0xef, 0x86, 0xc3, 0xcb, 0xa9, 0xc3, 0xae,
+    0x3a, 0xfc, 0xf5, 0x13, 0x7f, 0x4d, 0x72, 0x7a, 0xe0, 0x05, 0x31, 0x48, 0xba, 0x6f, 0xe7, 0x80, 0x0d, 0x7c, 0x61, 0x10, 0x90, 0x12, 0x38, 0x11,
+    0x26, 0x32, 0x07, 0x86, 0x15, 0x31, 0x4d, 0xf9, 0xaf, 0xf7, 0xee, 0x22, 0xc0, 0xa9, 0x08, 0x38, 0x6f, 0xbf, 0x0f, 0xb2, 0xd5, 0x7d, 0xac, 0x82,
+    0x30, 0x0b, 0xa1, 0x61, 0x4c, 0x96, 0xc5, 0x34, 0x4b, 0x7a, 0x8c, 0x38, 0xf7, 0x0f, 0x69, 0xf0, 0x2e, 0x1f, 0xec, 0x61, 0xb7, 0xb2, 0xd4, 0xd3,
+    0xf0, 0x52, 0x57, 0xef, 0xce, 0x45, 0x1d, 0xc8, 0x23, 0xd8, 0x19, 0x23, 0xe8, 0x81, 0x1d, 0x74, 0xd8, 0x50, 0xee, 0xbb, 0x4f, 0x6c, 0xbe, 0xdd,
+    0xfa, 0xeb, 0x2c, 0x80, 0xe1, 0xda, 0xd0, 0x60, 0xfa, 0xa8, 0x3f, 0x75, 0xd4, 0x5b, 0x0d, 0x71, 0x34, 0x86, 0x6b, 0x24, 0x1f, 0x2f, 0x20, 0x79,
+    0xaf, 0x61, 0x0a, 0xec, 0x37, 0xbb, 0x28, 0x16, 0x47, 0xe8, 0x23, 0x6a, 0x04, 0xa7, 0x79, 0x31, 0x6e, 0xc3, 0xd6, 0x3c, 0xed, 0x67, 0xf6, 0x79,
+    0x28, 0x64, 0x2a, 0x29, 0xc7, 0x98, 0xd4, 0xec, 0x18, 0x27, 0xe8, 0x20, 0xf6, 0x1d, 0xf0, 0x94, 0x2e, 0xa8, 0x81, 0x8f, 0x17, 0x12, 0x76, 0x64,
+    0xcf, 0x55, 0xa4, 0xdc, 0x3a, 0xe3, 0x2e, 0x1d, 0xf5, 0x27, 0x8e, 0xfa, 0xd7, 0x8f, 0x2e, 0x27, 0x8e, 0x2e, 0x87, 0x10, 0x6b, 0xf7, 0x34, 0xc2,
+    0x06, 0xdc, 0x3a, 0x32, 0xba, 0xef, 0x21, 0xe3, 0x7b, 0x23, 0xb4, 0x5e, 0x05, 0x2c, 0xef, 0x00, 0x1c, 0x78, 0xd0, 0xa4, 0xa9, 0xbd, 0x24, 0xd6,
+    0xef, 0xb3, 0xda, 0x37, 0x7a, 0x49, 0xe2, 0xba, 0x37, 0x4f, 0xdf, 0x83, 0xf1, 0x6f, 0x30, 0xc2, 0x5b, 0xa6, 0x50, 0xcb, 0x58, 0xdc, 0xed, 0x73,
+    0x1e, 0x2e, 0xa8, 0xf9, 0xda, 0x51, 0x1a, 0x60, 0x58, 0xce, 0xb9, 0xa3, 0xdf, 0xa4, 0x0c, 0xa6, 0xa1, 0xe5, 0xcd, 0x73, 0x2b, 0xb6, 0xd7, 0x94,
+    0xd3, 0xdc, 0xf2, 0x32, 0xa2, 0x7e, 0x19, 0x38, 0x18, 0xed, 0xfb, 0xb3, 0x7c, 0xe3, 0xe4, 0x6a, 0x6a, 0x7e, 0x0b, 0xae, 0xbe, 0x60, 0xf0, 0x87,
+    0xcf, 0x7c, 0x5e, 0x53, 0xfc, 0xa6, 0x5e, 0x94, 0xdc, 0xf9, 0x8f, 0x74, 0x1d, 0x84, 0xff, 0xd5, 0xb6, 0x1b, 0xde, 0x7e, 0x2c, 0x27, 0x9f, 0x34,
+    0x16, 0x30, 0x18, 0x97, 0x15, 0xcc, 0x47, 0x94, 0xed, 0xba, 0x6d, 0x7f, 0xd0, 0xf5, 0x7b, 0x46, 0xf8, 0x93, 0x46, 0xf4, 0xbc, 0xab, 0x5f, 0xd0,
+    0x36, 0x6f, 0x39, 0x3f, 0x86, 0x6e, 0xb8, 0xb6, 0xda, 0x31, 0x0a, 0xe4, 0x18, 0xf8, 0xbb, 0x98, 0xb3, 0x80, 0xd1, 0x91, 0xcd, 0xd0, 0x2c, 0x9f,
+    0xf9, 0x30, 0xb0, 0x2c, 0xe0, 0x0c, 0xf7, 0x36, 0x49, 0x10, 0x86, 0x6b, 0x3f, 0xd8, 0x0e, 0x1e, 0x64, 0xef, 0xe2, 0x25, 0x5f, 0xc5, 0x91, 0x5d,
+    0xe4, 0x66, 0x13, 0x71, 0xa8, 0x9e, 0x5c, 0xbd, 0x1e, 0x31, 0x83, 0xc9, 0x9b, 0xbf, 0xff, 0xfa, 0x93, 0xbc, 0x69, 0xc5, 0xd6, 0xf8, 0xa9, 0xf3,
+    0x30, 0x99, 0x1f, 0xf0, 0xf9, 0x7a, 0xf8, 0xec, 0x59, 0x13, 0xda, 0x1d, 0xbf, 0xf7, 0x08, 0x57, 0x0b, 0x5f, 0x3d, 0x40, 0x58, 0x86, 0xaa, 0x9e,
+    0x3f, 0x2e, 0x66, 0xac, 0xed, 0xe9, 0xcc, 0xfa, 0x70, 0x55, 0x67, 0xe5, 0x86, 0xec, 0x05, 0x63, 0x66, 0x84, 0xea, 0x18, 0x28, 0x54, 0xd1, 0x01,
+    0x3b, 0x5b, 0xbd, 0x34, 0x82, 0x28, 0x57, 0xc8, 0x3e, 0xe4, 0x2e, 0x28, 0xc3, 0xd1, 0x5b, 0xd9, 0x6c, 0xf5, 0xc5, 0x3c, 0x55, 0xf7, 0x88, 0x7a,
+    0x9e, 0xfd, 0x03, 0x6f, 0x08, 0x6c, 0x43, 0xcb, 0x18, 0x00, 0x00,
+};
+
+// dashboard.js: 3243 bytes, gzip 1136 bytes
+const char    dashboard_js_etag[] = "\"f1899fb2\"";
+const uint8_t dashboard_js_gz[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x56, 0xcd, 0x6e, 0xdb, 0x46, 0x10, 0xbe, 0xeb, 0x29, 0x06, 0x44, 0x11, 0x52,
+    0x88, 0x49, 0xf9, 0xef, 0x60, 0x48, 0xa1, 0x8a, 0x26, 0x75, 0x13, 0x17, 0x4e, 0x5a, 0x40, 0x02, 0x7a, 0x28, 0x0a, 0x64, 0x45, 0x8e, 0x48, 0xd6,
+    0xab, 0x5d, 0x62, 0x77, 0x65, 0x5b, 0x4d, 0x04, 0xe4, 0x01, 0x02, 0xf4, 0xda, 0x9e, 0xfa, 0x1a, 0x7d, 0x9e, 0xbe, 0x40, 0xfb, 0x08, 0x9d, 0x5d,
+    0x92, 0x12, 0x2d, 0x4b, 0x86, 0x52, 0x37, 0x07, 0x51, 0xe4, 0xec, 0xfc, 0x7c, 0xdf, 0xec, 0xec, 0xce, 0x4c, 0xe7, 0x22, 0x31, 0x85, 0x14, 0x60,
+    0x64, 0x96, 0x71, 0x1c, 0xe7, 0x38, 0xc3, 0xa0, 0x0b, 0xef, 0x3a, 0x00, 0xa9, 0x4c, 0xe6, 0x33, 0x14, 0x26, 0x9a, 0xc8, 0x74, 0x11, 0x25, 0x9c,
+    0x69, 0x7d, 0x59, 0x68, 0x13, 0x55, 0x9a, 0x81, 0x9f, 0x32, 0x75, 0x15, 0xce, 0x64, 0x8a, 0x7e, 0x77, 0x40, 0xea, 0x89, 0x14, 0xda, 0x40, 0xa1,
+    0xbf, 0x26, 0x31, 0xc4, 0x3b, 0xad, 0x49, 0xcd, 0xb0, 0x42, 0xe8, 0x7b, 0xf6, 0x2b, 0x83, 0x0c, 0xcd, 0x39, 0x47, 0xfb, 0xfa, 0x7c, 0x71, 0x91,
+    0x06, 0xbe, 0xb1, 0x98, 0xc2, 0x82, 0x0c, 0xfd, 0x6e, 0x54, 0x08, 0x81, 0x6a, 0x8c, 0xb7, 0x86, 0x42, 0xd4, 0xb1, 0xbe, 0x04, 0xff, 0xaf, 0xdf,
+    0x3e, 0xfc, 0xfd, 0xe7, 0xaf, 0x3e, 0xf4, 0xc1, 0xff, 0xe7, 0x8f, 0x8f, 0xbf, 0xfb, 0x7b, 0xf8, 0x33, 0xe4, 0x63, 0xa7, 0xbf, 0xcb, 0x22, 0xcb,
+    0x0d, 0xbc, 0xb6, 0xd8, 0xac, 0x4f, 0x27, 0x76, 0x5f, 0x83, 0xce, 0xb2, 0xd3, 0xe9, 0xf5, 0x60, 0x24, 0x58, 0xa9, 0x73, 0x69, 0x40, 0x8a, 0x04,
+    0xa1, 0x44, 0x05, 0x81, 0xc2, 0x2e, 0x41, 0x14, 0x98, 0x98, 0x03, 0x60, 0x53, 0x43, 0x22, 0x93, 0x33, 0x43, 0x0f, 0x84, 0x14, 0xaf, 0x0b, 0xab,
+    0x36, 0xd7, 0x39, 0x6a, 0xc0, 0x6b, 0x54, 0x0b, 0xe0, 0x32, 0x03, 0x5e, 0x08, 0x3c, 0x00, 0x6d, 0x98, 0x41, 0x48, 0x72, 0x26, 0x32, 0x04, 0x26,
+    0x52, 0xfb, 0x4a, 0x76, 0x73, 0x25, 0x6c, 0x24, 0x49, 0xda, 0x30, 0x42, 0x45, 0x7f, 0xe1, 0x88, 0x38, 0xc0, 0xf9, 0x35, 0x3d, 0x35, 0x04, 0xee,
+    0xff, 0x1b, 0xc4, 0x94, 0x30, 0x40, 0x29, 0x95, 0x81, 0xb3, 0x23, 0x72, 0x66, 0x35, 0x53, 0x98, 0x2c, 0xa0, 0x20, 0x25, 0x79, 0x43, 0x1b, 0xcb,
+    0xf4, 0x55, 0xb7, 0xc3, 0xd1, 0x40, 0x4e, 0xf9, 0x97, 0x14, 0x3a, 0x86, 0x1f, 0x7f, 0x1a, 0x38, 0x49, 0x15, 0x3a, 0x86, 0xc3, 0x01, 0x50, 0xa8,
+    0xc3, 0xf8, 0x22, 0xe5, 0x04, 0xe8, 0x28, 0xb6, 0x3b, 0x85, 0xa2, 0x10, 0xd9, 0x01, 0x1c, 0xc7, 0xe3, 0xbc, 0x10, 0x57, 0xee, 0xfd, 0x24, 0x1e,
+    0x95, 0xc8, 0xaa, 0xf7, 0xd3, 0xf8, 0x07, 0x56, 0x98, 0xf1, 0x78, 0xd4, 0xe9, 0x4c, 0x9b, 0x1a, 0x52, 0x28, 0x52, 0x54, 0x2f, 0x08, 0x7e, 0x5d,
+    0x42, 0x55, 0x4d, 0x58, 0x3e, 0xcf, 0xe5, 0x6d, 0xbb, 0x28, 0x36, 0xf6, 0xc4, 0xb3, 0x2a, 0x61, 0x5d, 0x1a, 0xa8, 0x3c, 0x57, 0x10, 0x0e, 0xb2,
+    0x99, 0x71, 0xb2, 0xf3, 0x3c, 0x2b, 0x28, 0xa6, 0x10, 0xd4, 0x1c, 0x22, 0x8e, 0x22, 0x33, 0x39, 0xc4, 0x31, 0x81, 0x87, 0x27, 0x4f, 0x1a, 0x26,
+    0xf6, 0xb3, 0x0a, 0x0d, 0x8d, 0xad, 0xff, 0x2c, 0x2d, 0xae, 0x69, 0x7d, 0xc1, 0x31, 0xf6, 0xec, 0xae, 0x87, 0x8c, 0x17, 0x99, 0xe8, 0x27, 0x14,
+    0x1c, 0xd5, 0x80, 0x30, 0x72, 0xa9, 0xfa, 0x99, 0x62, 0x8b, 0x01, 0x4c, 0x09, 0x41, 0xa8, 0x8b, 0x5f, 0xb0, 0x7f, 0x74, 0x52, 0xde, 0x0e, 0xa0,
+    0x64, 0x69, 0x4a, 0x6c, 0x43, 0x23, 0xcb, 0xfe, 0xf1, 0x21, 0x49, 0xbc, 0xe1, 0x1b, 0x69, 0x59, 0xd1, 0x6e, 0x68, 0xe6, 0x38, 0x2f, 0xd0, 0x44,
+    0xcf, 0x26, 0x6a, 0xf8, 0xbd, 0x42, 0xad, 0xc1, 0x1b, 0xbb, 0xc3, 0x01, 0x63, 0xc6, 0xaf, 0x3c, 0x3a, 0x53, 0x16, 0x97, 0x22, 0x85, 0x1e, 0x61,
+    0x18, 0xba, 0xb2, 0x5c, 0x02, 0x72, 0x8d, 0x0d, 0xc4, 0x9a, 0xcd, 0x54, 0xaa, 0x73, 0x96, 0xe4, 0xc1, 0x4c, 0x67, 0x10, 0x0f, 0xeb, 0x45, 0x4b,
+    0xd8, 0x4a, 0x22, 0x25, 0x79, 0x45, 0xcd, 0xcf, 0xe6, 0xa8, 0xa9, 0x6a, 0x57, 0x0a, 0xb0, 0xe2, 0xf9, 0x34, 0x86, 0xb7, 0x8e, 0xa8, 0x3b, 0x69,
+    0xb1, 0x67, 0x3d, 0x39, 0x6d, 0x6f, 0x68, 0xc5, 0xc3, 0xf6, 0x9a, 0x4b, 0x36, 0x67, 0x13, 0xe4, 0xa1, 0x9e, 0x31, 0xce, 0xbd, 0xe1, 0x4b, 0xab,
+    0x59, 0x81, 0x6c, 0x2b, 0x4e, 0xe6, 0x93, 0x09, 0x47, 0x6f, 0xf8, 0xc5, 0x3b, 0x0b, 0xc3, 0xe6, 0x6e, 0x59, 0x2b, 0xb5, 0x9e, 0x6f, 0x07, 0x35,
+    0x98, 0x9a, 0xd9, 0x3d, 0xd0, 0xac, 0xd8, 0x1b, 0x31, 0x2b, 0xf6, 0x82, 0xfb, 0xd5, 0xc5, 0xe7, 0xc2, 0xaa, 0x17, 0x54, 0xf8, 0xb3, 0xbd, 0xf1,
+    0x56, 0xea, 0xde, 0xa7, 0x00, 0x59, 0x43, 0x70, 0xff, 0x4b, 0x57, 0xea, 0xcb, 0xba, 0xba, 0xd7, 0x55, 0x7c, 0xd4, 0xfd, 0x3f, 0xf6, 0x75, 0x75,
+    0x8e, 0xa3, 0x28, 0xda, 0x9d, 0xb2, 0xb6, 0x8c, 0x37, 0x16, 0xe1, 0x0d, 0xbb, 0xc6, 0x26, 0xc8, 0xca, 0x74, 0xcb, 0xeb, 0x8e, 0xa7, 0xe3, 0x59,
+    0x27, 0xb9, 0x4d, 0xec, 0xb8, 0xfb, 0xe8, 0xed, 0x6f, 0x2e, 0xa4, 0xbd, 0x49, 0x99, 0x45, 0x69, 0x19, 0xa5, 0xd2, 0xe8, 0xcf, 0xc0, 0xe8, 0x04,
+    0xde, 0xbf, 0x6f, 0xdd, 0x3f, 0xa7, 0x8f, 0x27, 0xd8, 0xdc, 0xb2, 0x7b, 0x13, 0xd4, 0xb5, 0x41, 0x38, 0x61, 0xea, 0xd1, 0x14, 0xeb, 0xeb, 0xba,
+    0x6a, 0x8d, 0xaf, 0xc6, 0xaf, 0x2f, 0xe9, 0x12, 0xb5, 0x8c, 0xda, 0x6b, 0x3a, 0xa1, 0x33, 0xc3, 0xc7, 0xb2, 0xa4, 0xb5, 0xbb, 0xb2, 0x57, 0x68,
+    0x7b, 0xa7, 0xeb, 0x93, 0xab, 0xbe, 0xc0, 0xca, 0x92, 0x3a, 0xc3, 0xa5, 0xcc, 0x02, 0x7b, 0x1c, 0xda, 0xad, 0x81, 0x6e, 0xe0, 0xd9, 0x43, 0x7d,
+    0xc1, 0xae, 0x17, 0x82, 0xf1, 0xaa, 0x23, 0xd8, 0x2f, 0x77, 0xa2, 0x5e, 0xd0, 0x3d, 0x6d, 0x7b, 0x21, 0xe5, 0xd8, 0x7e, 0x36, 0xcd, 0x61, 0x73,
+    0xbd, 0xe9, 0x12, 0x43, 0x38, 0x3b, 0x3c, 0xa4, 0xbe, 0x70, 0xcf, 0x3e, 0xbe, 0x27, 0x8a, 0x34, 0xa7, 0x56, 0x1d, 0x84, 0xa7, 0xd6, 0x60, 0x15,
+    0xb3, 0x4d, 0xb7, 0x25, 0xd8, 0xc6, 0x95, 0x4b, 0x96, 0x36, 0xd3, 0x41, 0xdd, 0x05, 0xa7, 0x68, 0xe8, 0x6e, 0xf7, 0x7b, 0xd4, 0xf2, 0x35, 0x8d,
+    0x1c, 0x34, 0x11, 0x88, 0x40, 0xd9, 0x7b, 0x5e, 0xb9, 0xc8, 0x41, 0xb7, 0x96, 0xa5, 0xcc, 0x30, 0x77, 0xfd, 0xef, 0x93, 0x8f, 0x0d, 0x1e, 0xd4,
+    0x21, 0x5b, 0x69, 0xb6, 0x9e, 0xba, 0x83, 0xfa, 0x72, 0x69, 0xc2, 0xb7, 0xdb, 0xd6, 0x06, 0x8c, 0x9f, 0xb5, 0x14, 0x5b, 0x60, 0xac, 0x07, 0x06,
+    0x2b, 0x8b, 0x9a, 0x4f, 0x2a, 0x77, 0x1a, 0x20, 0x56, 0xc3, 0x83, 0x5b, 0xab, 0x3e, 0x68, 0x85, 0x46, 0x89, 0xf6, 0x18, 0x50, 0x81, 0xa0, 0x04,
+    0xdd, 0x14, 0x22, 0x95, 0x37, 0x11, 0x35, 0x54, 0x37, 0xb8, 0x54, 0x37, 0x13, 0xaa, 0xc0, 0xb7, 0x09, 0xf3, 0x0f, 0xa0, 0x49, 0xe0, 0x9d, 0xc9,
+    0x61, 0x6a, 0xc7, 0x9b, 0x18, 0x04, 0xde, 0x54, 0x63, 0xcf, 0x48, 0xce, 0x15, 0xed, 0x8e, 0x9f, 0x1b, 0x53, 0xf6, 0x7b, 0x3d, 0x1f, 0x9e, 0x52,
+    0xbe, 0x13, 0xc7, 0x28, 0xca, 0xa5, 0x36, 0x82, 0xcd, 0x90, 0x64, 0x7e, 0xff, 0xec, 0xa8, 0x87, 0x6e, 0x4e, 0xf2, 0xeb, 0x14, 0x60, 0x1a, 0x49,
+    0x21, 0x29, 0x3f, 0xe4, 0xae, 0xbd, 0x45, 0xab, 0xd5, 0x6d, 0xc0, 0x32, 0xc2, 0x85, 0x36, 0x15, 0xeb, 0xcc, 0x62, 0xe4, 0x72, 0xdb, 0x7d, 0xc0,
+    0x2e, 0xe1, 0xc8, 0x54, 0x63, 0xf9, 0x5f, 0xf7, 0x72, 0xf9, 0x50, 0x04, 0x97, 0xec, 0x75, 0x84, 0x66, 0x23, 0x4a, 0x3a, 0xfc, 0x78, 0x21, 0x4c,
+    0x03, 0x72, 0xdb, 0x4e, 0xec, 0xf4, 0x69, 0xe7, 0xcd, 0xb5, 0xcb, 0x66, 0x30, 0xb1, 0x23, 0x6b, 0xf0, 0xed, 0xe8, 0xbb, 0x37, 0x91, 0x73, 0xbe,
+    0xa6, 0xff, 0x29, 0xae, 0x35, 0x4d, 0x46, 0xb6, 0xe6, 0x36, 0xbd, 0x57, 0x83, 0xe8, 0x56, 0x4f, 0x77, 0x4f, 0x11, 0x15, 0x10, 0xfd, 0xfe, 0x05,
+    0x43, 0x5e, 0x86, 0x7f, 0xab, 0x0c, 0x00, 0x00,
+};
@@ -0,0 +1,141 @@
+// host shim: the part of the ESP32 Arduino core (3.x, IDF 5) the library uses, on Linux / macOS
+#pragma once
+
+//  The shims let the library sources compile unchanged for the host (see extras/host/CMakeLists.txt). Time is the
+//  wall clock, tasks are threads, the network is the host's, I2S reads and writes WAV files. Memory is one heap:
+//  PSRAM and internal RAM are the same malloc() and the free sizes are made up.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+#include "newlib.h"
+#include "stdlib_noniso.h"
+#include "WCharacter.h"
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "esp32-hal-log.h"
+#include "esp_arduino_version.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+using std::max;
+using std::min;
+
+typedef bool    boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(a)  (*(const uint8_t*)(a))
+#define pgm_read_word(a)  (*(const uint16_t*)(a))
+#define pgm_read_dword(a) (*(const uint32_t*)(a))
+#define pgm_read_float(a) (*(const float*)(a))
+
+#define LOW          0x0
+#define HIGH         0x1
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define PI      3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI  6.283185307179586476925286766559
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : ((v) > (hi) ? (hi) : (v)))
+#define _min(a, b) ((a) < (b) ? (a) : (b))
+#define _max(a, b) ((a) > (b) ? (a) : (b))
+
+typedef int esp_err_t;
+#define ESP_OK                0
+#define ESP_FAIL              -1
+#define ESP_ERR_NO_MEM        0x101
+#define ESP_ERR_INVALID_ARG   0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_TIMEOUT       0x107
+typedef int gpio_num_t;
+
+// time, from the start of the program
+unsigned long millis();
+unsigned long micros();
+void          delay(uint32_t ms);
+void          delayMicroseconds(uint32_t us);
+void          yield();                       // gives the CPU away briefly, the loops of the sketches spin on it
+int64_t       esp_timer_get_time();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// no pins on the host: inputs read HIGH (a button is not pressed), outputs are ignored
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+void neopixelWrite(uint8_t pin, uint8_t r, uint8_t g, uint8_t b);
+
+// memory: one heap
+#define MALLOC_CAP_EXEC     (1 << 0)
+#define MALLOC_CAP_32BIT    (1 << 1)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+inline void*  heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+inline void*  heap_caps_calloc(size_t n, size_t size, uint32_t) { return calloc(n, size); }
+inline void*  heap_caps_realloc(void* p, size_t size, uint32_t) { return realloc(p, size); }
+inline void*  heap_caps_malloc_prefer(size_t size, size_t, ...) { return malloc(size); }
+inline void*  heap_caps_calloc_prefer(size_t n, size_t size, size_t, ...) { return calloc(n, size); }
+inline void   heap_caps_free(void* p) { free(p); }
+size_t        heap_caps_get_free_size(uint32_t caps);
+size_t        heap_caps_get_largest_free_block(uint32_t caps);
+inline void*  ps_malloc(size_t size) { return malloc(size); }
+inline void*  ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+inline void*  ps_realloc(void* p, size_t size) { return realloc(p, size); }
+inline bool   psramFound() { return true; }
+inline bool   psramInit() { return true; }
+
+class EspClass {
+
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getHeapSize();
+    uint32_t getPsramSize();
+    uint32_t getFreePsram();
+    uint32_t getCpuFreqMHz() { return 240; };
+    uint32_t getCycleCount() { return (uint32_t)(micros() * 240); };
+    uint64_t getEfuseMac() { return 0x00CAFE0DB0E1ULL; };
+    void     restart();
+};
+extern EspClass ESP;
+
+class HardwareSerial : public Stream {          // stdout, nothing to read
+
+public:
+    void   begin(unsigned long /*baud*/, ...) {};
+    void   end() {};
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    using  Print::write;
+    int    available() override { return 0; };
+    int    read() override { return -1; };
+    int    peek() override { return -1; };
+    int    availableForWrite() override { return 1024; };
+    void   flush() override;
+    operator bool() const { return true; };
+};
+extern HardwareSerial Serial;
@@ -0,0 +1,446 @@
+// host shim: the part of ArduinoJson the library uses, in the tree so the host build needs no network
+#pragma once
+
+#include "Arduino.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//  Same names and semantics as ArduinoJson 7 for what src/ calls: documents of objects, arrays, strings, numbers and
+//  booleans, doc["key"] read without creating the member and written with creating it, createNestedObject() /
+//  createNestedArray(), as<T>(), serializeJson() into a String or a buffer and deserializeJson() from a String or
+//  text (\u escapes with surrogate pairs). No capacity: DynamicJsonDocument(size) ignores the size like version 7.
+//  To build against the real header instead: cmake -DARDUINOJSON_INCLUDE=<directory of ArduinoJson.h>.
+
+namespace host_json {
+
+struct Node {
+    enum type_t : uint8_t { NUL, BOOL, INT, FLOAT, STR, ARR, OBJ };
+    type_t                                             type = NUL;
+    bool                                               b = false;
+    long long                                          i = 0;
+    double                                             f = 0;
+    std::string                                        s;
+    std::vector<std::shared_ptr<Node>>                 items;
+    std::vector<std::pair<std::string, std::shared_ptr<Node>>> members;
+
+    void reset(type_t t) { type = t; b = false; i = 0; f = 0; s.clear(); items.clear(); members.clear(); }
+    std::shared_ptr<Node> member(const std::string& key) const {
+        if(type == OBJ) for(auto& m : members) if(m.first == key) return m.second;
+        return nullptr;
+    }
+    std::shared_ptr<Node> item(size_t n) const { return type == ARR && n < items.size() ? items[n] : nullptr; }
+};
+
+inline void        write(const Node* n, std::string& out);
+inline const char* parse(Node& n, const char* p, const char* end, int depth);
+
+} // namespace host_json
+
+class JsonArray;
+class JsonObject;
+
+class JsonVariant { // a node, or a member / element of a parent that is created on the first write
+
+public:
+    JsonVariant() {};
+    explicit JsonVariant(std::shared_ptr<host_json::Node> n) : m_node(n) {};
+
+    JsonVariant operator[](const char* key) const { return JsonVariant(node(), std::string(key), 0); };
+    JsonVariant operator[](const String& key) const { return (*this)[key.c_str()]; };
+    JsonVariant operator[](int n) const { return JsonVariant(node(), std::string(), n); };
+
+    JsonVariant& operator=(const JsonVariant& v) { // assignment of a value copies it, like ArduinoJson
+        auto n = make();
+        if(n && v.node() != n) { auto src = v.node(); if(src) *n = *src; else n->reset(host_json::Node::NUL); }
+        return *this;
+    };
+    JsonVariant& operator=(const char* s) { if(auto n = make()) { n->reset(s ? host_json::Node::STR : host_json::Node::NUL); if(s) n->s = s; } return *this; };
+    JsonVariant& operator=(const String& s) { return *this = s.c_str(); };
+    JsonVariant& operator=(bool v) { if(auto n = make()) { n->reset(host_json::Node::BOOL); n->b = v; } return *this; };
+    JsonVariant& operator=(double v) { if(auto n = make()) { n->reset(host_json::Node::FLOAT); n->f = v; } return *this; };
+    JsonVariant& operator=(float v) { return *this = (double)v; };
+    JsonVariant& operator=(int v) { return setInt(v); };
+    JsonVariant& operator=(unsigned v) { return setInt(v); };
+    JsonVariant& operator=(long v) { return setInt(v); };
+    JsonVariant& operator=(unsigned long v) { return setInt(v); };
+    JsonVariant& operator=(long long v) { return setInt(v); };
+    JsonVariant& operator=(const JsonArray& v);
+    JsonVariant& operator=(const JsonObject& v);
+
+    template <typename T> T as() const;
+    template <typename T> bool is() const;
+    template <typename T> T operator|(T def) const { return isNull() ? def : as<T>(); };
+    const char* operator|(const char* def) const { auto n = node(); return n && n->type == host_json::Node::STR ? n->s.c_str() : def; };
+    bool        isNull() const { auto n = node(); return !n || n->type == host_json::Node::NUL; };
+    bool        containsKey(const char* key) const { auto n = node(); return n && n->member(key); };
+    size_t      size() const { auto n = node(); return !n ? 0 : n->type == host_json::Node::ARR ? n->items.size() : n->type == host_json::Node::OBJ ? n->members.size() : 0; };
+    template <typename T> bool add(T v);
+
+    JsonObject createNestedObject() const;
+    JsonObject createNestedObject(const char* key) const;
+    JsonArray  createNestedArray() const;
+    JsonArray  createNestedArray(const char* key) const;
+
+    std::shared_ptr<host_json::Node> node() const { // NULL while the member / element does not exist
+        if(m_node || !m_parent) return m_node;
+        return m_key.size() ? m_parent->member(m_key) : m_parent->item(m_index);
+    };
+    std::shared_ptr<host_json::Node> make() const { // creates the member / element, a null parent becomes the container
+        if(auto n = node()) return n;
+        if(!m_parent) return nullptr;
+        auto n = std::make_shared<host_json::Node>();
+        if(m_key.size()) {
+            if(m_parent->type != host_json::Node::OBJ) m_parent->reset(host_json::Node::OBJ);
+            m_parent->members.emplace_back(m_key, n);
+        } else {
+            if(m_parent->type != host_json::Node::ARR) m_parent->reset(host_json::Node::ARR);
+            if(m_index != m_parent->items.size()) return nullptr; // only the next element can be created
+            m_parent->items.push_back(n);
+        }
+        return n;
+    };
+
+protected:
+    JsonVariant(std::shared_ptr<host_json::Node> parent, std::string key, size_t index)
+        : m_parent(parent ? parent : std::make_shared<host_json::Node>()), m_key(std::move(key)), m_index(index) {};
+    template <typename T> JsonVariant& setInt(T v) { if(auto n = make()) { n->reset(host_json::Node::INT); n->i = (long long)v; } return *this; };
+    std::shared_ptr<host_json::Node> append(host_json::Node::type_t t) const {
+        auto p = make();
+        if(!p) return nullptr;
+        if(p->type != host_json::Node::ARR) p->reset(host_json::Node::ARR);
+        p->items.push_back(std::make_shared<host_json::Node>());
+        p->items.back()->type = t;
+        return p->items.back();
+    };
+
+    std::shared_ptr<host_json::Node> m_node;
+    std::shared_ptr<host_json::Node> m_parent;
+    std::string                      m_key;
+    size_t                           m_index = 0;
+};
+
+class JsonObject : public JsonVariant {
+
+public:
+    JsonObject() {};
+    explicit JsonObject(std::shared_ptr<host_json::Node> n) : JsonVariant(n) {};
+    using JsonVariant::operator=;
+};
+
+class JsonArray : public JsonVariant {
+
+public:
+    JsonArray() {};
+    explicit JsonArray(std::shared_ptr<host_json::Node> n) : JsonVariant(n) {};
+    using JsonVariant::operator=;
+};
+
+inline JsonVariant& JsonVariant::operator=(const JsonArray& v) {
+    if(auto n = make()) { if(auto src = v.node()) *n = *src; else n->reset(host_json::Node::ARR); }
+    return *this;
+}
+inline JsonVariant& JsonVariant::operator=(const JsonObject& v) {
+    if(auto n = make()) { if(auto src = v.node()) *n = *src; else n->reset(host_json::Node::OBJ); }
+    return *this;
+}
+inline JsonObject JsonVariant::createNestedObject() const { return JsonObject(append(host_json::Node::OBJ)); }
+inline JsonArray  JsonVariant::createNestedArray() const { return JsonArray(append(host_json::Node::ARR)); }
+inline JsonObject JsonVariant::createNestedObject(const char* key) const {
+    JsonVariant v = (*this)[key];
+    auto n = v.make();
+    if(n) n->reset(host_json::Node::OBJ);
+    return JsonObject(n);
+}
+inline JsonArray JsonVariant::createNestedArray(const char* key) const {
+    JsonVariant v = (*this)[key];
+    auto n = v.make();
+    if(n) n->reset(host_json::Node::ARR);
+    return JsonArray(n);
+}
+template <typename T> bool JsonVariant::add(T v) {
+    auto n = append(host_json::Node::NUL);
+    if(!n) return false;
+    JsonVariant item(n);
+    item = v;
+    return true;
+}
+
+template <typename T> T JsonVariant::as() const { // numbers and booleans
+    auto n = node();
+    if(!n) return T();
+    switch(n->type) {
+        case host_json::Node::BOOL:  return (T)n->b;
+        case host_json::Node::INT:   return (T)n->i;
+        case host_json::Node::FLOAT: return (T)n->f;
+        default:                     return T();
+    }
+}
+template <> inline const char* JsonVariant::as<const char*>() const {
+    auto n = node();
+    return n && n->type == host_json::Node::STR ? n->s.c_str() : NULL;
+}
+template <> inline String JsonVariant::as<String>() const { // like ArduinoJson: a string as it is, anything else as JSON
+    auto n = node();
+    if(!n || n->type == host_json::Node::NUL) return String("null");
+    if(n->type == host_json::Node::STR) return String(n->s.c_str(), n->s.size());
+    std::string out;
+    host_json::write(n.get(), out);
+    return String(out);
+}
+template <> inline JsonObject JsonVariant::as<JsonObject>() const {
+    auto n = node();
+    return JsonObject(n && n->type == host_json::Node::OBJ ? n : nullptr);
+}
+template <> inline JsonArray JsonVariant::as<JsonArray>() const {
+    auto n = node();
+    return JsonArray(n && n->type == host_json::Node::ARR ? n : nullptr);
+}
+template <typename T> bool JsonVariant::is() const {
+    auto n = node();
+    if(!n) return false;
+    if(std::is_same<T, bool>::value) return n->type == host_json::Node::BOOL;
+    if(std::is_floating_point<T>::value) return n->type == host_json::Node::FLOAT || n->type == host_json::Node::INT;
+    if(std::is_integral<T>::value) return n->type == host_json::Node::INT;
+    if(std::is_same<T, const char*>::value || std::is_same<T, String>::value) return n->type == host_json::Node::STR;
+    if(std::is_same<T, JsonObject>::value) return n->type == host_json::Node::OBJ;
+    if(std::is_same<T, JsonArray>::value) return n->type == host_json::Node::ARR;
+    return false;
+}
+
+class JsonDocument : public JsonVariant {
+
+public:
+    explicit JsonDocument(size_t /*capacity*/ = 0) : JsonVariant(std::make_shared<host_json::Node>()) {};
+    JsonDocument(const JsonDocument& d) : JsonVariant(std::make_shared<host_json::Node>(*d.m_node)) {};
+    JsonDocument& operator=(const JsonDocument& d) { *m_node = *d.m_node; return *this; };
+    using JsonVariant::operator=;
+    void clear() { m_node->reset(host_json::Node::NUL); };
+    template <typename T> T to() {
+        m_node->reset(std::is_same<T, JsonArray>::value ? host_json::Node::ARR : host_json::Node::OBJ);
+        return T(m_node);
+    };
+};
+typedef JsonDocument DynamicJsonDocument;
+template <size_t N> class StaticJsonDocument : public JsonDocument {};
+
+class DeserializationError {
+
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+    DeserializationError(Code c = Ok) : m_code(c) {};
+    Code        code() const { return m_code; };
+    const char* c_str() const {
+        static const char* names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+        return names[m_code];
+    };
+    const char* f_str() const { return c_str(); };
+    explicit operator bool() const { return m_code != Ok; };
+    bool operator==(Code c) const { return m_code == c; };
+    bool operator!=(Code c) const { return m_code != c; };
+
+private:
+    Code m_code;
+};
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* json, size_t len);
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* json) { return deserializeJson(doc, json, json ? strlen(json) : 0); }
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& json) { return deserializeJson(doc, json.c_str(), json.length()); }
+inline DeserializationError deserializeJson(JsonDocument& doc, const std::string& json) { return deserializeJson(doc, json.data(), json.size()); }
+inline DeserializationError deserializeJson(JsonDocument& doc, Stream& in) {
+    String s;
+    while(in.available() > 0) { int c = in.read(); if(c < 0) break; s += (char)c; }
+    return deserializeJson(doc, s);
+}
+
+inline size_t serializeJson(const JsonVariant& v, std::string& out) {
+    out.clear();
+    auto n = v.node();
+    host_json::write(n.get(), out);
+    return out.size();
+}
+inline size_t serializeJson(const JsonVariant& v, String& out) {
+    std::string s;
+    serializeJson(v, s);
+    out = String(s);
+    return s.size();
+}
+inline size_t serializeJson(const JsonVariant& v, Print& out) {
+    std::string s;
+    serializeJson(v, s);
+    return out.write((const uint8_t*)s.data(), s.size());
+}
+inline size_t serializeJson(const JsonVariant& v, char* buf, size_t size) {
+    std::string s;
+    serializeJson(v, s);
+    if(!size) return 0;
+    size_t n = std::min(s.size(), size - 1);
+    memcpy(buf, s.data(), n);
+    buf[n] = '\0';
+    return n;
+}
+inline size_t measureJson(const JsonVariant& v) { std::string s; return serializeJson(v, s); }
+
+//----------------------------------------------------------------------------------------------------------------------
+namespace host_json {
+
+inline void writeString(const std::string& s, std::string& out) {
+    out += '"';
+    for(unsigned char c : s) {
+        switch(c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if(c < 0x20) { char e[7]; snprintf(e, sizeof(e), "\\u%04x", c); out += e; }
+                else out += (char)c;
+        }
+    }
+    out += '"';
+}
+
+inline void write(const Node* n, std::string& out) {
+    char num[32];
+    if(!n) { out += "null"; return; }
+    switch(n->type) {
+        case Node::NUL:   out += "null"; break;
+        case Node::BOOL:  out += n->b ? "true" : "false"; break;
+        case Node::INT:   snprintf(num, sizeof(num), "%lld", n->i); out += num; break;
+        case Node::FLOAT: snprintf(num, sizeof(num), "%.9g", n->f); out += num; break;
+        case Node::STR:   writeString(n->s, out); break;
+        case Node::ARR:
+            out += '[';
+            for(size_t k = 0; k < n->items.size(); k++) { if(k) out += ','; write(n->items[k].get(), out); }
+            out += ']';
+            break;
+        case Node::OBJ:
+            out += '{';
+            for(size_t k = 0; k < n->members.size(); k++) {
+                if(k) out += ',';
+                writeString(n->members[k].first, out);
+                out += ':';
+                write(n->members[k].second.get(), out);
+            }
+            out += '}';
+            break;
+    }
+}
+
+inline const char* skip(const char* p, const char* end) {
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+inline void utf8(uint32_t cp, std::string& out) {
+    if(cp < 0x80) out += (char)cp;
+    else if(cp < 0x800) { out += (char)(0xC0 | cp >> 6); out += (char)(0x80 | (cp & 0x3F)); }
+    else if(cp < 0x10000) { out += (char)(0xE0 | cp >> 12); out += (char)(0x80 | (cp >> 6 & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+    else { out += (char)(0xF0 | cp >> 18); out += (char)(0x80 | (cp >> 12 & 0x3F)); out += (char)(0x80 | (cp >> 6 & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+}
+
+inline const char* hex4(const char* p, const char* end, uint32_t& v) { // NULL if not four hex digits
+    if(end - p < 4) return NULL;
+    v = 0;
+    for(int k = 0; k < 4; k++, p++) {
+        char c = *p;
+        v <<= 4;
+        if(c >= '0' && c <= '9') v |= c - '0';
+        else if(c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return NULL;
+    }
+    return p;
+}
+
+inline const char* parseString(std::string& s, const char* p, const char* end) { // p after the opening quote
+    while(p < end && *p != '"') {
+        if(*p != '\\') { s += *p++; continue; }
+        if(++p >= end) return NULL;
+        char c = *p++;
+        switch(c) {
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case '"': case '\\': case '/': s += c; break;
+            case 'u': {
+                uint32_t cp, lo;
+                if(!(p = hex4(p, end, cp))) return NULL;
+                if(cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u' && hex4(p + 2, end, lo) &&
+                   lo >= 0xDC00 && lo < 0xE000) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    p += 6;
+                }
+                else if(cp >= 0xD800 && cp < 0xE000) cp = 0xFFFD; // lone surrogate
+                utf8(cp, s);
+                break;
+            }
+            default: return NULL;
+        }
+    }
+    return p < end ? p + 1 : NULL;
+}
+
+inline const char* parse(Node& n, const char* p, const char* end, int depth) { // NULL on an error
+    if(depth > 64) return NULL;
+    p = skip(p, end);
+    if(p >= end) return NULL;
+    auto word = [&](const char* w) { size_t l = strlen(w); return (size_t)(end - p) >= l && !memcmp(p, w, l); };
+    if(*p == '"') { n.reset(Node::STR); return parseString(n.s, p + 1, end); }
+    if(word("null"))  { n.reset(Node::NUL); return p + 4; }
+    if(word("true"))  { n.reset(Node::BOOL); n.b = true; return p + 4; }
+    if(word("false")) { n.reset(Node::BOOL); return p + 5; }
+    if(*p == '[' || *p == '{') {
+        bool obj = *p++ == '{';
+        n.reset(obj ? Node::OBJ : Node::ARR);
+        p = skip(p, end);
+        if(p < end && *p == (obj ? '}' : ']')) return p + 1;
+        while(p < end) {
+            auto child = std::make_shared<Node>();
+            if(obj) {
+                std::string key;
+                p = skip(p, end);
+                if(p >= end || *p != '"' || !(p = parseString(key, p + 1, end))) return NULL;
+                p = skip(p, end);
+                if(p >= end || *p++ != ':') return NULL;
+                n.members.emplace_back(key, child);
+            }
+            else n.items.push_back(child);
+            if(!(p = parse(*child, p, end, depth + 1))) return NULL;
+            p = skip(p, end);
+            if(p < end && *p == ',') { p++; continue; }
+            if(p < end && *p == (obj ? '}' : ']')) return p + 1;
+            return NULL;
+        }
+        return NULL;
+    }
+    std::string num;
+    bool        real = false;
+    while(p < end && (isdigit((unsigned char)*p) || strchr("+-.eE", *p))) { real |= strchr(".eE", *p) != NULL; num += *p++; }
+    if(num.empty()) return NULL;
+    char* e;
+    if(real) { n.reset(Node::FLOAT); n.f = strtod(num.c_str(), &e); }
+    else     { n.reset(Node::INT); n.i = strtoll(num.c_str(), &e, 10); }
+    return *e ? NULL : p;
+}
+
+} // namespace host_json
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* json, size_t len) {
+    doc.clear();
+    const char* end = json + len;
+    const char* p = host_json::skip(json, end);
+    if(p >= end) return DeserializationError::EmptyInput;
+    host_json::Node n;
+    const char*     q = host_json::parse(n, p, end, 0);
+    if(!q) return DeserializationError::InvalidInput;
+    *doc.node() = std::move(n);
+    return DeserializationError::Ok;
+}
@@ -0,0 +1,37 @@
+// host shim: I2SClass of the ESP32 core (3.x), receive side, the microphone is a WAV file or silence
+#pragma once
+
+#include "Arduino.h"
+#include "driver/i2s_std.h"
+
+//  Samples come at the sample rate from begin() on, in DMA frames of 240 like the core. read() waits for the frame
+//  of the next sample (up to the timeout), samples older than the DMA ring (100 ms) are lost like on the device, and
+//  available() is > 0 while the channel runs, as in the core. The samples are hostSimSetMicInput() (16 bit PCM WAV,
+//  mono or the left channel), silence after its end. Only the receive side, TX is driver/i2s_std.h.
+
+typedef enum { I2S_MODE_STD, I2S_MODE_TDM, I2S_MODE_PDM_TX, I2S_MODE_PDM_RX } i2s_mode_t;
+
+class I2SClass : public Stream {
+
+public:
+    ~I2SClass() { end(); };
+    void   setPins(int8_t /*bclk*/, int8_t /*ws*/, int8_t /*dout*/, int8_t /*din*/ = -1, int8_t /*mclk*/ = -1) {};
+    void   setPinsPdmRx(int8_t /*clk*/, int8_t /*din0*/, int8_t /*din1*/ = -1, int8_t /*din2*/ = -1, int8_t /*din3*/ = -1) {};
+    void   setPinsPdmTx(int8_t /*clk*/, int8_t /*dout0*/, int8_t /*dout1*/ = -1) {};
+    bool   begin(i2s_mode_t mode, uint32_t rate, i2s_data_bit_width_t bits, i2s_slot_mode_t ch, int8_t slot_mask = -1);
+    bool   end();
+    int    available() override;
+    int    read() override;                              // one sample, 0 ... 65535, -1: none yet
+    int    peek() override { return -1; };
+    size_t readBytes(char* buf, size_t size) override;  // whole samples, waits for them up to the timeout
+    using  Stream::readBytes;
+    size_t write(uint8_t) override { return 0; };
+    size_t write(const uint8_t* /*buf*/, size_t /*size*/) override { return 0; };
+    using  Print::write;
+
+private:
+    bool     m_running = false;
+    uint32_t m_rate = 16000;
+    uint64_t m_start = 0;     // micros() of begin()
+    uint64_t m_taken = 0;     // samples read or lost since begin()
+};
@@ -0,0 +1,6 @@
+// host shim: the FFat file system, the "ffat" directory of the host root (see FS.h)
+#pragma once
+
+#include "FS.h"
+
+extern HostFS FFat;
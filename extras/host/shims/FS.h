@@ -0,0 +1,95 @@
+// host shim: fs::FS and fs::File of the ESP32 core over a directory of the host
+#pragma once
+
+#include <memory>
+#include "Arduino.h"
+
+//  Every file system object (SD, SD_MMC, SPIFFS, FFat, LittleFS) is a subdirectory of one host directory, see
+//  hostSimSetFsRoot() in host_sim.h (default: ./host_fs). Paths are the device paths, "/music/a.mp3".
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+
+public:
+    struct impl_t;
+    File() {};
+    explicit File(std::shared_ptr<impl_t> impl) : m_impl(impl) {};
+
+    size_t      write(uint8_t c) override { return write(&c, 1); };
+    size_t      write(const uint8_t* buf, size_t size) override;
+    using       Print::write;
+    int         available() override;
+    int         read() override;
+    size_t      read(uint8_t* buf, size_t size);
+    size_t      readBytes(char* buf, size_t len) override { return read((uint8_t*)buf, len); };
+    using       Stream::readBytes;
+    int         peek() override;
+    void        flush() override;
+    bool        seek(uint32_t pos, SeekMode mode);
+    bool        seek(uint32_t pos) { return seek(pos, SeekSet); };
+    size_t      position() const;
+    size_t      size() const;
+    bool        setBufferSize(size_t /*size*/) { return true; };
+    void        close() { m_impl.reset(); };
+    operator bool() const { return m_impl != nullptr; };
+    time_t      getLastWrite();
+    const char* path() const;
+    const char* name() const;
+    bool        isDirectory() const;
+    File        openNextFile(const char* mode = FILE_READ);
+    String      getNextFileName();
+    void        rewindDirectory();
+
+private:
+    std::shared_ptr<impl_t> m_impl;
+};
+
+class FS {
+
+public:
+    explicit FS(const char* dir) : m_dir(dir) {};
+    File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, const bool create = false) { return open(path.c_str(), mode, create); };
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); };
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); };
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); };
+    bool rmdir(const char* path);
+    std::string hostPath(const char* path) const; // where a device path is on the host
+
+protected:
+    const char* m_dir;
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+// a file system of the core, begin() creates its directory
+class HostFS : public fs::FS {
+
+public:
+    explicit HostFS(const char* dir) : fs::FS(dir) {};
+    template <typename... A> bool begin(A...) { return mkdir("/"); };
+    void     end() {};
+    bool     format() { return true; };
+    uint64_t totalBytes() { return 16ULL << 20; };
+    uint64_t usedBytes() { return 0; };
+    uint64_t cardSize() { return 16ULL << 30; };
+    uint8_t  cardType() { return 2; }; // CARD_SDHC
+};
@@ -0,0 +1,83 @@
+// host shim: HTTPClient of the ESP32 core, HTTP/1.1 over NetworkClient(Secure), one request per connection
+#pragma once
+
+#include <vector>
+#include "Arduino.h"
+#include "NetworkClientSecure.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_NO_CONTENT = 204,
+    HTTP_CODE_MOVED_PERMANENTLY = 301,
+    HTTP_CODE_FOUND = 302,
+    HTTP_CODE_BAD_REQUEST = 400,
+    HTTP_CODE_UNAUTHORIZED = 401,
+    HTTP_CODE_NOT_FOUND = 404,
+    HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+} t_http_codes;
+
+class HTTPClient {
+
+public:
+    ~HTTPClient() { end(); };
+
+    bool   begin(const String& url);
+    bool   begin(NetworkClient& client, const String& url);
+    void   end();
+    void   setTimeout(uint16_t ms) { m_timeout = ms; };
+    void   setConnectTimeout(int32_t ms) { m_connectTimeout = ms; };
+    void   setReuse(bool /*reuse*/) {};
+    void   setUserAgent(const String& agent) { m_userAgent = agent; };
+    void   addHeader(const String& name, const String& value);
+    void   collectHeaders(const char* names[], size_t count);
+    String header(const char* name);
+
+    int    GET();
+    int    POST(uint8_t* payload, size_t size) { return sendRequest("POST", payload, size); };
+    int    POST(const String& payload) { return sendRequest("POST", (uint8_t*)payload.c_str(), payload.length()); };
+    int    sendRequest(const char* method, const String& payload) { return sendRequest(method, (uint8_t*)payload.c_str(), payload.length()); };
+    int    sendRequest(const char* method, uint8_t* payload = NULL, size_t size = 0);
+    int    sendRequest(const char* method, Stream* stream, size_t size = 0);
+
+    int            getSize() { return m_size; };
+    NetworkClient* getStreamPtr() { return m_client; };
+    NetworkClient& getStream() { return *m_client; };
+    int            writeToStream(Stream* stream); // body bytes written, < 0 HTTPC_ERROR_...
+    String         getString();
+    static String  errorToString(int error);
+    bool           connected() { return m_client && m_client->connected(); };
+
+private:
+    bool connect();
+    int  sendHeader(const char* method, size_t size);
+    int  handleHeaderResponse();
+    int  readBody(Stream* stream);
+    bool readLine(String& line);
+
+    NetworkClientSecure m_own;                 // plain or TLS by the URL scheme
+    NetworkClient*      m_client = NULL;
+    bool                m_tls = false;
+    String              m_host;
+    uint16_t            m_port = 80;
+    String              m_uri;
+    String              m_headers;
+    String              m_userAgent = "ESP32HTTPClient";
+    uint16_t            m_timeout = 5000;
+    int32_t             m_connectTimeout = 5000;
+    int                 m_code = 0;
+    int                 m_size = -1;
+    bool                m_chunked = false;
+    std::vector<std::pair<String, String>> m_collect;
+};
@@ -0,0 +1,20 @@
+// host shim: IPv4 address of the ESP32 core
+#pragma once
+
+#include "Arduino.h"
+
+class IPAddress {
+
+public:
+    IPAddress() : m_addr{0, 0, 0, 0} {};
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : m_addr{a, b, c, d} {};
+    explicit IPAddress(uint32_t addr) { memcpy(m_addr, &addr, 4); }; // network order, like the core
+
+    uint8_t  operator[](int i) const { return m_addr[i & 3]; };
+    operator uint32_t() const { uint32_t a; memcpy(&a, m_addr, 4); return a; };
+    bool     fromString(const char* s);
+    String   toString() const;
+
+private:
+    uint8_t m_addr[4];
+};
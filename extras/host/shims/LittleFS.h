@@ -0,0 +1,6 @@
+// host shim: the LittleFS file system, the "littlefs" directory of the host root (see FS.h)
+#pragma once
+
+#include "FS.h"
+
+extern HostFS LittleFS;
@@ -0,0 +1,52 @@
+// host shim: TCP client of the ESP32 core (3.x) on a POSIX socket
+#pragma once
+
+#include <memory>
+#include "Arduino.h"
+#include "IPAddress.h"
+
+//  Copies share the socket like the core does (server.client(), WiFiClient c = other). connect() blocks up to the
+//  timeout, writes block until the kernel took the bytes or the timeout, available() and read() never block.
+//  connected() is true while the peer is open or unread bytes are left. NetworkClientSecure overrides the raw I/O.
+
+class NetworkClient : public Stream {
+
+public:
+    NetworkClient();
+    virtual ~NetworkClient();
+
+    virtual int connect(IPAddress ip, uint16_t port) { return connect(ip.toString().c_str(), port); };
+    virtual int connect(IPAddress ip, uint16_t port, int32_t timeout_ms) { return connect(ip.toString().c_str(), port, timeout_ms); };
+    virtual int connect(const char* host, uint16_t port) { return connect(host, port, m_connectTimeout); };
+    virtual int connect(const char* host, uint16_t port, int32_t timeout_ms);
+    size_t      write(uint8_t c) override { return write(&c, 1); };
+    size_t      write(const uint8_t* buf, size_t size) override;
+    using       Print::write;
+    int         available() override;
+    int         read() override;
+    virtual int read(uint8_t* buf, size_t size);
+    int         read(char* buf, size_t size) { return read((uint8_t*)buf, size); };
+    int         peek() override;
+    void        flush() override {};
+    void        clear();
+    virtual void stop();
+    virtual uint8_t connected();
+    operator bool() { return connected(); };
+    int         setNoDelay(bool nodelay);
+    void        setConnectionTimeout(uint32_t ms) { m_connectTimeout = ms; };
+    int         fd() const;
+    IPAddress   remoteIP() const;
+    uint16_t    remotePort() const;
+    IPAddress   localIP() const;
+
+protected:
+    struct socket_t;
+    int  openSocket(const char* host, uint16_t port, int32_t timeout_ms); // the connected fd or -1
+    bool waitSocket(bool forWrite, int32_t timeout_ms);
+    virtual int recvRaw(uint8_t* buf, size_t size, bool peek); // > 0 bytes, 0 nothing yet, < 0 closed
+    virtual int sendRaw(const uint8_t* buf, size_t size);      // >= 0 bytes, < 0 error
+    virtual int pending();                                     // bytes readable without the kernel buffer
+
+    std::shared_ptr<socket_t> m_socket;
+    int32_t                   m_connectTimeout = 3000;
+};
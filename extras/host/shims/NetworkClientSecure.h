@@ -0,0 +1,28 @@
+// host shim: TLS client of the ESP32 core (3.x), OpenSSL if the host build found it, else plain TCP
+#pragma once
+
+#include "NetworkClient.h"
+
+//  With HOST_TLS the handshake verifies against setCACert() or the system store, setInsecure() skips it. Without
+//  HOST_TLS connect() opens a plain TCP connection, enough for the local stand-in servers (ws://, http://).
+
+class NetworkClientSecure : public NetworkClient {
+
+public:
+    using NetworkClient::connect;
+    int     connect(const char* host, uint16_t port, int32_t timeout_ms) override;
+    void    stop() override;
+    void    setInsecure() { m_insecure = true; };
+    void    setCACert(const char* rootCA) { m_caCert = rootCA ? rootCA : ""; m_insecure = false; };
+    void    setHandshakeTimeout(unsigned long seconds) { m_handshakeTimeout = seconds * 1000; };
+
+protected:
+    int recvRaw(uint8_t* buf, size_t size, bool peek) override;
+    int sendRaw(const uint8_t* buf, size_t size) override;
+    int pending() override;
+
+private:
+    bool          m_insecure = false;
+    std::string   m_caCert;
+    unsigned long m_handshakeTimeout = 30000;
+};
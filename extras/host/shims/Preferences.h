@@ -0,0 +1,48 @@
+// host shim: Preferences (NVS) of the ESP32 core, one text file per namespace
+#pragma once
+
+#include "Arduino.h"
+#include <map>
+
+//  A namespace is <fs root>/nvs/<name>, one "key=value" line per entry, rewritten on every change. The values are
+//  kept as text, getInt() of a string key reads it as a number where NVS would fail: close enough for the sketches.
+
+class Preferences {
+
+public:
+    bool   begin(const char* name, bool readOnly = false, const char* partition = NULL);
+    void   end();
+    bool   clear();
+    bool   remove(const char* key);
+    bool   isKey(const char* key) { return m_started && m_values.count(key); };
+    size_t freeEntries() { return m_started ? 500 - m_values.size() : 0; };
+
+    size_t putString(const char* key, const char* value) { return put(key, value ? value : ""); };
+    size_t putString(const char* key, const String& value) { return put(key, value.c_str()); };
+    size_t putInt(const char* key, int32_t value) { return put(key, String(value).c_str()) ? 4 : 0; };
+    size_t putUInt(const char* key, uint32_t value) { return put(key, String(value).c_str()) ? 4 : 0; };
+    size_t putLong(const char* key, long value) { return put(key, String(value).c_str()) ? 4 : 0; };
+    size_t putULong(const char* key, unsigned long value) { return put(key, String(value).c_str()) ? 4 : 0; };
+    size_t putUChar(const char* key, uint8_t value) { return put(key, String(value).c_str()) ? 1 : 0; };
+    size_t putBool(const char* key, bool value) { return put(key, value ? "1" : "0") ? 1 : 0; };
+    size_t putFloat(const char* key, float value) { return put(key, String(value, 6).c_str()) ? 4 : 0; };
+
+    String   getString(const char* key, const String& def = String());
+    size_t   getString(const char* key, char* value, size_t maxLen);
+    int32_t  getInt(const char* key, int32_t def = 0) { return isKey(key) ? (int32_t)atol(m_values[key].c_str()) : def; };
+    uint32_t getUInt(const char* key, uint32_t def = 0) { return isKey(key) ? (uint32_t)strtoul(m_values[key].c_str(), NULL, 10) : def; };
+    long     getLong(const char* key, long def = 0) { return isKey(key) ? atol(m_values[key].c_str()) : def; };
+    unsigned long getULong(const char* key, unsigned long def = 0) { return isKey(key) ? strtoul(m_values[key].c_str(), NULL, 10) : def; };
+    uint8_t  getUChar(const char* key, uint8_t def = 0) { return isKey(key) ? (uint8_t)atoi(m_values[key].c_str()) : def; };
+    bool     getBool(const char* key, bool def = false) { return isKey(key) ? m_values[key] != "0" : def; };
+    float    getFloat(const char* key, float def = NAN) { return isKey(key) ? (float)atof(m_values[key].c_str()) : def; };
+
+private:
+    size_t put(const char* key, const char* value);
+    bool   save();
+
+    std::map<std::string, std::string> m_values;
+    std::string m_file;
+    bool        m_started = false;
+    bool        m_readOnly = false;
+};
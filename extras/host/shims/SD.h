@@ -0,0 +1,6 @@
+// host shim: the SD file system, the "sd" directory of the host root (see FS.h)
+#pragma once
+
+#include "FS.h"
+
+extern HostFS SD;
@@ -0,0 +1,6 @@
+// host shim: the SD_MMC file system, the "sd_mmc" directory of the host root (see FS.h)
+#pragma once
+
+#include "FS.h"
+
+extern HostFS SD_MMC;
@@ -0,0 +1,6 @@
+// host shim: the SPIFFS file system, the "spiffs" directory of the host root (see FS.h)
+#pragma once
+
+#include "FS.h"
+
+extern HostFS SPIFFS;
@@ -0,0 +1,34 @@
+// host shim: Stream of the ESP32 core, the timed reads wait up to setTimeout() like on the device
+#pragma once
+
+#include "Print.h"
+
+class Stream : public Print {
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void          setTimeout(unsigned long ms) { m_timeout = ms; };
+    unsigned long getTimeout() { return m_timeout; };
+
+    bool   find(const char* target);
+    bool   find(const char* target, size_t len);
+    bool   findUntil(const char* target, const char* terminator);
+    long   parseInt();
+    float  parseFloat();
+    virtual size_t readBytes(char* buf, size_t len);
+    virtual size_t readBytes(uint8_t* buf, size_t len) { return readBytes((char*)buf, len); };
+    size_t readBytesUntil(char terminator, char* buf, size_t len);
+    size_t readBytesUntil(char terminator, uint8_t* buf, size_t len) { return readBytesUntil(terminator, (char*)buf, len); };
+    String readString();
+    String readStringUntil(char terminator);
+
+protected:
+    int timedRead();
+    int timedPeek();
+    int peekNextDigit(bool detectDecimal);
+
+    unsigned long m_timeout = 1000;
+};
@@ -0,0 +1,24 @@
+// host shim: StreamString of the ESP32 core, a String that is a Stream
+#pragma once
+
+#include "Arduino.h"
+
+//  Writes append, reads take from the front. Like the core the read position is not kept: every read moves the rest
+//  of the string down, fine for the sizes the library reads back.
+
+class StreamString : public Stream, public String {
+
+public:
+    size_t write(const uint8_t* buf, size_t size) override { return concat((const char*)buf, size) ? size : 0; };
+    size_t write(uint8_t c) override { return concat((char)c) ? 1 : 0; };
+    using  Print::write;
+    int    available() override { return length(); };
+    int    read() override {
+        if(!length()) return -1;
+        int c = (uint8_t)charAt(0);
+        remove(0, 1);
+        return c;
+    };
+    int    peek() override { return length() ? (uint8_t)charAt(0) : -1; };
+    void   flush() override {};
+};
@@ -0,0 +1,118 @@
+// host shim: Arduino String on top of std::string, same interface and semantics as the ESP32 core
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper*)(s))
+
+class String {
+
+public:
+    String(const char* s = "") { if(s) m_s = s; };
+    String(const char* s, size_t len) { if(s) m_s.assign(s, len); };
+    String(const __FlashStringHelper* s) : String((const char*)s) {};
+    String(const std::string& s) : m_s(s) {};
+    explicit String(char c) : m_s(1, c) {};
+    explicit String(unsigned char v, unsigned char base = 10);
+    explicit String(int v, unsigned char base = 10);
+    explicit String(unsigned int v, unsigned char base = 10);
+    explicit String(long v, unsigned char base = 10);
+    explicit String(unsigned long v, unsigned char base = 10);
+    explicit String(long long v, unsigned char base = 10);
+    explicit String(unsigned long long v, unsigned char base = 10);
+    explicit String(float v, unsigned int decimals = 2);
+    explicit String(double v, unsigned int decimals = 2);
+
+    const char* c_str() const { return m_s.c_str(); };
+    unsigned    length() const { return m_s.size(); };
+    bool        isEmpty() const { return m_s.empty(); };
+    bool        reserve(unsigned size) { m_s.reserve(size); return true; };
+    explicit operator bool() const { return true; };
+
+    bool concat(const String& s) { m_s += s.m_s; return true; };
+    bool concat(const char* s) { if(s) m_s += s; return s != NULL; };
+    bool concat(const char* s, unsigned len) { if(s) m_s.append(s, len); return s != NULL; };
+    bool concat(const uint8_t* s, unsigned len) { return concat((const char*)s, len); };
+    bool concat(char c) { m_s += c; return true; };
+    template <typename T> bool concat(T v) { return concat(String(v)); };
+    template <typename T> String& operator+=(const T& v) { concat(v); return *this; };
+
+    bool operator==(const String& s) const { return m_s == s.m_s; };
+    bool operator==(const char* s) const { return m_s == (s ? s : ""); };
+    bool operator!=(const String& s) const { return !(*this == s); };
+    bool operator!=(const char* s) const { return !(*this == s); };
+    bool operator<(const String& s) const { return m_s < s.m_s; };
+    bool operator>(const String& s) const { return m_s > s.m_s; };
+    bool operator<=(const String& s) const { return m_s <= s.m_s; };
+    bool operator>=(const String& s) const { return m_s >= s.m_s; };
+    int  compareTo(const String& s) const { return m_s.compare(s.m_s); };
+    bool equals(const String& s) const { return *this == s; };
+    bool equals(const char* s) const { return *this == s; };
+    bool equalsIgnoreCase(const String& s) const;
+    bool startsWith(const String& s, unsigned offset = 0) const { return offset <= m_s.size() && m_s.compare(offset, s.m_s.size(), s.m_s) == 0; };
+    bool endsWith(const String& s) const { return m_s.size() >= s.m_s.size() && m_s.compare(m_s.size() - s.m_s.size(), s.m_s.size(), s.m_s) == 0; };
+
+    char  charAt(unsigned i) const { return i < m_s.size() ? m_s[i] : 0; };
+    void  setCharAt(unsigned i, char c) { if(i < m_s.size()) m_s[i] = c; };
+    char  operator[](unsigned i) const { return charAt(i); };
+    char& operator[](unsigned i) { static char dummy; return i < m_s.size() ? m_s[i] : (dummy = 0); };
+    void  getBytes(unsigned char* buf, unsigned size, unsigned index = 0) const;
+    void  toCharArray(char* buf, unsigned size, unsigned index = 0) const { getBytes((unsigned char*)buf, size, index); };
+    const char* begin() const { return m_s.c_str(); };
+    const char* end() const { return m_s.c_str() + m_s.size(); };
+
+    int    indexOf(char c, unsigned from = 0) const { return pos(m_s.find(c, from)); };
+    int    indexOf(const String& s, unsigned from = 0) const { return pos(m_s.find(s.m_s, from)); };
+    int    lastIndexOf(char c) const { return pos(m_s.rfind(c)); };
+    int    lastIndexOf(char c, unsigned from) const { return pos(m_s.rfind(c, from)); };
+    int    lastIndexOf(const String& s) const { return pos(m_s.rfind(s.m_s)); };
+    int    lastIndexOf(const String& s, unsigned from) const { return pos(m_s.rfind(s.m_s, from)); };
+    String substring(unsigned from) const { return from < m_s.size() ? String(m_s.substr(from)) : String(); };
+    String substring(unsigned from, unsigned to) const;
+
+    void replace(char a, char b);
+    void replace(const String& a, const String& b);
+    void remove(unsigned index) { if(index < m_s.size()) m_s.erase(index); };
+    void remove(unsigned index, unsigned count) { if(index < m_s.size()) m_s.erase(index, count); };
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long   toInt() const;
+    float  toFloat() const;
+    double toDouble() const;
+
+private:
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; };
+    std::string m_s;
+};
+
+inline String operator+(const String& a, const String& b) { String s(a); s.concat(b); return s; }
+inline String operator+(const String& a, const char* b) { String s(a); s.concat(b); return s; }
+inline String operator+(const char* a, const String& b) { String s(a); s.concat(b); return s; }
+inline String operator+(const String& a, char b) { String s(a); s.concat(b); return s; }
+inline String operator+(char a, const String& b) { String s(a); s.concat(b); return s; }
+#define HOST_STRING_SUM(T) \
+    inline String operator+(const String& a, T b) { String s(a); s.concat(String(b)); return s; }
+HOST_STRING_SUM(unsigned char)
+HOST_STRING_SUM(int)
+HOST_STRING_SUM(unsigned int)
+HOST_STRING_SUM(long)
+HOST_STRING_SUM(unsigned long)
+HOST_STRING_SUM(long long)
+HOST_STRING_SUM(unsigned long long)
+HOST_STRING_SUM(float)
+HOST_STRING_SUM(double)
+#undef HOST_STRING_SUM
+inline bool operator==(const char* a, const String& b) { return b == a; }
+inline bool operator!=(const char* a, const String& b) { return b != a; }
+
+class StringSumHelper : public String { // the core's type of a + b, ArduinoJson names it
+
+public:
+    StringSumHelper(const String& s) : String(s) {};
+    StringSumHelper(const char* s) : String(s) {};
+};
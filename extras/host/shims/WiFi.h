@@ -0,0 +1,36 @@
+// host shim: WiFi of the ESP32 core, the host is always connected
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiClientSecure.h"
+
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL, WL_SCAN_COMPLETED, WL_CONNECTED, WL_CONNECT_FAILED,
+               WL_CONNECTION_LOST, WL_DISCONNECTED } wl_status_t;
+typedef enum { WIFI_OFF = 0, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+class WiFiClass {
+
+public:
+    bool        mode(wifi_mode_t m) { m_mode = m; return true; };
+    wifi_mode_t getMode() { return m_mode; };
+    wl_status_t begin(const char* /*ssid*/ = NULL, const char* /*pass*/ = NULL) { return WL_CONNECTED; };
+    wl_status_t status() { return WL_CONNECTED; };
+    bool        isConnected() { return true; };
+    bool        reconnect() { return true; };
+    bool        disconnect(bool /*wifioff*/ = false) { return true; };
+    bool        setSleep(bool /*enable*/) { return true; };
+    bool        setAutoReconnect(bool /*enable*/) { return true; };
+    bool        softAP(const char* /*ssid*/, const char* /*pass*/ = NULL) { return true; };
+    IPAddress   localIP() { return IPAddress(127, 0, 0, 1); };
+    IPAddress   softAPIP() { return IPAddress(127, 0, 0, 1); };
+    int8_t      RSSI() { return -50; };
+    String      SSID() { return "host"; };
+    String      macAddress() { return "02:00:00:00:00:01"; };
+    int         hostByName(const char* host, IPAddress& ip);
+
+private:
+    wifi_mode_t m_mode = WIFI_STA;
+};
+extern WiFiClass WiFi;
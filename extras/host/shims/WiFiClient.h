@@ -0,0 +1,6 @@
+// host shim: the 2.x names of the network clients
+#pragma once
+
+#include "NetworkClient.h"
+
+typedef NetworkClient WiFiClient;
@@ -0,0 +1,400 @@
+/*
+ * arduino.cpp
+ *
+ *  host shim: String, Print, Stream, Serial, time, random numbers and the log output of the ESP32 core
+ *
+ */
+#include "Arduino.h"
+#include <unistd.h>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+static const auto s_start = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    usleep(200);
+}
+//----------------------------------------------------------------------------------------------------------------------
+static std::mt19937 s_random(1);
+
+long random(long max) {
+    return max > 0 ? random(0, max) : 0;
+}
+
+long random(long min, long max) {
+    if(min >= max) return min;
+    return min + (long)(s_random() % (unsigned long)(max - min));
+}
+
+void randomSeed(unsigned long seed) {
+    if(seed) s_random.seed(seed);
+}
+
+void pinMode(uint8_t /*pin*/, uint8_t /*mode*/) {}
+void digitalWrite(uint8_t /*pin*/, uint8_t /*val*/) {}
+int  digitalRead(uint8_t /*pin*/) { return HIGH; }
+void neopixelWrite(uint8_t /*pin*/, uint8_t /*r*/, uint8_t /*g*/, uint8_t /*b*/) {}
+
+size_t heap_caps_get_free_size(uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? 8u << 20 : 256u << 10; }
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? 4u << 20 : 128u << 10; }
+
+EspClass ESP;
+uint32_t EspClass::getFreeHeap() { return heap_caps_get_free_size(MALLOC_CAP_INTERNAL); }
+uint32_t EspClass::getMinFreeHeap() { return heap_caps_get_free_size(MALLOC_CAP_INTERNAL); }
+uint32_t EspClass::getMaxAllocHeap() { return heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL); }
+uint32_t EspClass::getHeapSize() { return 320u << 10; }
+uint32_t EspClass::getPsramSize() { return 8u << 20; }
+uint32_t EspClass::getFreePsram() { return heap_caps_get_free_size(MALLOC_CAP_SPIRAM); }
+void     EspClass::restart() {
+    fflush(stdout);
+    _exit(3);
+}
+//----------------------------------------------------------------------------------------------------------------------
+static std::mutex s_out; // one line at a time from all tasks
+
+HardwareSerial Serial;
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t size) {
+    std::lock_guard<std::mutex> lock(s_out);
+    return fwrite(buf, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+void log_printf(const char* fmt, ...) {
+    std::lock_guard<std::mutex> lock(s_out);
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+void hostLog(char level, const char* file, int line, const char* func, const char* fmt, ...) {
+    const char* name = strrchr(file, '/');
+    name = name ? name + 1 : file;
+    std::lock_guard<std::mutex> lock(s_out);
+    fprintf(stderr, "[%6lu][%c][%s:%d] %s(): ", millis(), level, name, line, func);
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+//----------------------------------------------------------------------------------------------------------------------
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if(size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return len;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+    size_t used = strnlen(dst, size);
+    return used == size ? size + strlen(src) : used + strlcpy(dst + used, src, size - used);
+}
+#endif
+
+static std::string number(unsigned long long v, bool negative, unsigned char base);
+
+char* itoa(int val, char* s, int radix) { return lltoa(val, s, radix); }
+char* ltoa(long val, char* s, int radix) { return lltoa(val, s, radix); }
+char* utoa(unsigned int val, char* s, int radix) { return ulltoa(val, s, radix); }
+char* ultoa(unsigned long val, char* s, int radix) { return ulltoa(val, s, radix); }
+
+char* lltoa(long long val, char* s, int radix) {
+    // like the core: negative numbers get a sign in every base
+    strcpy(s, number(val < 0 ? 0ULL - (unsigned long long)val : val, val < 0, radix).c_str());
+    return s;
+}
+
+char* ulltoa(unsigned long long val, char* s, int radix) {
+    strcpy(s, number(val, false, radix).c_str());
+    return s;
+}
+
+char* dtostrf(double val, signed char width, unsigned char prec, char* s) {
+    sprintf(s, "%*.*f", width, prec, val);
+    return s;
+}
+
+static std::string number(unsigned long long v, bool negative, unsigned char base) {
+    if(base < 2 || base > 36) base = 10;
+    char  buf[72];
+    char* p = buf + sizeof(buf);
+    *--p = 0;
+    do {
+        uint8_t d = v % base;
+        *--p = d < 10 ? '0' + d : 'a' + d - 10;
+        v /= base;
+    } while(v);
+    if(negative) *--p = '-';
+    return p;
+}
+
+static std::string number(double v, unsigned decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    return buf;
+}
+
+// like the core: negative numbers are signed in base 10 only, other bases show the two's complement of the type
+String::String(unsigned char v, unsigned char base) : m_s(number(v, false, base)) {}
+String::String(int v, unsigned char base) : m_s(base == 10 ? number(v < 0 ? -(long long)v : v, v < 0, 10) : number((unsigned)v, false, base)) {}
+String::String(unsigned int v, unsigned char base) : m_s(number(v, false, base)) {}
+String::String(long v, unsigned char base) : m_s(base == 10 ? number(v < 0 ? -(long long)v : v, v < 0, 10) : number((unsigned long)v, false, base)) {}
+String::String(unsigned long v, unsigned char base) : m_s(number(v, false, base)) {}
+String::String(long long v, unsigned char base) : m_s(base == 10 ? number(v < 0 ? 0ULL - (unsigned long long)v : v, v < 0, 10) : number((unsigned long long)v, false, base)) {}
+String::String(unsigned long long v, unsigned char base) : m_s(number(v, false, base)) {}
+String::String(float v, unsigned int decimals) : m_s(number(v, decimals)) {}
+String::String(double v, unsigned int decimals) : m_s(number(v, decimals)) {}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    return m_s.size() == s.m_s.size() && strncasecmp(m_s.c_str(), s.m_s.c_str(), m_s.size()) == 0;
+}
+
+void String::getBytes(unsigned char* buf, unsigned size, unsigned index) const {
+    if(!buf || !size) return;
+    if(index >= m_s.size()) {
+        buf[0] = 0;
+        return;
+    }
+    size_t n = std::min((size_t)size - 1, m_s.size() - index);
+    memcpy(buf, m_s.c_str() + index, n);
+    buf[n] = 0;
+}
+
+String String::substring(unsigned from, unsigned to) const {
+    if(from > to) std::swap(from, to);
+    if(from >= m_s.size()) return String();
+    return String(m_s.substr(from, std::min((size_t)to, m_s.size()) - from));
+}
+
+void String::replace(char a, char b) {
+    std::replace(m_s.begin(), m_s.end(), a, b);
+}
+
+void String::replace(const String& a, const String& b) {
+    if(a.m_s.empty()) return;
+    size_t p = 0;
+    while((p = m_s.find(a.m_s, p)) != std::string::npos) {
+        m_s.replace(p, a.m_s.size(), b.m_s);
+        p += b.m_s.size();
+    }
+}
+
+void String::toLowerCase() {
+    for(char& c : m_s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for(char& c : m_s) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t a = 0, b = m_s.size();
+    while(a < b && isspace((unsigned char)m_s[a])) a++;
+    while(b > a && isspace((unsigned char)m_s[b - 1])) b--;
+    m_s = m_s.substr(a, b - a);
+}
+
+long   String::toInt() const { return atol(m_s.c_str()); }
+float  String::toFloat() const { return (float)atof(m_s.c_str()); }
+double String::toDouble() const { return atof(m_s.c_str()); }
+//----------------------------------------------------------------------------------------------------------------------
+size_t Print::write(const uint8_t* buf, size_t size) {
+    size_t n = 0;
+    while(size--) {
+        if(!write(*buf++)) break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char* fmt, ...) {
+    char    small[128];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(small, sizeof(small), fmt, args);
+    va_end(args);
+    if(len < 0) return 0;
+    if((size_t)len < sizeof(small)) return write((const uint8_t*)small, len);
+    std::string big(len + 1, 0);
+    va_start(args, fmt);
+    vsnprintf(&big[0], big.size(), fmt, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+size_t Print::print(long long v, int base) {
+    return print(String(v, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long long v, int base) {
+    return print(String(v, (unsigned char)base));
+}
+
+size_t Print::print(double v, int digits) {
+    return print(String(v, (unsigned)digits));
+}
+//----------------------------------------------------------------------------------------------------------------------
+int Stream::timedRead() {
+    unsigned long start = millis();
+    do {
+        int c = read();
+        if(c >= 0) return c;
+        yield();
+    } while(millis() - start < m_timeout);
+    return -1;
+}
+
+int Stream::timedPeek() {
+    unsigned long start = millis();
+    do {
+        int c = peek();
+        if(c >= 0) return c;
+        yield();
+    } while(millis() - start < m_timeout);
+    return -1;
+}
+
+int Stream::peekNextDigit(bool detectDecimal) {
+    while(true) {
+        int c = timedPeek();
+        if(c < 0 || c == '-' || (c >= '0' && c <= '9') || (detectDecimal && c == '.')) return c;
+        read();
+    }
+}
+
+bool Stream::find(const char* target) {
+    return findUntil(target, NULL);
+}
+
+bool Stream::find(const char* target, size_t len) {
+    size_t matched = 0;
+    if(!len) return true;
+    while(true) {
+        int c = timedRead();
+        if(c < 0) return false;
+        if(c == target[matched]) {
+            if(++matched == len) return true;
+        }
+        else {
+            matched = c == target[0] ? 1 : 0;
+        }
+    }
+}
+
+bool Stream::findUntil(const char* target, const char* terminator) {
+    size_t len = strlen(target), tlen = terminator ? strlen(terminator) : 0;
+    size_t matched = 0, tmatched = 0;
+    if(!len) return true;
+    while(true) {
+        int c = timedRead();
+        if(c < 0) return false;
+        if(c == target[matched]) {
+            if(++matched == len) return true;
+        }
+        else {
+            matched = c == target[0] ? 1 : 0;
+        }
+        if(tlen) {
+            if(c == terminator[tmatched]) {
+                if(++tmatched == tlen) return false;
+            }
+            else {
+                tmatched = c == terminator[0] ? 1 : 0;
+            }
+        }
+    }
+}
+
+long Stream::parseInt() {
+    int c = peekNextDigit(false);
+    if(c < 0) return 0;
+    bool negative = false;
+    long v = 0;
+    do {
+        if(c == '-') negative = true;
+        else         v = v * 10 + c - '0';
+        read();
+        c = timedPeek();
+    } while(c >= '0' && c <= '9');
+    return negative ? -v : v;
+}
+
+float Stream::parseFloat() {
+    int c = peekNextDigit(true);
+    if(c < 0) return 0;
+    std::string s;
+    do {
+        s += (char)c;
+        read();
+        c = timedPeek();
+    } while((c >= '0' && c <= '9') || c == '.');
+    return (float)atof(s.c_str());
+}
+
+size_t Stream::readBytes(char* buf, size_t len) {
+    size_t n = 0;
+    while(n < len) {
+        int c = timedRead();
+        if(c < 0) break;
+        buf[n++] = (char)c;
+    }
+    return n;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buf, size_t len) {
+    size_t n = 0;
+    while(n < len) {
+        int c = timedRead();
+        if(c < 0 || c == terminator) break;
+        buf[n++] = (char)c;
+    }
+    return n;
+}
+
+String Stream::readString() {
+    std::string s;
+    int         c;
+    while((c = timedRead()) >= 0) s += (char)c;
+    return String(s);
+}
+
+String Stream::readStringUntil(char terminator) {
+    std::string s;
+    int         c;
+    while((c = timedRead()) >= 0 && c != terminator) s += (char)c;
+    return String(s);
+}
@@ -0,0 +1,217 @@
+/*
+ * crypto.cpp
+ *
+ *  host shim: base64 (libb64 and mbedTLS flavour) and SHA-1
+ *
+ */
+#include "libb64/cencode.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/sha1.h"
+#include <string.h>
+
+static const char s_b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void base64_init_encodestate(base64_encodestate* state) {
+    state->step = step_A;
+    state->result = 0;
+    state->stepcount = 0;
+}
+
+char base64_encode_value(char value) {
+    return (unsigned char)value > 63 ? '=' : s_b64[(int)value];
+}
+
+int base64_encode_block(const char* plaintext, int length, char* code, base64_encodestate* state) {
+    const char* p = plaintext;
+    const char* end = plaintext + length;
+    char*       c = code;
+    char        result = state->result;
+    char        fragment;
+    switch(state->step) {
+        while(1) {
+            case step_A:
+                if(p == end) {
+                    state->result = result;
+                    state->step = step_A;
+                    return c - code;
+                }
+                fragment = *p++;
+                result = (fragment & 0x0fc) >> 2;
+                *c++ = base64_encode_value(result);
+                result = (fragment & 0x003) << 4;
+                /* fall through */
+            case step_B:
+                if(p == end) {
+                    state->result = result;
+                    state->step = step_B;
+                    return c - code;
+                }
+                fragment = *p++;
+                result |= (fragment & 0x0f0) >> 4;
+                *c++ = base64_encode_value(result);
+                result = (fragment & 0x00f) << 2;
+                /* fall through */
+            case step_C:
+                if(p == end) {
+                    state->result = result;
+                    state->step = step_C;
+                    return c - code;
+                }
+                fragment = *p++;
+                result |= (fragment & 0x0c0) >> 6;
+                *c++ = base64_encode_value(result);
+                result = (fragment & 0x03f) >> 0;
+                *c++ = base64_encode_value(result);
+                ++(state->stepcount);
+        }
+    }
+    return c - code;
+}
+
+int base64_encode_blockend(char* code, base64_encodestate* state) {
+    char* c = code;
+    switch(state->step) {
+        case step_B:
+            *c++ = base64_encode_value(state->result);
+            *c++ = '=';
+            *c++ = '=';
+            break;
+        case step_C:
+            *c++ = base64_encode_value(state->result);
+            *c++ = '=';
+            break;
+        case step_A: break;
+    }
+    *c = 0;
+    return c - code;
+}
+
+int base64_encode_chars(const char* plaintext, int length, char* code) {
+    base64_encodestate state;
+    base64_init_encodestate(&state);
+    int len = base64_encode_block(plaintext, length, code, &state);
+    return len + base64_encode_blockend(code + len, &state);
+}
+//----------------------------------------------------------------------------------------------------------------------
+int mbedtls_base64_encode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen) {
+    size_t n = (slen + 2) / 3 * 4;
+    if(!dst || dlen < n + 1) {
+        *olen = n + 1;
+        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+    }
+    *olen = base64_encode_chars((const char*)src, slen, (char*)dst);
+    return 0;
+}
+
+int mbedtls_base64_decode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen) {
+    size_t n = 0, pad = 0;
+    for(size_t i = 0; i < slen; i++) { // length first, like mbedTLS
+        if(src[i] == '\r' || src[i] == '\n' || src[i] == ' ') continue;
+        if(src[i] == '=') {
+            pad++;
+            n++;
+            continue;
+        }
+        if(pad || !strchr(s_b64, src[i]) || !src[i]) return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+        n++;
+    }
+    if(pad > 2 || n % 4) return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+    size_t out = n / 4 * 3 - pad;
+    if(!dst || dlen < out) {
+        *olen = out;
+        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+    }
+    uint32_t acc = 0;
+    int      bits = 0;
+    size_t   k = 0;
+    for(size_t i = 0; i < slen; i++) {
+        const char* p = src[i] ? strchr(s_b64, src[i]) : NULL;
+        if(!p) continue;
+        acc = acc << 6 | (uint32_t)(p - s_b64);
+        bits += 6;
+        if(bits >= 8) {
+            bits -= 8;
+            dst[k++] = acc >> bits;
+        }
+    }
+    *olen = k;
+    return 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+static uint32_t rol(uint32_t v, int n) {
+    return v << n | v >> (32 - n);
+}
+
+static void sha1Block(mbedtls_sha1_context* ctx, const unsigned char* p) {
+    uint32_t w[80];
+    for(int i = 0; i < 16; i++) w[i] = (uint32_t)p[4 * i] << 24 | p[4 * i + 1] << 16 | p[4 * i + 2] << 8 | p[4 * i + 3];
+    for(int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    uint32_t a = ctx->state[0], b = ctx->state[1], c = ctx->state[2], d = ctx->state[3], e = ctx->state[4];
+    for(int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if(i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if(i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if(i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else            { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+        uint32_t t = rol(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rol(b, 30);
+        b = a;
+        a = t;
+    }
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+}
+
+void mbedtls_sha1_init(mbedtls_sha1_context* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_sha1_free(mbedtls_sha1_context* ctx) {
+    if(ctx) memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_sha1_starts(mbedtls_sha1_context* ctx) {
+    static const uint32_t init[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    memcpy(ctx->state, init, sizeof(init));
+    ctx->total[0] = ctx->total[1] = 0;
+    return 0;
+}
+
+int mbedtls_sha1_update(mbedtls_sha1_context* ctx, const unsigned char* input, size_t ilen) {
+    while(ilen) {
+        size_t used = ctx->total[0] & 63;
+        size_t n = 64 - used < ilen ? 64 - used : ilen;
+        memcpy(ctx->buffer + used, input, n);
+        ctx->total[0] += n;
+        if(ctx->total[0] < n) ctx->total[1]++;
+        input += n;
+        ilen -= n;
+        if(used + n == 64) sha1Block(ctx, ctx->buffer);
+    }
+    return 0;
+}
+
+int mbedtls_sha1_finish(mbedtls_sha1_context* ctx, unsigned char output[20]) {
+    uint64_t      bits = ((uint64_t)ctx->total[1] << 32 | ctx->total[0]) * 8;
+    unsigned char pad[72] = {0x80};
+    size_t        used = ctx->total[0] & 63;
+    size_t        n = used < 56 ? 56 - used : 120 - used;
+    for(int i = 0; i < 8; i++) pad[n + i] = bits >> (56 - 8 * i);
+    mbedtls_sha1_update(ctx, pad, n + 8);
+    for(int i = 0; i < 20; i++) output[i] = ctx->state[i / 4] >> (24 - 8 * (i % 4));
+    return 0;
+}
+
+int mbedtls_sha1(const unsigned char* input, size_t ilen, unsigned char output[20]) {
+    mbedtls_sha1_context ctx;
+    mbedtls_sha1_init(&ctx);
+    mbedtls_sha1_starts(&ctx);
+    mbedtls_sha1_update(&ctx, input, ilen);
+    mbedtls_sha1_finish(&ctx, output);
+    return 0;
+}
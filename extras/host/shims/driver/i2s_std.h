@@ -0,0 +1,118 @@
+// host shim: the IDF 5 I2S standard mode driver, TX into a WAV file at the pace of the sample clock
+#pragma once
+
+#include "Arduino.h"
+
+//  A TX channel is a DMA ring of dma_desc_num x dma_frame_num frames. A clock thread takes one descriptor per
+//  frame period out of it, appends the samples to the output WAV (hostSimSetI2sOutput()) and calls on_sent. Without
+//  data the descriptor goes out as silence (auto_clear), that silence is not written: the file holds what was played.
+//  i2s_channel_write() copies what fits and returns, it waits up to the timeout for room like the driver.
+
+typedef enum { I2S_NUM_0 = 0, I2S_NUM_1 = 1, I2S_NUM_AUTO } i2s_port_t;
+typedef enum { I2S_ROLE_MASTER, I2S_ROLE_SLAVE } i2s_role_t;
+typedef enum { I2S_DIR_RX = 1, I2S_DIR_TX = 2 } i2s_dir_t;
+typedef enum {
+    I2S_DATA_BIT_WIDTH_8BIT = 8,
+    I2S_DATA_BIT_WIDTH_16BIT = 16,
+    I2S_DATA_BIT_WIDTH_24BIT = 24,
+    I2S_DATA_BIT_WIDTH_32BIT = 32,
+} i2s_data_bit_width_t;
+typedef enum {
+    I2S_SLOT_BIT_WIDTH_AUTO = 0,
+    I2S_SLOT_BIT_WIDTH_8BIT = 8,
+    I2S_SLOT_BIT_WIDTH_16BIT = 16,
+    I2S_SLOT_BIT_WIDTH_24BIT = 24,
+    I2S_SLOT_BIT_WIDTH_32BIT = 32,
+} i2s_slot_bit_width_t;
+typedef enum { I2S_SLOT_MODE_MONO = 1, I2S_SLOT_MODE_STEREO = 2 } i2s_slot_mode_t;
+typedef enum { I2S_STD_SLOT_LEFT = 1, I2S_STD_SLOT_RIGHT = 2, I2S_STD_SLOT_BOTH = 3 } i2s_std_slot_mask_t;
+typedef enum { I2S_CLK_SRC_DEFAULT = 0, I2S_CLK_SRC_PLL_160M = 0, I2S_CLK_SRC_XTAL, I2S_CLK_SRC_APLL } i2s_clock_src_t;
+typedef enum {
+    I2S_MCLK_MULTIPLE_128 = 128,
+    I2S_MCLK_MULTIPLE_256 = 256,
+    I2S_MCLK_MULTIPLE_384 = 384,
+    I2S_MCLK_MULTIPLE_512 = 512,
+} i2s_mclk_multiple_t;
+
+#define GPIO_NUM_NC     ((gpio_num_t)-1)
+#define I2S_GPIO_UNUSED GPIO_NUM_NC
+
+typedef struct i2s_channel_obj_t* i2s_chan_handle_t;
+
+typedef struct {
+    i2s_port_t id;
+    i2s_role_t role;
+    uint32_t   dma_desc_num;
+    uint32_t   dma_frame_num;
+    bool       auto_clear;
+    int        intr_priority;
+} i2s_chan_config_t;
+
+typedef struct {
+    uint32_t            sample_rate_hz;
+    i2s_clock_src_t     clk_src;
+    i2s_mclk_multiple_t mclk_multiple;
+} i2s_std_clk_config_t;
+
+typedef struct {
+    i2s_data_bit_width_t data_bit_width;
+    i2s_slot_bit_width_t slot_bit_width;
+    i2s_slot_mode_t      slot_mode;
+    i2s_std_slot_mask_t  slot_mask;
+    uint32_t             ws_width;
+    bool                 ws_pol;
+    bool                 bit_shift;
+    bool                 left_align;
+    bool                 big_endian;
+    bool                 bit_order_lsb;
+} i2s_std_slot_config_t;
+
+typedef struct {
+    gpio_num_t mclk;
+    gpio_num_t bclk;
+    gpio_num_t ws;
+    gpio_num_t dout;
+    gpio_num_t din;
+    struct {
+        uint32_t mclk_inv : 1;
+        uint32_t bclk_inv : 1;
+        uint32_t ws_inv : 1;
+    } invert_flags;
+} i2s_std_gpio_config_t;
+
+typedef struct {
+    i2s_std_clk_config_t  clk_cfg;
+    i2s_std_slot_config_t slot_cfg;
+    i2s_std_gpio_config_t gpio_cfg;
+} i2s_std_config_t;
+
+#define I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits, mode) \
+    { (bits), I2S_SLOT_BIT_WIDTH_AUTO, (mode), I2S_STD_SLOT_BOTH, (uint32_t)(bits), false, true, false, false, false }
+#define I2S_STD_MSB_SLOT_DEFAULT_CONFIG(bits, mode) \
+    { (bits), I2S_SLOT_BIT_WIDTH_AUTO, (mode), I2S_STD_SLOT_BOTH, (uint32_t)(bits), false, false, false, false, false }
+#define I2S_STD_PCM_SLOT_DEFAULT_CONFIG(bits, mode) \
+    { (bits), I2S_SLOT_BIT_WIDTH_AUTO, (mode), I2S_STD_SLOT_BOTH, 1, true, true, false, false, false }
+#define I2S_STD_CLK_DEFAULT_CONFIG(rate) { (rate), I2S_CLK_SRC_DEFAULT, I2S_MCLK_MULTIPLE_256 }
+
+typedef struct {
+    void*  data;
+    size_t size;
+} i2s_event_data_t;
+typedef bool (*i2s_isr_callback_t)(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
+typedef struct {
+    i2s_isr_callback_t on_recv;
+    i2s_isr_callback_t on_recv_q_ovf;
+    i2s_isr_callback_t on_sent;
+    i2s_isr_callback_t on_send_q_ovf;
+} i2s_event_callbacks_t;
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t* cfg, i2s_chan_handle_t* tx, i2s_chan_handle_t* rx);
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t* cfg);
+esp_err_t i2s_channel_reconfig_std_clock(i2s_chan_handle_t handle, const i2s_std_clk_config_t* cfg);
+esp_err_t i2s_channel_reconfig_std_slot(i2s_chan_handle_t handle, const i2s_std_slot_config_t* cfg);
+esp_err_t i2s_channel_reconfig_std_gpio(i2s_chan_handle_t handle, const i2s_std_gpio_config_t* cfg);
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t handle, const i2s_event_callbacks_t* cbs, void* user_data);
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void* src, size_t size, size_t* written, uint32_t timeout_ms);
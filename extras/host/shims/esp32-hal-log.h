@@ -0,0 +1,48 @@
+// host shim: log_e() ... log_v() of the ESP32 core, to stderr, levels above CORE_DEBUG_LEVEL compile to nothing
+#pragma once
+
+#define ARDUHAL_LOG_LEVEL_NONE    0
+#define ARDUHAL_LOG_LEVEL_ERROR   1
+#define ARDUHAL_LOG_LEVEL_WARN    2
+#define ARDUHAL_LOG_LEVEL_INFO    3
+#define ARDUHAL_LOG_LEVEL_DEBUG   4
+#define ARDUHAL_LOG_LEVEL_VERBOSE 5
+
+#ifndef CORE_DEBUG_LEVEL
+#define CORE_DEBUG_LEVEL ARDUHAL_LOG_LEVEL_WARN
+#endif
+#define ARDUHAL_LOG_LEVEL CORE_DEBUG_LEVEL
+
+void log_printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+void hostLog(char level, const char* file, int line, const char* func, const char* fmt, ...) __attribute__((format(printf, 5, 6)));
+
+#define HOST_LOG(l, fmt, ...) hostLog(l, __FILE__, __LINE__, __FUNCTION__, fmt, ##__VA_ARGS__)
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_ERROR
+#define log_e(fmt, ...) HOST_LOG('E', fmt, ##__VA_ARGS__)
+#else
+#define log_e(fmt, ...) do {} while(0)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_WARN
+#define log_w(fmt, ...) HOST_LOG('W', fmt, ##__VA_ARGS__)
+#else
+#define log_w(fmt, ...) do {} while(0)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+#define log_i(fmt, ...) HOST_LOG('I', fmt, ##__VA_ARGS__)
+#else
+#define log_i(fmt, ...) do {} while(0)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
+#define log_d(fmt, ...) HOST_LOG('D', fmt, ##__VA_ARGS__)
+#else
+#define log_d(fmt, ...) do {} while(0)
+#endif
+#if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_VERBOSE
+#define log_v(fmt, ...) HOST_LOG('V', fmt, ##__VA_ARGS__)
+#else
+#define log_v(fmt, ...) do {} while(0)
+#endif
+#define ESP_LOGE(tag, fmt, ...) log_e("%s: " fmt, tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) log_w("%s: " fmt, tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) log_i("%s: " fmt, tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) log_d("%s: " fmt, tag, ##__VA_ARGS__)
@@ -0,0 +1,349 @@
+/*
+ * freertos.cpp
+ *
+ *  host shim: FreeRTOS tasks, notifications, semaphores, mutexes and queues on pthreads
+ *
+ */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+unsigned long millis();
+void          delay(uint32_t ms);
+
+struct tskTaskControlBlock {
+    pthread_t               thread;
+    TaskFunction_t          fn = NULL;
+    void*                   param = NULL;
+    std::string             name;
+    uint32_t                stack = 0;
+    std::mutex              m;
+    std::condition_variable cv;
+    uint32_t                notify = 0;
+    std::atomic<bool>       kill = {false};      // vTaskDelete() from another task
+    std::atomic<bool>       deleted = {false};
+};
+
+static thread_local TaskHandle_t t_self = NULL;
+
+static void exitIfDeleted() { // another task deleted this one: it ends at its next wait, the stack unwinds
+    if(t_self && t_self->kill) pthread_exit(NULL);
+}
+
+static bool waitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t ticks,
+                      const std::function<bool()>& ready) {
+    if(ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(pdTICKS_TO_MS(ticks)), ready);
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void* taskMain(void* arg) {
+    TaskHandle_t t = (TaskHandle_t)arg;
+    t_self = t;
+    struct Done {
+        TaskHandle_t t;
+        ~Done() { t->deleted = true; } // also when pthread_exit() unwinds the stack
+    } done = {t};
+    t->fn(t->param); // a FreeRTOS task must not return, here it simply ends
+    return NULL;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                           UBaseType_t /*priority*/, StackType_t* /*stack*/, StaticTask_t* /*tcb*/,
+                                           BaseType_t /*core*/) {
+    TaskHandle_t t = new tskTaskControlBlock;
+    t->fn = fn;
+    t->param = param;
+    t->name = name ? name : "";
+    t->stack = stackDepth;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, std::max((size_t)stackDepth * 4, (size_t)256 * 1024));
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&t->thread, &attr, taskMain, t);
+    pthread_attr_destroy(&attr);
+    if(err) {
+        fprintf(stderr, "[host] task %s not created: %s\n", t->name.c_str(), strerror(err));
+        delete t;
+        return NULL;
+    }
+#ifdef __linux__
+    pthread_setname_np(t->thread, t->name.substr(0, 15).c_str());
+#endif
+    return t;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t core) {
+    TaskHandle_t t = xTaskCreateStaticPinnedToCore(fn, name, stackDepth, param, priority, NULL, NULL, core);
+    if(created) *created = t;
+    return t ? pdPASS : pdFAIL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param, UBaseType_t priority,
+                       TaskHandle_t* created) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if(!task || task == t_self) {
+        if(!t_self) return; // the main thread is not a task of its own
+        pthread_exit(NULL);
+    }
+    {
+        std::lock_guard<std::mutex> lock(task->m);
+        task->kill = true; // the handle stays valid, eTaskGetState() says eDeleted once the thread has gone
+    }
+    task->cv.notify_all();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void vTaskDelay(TickType_t ticks) {
+    if(!t_self) {
+        delay(pdTICKS_TO_MS(ticks));
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(t_self->m);
+        waitUntil(lock, t_self->cv, ticks, [] { return (bool)t_self->kill; });
+    }
+    exitIfDeleted();
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
+
+TickType_t xTaskGetTickCountFromISR() {
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if(!t_self) { // the main thread (setup() / loop()) gets a handle on first use, for the notifications
+        t_self = new tskTaskControlBlock;
+        t_self->thread = pthread_self();
+        t_self->name = "loopTask";
+    }
+    return t_self;
+}
+
+eTaskState eTaskGetState(TaskHandle_t task) {
+    if(!task) return eInvalid;
+    if(task->deleted) return eDeleted;
+    return task == t_self ? eRunning : eBlocked;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    if(!task) task = t_self;
+    return task ? task->stack : 0;
+}
+
+void taskYIELD() {
+    exitIfDeleted();
+    sched_yield();
+}
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    TaskHandle_t t = xTaskGetCurrentTaskHandle();
+    uint32_t     value;
+    {
+        std::unique_lock<std::mutex> lock(t->m);
+        waitUntil(lock, t->cv, ticks, [t] { return t->notify > 0 || t->kill; });
+        value = t->notify;
+        if(value) t->notify = clearOnExit ? 0 : value - 1;
+    }
+    exitIfDeleted();
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if(!task) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(task->m);
+        task->notify++;
+    }
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if(woken) *woken = pdFALSE;
+}
+//----------------------------------------------------------------------------------------------------------------------
+struct QueueDefinition {
+    enum : uint8_t { QUEUE, SEMAPHORE, MUTEX, RECURSIVE };
+    uint8_t                           kind;
+    std::mutex                        m;
+    std::condition_variable           cv;
+    UBaseType_t                       count = 0;      // semaphores: tokens, queues: items
+    UBaseType_t                       max = 1;
+    UBaseType_t                       itemSize = 0;
+    std::deque<std::vector<uint8_t>>  items;
+    pthread_t                         owner;
+    UBaseType_t                       depth = 0;      // recursive mutex
+};
+
+static QueueHandle_t create(uint8_t kind, UBaseType_t max, UBaseType_t initial) {
+    QueueHandle_t q = new QueueDefinition;
+    q->kind = kind;
+    q->max = max;
+    q->count = initial;
+    return q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return create(QueueDefinition::MUTEX, 1, 1); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return create(QueueDefinition::RECURSIVE, 1, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary() { return create(QueueDefinition::SEMAPHORE, 1, 0); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    return create(QueueDefinition::SEMAPHORE, max, initial);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+    exitIfDeleted();
+    if(!s) return pdFAIL;
+    std::unique_lock<std::mutex> lock(s->m);
+    if(!waitUntil(lock, s->cv, ticks, [s] { return s->count > 0; })) return pdFAIL;
+    s->count--;
+    s->owner = pthread_self();
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    if(!s) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(s->m);
+        if(s->count >= s->max) return pdFAIL;
+        s->count++;
+    }
+    s->cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t ticks) {
+    if(!s) return pdFAIL;
+    std::unique_lock<std::mutex> lock(s->m);
+    if(s->depth && pthread_equal(s->owner, pthread_self())) {
+        s->depth++;
+        return pdPASS;
+    }
+    if(!waitUntil(lock, s->cv, ticks, [s] { return s->depth == 0; })) return pdFAIL;
+    s->depth = 1;
+    s->owner = pthread_self();
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s) {
+    if(!s) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(s->m);
+        if(!s->depth || !pthread_equal(s->owner, pthread_self())) return pdFAIL;
+        if(--s->depth) return pdPASS;
+    }
+    s->cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t* woken) {
+    if(woken) *woken = pdFALSE;
+    return xSemaphoreGive(s);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t s) {
+    std::lock_guard<std::mutex> lock(s->m);
+    return s->count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s) {
+    delete s;
+}
+//----------------------------------------------------------------------------------------------------------------------
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    QueueHandle_t q = create(QueueDefinition::QUEUE, length, 0);
+    q->itemSize = itemSize;
+    return q;
+}
+
+static BaseType_t send(QueueHandle_t q, const void* item, TickType_t ticks, bool front) {
+    if(!q) return pdFAIL;
+    {
+        std::unique_lock<std::mutex> lock(q->m);
+        if(!waitUntil(lock, q->cv, ticks, [q] { return q->items.size() < q->max; })) return pdFAIL;
+        std::vector<uint8_t> v((const uint8_t*)item, (const uint8_t*)item + q->itemSize);
+        if(front) q->items.push_front(std::move(v));
+        else      q->items.push_back(std::move(v));
+    }
+    q->cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) { return send(q, item, ticks, false); }
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticks) { return send(q, item, ticks, false); }
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t ticks) { return send(q, item, ticks, true); }
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken) {
+    if(woken) *woken = pdFALSE;
+    return send(q, item, 0, false);
+}
+
+static BaseType_t receive(QueueHandle_t q, void* item, TickType_t ticks, bool remove) {
+    if(!q) return pdFAIL;
+    {
+        std::unique_lock<std::mutex> lock(q->m);
+        if(!waitUntil(lock, q->cv, ticks, [q] { return !q->items.empty(); })) return pdFAIL;
+        memcpy(item, q->items.front().data(), q->itemSize);
+        if(!remove) return pdPASS;
+        q->items.pop_front();
+    }
+    q->cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) { return receive(q, item, ticks, true); }
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks) { return receive(q, item, ticks, false); }
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    {
+        std::lock_guard<std::mutex> lock(q->m);
+        q->items.clear();
+    }
+    q->cv.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->max - q->items.size();
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    delete q;
+}
+//----------------------------------------------------------------------------------------------------------------------
+static std::recursive_mutex s_critical;
+
+void vPortEnterCritical(portMUX_TYPE* /*mux*/) {
+    s_critical.lock();
+}
+
+void vPortExitCritical(portMUX_TYPE* /*mux*/) {
+    s_critical.unlock();
+}
@@ -0,0 +1,42 @@
+// host shim: FreeRTOS (IDF flavour) on pthreads, types and ticks
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+//  A task is a thread, priorities and cores are taken note of and ignored, the stack is at least 256 KB (host code
+//  needs more than the device). One tick is one millisecond. Semaphores, mutexes and queues are one object with a
+//  mutex and a condition variable, like the queues they are made of in FreeRTOS. Critical sections are one global
+//  recursive lock. Nothing runs from an interrupt, the ...FromISR() calls are the plain ones.
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t  StackType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(t)    ((uint32_t)(((uint64_t)(t) * 1000) / configTICK_RATE_HZ))
+#define tskNO_AFFINITY      ((BaseType_t)0x7FFFFFFF)
+
+typedef struct {
+    volatile int owner;
+    volatile int count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux)     vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)      vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)  vPortExitCritical(mux)
+#define taskENTER_CRITICAL(mux)     vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux)      vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(...)     do {} while(0)
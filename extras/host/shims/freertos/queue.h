@@ -0,0 +1,19 @@
+// host shim: FreeRTOS queues, items are copied, see FreeRTOS.h
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct QueueDefinition;
+typedef struct QueueDefinition* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t    xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t    xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t    xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t    xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken);
+BaseType_t    xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks);
+BaseType_t    xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks);
+BaseType_t    xQueueReset(QueueHandle_t q);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t q);
+UBaseType_t   uxQueueSpacesAvailable(QueueHandle_t q);
+void          vQueueDelete(QueueHandle_t q);
@@ -0,0 +1,18 @@
+// host shim: FreeRTOS semaphores and mutexes, see FreeRTOS.h
+#pragma once
+
+#include "queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t s);
+BaseType_t        xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t ticks);
+BaseType_t        xSemaphoreGiveRecursive(SemaphoreHandle_t s);
+BaseType_t        xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t* woken);
+UBaseType_t       uxSemaphoreGetCount(SemaphoreHandle_t s);
+void              vSemaphoreDelete(SemaphoreHandle_t s);
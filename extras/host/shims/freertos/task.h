@@ -0,0 +1,29 @@
+// host shim: FreeRTOS tasks and direct-to-task notifications on pthreads
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct tskTaskControlBlock;
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+typedef struct { uint8_t dummy; } StaticTask_t;
+typedef enum { eRunning = 0, eReady, eBlocked, eSuspended, eDeleted, eInvalid } eTaskState;
+
+BaseType_t   xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                     UBaseType_t priority, TaskHandle_t* created, BaseType_t core);
+BaseType_t   xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param, UBaseType_t priority,
+                         TaskHandle_t* created);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                           UBaseType_t priority, StackType_t* stack, StaticTask_t* tcb, BaseType_t core);
+void         vTaskDelete(TaskHandle_t task);          // another task ends at its next wait
+void         vTaskDelay(TickType_t ticks);
+TickType_t   xTaskGetTickCount();
+TickType_t   xTaskGetTickCountFromISR();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+eTaskState   eTaskGetState(TaskHandle_t task);
+UBaseType_t  uxTaskGetStackHighWaterMark(TaskHandle_t task); // not measured, the stack size
+void         taskYIELD();
+
+uint32_t     ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t   xTaskNotifyGive(TaskHandle_t task);
+void         vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
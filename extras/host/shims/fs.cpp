@@ -0,0 +1,193 @@
+/*
+ * fs.cpp
+ *
+ *  host shim: fs::FS and fs::File on stdio and POSIX directories, the file system objects of the core
+ *
+ */
+#include "FS.h"
+#include "SD.h"
+#include "SD_MMC.h"
+#include "SPIFFS.h"
+#include "FFat.h"
+#include "LittleFS.h"
+#include "host_sim.h"
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+HostFS SD("sd");
+HostFS SD_MMC("sd_mmc");
+HostFS SPIFFS("spiffs");
+HostFS FFat("ffat");
+HostFS LittleFS("littlefs");
+
+static std::string s_root = "host_fs";
+
+void hostSimSetFsRoot(const char* dir) {
+    s_root = dir;
+}
+
+std::string hostSimFsRoot() {
+    return s_root;
+}
+
+struct fs::File::impl_t {
+    FILE*       fp = NULL;
+    DIR*        dir = NULL;
+    std::string host;  // path on the host
+    std::string path;  // path on the device
+    std::string name;
+
+    ~impl_t() {
+        if(fp) fclose(fp);
+        if(dir) closedir(dir);
+    }
+};
+
+static void makeDirs(const std::string& hostPath) { // parents of a file
+    for(size_t p = hostPath.find('/', 1); p != std::string::npos; p = hostPath.find('/', p + 1))
+        ::mkdir(hostPath.substr(0, p).c_str(), 0755);
+}
+//----------------------------------------------------------------------------------------------------------------------
+std::string fs::FS::hostPath(const char* path) const {
+    std::string p = s_root + "/" + m_dir;
+    if(!path || path[0] != '/') p += '/';
+    if(path) p += path;
+    while(p.size() > 1 && p.back() == '/') p.pop_back();
+    return p;
+}
+
+fs::File fs::FS::open(const char* path, const char* mode, const bool /*create*/) {
+    std::string host = hostPath(path);
+    struct stat st;
+    auto        impl = std::make_shared<File::impl_t>();
+    impl->host = host;
+    impl->path = path;
+    const char* slash = strrchr(path, '/');
+    impl->name = slash ? slash + 1 : path;
+
+    if(stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(host.c_str());
+        return impl->dir ? File(impl) : File();
+    }
+    if(mode[0] != 'r') makeDirs(host); // like create = true, SD makes the parents anyway
+    std::string m = mode[0] == 'w' ? "wb" : mode[0] == 'a' ? "ab" : "rb";
+    if(strchr(mode, '+')) m += '+';
+    impl->fp = fopen(host.c_str(), m.c_str());
+    return impl->fp ? File(impl) : File();
+}
+
+bool fs::FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool fs::FS::remove(const char* path) {
+    return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool fs::FS::rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool fs::FS::mkdir(const char* path) {
+    std::string host = hostPath(path);
+    makeDirs(host + "/");
+    struct stat st;
+    return stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool fs::FS::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t fs::File::write(const uint8_t* buf, size_t size) {
+    return m_impl && m_impl->fp ? fwrite(buf, 1, size, m_impl->fp) : 0;
+}
+
+size_t fs::File::read(uint8_t* buf, size_t size) {
+    return m_impl && m_impl->fp ? fread(buf, 1, size, m_impl->fp) : 0;
+}
+
+int fs::File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int fs::File::peek() {
+    if(!m_impl || !m_impl->fp) return -1;
+    int c = fgetc(m_impl->fp);
+    if(c != EOF) ungetc(c, m_impl->fp);
+    return c == EOF ? -1 : c;
+}
+
+int fs::File::available() {
+    if(!m_impl || !m_impl->fp) return 0;
+    return size() - position();
+}
+
+void fs::File::flush() {
+    if(m_impl && m_impl->fp) fflush(m_impl->fp);
+}
+
+bool fs::File::seek(uint32_t pos, SeekMode mode) {
+    if(!m_impl || !m_impl->fp) return false;
+    int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+    return fseek(m_impl->fp, (long)pos, whence) == 0; // like the core: SeekEnd with pos > 0 is past the end
+}
+
+size_t fs::File::position() const {
+    return m_impl && m_impl->fp ? ftell(m_impl->fp) : 0;
+}
+
+size_t fs::File::size() const {
+    if(!m_impl || !m_impl->fp) return 0;
+    fflush(m_impl->fp);
+    struct stat st;
+    return fstat(fileno(m_impl->fp), &st) == 0 ? st.st_size : 0;
+}
+
+time_t fs::File::getLastWrite() {
+    struct stat st;
+    return m_impl && stat(m_impl->host.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+const char* fs::File::path() const {
+    return m_impl ? m_impl->path.c_str() : NULL;
+}
+
+const char* fs::File::name() const {
+    return m_impl ? m_impl->name.c_str() : NULL;
+}
+
+bool fs::File::isDirectory() const {
+    return m_impl && m_impl->dir;
+}
+
+fs::File fs::File::openNextFile(const char* mode) {
+    if(!m_impl || !m_impl->dir) return File();
+    while(dirent* e = readdir(m_impl->dir)) {
+        if(!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+        auto        impl = std::make_shared<impl_t>();
+        std::string path = m_impl->path;
+        if(path.empty() || path.back() != '/') path += '/';
+        impl->path = path + e->d_name;
+        impl->host = m_impl->host + "/" + e->d_name;
+        impl->name = e->d_name;
+        struct stat st;
+        if(stat(impl->host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) impl->dir = opendir(impl->host.c_str());
+        else impl->fp = fopen(impl->host.c_str(), mode[0] == 'r' ? "rb" : "ab");
+        if(impl->fp || impl->dir) return File(impl);
+    }
+    return File();
+}
+
+String fs::File::getNextFileName() {
+    File f = openNextFile();
+    return f ? String(f.path()) : String();
+}
+
+void fs::File::rewindDirectory() {
+    if(m_impl && m_impl->dir) rewinddir(m_impl->dir);
+}
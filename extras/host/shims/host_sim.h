@@ -0,0 +1,23 @@
+// host shim: the knobs of the host build, what the microphone hears, where the speaker and the files go
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+//  A program built against the shims (see extras/host/sim) sets these before it starts the library. The I2S
+//  statistics give the time of the first sound after a mark, for the latency of a reply.
+
+void hostSimSetFsRoot(const char* dir);           // host directory of SD, SPIFFS, LittleFS ..., default ./host_fs
+std::string hostSimFsRoot();                      // and of the Preferences (nvs/)
+void hostSimSetMicInput(const char* wavPath);     // NULL: silence
+void hostSimRewindMic();                          // the input starts again with the next sample
+void hostSimSetI2sOutput(const char* wavPath);    // what the TX channel played, NULL: nothing is written
+
+typedef struct {
+    uint32_t sampleRate;  // of the TX channel
+    uint64_t frames;      // frames played since the mark
+    uint32_t firstSound;  // millis() of the first frame that was not silence since the mark, 0: none yet
+    uint32_t lastSound;   // millis() of the last one
+} host_i2s_stats_t;
+void hostSimMarkI2s();                            // starts the statistics again
+void hostSimI2sStats(host_i2s_stats_t* stats);
@@ -0,0 +1,217 @@
+/*
+ * http.cpp
+ *
+ *  host shim: HTTPClient, the request goes out with a Content-Length, the response body is read by its
+ *  Content-Length, as chunks or up to the close
+ *
+ */
+#include "HTTPClient.h"
+
+bool HTTPClient::begin(const String& url) {
+    m_client = &m_own;
+    int scheme = url.indexOf("://");
+    if(scheme < 0) return false;
+    String protocol = url.substring(0, scheme);
+    m_tls = protocol.equalsIgnoreCase("https");
+    if(!m_tls && !protocol.equalsIgnoreCase("http")) {
+        log_e("unsupported scheme %s", protocol.c_str());
+        return false;
+    }
+    if(!m_tls) m_own.setInsecure(); // NetworkClientSecure is plain TCP then, see connect()
+    String rest = url.substring(scheme + 3);
+    int    slash = rest.indexOf('/');
+    String host = slash < 0 ? rest : rest.substring(0, slash);
+    m_uri = slash < 0 ? String("/") : rest.substring(slash);
+    int colon = host.lastIndexOf(':');
+    m_port = m_tls ? 443 : 80;
+    if(colon >= 0) {
+        m_port = host.substring(colon + 1).toInt();
+        host = host.substring(0, colon);
+    }
+    m_host = host;
+    m_headers = "";
+    return true;
+}
+
+bool HTTPClient::begin(NetworkClient& client, const String& url) {
+    bool ok = begin(url);
+    m_client = &client;
+    return ok;
+}
+
+void HTTPClient::end() {
+    if(m_client) m_client->stop();
+    m_client = NULL;
+    m_code = 0;
+    m_size = -1;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    m_headers += name + ": " + value + "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char* names[], size_t count) {
+    m_collect.clear();
+    for(size_t i = 0; i < count; i++) m_collect.push_back({String(names[i]), String()});
+}
+
+String HTTPClient::header(const char* name) {
+    for(auto& h : m_collect)
+        if(h.first.equalsIgnoreCase(name)) return h.second;
+    return String();
+}
+
+String HTTPClient::errorToString(int error) {
+    switch(error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED:  return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED:  return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED:       return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST:     return "connection lost";
+        case HTTPC_ERROR_NO_STREAM:           return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER:      return "no HTTP server";
+        case HTTPC_ERROR_ENCODING:            return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE:        return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT:        return "read Timeout";
+        default:                              return String();
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool HTTPClient::connect() {
+    if(!m_client) return false;
+    if(m_client->connected()) return true;
+    if(m_client == &m_own && m_tls) return m_own.connect(m_host.c_str(), m_port, m_connectTimeout);
+    return m_client->NetworkClient::connect(m_host.c_str(), m_port, m_connectTimeout);
+}
+
+int HTTPClient::sendHeader(const char* method, size_t size) {
+    String head = String(method) + " " + m_uri + " HTTP/1.1\r\nHost: " + m_host;
+    if(m_port != (m_tls ? 443 : 80)) head += ":" + String(m_port);
+    head += "\r\nUser-Agent: " + m_userAgent + "\r\nConnection: close\r\nAccept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+    String lower = m_headers;
+    lower.toLowerCase();
+    if(lower.indexOf("content-length:") < 0 && (size || strcmp(method, "GET"))) head += "Content-Length: " + String((unsigned)size) + "\r\n";
+    head += m_headers + "\r\n";
+    return m_client->write((const uint8_t*)head.c_str(), head.length()) == head.length() ? 0 : HTTPC_ERROR_SEND_HEADER_FAILED;
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET");
+}
+
+int HTTPClient::sendRequest(const char* method, uint8_t* payload, size_t size) {
+    if(!connect()) return HTTPC_ERROR_CONNECTION_REFUSED;
+    m_client->setTimeout(m_timeout);
+    int err = sendHeader(method, size);
+    if(err) return err;
+    if(size && m_client->write(payload, size) != size) return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    return handleHeaderResponse();
+}
+
+int HTTPClient::sendRequest(const char* method, Stream* stream, size_t size) {
+    if(!stream) return HTTPC_ERROR_NO_STREAM;
+    if(!connect()) return HTTPC_ERROR_CONNECTION_REFUSED;
+    m_client->setTimeout(m_timeout);
+    int err = sendHeader(method, size);
+    if(err) return err;
+    uint8_t buf[1460];
+    size_t  sent = 0;
+    while(sent < size) {
+        size_t n = stream->readBytes(buf, min(sizeof(buf), size - sent));
+        if(!n || m_client->write(buf, n) != n) return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+        sent += n;
+    }
+    return handleHeaderResponse();
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool HTTPClient::readLine(String& line) { // waits up to the timeout, without the CR LF
+    line = "";
+    unsigned long start = millis();
+    while(millis() - start < m_timeout) {
+        int c = m_client->read();
+        if(c < 0) {
+            if(!m_client->connected()) break;
+            delay(1);
+            continue;
+        }
+        if(c == '\n') return true;
+        if(c != '\r') line += (char)c;
+    }
+    return false;
+}
+
+int HTTPClient::handleHeaderResponse() {
+    m_code = 0;
+    m_size = -1;
+    m_chunked = false;
+    for(auto& h : m_collect) h.second = "";
+    String line;
+    while(readLine(line)) {
+        if(!m_code) {
+            if(!line.startsWith("HTTP/1.")) return HTTPC_ERROR_NO_HTTP_SERVER;
+            m_code = line.substring(9, 12).toInt();
+            continue;
+        }
+        if(line.length() == 0) return m_code;
+        int colon = line.indexOf(':');
+        if(colon < 0) continue;
+        String name = line.substring(0, colon), value = line.substring(colon + 1);
+        value.trim();
+        if(name.equalsIgnoreCase("Content-Length")) m_size = value.toInt();
+        if(name.equalsIgnoreCase("Transfer-Encoding")) m_chunked = value.equalsIgnoreCase("chunked");
+        for(auto& h : m_collect)
+            if(h.first.equalsIgnoreCase(name)) h.second = value;
+    }
+    return m_code ? HTTPC_ERROR_CONNECTION_LOST : HTTPC_ERROR_READ_TIMEOUT;
+}
+
+int HTTPClient::readBody(Stream* stream) {
+    uint8_t       buf[1024];
+    int           total = 0;
+    long          left = m_chunked ? 0 : m_size;  // < 0: up to the close
+    unsigned long idle = millis();
+    while(true) {
+        if(m_chunked && left == 0) {
+            String line;
+            if(total && !readLine(line)) return HTTPC_ERROR_READ_TIMEOUT;  // CR LF after the chunk data
+            if(!readLine(line)) return HTTPC_ERROR_READ_TIMEOUT;
+            left = strtol(line.c_str(), NULL, 16);
+            if(left == 0) {
+                while(readLine(line) && line.length()) {}  // trailer
+                return total;
+            }
+        }
+        if(left == 0) return total;
+        int n = m_client->read(buf, left > 0 ? min((long)sizeof(buf), left) : (long)sizeof(buf));
+        if(n <= 0) {
+            if(!m_client->connected()) return left < 0 ? total : HTTPC_ERROR_CONNECTION_LOST;
+            if(millis() - idle > m_timeout) return HTTPC_ERROR_READ_TIMEOUT;
+            delay(1);
+            continue;
+        }
+        idle = millis();
+        if(stream && stream->write(buf, n) != (size_t)n) return HTTPC_ERROR_STREAM_WRITE;
+        total += n;
+        if(left > 0) left -= n;
+    }
+}
+
+int HTTPClient::writeToStream(Stream* stream) {
+    if(!stream) return HTTPC_ERROR_NO_STREAM;
+    if(!m_client || !m_code) return HTTPC_ERROR_NOT_CONNECTED;
+    return readBody(stream);
+}
+
+String HTTPClient::getString() {
+    class Sink : public Stream {
+    public:
+        String s;
+        size_t write(uint8_t c) override { s += (char)c; return 1; };
+        size_t write(const uint8_t* buf, size_t size) override { s.concat((const char*)buf, size); return size; };
+        int    available() override { return 0; };
+        int    read() override { return -1; };
+        int    peek() override { return -1; };
+    } sink;
+    if(m_client && m_code) readBody(&sink);
+    return sink.s;
+}
@@ -0,0 +1,375 @@
+/*
+ * i2s.cpp
+ *
+ *  host shim: I2S TX channel of the IDF (clocked DMA ring into a WAV file), I2SClass RX of the core (WAV file or
+ *  silence at the sample rate)
+ *
+ */
+#include "driver/i2s_std.h"
+#include "ESP_I2S.h"
+#include "host_sim.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+// output file and statistics, one TX channel plays at a time
+static std::mutex       s_outLock;
+static std::string      s_outPath;
+static FILE*            s_out = NULL;
+static uint32_t         s_outRate = 0;
+static uint32_t         s_outBytes = 0;
+static host_i2s_stats_t s_stats = {};
+
+static void wavHeader(FILE* f, uint32_t rate, uint16_t channels, uint32_t dataBytes) {
+    uint8_t h[44];
+    auto    le32 = [](uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; };
+    auto    le16 = [](uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; };
+    memcpy(h, "RIFF", 4);
+    le32(h + 4, 36 + dataBytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    le32(h + 16, 16);
+    le16(h + 20, 1);
+    le16(h + 22, channels);
+    le32(h + 24, rate);
+    le32(h + 28, rate * channels * 2);
+    le16(h + 32, channels * 2);
+    le16(h + 34, 16);
+    memcpy(h + 36, "data", 4);
+    le32(h + 40, dataBytes);
+    fseek(f, 0, SEEK_SET);
+    fwrite(h, 1, 44, f);
+    fseek(f, 0, SEEK_END);
+}
+
+void hostSimSetI2sOutput(const char* wavPath) {
+    std::lock_guard<std::mutex> lock(s_outLock);
+    if(s_out) fclose(s_out);
+    s_out = NULL;
+    s_outPath = wavPath ? wavPath : "";
+    s_outRate = 0;
+    s_outBytes = 0;
+}
+
+void hostSimMarkI2s() {
+    std::lock_guard<std::mutex> lock(s_outLock);
+    uint32_t rate = s_stats.sampleRate;
+    s_stats = {};
+    s_stats.sampleRate = rate;
+}
+
+void hostSimI2sStats(host_i2s_stats_t* stats) {
+    std::lock_guard<std::mutex> lock(s_outLock);
+    *stats = s_stats;
+}
+
+static void played(const int16_t* frames, size_t count, uint32_t rate) { // 16 bit stereo
+    std::lock_guard<std::mutex> lock(s_outLock);
+    s_stats.sampleRate = rate;
+    s_stats.frames += count;
+    for(size_t i = 0; i < count * 2; i++) {
+        if(abs(frames[i]) < 8) continue; // dither and rounding are silence
+        if(!s_stats.firstSound) s_stats.firstSound = max(millis(), 1UL);
+        s_stats.lastSound = millis();
+        break;
+    }
+    if(s_outPath.empty()) return;
+    if(!s_out) {
+        s_out = fopen(s_outPath.c_str(), "wb");
+        if(!s_out) {
+            log_e("can't write %s", s_outPath.c_str());
+            s_outPath = "";
+            return;
+        }
+        s_outRate = rate;
+        wavHeader(s_out, rate, 2, 0);
+    }
+    if(rate != s_outRate) log_w("I2S rate %u Hz, the WAV file has %u Hz", rate, s_outRate);
+    s_outBytes += fwrite(frames, 4, count, s_out) * 4;
+    wavHeader(s_out, s_outRate, 2, s_outBytes); // the file is complete at any time, the simulation may end with _exit()
+    fflush(s_out);
+}
+//----------------------------------------------------------------------------------------------------------------------
+struct i2s_channel_obj_t {
+    i2s_chan_config_t       chan;
+    i2s_std_config_t        std = {};
+    i2s_event_callbacks_t   cbs = {};
+    void*                   ctx = NULL;
+    std::mutex              m;
+    std::condition_variable room;   // for i2s_channel_write()
+    std::condition_variable state;  // for the clock
+    std::vector<uint8_t>    ring;
+    size_t                  head = 0;
+    size_t                  fill = 0;
+    bool                    enabled = false;
+    bool                    restart = false;
+    bool                    quit = false;
+    std::thread             clock;
+
+    size_t frameBytes() const { return std::max(1, (int)std.slot_cfg.data_bit_width / 8 * (int)std.slot_cfg.slot_mode); }
+    void   run();
+};
+
+void i2s_channel_obj_t::run() {
+    std::vector<uint8_t> desc;
+    auto                 next = steady_clock::now();
+    while(true) {
+        uint32_t rate, frames;
+        size_t   take, bytes;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            state.wait(lock, [this] { return enabled || quit; });
+            if(quit) return;
+            if(restart) next = steady_clock::now();
+            restart = false;
+            rate = max(std.clk_cfg.sample_rate_hz, (uint32_t)1000);
+            frames = chan.dma_frame_num;
+        }
+        next += microseconds((uint64_t)frames * 1000000 / rate);
+        auto now = steady_clock::now();
+        if(now - next > std::chrono::milliseconds(50)) next = now; // after a stall the clock goes on, no catch-up
+        std::this_thread::sleep_until(next);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if(!enabled) continue;
+            bytes = frames * frameBytes();
+            take = min(fill, bytes);
+            desc.assign(bytes, 0); // auto_clear: the rest of the descriptor is silence
+            for(size_t i = 0; i < take; i++) desc[i] = ring[(head + i) % ring.size()];
+            head = (head + take) % ring.size();
+            fill -= take;
+        }
+        room.notify_all();
+        if(take && std.slot_cfg.data_bit_width == I2S_DATA_BIT_WIDTH_16BIT && std.slot_cfg.slot_mode == I2S_SLOT_MODE_STEREO)
+            played((const int16_t*)desc.data(), take / 4, rate);
+        i2s_event_data_t ev = {desc.data(), bytes};
+        if(cbs.on_sent) cbs.on_sent(this, &ev, ctx);
+    }
+}
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t* cfg, i2s_chan_handle_t* tx, i2s_chan_handle_t* rx) {
+    if(!cfg || !tx) return ESP_ERR_INVALID_ARG; // receive channels are I2SClass (ESP_I2S.h)
+    i2s_chan_handle_t h = new i2s_channel_obj_t;
+    h->chan = *cfg;
+    h->chan.dma_desc_num = max(h->chan.dma_desc_num, (uint32_t)2);
+    h->chan.dma_frame_num = max(h->chan.dma_frame_num, (uint32_t)8);
+    h->std.clk_cfg.sample_rate_hz = 44100;
+    h->std.slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO);
+    h->ring.resize(h->chan.dma_desc_num * h->chan.dma_frame_num * 4);
+    h->clock = std::thread([h] { h->run(); });
+    *tx = h;
+    if(rx) *rx = NULL;
+    return ESP_OK;
+}
+
+esp_err_t i2s_del_channel(i2s_chan_handle_t h) {
+    if(!h) return ESP_ERR_INVALID_ARG;
+    {
+        std::lock_guard<std::mutex> lock(h->m);
+        h->quit = true;
+    }
+    h->state.notify_all();
+    h->clock.join();
+    delete h;
+    return ESP_OK;
+}
+
+static esp_err_t reconfigure(i2s_chan_handle_t h, const std::function<void()>& change) {
+    if(!h) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(h->m);
+    change();
+    h->ring.assign(h->chan.dma_desc_num * h->chan.dma_frame_num * h->frameBytes(), 0);
+    h->head = 0;
+    h->fill = 0;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t h, const i2s_std_config_t* cfg) {
+    return reconfigure(h, [h, cfg] { h->std = *cfg; });
+}
+
+esp_err_t i2s_channel_reconfig_std_clock(i2s_chan_handle_t h, const i2s_std_clk_config_t* cfg) {
+    return reconfigure(h, [h, cfg] { h->std.clk_cfg = *cfg; });
+}
+
+esp_err_t i2s_channel_reconfig_std_slot(i2s_chan_handle_t h, const i2s_std_slot_config_t* cfg) {
+    return reconfigure(h, [h, cfg] { h->std.slot_cfg = *cfg; });
+}
+
+esp_err_t i2s_channel_reconfig_std_gpio(i2s_chan_handle_t h, const i2s_std_gpio_config_t* cfg) {
+    if(!h) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(h->m);
+    h->std.gpio_cfg = *cfg;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t h, const i2s_event_callbacks_t* cbs, void* user_data) {
+    if(!h) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(h->m);
+    if(h->enabled) return ESP_ERR_INVALID_STATE;
+    h->cbs = cbs ? *cbs : i2s_event_callbacks_t{};
+    h->ctx = user_data;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_enable(i2s_chan_handle_t h) {
+    if(!h) return ESP_ERR_INVALID_ARG;
+    {
+        std::lock_guard<std::mutex> lock(h->m);
+        if(h->enabled) return ESP_ERR_INVALID_STATE;
+        h->enabled = true;
+        h->restart = true;
+    }
+    h->state.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_disable(i2s_chan_handle_t h) {
+    if(!h) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(h->m);
+    if(!h->enabled) return ESP_ERR_INVALID_STATE;
+    h->enabled = false;
+    h->head = 0;
+    h->fill = 0;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_write(i2s_chan_handle_t h, const void* src, size_t size, size_t* written, uint32_t timeout_ms) {
+    if(written) *written = 0;
+    if(!h || !src) return ESP_ERR_INVALID_ARG;
+    std::unique_lock<std::mutex> lock(h->m);
+    if(!h->enabled) return ESP_ERR_INVALID_STATE;
+    size_t fb = h->frameBytes();
+    auto   roomFor = [h, fb] { return (h->ring.size() - h->fill) / fb * fb; };
+    if(!roomFor() && timeout_ms) h->room.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] { return roomFor() > 0 || !h->enabled; });
+    size_t n = min(size / fb * fb, roomFor());
+    size_t tail = (h->head + h->fill) % h->ring.size();
+    for(size_t i = 0; i < n; i++) h->ring[(tail + i) % h->ring.size()] = ((const uint8_t*)src)[i];
+    h->fill += n;
+    if(written) *written = n;
+    return n || !size ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+//----------------------------------------------------------------------------------------------------------------------
+static std::mutex           s_micLock;
+static std::vector<int16_t> s_mic;
+static uint32_t             s_micRate = 0;
+static uint64_t             s_micPos = 0;
+
+void hostSimSetMicInput(const char* wavPath) {
+    std::lock_guard<std::mutex> lock(s_micLock);
+    s_mic.clear();
+    s_micPos = 0;
+    if(!wavPath) return;
+    FILE* f = fopen(wavPath, "rb");
+    if(!f) {
+        log_e("can't read %s", wavPath);
+        return;
+    }
+    uint8_t  h[12], c[8];
+    uint16_t format = 0, channels = 1, bits = 16;
+    if(fread(h, 1, 12, f) != 12 || memcmp(h, "RIFF", 4) || memcmp(h + 8, "WAVE", 4)) {
+        log_e("%s is not a WAV file", wavPath);
+        fclose(f);
+        return;
+    }
+    while(fread(c, 1, 8, f) == 8) { // chunks: fmt, then data
+        uint32_t size = c[4] | c[5] << 8 | c[6] << 16 | (uint32_t)c[7] << 24;
+        if(!memcmp(c, "fmt ", 4)) {
+            uint8_t fmt[16] = {};
+            fread(fmt, 1, min(size, (uint32_t)16), f);
+            if(size > 16) fseek(f, size - 16, SEEK_CUR);
+            format = fmt[0] | fmt[1] << 8;
+            channels = fmt[2] | fmt[3] << 8;
+            s_micRate = fmt[4] | fmt[5] << 8 | fmt[6] << 16 | (uint32_t)fmt[7] << 24;
+            bits = fmt[14] | fmt[15] << 8;
+            continue;
+        }
+        if(memcmp(c, "data", 4)) {
+            fseek(f, (size + 1) & ~1u, SEEK_CUR);
+            continue;
+        }
+        if(format != 1 || bits != 16 || !channels) {
+            log_e("%s: 16 bit PCM only", wavPath);
+            break;
+        }
+        std::vector<int16_t> pcm(size / 2);
+        pcm.resize(fread(pcm.data(), 2, pcm.size(), f));
+        for(size_t i = 0; i < pcm.size(); i += channels) s_mic.push_back(pcm[i]);
+        break;
+    }
+    fclose(f);
+}
+
+void hostSimRewindMic() {
+    std::lock_guard<std::mutex> lock(s_micLock);
+    s_micPos = 0;
+}
+
+static int16_t micSample(uint32_t rate) {
+    std::lock_guard<std::mutex> lock(s_micLock);
+    static bool warned = false;
+    if(!s_mic.empty() && s_micRate != rate && !warned) log_w("mic input has %u Hz, I2S runs at %u Hz", s_micRate, rate);
+    warned |= !s_mic.empty() && s_micRate != rate;
+    uint64_t i = s_micPos++;
+    return i < s_mic.size() ? s_mic[i] : 0;
+}
+
+static const uint32_t RX_DMA_FRAMES = 240;
+
+bool I2SClass::begin(i2s_mode_t mode, uint32_t rate, i2s_data_bit_width_t bits, i2s_slot_mode_t /*ch*/, int8_t /*slot_mask*/) {
+    if(mode == I2S_MODE_PDM_TX || bits != I2S_DATA_BIT_WIDTH_16BIT) {
+        log_e("host I2S: 16 bit receive only");
+        return false;
+    }
+    m_rate = rate;
+    m_start = micros();
+    m_taken = 0;
+    m_running = true;
+    return true;
+}
+
+bool I2SClass::end() {
+    m_running = false;
+    return true;
+}
+
+int I2SClass::available() {
+    return m_running ? 1024 : 0;
+}
+
+int I2SClass::read() {
+    if(!m_running) return -1;
+    uint64_t ring = m_rate / 10;
+    uint64_t due = (micros() - m_start) * m_rate / 1000000; // samples the clock has produced
+    due -= due % RX_DMA_FRAMES;                              // ... in whole DMA frames
+    if(due > m_taken + ring) {                               // the ring overran, the oldest ones are gone
+        for(uint64_t n = due - ring - m_taken; n; n--) micSample(m_rate);
+        m_taken = due - ring;
+    }
+    if(m_taken >= due) {                                     // wait for the frame of this sample
+        uint64_t ready = m_start + (m_taken / RX_DMA_FRAMES + 1) * RX_DMA_FRAMES * 1000000 / m_rate;
+        uint64_t now = micros();
+        if(ready > now + m_timeout * 1000) return -1;
+        if(ready > now) delayMicroseconds(ready - now);
+    }
+    m_taken++;
+    return (uint16_t)micSample(m_rate);
+}
+
+size_t I2SClass::readBytes(char* buf, size_t size) {
+    size_t n = 0;
+    for(; n + 2 <= size; n += 2) {
+        int s = read();
+        if(s < 0) break;
+        buf[n] = s;
+        buf[n + 1] = s >> 8;
+    }
+    return n;
+}
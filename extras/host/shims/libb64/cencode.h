@@ -0,0 +1,17 @@
+// host shim: the libb64 encoder of the ESP32 core, no line breaks
+#pragma once
+
+#define base64_encode_expected_len(n) ((((4 * (n)) / 3) + 3) & ~3)
+
+typedef enum { step_A, step_B, step_C } base64_encodestep;
+typedef struct {
+    base64_encodestep step;
+    char              result;
+    int               stepcount;
+} base64_encodestate;
+
+void base64_init_encodestate(base64_encodestate* state);
+char base64_encode_value(char value);
+int  base64_encode_block(const char* plaintext, int length, char* code, base64_encodestate* state);
+int  base64_encode_blockend(char* code, base64_encodestate* state); // with the terminating 0
+int  base64_encode_chars(const char* plaintext, int length, char* code);
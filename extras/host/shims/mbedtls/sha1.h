@@ -0,0 +1,18 @@
+// host shim: SHA-1 of mbedTLS (3.x names)
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t total[2];
+    uint32_t state[5];
+    unsigned char buffer[64];
+} mbedtls_sha1_context;
+
+void mbedtls_sha1_init(mbedtls_sha1_context* ctx);
+void mbedtls_sha1_free(mbedtls_sha1_context* ctx);
+int  mbedtls_sha1_starts(mbedtls_sha1_context* ctx);
+int  mbedtls_sha1_update(mbedtls_sha1_context* ctx, const unsigned char* input, size_t ilen);
+int  mbedtls_sha1_finish(mbedtls_sha1_context* ctx, unsigned char output[20]);
+int  mbedtls_sha1(const unsigned char* input, size_t ilen, unsigned char output[20]);
@@ -0,0 +1,343 @@
+/*
+ * network.cpp
+ *
+ *  host shim: WiFi, IPAddress, NetworkClient on POSIX sockets, NetworkClientSecure on OpenSSL (HOST_TLS)
+ *
+ */
+#include "WiFi.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <vector>
+#ifdef HOST_TLS
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+WiFiClass WiFi;
+
+static struct IgnoreSigpipe { // a write to a closed peer is an error return, like lwIP, and not the end of the program
+    IgnoreSigpipe() { signal(SIGPIPE, SIG_IGN); }
+} s_ignoreSigpipe;
+
+int WiFiClass::hostByName(const char* host, IPAddress& ip) {
+    addrinfo hints = {}, *res = NULL;
+    hints.ai_family = AF_INET;
+    if(getaddrinfo(host, NULL, &hints, &res) || !res) return 0;
+    ip = IPAddress((uint32_t)((sockaddr_in*)res->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(res);
+    return 1;
+}
+
+bool IPAddress::fromString(const char* s) {
+    in_addr a;
+    if(!s || inet_pton(AF_INET, s, &a) != 1) return false;
+    memcpy(m_addr, &a.s_addr, 4);
+    return true;
+}
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", m_addr[0], m_addr[1], m_addr[2], m_addr[3]);
+    return buf;
+}
+//----------------------------------------------------------------------------------------------------------------------
+// received bytes wait here, available() and peek() work the same for TCP and TLS
+struct NetworkClient::socket_t {
+    int                  fd = -1;
+    bool                 closed = false;  // the peer closed or an error, unread bytes are still returned
+    std::vector<uint8_t> rx;
+    size_t               rxPos = 0;
+    void*                ssl = NULL;
+    void*                ctx = NULL;
+
+    ~socket_t() {
+#ifdef HOST_TLS
+        if(ssl) {
+            SSL_shutdown((SSL*)ssl);
+            SSL_free((SSL*)ssl);
+        }
+        if(ctx) SSL_CTX_free((SSL_CTX*)ctx);
+#endif
+        if(fd >= 0) close(fd);
+    }
+    size_t buffered() const { return rx.size() - rxPos; }
+};
+
+NetworkClient::NetworkClient() {}
+
+NetworkClient::~NetworkClient() {}
+
+int NetworkClient::fd() const {
+    return m_socket ? m_socket->fd : -1;
+}
+
+bool NetworkClient::waitSocket(bool forWrite, int32_t timeout_ms) {
+    pollfd p = {fd(), (short)(forWrite ? POLLOUT : POLLIN), 0};
+    int    r;
+    do {
+        r = poll(&p, 1, timeout_ms);
+    } while(r < 0 && errno == EINTR);
+    return r > 0;
+}
+
+int NetworkClient::openSocket(const char* host, uint16_t port, int32_t timeout_ms) {
+    addrinfo hints = {}, *res = NULL;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if(getaddrinfo(host, service, &hints, &res) || !res) {
+        log_e("host %s not found", host);
+        return -1;
+    }
+    int fd = -1;
+    for(addrinfo* a = res; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if(fd < 0) continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        if(::connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        if(errno == EINPROGRESS) {
+            pollfd p = {fd, POLLOUT, 0};
+            int    err = 0;
+            socklen_t len = sizeof(err);
+            if(poll(&p, 1, timeout_ms) > 0 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && !err) break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+#ifdef SO_NOSIGPIPE
+    if(fd >= 0) {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+    }
+#endif
+    return fd;
+}
+
+int NetworkClient::connect(const char* host, uint16_t port, int32_t timeout_ms) {
+    stop();
+    int fd = openSocket(host, port, timeout_ms);
+    if(fd < 0) return 0;
+    m_socket = std::make_shared<socket_t>();
+    m_socket->fd = fd;
+    return 1;
+}
+
+void NetworkClient::stop() {
+    m_socket.reset(); // the last copy closes the socket
+}
+
+void NetworkClient::clear() {
+    if(!m_socket) return;
+    m_socket->rx.clear();
+    m_socket->rxPos = 0;
+    uint8_t buf[512];
+    while(recvRaw(buf, sizeof(buf), false) > 0) {}
+}
+
+int NetworkClient::setNoDelay(bool nodelay) {
+    int one = nodelay;
+    return fd() >= 0 ? setsockopt(fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) : -1;
+}
+
+IPAddress NetworkClient::remoteIP() const {
+    sockaddr_in a = {};
+    socklen_t   len = sizeof(a);
+    if(fd() < 0 || getpeername(fd(), (sockaddr*)&a, &len) || a.sin_family != AF_INET) return IPAddress();
+    return IPAddress((uint32_t)a.sin_addr.s_addr);
+}
+
+IPAddress NetworkClient::localIP() const {
+    sockaddr_in a = {};
+    socklen_t   len = sizeof(a);
+    if(fd() < 0 || getsockname(fd(), (sockaddr*)&a, &len) || a.sin_family != AF_INET) return IPAddress();
+    return IPAddress((uint32_t)a.sin_addr.s_addr);
+}
+
+uint16_t NetworkClient::remotePort() const {
+    sockaddr_in a = {};
+    socklen_t   len = sizeof(a);
+    if(fd() < 0 || getpeername(fd(), (sockaddr*)&a, &len)) return 0;
+    return ntohs(a.sin_port);
+}
+//----------------------------------------------------------------------------------------------------------------------
+int NetworkClient::recvRaw(uint8_t* buf, size_t size, bool peek) {
+    ssize_t n = recv(fd(), buf, size, MSG_DONTWAIT | (peek ? MSG_PEEK : 0));
+    if(n > 0) return n;
+    if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    return -1; // 0: the peer closed
+}
+
+int NetworkClient::sendRaw(const uint8_t* buf, size_t size) {
+    ssize_t n = send(fd(), buf, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if(n >= 0) return n;
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+}
+
+int NetworkClient::pending() {
+    int n = 0;
+    if(ioctl(fd(), FIONREAD, &n) < 0) return 0;
+    return n;
+}
+
+int NetworkClient::available() {
+    if(!m_socket) return 0;
+    socket_t& s = *m_socket;
+    if(!s.closed) {
+        int want = max(pending(), 1);
+        if(s.rxPos == s.rx.size()) {
+            s.rx.clear();
+            s.rxPos = 0;
+        }
+        size_t old = s.rx.size();
+        s.rx.resize(old + want);
+        int n = recvRaw(s.rx.data() + old, want, false);
+        s.rx.resize(old + max(n, 0));
+        if(n < 0) s.closed = true;
+    }
+    return s.buffered();
+}
+
+int NetworkClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int NetworkClient::read(uint8_t* buf, size_t size) {
+    if(!m_socket) return -1;
+    socket_t& s = *m_socket;
+    if(!s.buffered() && !available()) return s.closed ? -1 : 0;
+    size_t n = min(size, s.buffered());
+    memcpy(buf, s.rx.data() + s.rxPos, n);
+    s.rxPos += n;
+    return n;
+}
+
+int NetworkClient::peek() {
+    if(!m_socket || (!m_socket->buffered() && !available())) return -1;
+    return m_socket->rx[m_socket->rxPos];
+}
+
+size_t NetworkClient::write(const uint8_t* buf, size_t size) {
+    if(!m_socket || m_socket->closed) return 0;
+    size_t        done = 0;
+    unsigned long start = millis();
+    while(done < size) {
+        int n = sendRaw(buf + done, size - done);
+        if(n < 0) {
+            m_socket->closed = true;
+            break;
+        }
+        done += n;
+        if(n == 0 && (millis() - start > m_timeout || !waitSocket(true, m_timeout))) break;
+    }
+    return done;
+}
+
+uint8_t NetworkClient::connected() {
+    if(!m_socket) return 0;
+    if(m_socket->buffered()) return 1;
+    available();
+    return m_socket->buffered() || !m_socket->closed;
+}
+//----------------------------------------------------------------------------------------------------------------------
+#ifdef HOST_TLS
+
+int NetworkClientSecure::connect(const char* host, uint16_t port, int32_t timeout_ms) {
+    if(!NetworkClient::connect(host, port, timeout_ms)) return 0;
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    m_socket->ctx = ctx;
+    if(m_insecure) {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+    }
+    else {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, NULL);
+        if(m_caCert.empty()) {
+            SSL_CTX_set_default_verify_paths(ctx);
+        }
+        else {
+            BIO*  bio = BIO_new_mem_buf(m_caCert.data(), m_caCert.size());
+            X509* cert;
+            while((cert = PEM_read_bio_X509(bio, NULL, NULL, NULL))) {
+                X509_STORE_add_cert(SSL_CTX_get_cert_store(ctx), cert);
+                X509_free(cert);
+            }
+            BIO_free(bio);
+        }
+    }
+    SSL* ssl = SSL_new(ctx);
+    m_socket->ssl = ssl;
+    SSL_set_fd(ssl, fd());
+    SSL_set_tlsext_host_name(ssl, host);
+    if(!m_insecure) SSL_set1_host(ssl, host);
+
+    unsigned long start = millis();
+    while(true) {
+        int r = SSL_connect(ssl);
+        if(r == 1) return 1;
+        int err = SSL_get_error(ssl, r);
+        if((err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) || millis() - start > m_handshakeTimeout) {
+            log_e("TLS handshake with %s failed: %s", host, ERR_reason_error_string(ERR_get_error()));
+            stop();
+            return 0;
+        }
+        waitSocket(err == SSL_ERROR_WANT_WRITE, 100);
+    }
+}
+
+int NetworkClientSecure::recvRaw(uint8_t* buf, size_t size, bool peek) {
+    if(!m_socket || !m_socket->ssl) return NetworkClient::recvRaw(buf, size, peek);
+    SSL* ssl = (SSL*)m_socket->ssl;
+    int  n = peek ? SSL_peek(ssl, buf, size) : SSL_read(ssl, buf, size);
+    if(n > 0) return n;
+    int err = SSL_get_error(ssl, n);
+    return err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE ? 0 : -1;
+}
+
+int NetworkClientSecure::sendRaw(const uint8_t* buf, size_t size) {
+    if(!m_socket || !m_socket->ssl) return NetworkClient::sendRaw(buf, size);
+    SSL* ssl = (SSL*)m_socket->ssl;
+    int  n = SSL_write(ssl, buf, size);
+    if(n > 0) return n;
+    int err = SSL_get_error(ssl, n);
+    return err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE ? 0 : -1;
+}
+
+int NetworkClientSecure::pending() {
+    if(!m_socket || !m_socket->ssl) return NetworkClient::pending();
+    return max(SSL_pending((SSL*)m_socket->ssl), min(NetworkClient::pending(), 16384)); // a record is up to 16 KB
+}
+
+#else
+
+int NetworkClientSecure::connect(const char* host, uint16_t port, int32_t timeout_ms) {
+    static bool warned = false;
+    if(!warned) log_w("host build without TLS, %s:%u is plain TCP", host, port);
+    warned = true;
+    return NetworkClient::connect(host, port, timeout_ms);
+}
+
+int NetworkClientSecure::recvRaw(uint8_t* buf, size_t size, bool peek) { return NetworkClient::recvRaw(buf, size, peek); }
+int NetworkClientSecure::sendRaw(const uint8_t* buf, size_t size) { return NetworkClient::sendRaw(buf, size); }
+int NetworkClientSecure::pending() { return NetworkClient::pending(); }
+
+#endif
+
+void NetworkClientSecure::stop() {
+    NetworkClient::stop();
+}
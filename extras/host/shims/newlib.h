@@ -0,0 +1,31 @@
+// host shim: what the newlib headers of the ESP32 toolchain declare and glibc does not
+#pragma once
+
+//  Included before every library source (-include in CMakeLists.txt): the sources rely on these coming in with
+//  <stdlib.h>, <string.h> and <math.h> the way they do on the device.
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <sys/types.h>
+
+#ifndef __unused
+#define __unused __attribute__((__unused__))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38) // glibc 2.38 has them
+size_t strlcpy(char* dst, const char* src, size_t size);
+size_t strlcat(char* dst, const char* src, size_t size);
+#endif
+
+#ifndef __APPLE__
+static inline float pow10f(float x) { return powf(10.0f, x); }
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,79 @@
+/*
+ * preferences.cpp
+ *
+ *  host shim: Preferences in text files, see Preferences.h
+ *
+ */
+#include "Preferences.h"
+#include "host_sim.h"
+#include <sys/stat.h>
+
+bool Preferences::begin(const char* name, bool readOnly, const char* /*partition*/) {
+    if(m_started || !name || !*name || strlen(name) > 15) return false; // NVS limits the name to 15 characters
+    std::string dir = hostSimFsRoot() + "/nvs";
+    ::mkdir(hostSimFsRoot().c_str(), 0755);
+    ::mkdir(dir.c_str(), 0755);
+    m_file = dir + "/" + name;
+    m_values.clear();
+    if(FILE* f = fopen(m_file.c_str(), "r")) {
+        char line[1024];
+        while(fgets(line, sizeof(line), f)) {
+            char* eq = strchr(line, '=');
+            if(!eq) continue;
+            line[strcspn(line, "\r\n")] = 0;
+            *eq = 0;
+            m_values[line] = eq + 1;
+        }
+        fclose(f);
+    }
+    else if(readOnly) {
+        return false; // like NVS: a namespace that was never written cannot be opened read-only
+    }
+    m_readOnly = readOnly;
+    m_started = true;
+    return true;
+}
+
+void Preferences::end() {
+    m_started = false;
+    m_values.clear();
+}
+
+bool Preferences::clear() {
+    if(!m_started || m_readOnly) return false;
+    m_values.clear();
+    return save();
+}
+
+bool Preferences::remove(const char* key) {
+    if(!m_started || m_readOnly || !m_values.erase(key)) return false;
+    return save();
+}
+
+String Preferences::getString(const char* key, const String& def) {
+    return isKey(key) ? String(m_values[key]) : def;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    if(!isKey(key)) return 0;
+    const std::string& v = m_values[key];
+    if(!value) return v.size() + 1;
+    if(v.size() + 1 > maxLen) return 0;
+    memcpy(value, v.c_str(), v.size() + 1);
+    return v.size() + 1;
+}
+
+size_t Preferences::put(const char* key, const char* value) {
+    if(!m_started || m_readOnly || !key || strlen(key) > 15 || strchr(value, '\n')) return 0;
+    m_values[key] = value;
+    return save() ? strlen(value) : 0;
+}
+
+bool Preferences::save() {
+    std::string tmp = m_file + ".tmp";
+    FILE*       f = fopen(tmp.c_str(), "w");
+    if(!f) return false;
+    for(auto& kv : m_values) fprintf(f, "%s=%s\n", kv.first.c_str(), kv.second.c_str());
+    fclose(f);
+    return ::rename(tmp.c_str(), m_file.c_str()) == 0;
+}
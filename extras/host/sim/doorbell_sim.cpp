@@ -0,0 +1,296 @@
+/*
+ * doorbell_sim.cpp
+ *
+ *  The conversation loop of examples/Doorbell/AI_Doorbell_Elevenlabs_asr on the host, against the local mock
+ *  (examples/Doorbell/asr_mock): listen, speculative request on a stable partial, final, reply, speech, next turn.
+ *  Every stage is printed with its time after the end of the visitor audio (the stop of the recording), the same
+ *  reference the mock uses, so both sides of a run line up. Stages before it (the speculative request) are negative.
+ *
+ *    doorbell_sim [--host 127.0.0.1] [--port 8765] [--turns 2] [--mic in.wav] [--out played.wav] [--no-stream]
+ *                 [--fs dir] [--speech mp3,opus,aac,flac,wav [--runs 3]]
+ *
+ *  --speech skips the conversation and plays the reply of the first turn in each response_format, --runs times, for
+ *  the time from openai_speech() to the first decoded samples (the "first audio after" line of Audio) and to the
+ *  first frame on I2S. The mock's mp3, aac and opus are silent, so it is frames, not sound.
+ *
+ *  Exit code 0 when every turn got a reply that was played (every format played), 1 otherwise.
+ */
+#include "Arduino.h"
+#include "Audio.h"
+#include "ArduinoASRChat.h"
+#include "ArduinoGPTChat.h"
+#include "host_sim.h"
+#include <unistd.h>
+
+Audio audio; // ArduinoGPTChat plays through the sketch's global
+
+static ArduinoASRChat* asrChat = NULL;
+static ArduinoGPTChat* gptChat = NULL;
+
+static const char* SYSTEM_PROMPT = "You are the voice of a doorbell. Answer in one short sentence.";
+
+struct turn_t {
+    unsigned long start;       // recording started
+    unsigned long end;         // recording stopped: end of the visitor audio, 0 while listening
+    unsigned long partials;    // partial revisions seen
+    unsigned long speculative; // millis() of the stages, 0: not reached
+    unsigned long final;
+    unsigned long reply;
+    unsigned long speech;      // textToSpeech() returned
+    unsigned long sound;       // first frame that was not silence on I2S
+    unsigned long done;        // playback finished
+};
+
+static void stage(const turn_t& t, const char* what, const char* text = NULL) {
+    if(t.end) Serial.printf("  %-24s %+6ld ms", what, (long)(millis() - t.end));
+    else      Serial.printf("  %-24s %6lu ms after the start", what, (unsigned long)(millis() - t.start));
+    if(text) Serial.printf("  \"%s\"", text);
+    Serial.println();
+}
+
+static String after(const turn_t& t, unsigned long at) { // a column of the table
+    return at && t.end ? String((long)(at - t.end)) : String("-");
+}
+
+static unsigned long s_firstAudio = 0; // ms of the last "first audio after" line, 0: none since the reset
+
+void audio_info(const char* info) { // weak in Audio
+    unsigned long ms;
+    if(sscanf(info, "first audio after %lu ms", &ms) == 1) s_firstAudio = ms;
+}
+
+static bool runTurn(int n, turn_t& t) {
+    memset(&t, 0, sizeof(t));
+    t.start = millis();
+    Serial.printf("turn %d\n", n);
+    if(!asrChat->startRecording()) {
+        Serial.println("  startRecording() failed");
+        return false;
+    }
+
+    // STATE_LISTENING
+    uint32_t speculatedRevision = asrChat->getPartialRevision();
+    uint32_t revision = speculatedRevision;
+    while(!asrChat->hasNewResult()) {
+        audio.loop();
+        asrChat->loop();
+        if(!t.end && !asrChat->isRecording()) {
+            t.end = millis();
+            hostSimMarkI2s(); // the first sound after this is the reply
+            stage(t, "end of audio");
+        }
+        if(asrChat->getPartialRevision() != revision) {
+            revision = asrChat->getPartialRevision();
+            t.partials++;
+            stage(t, "partial", asrChat->getPartialText().c_str());
+        }
+        if(asrChat->isRecording() && asrChat->isPartialStable() && revision != speculatedRevision) {
+            speculatedRevision = revision; // once per partial, like the sketch
+            if(gptChat->beginSpeculative(asrChat->getPartialText())) {
+                t.speculative = millis();
+                stage(t, "speculative request", asrChat->getPartialText().c_str());
+            }
+        }
+        if(!asrChat->isRecording() && t.end && millis() - t.end > 10000) {
+            Serial.println("  no final within 10 s");
+            return false;
+        }
+        yield();
+    }
+    if(!t.end) {
+        t.end = millis(); // the final stopped the recording before loop() saw it
+        hostSimMarkI2s();
+    }
+    String text = asrChat->getRecognizedText();
+    asrChat->clearResult();
+    t.final = millis();
+    stage(t, "final", text.c_str());
+    if(text.length() == 0) {
+        gptChat->cancelSpeculative();
+        return false;
+    }
+
+    // STATE_PROCESSING_LLM
+    String response = gptChat->takeSpeculative(text);
+    bool   reused = response.length() > 0;
+    if(!reused) response = gptChat->sendMessage(text);
+    t.reply = millis();
+    stage(t, reused ? "reply (speculative)" : "reply", response.c_str());
+    if(response.length() == 0) return false;
+
+    // STATE_PLAYING_TTS, STATE_WAIT_TTS_COMPLETE
+    if(!gptChat->textToSpeech(response)) {
+        stage(t, "speech request failed");
+        return false;
+    }
+    t.speech = millis();
+    stage(t, "speech request");
+    unsigned long check = millis();
+    while(true) {
+        audio.loop();
+        asrChat->loop();
+        host_i2s_stats_t stats;
+        hostSimI2sStats(&stats);
+        if(!t.sound && stats.firstSound) {
+            t.sound = stats.firstSound;
+            Serial.printf("  %-24s %+6ld ms\n", "first sound", (long)(t.sound - t.end));
+        }
+        if(millis() - check > 100) {
+            check = millis();
+            if(!audio.isRunning()) break;
+        }
+        delay(10);
+    }
+    t.done = millis();
+    stage(t, "playback done");
+    delay(500);
+    return t.sound != 0;
+}
+
+struct speech_t {
+    unsigned long request; // openai_speech() returned, ms after the call
+    unsigned long audio;   // first decoded samples
+    unsigned long frame;   // first frame on I2S
+    unsigned long done;    // playback finished
+};
+
+static bool runSpeech(const char* format, const char* text, speech_t& r) {
+    memset(&r, 0, sizeof(r));
+    ArduinoGPTChat::SpeechOptions options = gptChat->speechOptions();
+    options.format = format;
+    s_firstAudio = 0;
+    hostSimMarkI2s();
+    unsigned long t0 = millis();
+    if(!gptChat->textToSpeech(text, options)) return false;
+    r.request = millis() - t0;
+    while(audio.isRunning() && millis() - t0 < 30000) {
+        audio.loop();
+        host_i2s_stats_t stats;
+        hostSimI2sStats(&stats);
+        if(!r.frame && stats.frames) r.frame = millis() - t0;
+        delay(2);
+    }
+    r.done = millis() - t0;
+    r.audio = s_firstAudio;
+    delay(200);
+    return r.audio && r.frame;
+}
+
+// every format of the list --runs times, round robin so a slow moment of the host does not land on one format
+static bool speechTable(String formats, int runs, const char* text) {
+    String list[8];
+    int    n = 0;
+    while(formats.length() && n < 8) {
+        int comma = formats.indexOf(',');
+        list[n++] = comma < 0 ? formats : formats.substring(0, comma);
+        formats = comma < 0 ? String("") : formats.substring(comma + 1);
+    }
+    speech_t sum[8] = {};
+    bool     ok = true;
+    for(int k = 0; k < runs; k++) {
+        for(int i = 0; i < n; i++) {
+            speech_t r;
+            bool played = runSpeech(list[i].c_str(), text, r);
+            Serial.printf("  %-5s run %d: request %4lu  first audio %5lu  first frame %5lu  done %5lu ms%s\n", list[i].c_str(),
+                          k + 1, r.request, r.audio, r.frame, r.done, played ? "" : "  NOT PLAYED");
+            ok &= played;
+            sum[i].request += r.request;
+            sum[i].audio += r.audio;
+            sum[i].frame += r.frame;
+            sum[i].done += r.done;
+        }
+    }
+    Serial.println();
+    Serial.printf("format  request  first audio  first frame   done   (ms after openai_speech(), mean of %d)\n", runs);
+    for(int i = 0; i < n; i++)
+        Serial.printf("%-6s  %7lu  %11lu  %11lu  %5lu\n", list[i].c_str(), sum[i].request / runs, sum[i].audio / runs,
+                      sum[i].frame / runs, sum[i].done / runs);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const char* host = "127.0.0.1";
+    int         port = 8765;
+    int         turns = 2;
+    const char* mic = NULL;
+    const char* out = NULL;
+    const char* fsRoot = NULL;
+    const char* speechFormats = NULL;
+    int         runs = 3;
+    bool        stream = true;
+    for(int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : NULL;
+        if(!strcmp(a, "--no-stream"))            stream = false;
+        else if(!v)                              { fprintf(stderr, "%s needs a value\n", a); return 2; }
+        else if(!strcmp(a, "--host"))            host = argv[++i];
+        else if(!strcmp(a, "--port"))            port = atoi(argv[++i]);
+        else if(!strcmp(a, "--turns"))           turns = atoi(argv[++i]);
+        else if(!strcmp(a, "--mic"))             mic = argv[++i];
+        else if(!strcmp(a, "--out"))             out = argv[++i];
+        else if(!strcmp(a, "--fs"))              fsRoot = argv[++i];
+        else if(!strcmp(a, "--speech"))          speechFormats = argv[++i];
+        else if(!strcmp(a, "--runs"))            runs = max(1, atoi(argv[++i]));
+        else                                     { fprintf(stderr, "unknown option %s\n", a); return 2; }
+    }
+    if(fsRoot) hostSimSetFsRoot(fsRoot);
+    hostSimSetMicInput(mic); // silence is enough: the mock answers on the amount of audio
+    hostSimSetI2sOutput(out);
+
+    // setup() of the sketch, the endpoints pointed at the mock
+    String base = String("http://") + host + ":" + String(port);
+    asrChat = new ArduinoASRChat("mock-key", "scribe_v2");
+    gptChat = new ArduinoGPTChat("mock-key", base.c_str());
+    audio.setPinout(5, 6, 7);
+    audio.setVolume(100);
+    audio.setOutputSampleRate(44100);
+    gptChat->setSystemPrompt(SYSTEM_PROMPT);
+    gptChat->enableMemory(true);
+    gptChat->enableStreaming(stream);
+    if(speechFormats) {
+        delay(100); // Audio takes a request at millis() 0 for none
+        bool ok = speechTable(speechFormats, runs, "Hello! Nobody is home right now, can I take a message?");
+        Serial.println(ok ? "OK" : "FAILED");
+        fflush(stdout);
+        _exit(ok ? 0 : 1);
+    }
+    ArduinoGPTChat::SpeechOptions speech = gptChat->speechOptions();
+    speech.format = "wav"; // a tone from the mock, its mp3, aac and opus are silent and a turn waits for the first sound
+    gptChat->setSpeechOptions(speech);
+    asrChat->getBackend()->setEndpoint(host, port, false);
+    if(!asrChat->initINMP441Microphone(5, 4, 6)) {
+        Serial.println("microphone init failed");
+        fflush(stdout);
+        _exit(1);
+    }
+    asrChat->setAudioParams(16000, 16, 1);
+    asrChat->setSilenceDuration(1000);
+    asrChat->setMaxRecordingSeconds(20);
+    unsigned long t0 = millis();
+    if(!asrChat->connectWebSocket()) {
+        Serial.printf("cannot connect to the mock at %s:%d\n", host, port);
+        fflush(stdout);
+        _exit(1);
+    }
+    Serial.printf("connected in %lu ms\n", millis() - t0);
+
+    bool    ok = true;
+    turn_t* results = new turn_t[turns];
+    for(int i = 0; i < turns && ok; i++) {
+        ok = runTurn(i + 1, results[i]);
+        if(!ok) turns = i + 1;
+    }
+
+    Serial.println();
+    Serial.println("turn  partials  speculative  final  reply  speech  first sound  done   (ms after the end of the audio)");
+    for(int i = 0; i < turns; i++) {
+        const turn_t& t = results[i];
+        Serial.printf("%4d  %8lu  %11s  %5s  %5s  %6s  %11s  %5s\n", i + 1, t.partials, after(t, t.speculative).c_str(),
+                      after(t, t.final).c_str(), after(t, t.reply).c_str(), after(t, t.speech).c_str(),
+                      after(t, t.sound).c_str(), after(t, t.done).c_str());
+    }
+    Serial.println(ok ? "OK" : "FAILED");
+    fflush(stdout);
+    fflush(stderr);
+    _exit(ok ? 0 : 1); // the tasks of the library are still running, no static destructors under them
+}
@@ -0,0 +1,36 @@
+#!/bin/sh
+# One run of doorbell_sim against examples/Doorbell/asr_mock with a script, both sides printed, the mock's stage times
+# after the sim's. Used by ctest and the host-sim workflow.
+#
+#   run_mock.sh <doorbell_sim> <script.json> [port] [doorbell_sim options ...]
+set -u
+SIM=$1
+SCRIPT=$2
+PORT=${3:-8765}
+shift 2
+[ $# -gt 0 ] && shift
+HERE=$(cd "$(dirname "$0")" && pwd)
+MOCK="$HERE/../../../examples/Doorbell/asr_mock/asr_mock.py"
+LOG=$(mktemp)
+
+python3 -u "$MOCK" "$SCRIPT" --port "$PORT" > "$LOG" 2>&1 &
+PID=$!
+trap 'kill $PID 2>/dev/null; rm -f "$LOG"' EXIT
+i=0
+until grep -q "ASR mock on" "$LOG"; do # listening
+    i=$((i + 1))
+    if [ $i -gt 50 ] || ! kill -0 $PID 2>/dev/null; then
+        cat "$LOG"
+        echo "mock did not start"
+        exit 1
+    fi
+    sleep 0.1
+done
+
+"$SIM" --port "$PORT" --fs "$(mktemp -d)" "$@"
+STATUS=$?
+sleep 0.2
+echo
+echo "mock:"
+cat "$LOG"
+exit $STATUS
@@ -0,0 +1,157 @@
+/*
+ * aac_alloc_test.cpp
+ *
+ *  The AAC decoder on the host: an ADTS clip (AAC-LC mono 24 kHz, long, start, eight short and stop windows with
+ *  spectral data in codebook 11, upsampled by the implicit SBR) decodes without errors, and after the first 16 frames
+ *  no frame reaches the heap, every scratch buffer comes from the workspace of the decoder.
+ *
+ */
+#include <map>
+#include <vector>
+#include "Arduino.h"
+#include "aac_decoder/aac_decoder.h"
+#include "aac_decoder/libfaad/tables.h"
+
+static int s_failed = 0;
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                            \
+        if(!(cond)) {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                \
+            s_failed++;                                                                             \
+        }                                                                                           \
+    } while(0)
+
+class Bits { // MSB first, the way the bitstream is read
+
+public:
+    void put(uint32_t value, uint8_t bits) {
+        for(int i = bits - 1; i >= 0; i--) {
+            if(m_n % 8 == 0) out.push_back(0);
+            if((value >> i) & 1) out.back() |= 0x80 >> (m_n % 8);
+            m_n++;
+        }
+    }
+    std::vector<uint8_t> out;
+
+private:
+    size_t m_n = 0;
+};
+//----------------------------------------------------------------------------------------------------------------------
+struct code_t {
+    uint32_t code;
+    uint8_t  len;
+};
+static std::map<int, code_t> s_cb11; // (x << 8 | y) -> codeword, read back from the decoder's two step table
+
+static void buildCodebook() {
+    const uint8_t first = 5; // hcbN[11]
+    for(uint32_t i = 0; i < (1u << first); i++) {
+        uint8_t extra = hcb11_1[i].extra_bits;
+        for(uint32_t j = 0; j < (1u << extra); j++) {
+            const hcb_2_pair& e = hcb11_2[hcb11_1[i].offset + j];
+            int key = e.x << 8 | e.y;
+            if(!s_cb11.count(key)) s_cb11[key] = {((i << extra) | j) >> (first + extra - e.bits), e.bits};
+        }
+    }
+}
+
+static void pair(Bits& b, int x, int y) { // unsigned codebook 11, the sign bits follow the codeword
+    code_t c = s_cb11[abs(x) << 8 | abs(y)];
+    b.put(c.code, c.len);
+    if(x) b.put(x < 0, 1);
+    if(y) b.put(y < 0, 1);
+}
+
+// one raw data block: a single channel element, every band in codebook 11 with scale factor = global gain
+static std::vector<uint8_t> frame(uint8_t windowSequence, int n) {
+    const bool short8 = windowSequence == EIGHT_SHORT_SEQUENCE;
+    const uint8_t maxSfb = short8 ? 4 : 20;
+    Bits b;
+    b.put(ID_SCE, 3);
+    b.put(0, 4);                           // tag
+    b.put(140, 8);                         // global gain
+    b.put(0, 1);                           // ics reserved
+    b.put(windowSequence, 2);
+    b.put(n & 1, 1);                       // window shape, sine and KBD
+    if(short8) {
+        b.put(maxSfb, 4);
+        b.put(0x7F, 7);                    // one group of eight windows
+        b.put(11, 4);                      // section: codebook, length (3 bit escape 7)
+        b.put(maxSfb, 3);
+    }
+    else {
+        b.put(maxSfb, 6);
+        b.put(0, 1);                       // no prediction
+        b.put(11, 4);                      // section: codebook, length (5 bit escape 31)
+        b.put(maxSfb, 5);
+    }
+    for(uint8_t sfb = 0; sfb < maxSfb; sfb++) b.put(0, 1); // scale factor delta 0, codeword "0"
+    b.put(0, 3);                           // no pulse, tns, gain control
+    int coefs = short8 ? 8 * swb_offset_128_24[maxSfb] : swb_offset_1024_24[maxSfb];
+    for(int k = 0; k < coefs; k += 2) pair(b, (k + n) % 7 - 3, (k * 3 + n) % 9 - 4);
+    b.put(ID_END, 3);
+
+    std::vector<uint8_t> adts;
+    Bits h;
+    size_t len = 7 + b.out.size();
+    h.put(0xFFF, 12);
+    h.put(0, 1);                           // MPEG-4
+    h.put(0, 2);
+    h.put(1, 1);                           // no CRC
+    h.put(1, 2);                           // AAC LC
+    h.put(6, 4);                           // 24 kHz
+    h.put(0, 1);
+    h.put(1, 3);                           // mono
+    h.put(0, 4);
+    h.put(len, 13);
+    h.put(0x7FF, 11);                      // VBR
+    h.put(0, 2);                           // one raw data block
+    adts = h.out;
+    adts.insert(adts.end(), b.out.begin(), b.out.end());
+    return adts;
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void testDecode(int frames) {
+    const uint8_t windows[] = {ONLY_LONG_SEQUENCE, ONLY_LONG_SEQUENCE, LONG_START_SEQUENCE, EIGHT_SHORT_SEQUENCE,
+                               EIGHT_SHORT_SEQUENCE, LONG_STOP_SEQUENCE};
+    std::vector<std::vector<uint8_t>> clip;
+    for(int n = 0; n < frames; n++) clip.push_back(frame(windows[n % 6], n));
+
+    CHECK(AACDecoder_AllocateBuffers());
+    static short out[2048 * 2];
+    uint32_t     allocs = 0;
+    int          errors = 0, sound = 0;
+    for(int n = 0; n < frames; n++) {
+        if(n == 16) allocs = NeAACDecGetAllocCount(); // the channel and SBR state is allocated by now
+        int32_t left = clip[n].size();
+        int     err = AACDecode(clip[n].data(), &left, out);
+        if(err) {
+            if(errors++ < 3) fprintf(stderr, "frame %d: %s\n", n, AACGetErrorMessage(err));
+            continue;
+        }
+        CHECK(left == 0);
+        for(int i = 0; i < AACGetOutputSamps(); i++)
+            if(out[i]) { sound++; break; }
+    }
+    CHECK(errors == 0);
+    CHECK(sound > frames / 2);
+    CHECK(AACGetSampRate() == 48000); // the implicit SBR ran
+    uint32_t after = NeAACDecGetAllocCount() - allocs;
+    if(after) fprintf(stderr, "%u heap allocations in frames 17 to %d\n", after, frames);
+    CHECK(after == 0);
+    AACDecoder_FreeBuffers();
+}
+//----------------------------------------------------------------------------------------------------------------------
+int main() {
+    buildCodebook();
+    CHECK(s_cb11.size() == 17 * 17);
+    testDecode(120);
+    testDecode(40); // a second decoder after the first one closed
+    if(s_failed) {
+        fprintf(stderr, "%d checks failed\n", s_failed);
+        return 1;
+    }
+    printf("aac_alloc: all checks passed\n");
+    return 0;
+}
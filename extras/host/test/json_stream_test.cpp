@@ -0,0 +1,230 @@
+/*
+ * json_stream_test.cpp
+ *
+ *  JsonStream on the host: \u escapes with surrogate pairs and lone surrogates, a reply of more than 32 KB fed in
+ *  odd-sized pieces that split escapes and UTF-8 sequences, server-sent events up to "data: [DONE]", what
+ *  JsonWriter / JsonSource write reads back unchanged, and JsonWriter::cutLength() keeps UTF-8 characters whole.
+ *
+ */
+#include "Arduino.h"
+#include "json_stream/json_stream.h"
+#include <string>
+#include <vector>
+
+static int s_failed = 0;
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                            \
+        if(!(cond)) {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                \
+            s_failed++;                                                                             \
+        }                                                                                           \
+    } while(0)
+
+#define CHECK_STR(got, want)                                                                        \
+    do {                                                                                            \
+        if((got) != (want)) {                                                                       \
+            fprintf(stderr, "%s:%d: %s\n  got  (%u) %s\n  want (%u) %s\n", __FILE__, __LINE__, #got, \
+                    (unsigned)(got).size(), hex(got).c_str(), (unsigned)(want).size(), hex(want).c_str()); \
+            s_failed++;                                                                             \
+        }                                                                                           \
+    } while(0)
+
+class Collect : public Print { // what JsonStream writes, and in how many pieces
+
+public:
+    size_t write(uint8_t c) override { s += (char)c; writes++; return 1; };
+    size_t write(const uint8_t* buf, size_t size) override { s.append((const char*)buf, size); writes++; return size; };
+    std::string s;
+    size_t      writes = 0;
+};
+
+static std::string hex(const std::string& s) { // the start of a value, bytes above 0x7e as \xNN
+    std::string r;
+    for(size_t i = 0; i < s.size() && i < 80; i++) {
+        uint8_t c = s[i];
+        if(c >= 0x20 && c < 0x7f) { r += (char)c; continue; }
+        char b[5];
+        snprintf(b, sizeof(b), "\\x%02x", c);
+        r += b;
+    }
+    return s.size() > 80 ? r + "..." : r;
+}
+
+// feeds the input in pieces of the given sizes (repeated), returns what the parser wrote
+static std::string feed(JsonStream& p, const std::string& in, const std::vector<size_t>& pieces) {
+    Collect out;
+    p.setOutput(&out);
+    size_t pos = 0, k = 0;
+    while(pos < in.size()) {
+        size_t n = min(pieces[k++ % pieces.size()], in.size() - pos);
+        p.feed((const uint8_t*)in.data() + pos, n);
+        pos += n;
+    }
+    p.setOutput(NULL);
+    return out.s;
+}
+
+static std::string parse(const std::string& in, const char* path, bool sse, const std::vector<size_t>& pieces) {
+    JsonStream p(path, NULL, sse);
+    return feed(p, in, pieces);
+}
+
+static std::string content(const std::string& json) { // {"choices":[{"message":{"content":<json>}}]}
+    return "{\"id\":\"c1\",\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":" + json + "}}]}";
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void testSurrogates() {
+    const std::string FFFD = "\xEF\xBF\xBD";
+    const std::string GRIN = "\xF0\x9F\x98\x80"; // U+1F600
+    struct {
+        const char* json;
+        std::string want;
+    } cases[] = {
+        {"\"\\uD83D\\uDE00\"", GRIN},
+        {"\"a\\ud83d\\ude00b\"", "a" + GRIN + "b"},                // lower case hex
+        {"\"\\u00e9\\u20AC\\u0041\"", "\xC3\xA9\xE2\x82\xAC" "A"}, // 2, 3 bytes and ASCII
+        {"\"\\uD83D\"", FFFD},                                     // high surrogate at the end of the string
+        {"\"\\uD83Dx\"", FFFD + "x"},                              // ... before a plain character
+        {"\"\\uD83D\\n\"", FFFD + "\n"},                           // ... before another escape
+        {"\"\\uD83D\\u0041\"", FFFD + "A"},                        // ... before a \u that is no low surrogate
+        {"\"\\uD83D\\uD83D\\uDE00\"", FFFD + GRIN},                // two high ones, the second one pairs
+        {"\"\\uDE00\"", FFFD},                                     // low surrogate alone
+        {"\"\\uDE00\\uD83D\"", FFFD + FFFD},
+        {"\"\\uD83D\\uDE00\\uDE00\"", GRIN + FFFD},                // a low one after a complete pair
+        {"\"\\u0000\"", std::string(1, '\0')},
+    };
+    for(auto& c : cases) {
+        std::string json = content(c.json);
+        CHECK_STR(parse(json, "choices/0/message/content", false, {json.size()}), c.want);
+        CHECK_STR(parse(json, "choices/0/message/content", false, {1}), c.want);
+    }
+
+    // every split of a document into two pieces, the cut goes through every escape and UTF-8 sequence
+    std::string json = content("\"\\uD83D\\uDE00 \xC3\xA9\\u00e9 \xE2\x82\xAC\\\"\\\\ \xF0\x9F\x98\x80\\uDE00\"");
+    std::string want = GRIN + " \xC3\xA9\xC3\xA9 \xE2\x82\xAC\"\\ " + GRIN + FFFD;
+    for(size_t cut = 1; cut < json.size(); cut++) {
+        Collect    out;
+        JsonStream p("choices/0/message/content", &out);
+        p.feed((const uint8_t*)json.data(), cut);
+        p.feed((const uint8_t*)json.data() + cut, json.size() - cut);
+        CHECK_STR(out.s, want);
+        CHECK(p.done());
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void testLongReply() {
+    // > 32 KB of text with every kind of escape and raw UTF-8, the expected value built next to it
+    const char* raw[] = {"plain ascii, ", "\xC3\xA9t\xC3\xA9 ", "\xE2\x82\xAC", "\xE4\xBD\xA0\xE5\xA5\xBD", "\xF0\x9F\x98\x80"};
+    struct {
+        const char* json;
+        const char* text;
+    } esc[] = {{"\\n", "\n"}, {"\\\"", "\""}, {"\\\\", "\\"}, {"\\/", "/"}, {"\\t", "\t"}, {"\\r", "\r"},
+               {"\\u00e9", "\xC3\xA9"}, {"\\u20ac", "\xE2\x82\xAC"}, {"\\uD83D\\uDE00", "\xF0\x9F\x98\x80"},
+               {"\\ud83c\\udf89", "\xF0\x9F\x8E\x89"}, {"\\u0001", "\x01"}};
+    std::string json = "\"", want;
+    for(int i = 0; want.size() < 40000; i++) {
+        json += raw[i % 5];
+        want += raw[i % 5];
+        json += esc[i % 11].json;
+        want += esc[i % 11].text;
+    }
+    json += "\"";
+    CHECK(want.size() > 32 * 1024);
+
+    // the value between decoys: same key at other paths, a nested array, a long key, numbers, true, null
+    std::string doc = "{\"id\":\"chatcmpl-1\",\"content\":\"not this\",\"choices\":[{\"index\":0,\"message\":{\"content\":\"no\"}},"
+                      "{\"index\":1,\"message\":{\"role\":\"assistant\",\"a_key_longer_than_the_limit_of_the_parser\":[1,2,{\"content\":\"x\"}],"
+                      "\"content\":" + json + ",\"refusal\":null}}],\"usage\":{\"total_tokens\":12345,\"content\":\"no\",\"ok\":true}}";
+
+    const std::vector<std::vector<size_t>> pieces = {{doc.size()}, {1}, {3}, {7}, {1, 3, 5, 7, 11, 13}, {1361}, {4093, 17}};
+    for(auto& p : pieces) {
+        JsonStream parser("choices/1/message/content");
+        CHECK_STR(feed(parser, doc, p), want);
+        CHECK(parser.found());
+        CHECK(parser.done());
+        CHECK(parser.valueLength() == want.size());
+    }
+
+    // through Stream::write(), the way HTTPClient::writeToStream() feeds it
+    Collect    out;
+    JsonStream parser("choices/1/message/content", &out);
+    Stream&    s = parser;
+    for(size_t pos = 0, k = 0; pos < doc.size(); k++) {
+        size_t n = min((size_t)(k % 2 ? 1 : 509), doc.size() - pos);
+        if(n == 1) s.write((uint8_t)doc[pos]);
+        else       s.write((const uint8_t*)doc.data() + pos, n);
+        pos += n;
+    }
+    CHECK_STR(out.s, want);
+    CHECK(out.writes > want.size() / 64); // written in pieces, never the whole value at once
+
+    // the same text written by JsonWriter and read back from a JsonSource in odd pieces
+    JsonSource src([&want](JsonWriter& w) {
+        w.raw("{\"choices\":[{\"delta\":{\"content\":");
+        w.string(want.data(), want.size());
+        w.raw("}}]}");
+    });
+    std::string body;
+    char        buf[997];
+    for(size_t k = 0; src.available() > 0; k++) {
+        size_t n = src.readBytes(buf, k % 3 == 0 ? 1 : k % 3 == 1 ? 331 : sizeof(buf));
+        body.append(buf, n);
+    }
+    CHECK(body.size() == src.size());
+    CHECK_STR(parse(body, "choices/0/delta/content", false, {13}), want);
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void testSse() {
+    // a surrogate pair split over two events is two lone surrogates: each event is a document of its own
+    const char* deltas[] = {"Halo", ", sel\\u00e9mat", " sore \\uD83D", "\\uDE00", " \xE2\x82\xAC" "5", "\\n\\\"ok\\\""};
+    std::string want = "Halo, sel\xC3\xA9mat sore \xEF\xBF\xBD\xEF\xBF\xBD \xE2\x82\xAC" "5\n\"ok\"";
+
+    std::string sse = ": keep-alive\r\n\r\n"
+                      "data: {\"id\":\"c1\",\"choices\":[{\"index\":0,\"delta\":{\"role\":\"assistant\",\"content\":\"\"}}]}\r\n\r\n";
+    for(auto d : deltas) {
+        sse += "event: message\n";
+        sse += std::string("data: {\"id\":\"c1\",\"choices\":[{\"index\":0,\"delta\":{\"content\":\"") + d + "\"}}]}\n\n";
+    }
+    sse += "data: {\"id\":\"c1\",\"choices\":[{\"index\":0,\"delta\":{},\"finish_reason\":\"stop\"}]}\n\n"
+           "data:{\"choices\":[{\"delta\":{\"content\":\"!\"}}]}\n\n" // no space after "data:"
+           "data: [DONE]\n\n"
+           "data: {\"choices\":[{\"delta\":{\"content\":\"after the end\"}}]}\n\n";
+    want += "!";
+
+    const std::vector<std::vector<size_t>> pieces = {{sse.size()}, {1}, {2}, {5, 3}, {7, 1, 11}, {64}};
+    for(auto& p : pieces) {
+        JsonStream parser("choices/0/delta/content", NULL, true);
+        CHECK_STR(feed(parser, sse, p), want);
+        CHECK(parser.found());
+        CHECK(parser.done());
+    }
+
+    // "[DONE]" only counts as the whole value of a data line
+    JsonStream  parser("choices/0/delta/content", NULL, true);
+    std::string tricky = "data: {\"choices\":[{\"delta\":{\"content\":\"[DONE]\"}}]}\n\ndata: [DONE\n\ndata: {\"choices\":[{\"delta\":{\"content\":\" more\"}}]}\n\n";
+    CHECK_STR(feed(parser, tricky, {3}), std::string("[DONE] more"));
+    CHECK(!parser.done());
+    parser.feed((const uint8_t*)"data:  [DONE]\n", 14);
+    CHECK(parser.done());
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void testCut() {
+    // a text cut to a budget ends before a UTF-8 character that does not fit, never inside it
+    const char*  mixed = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"; // 1, 2, 3 and 4 bytes
+    const size_t cuts[] = {0, 1, 1, 3, 3, 3, 6, 6, 6, 6, 10, 10};
+    for(size_t max = 0; max < 12; max++) CHECK(JsonWriter::cutLength(mixed, 10, max) == cuts[max]);
+}
+//----------------------------------------------------------------------------------------------------------------------
+int main() {
+    testSurrogates();
+    testLongReply();
+    testSse();
+    testCut();
+    if(s_failed) {
+        fprintf(stderr, "%d checks failed\n", s_failed);
+        return 1;
+    }
+    printf("json_stream: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * resampler_test.cpp
+ *
+ *  Resampler on the host: THD+N of a 1 kHz sine at -6 dBFS for the rate pairs of the speech and music streams, the
+ *  time per output frame, and the end of the input: after flush() every input frame has come out (the output has
+ *  inFrames * outRate / inRate frames, the last ones not silent) and delayFrames() is 0.
+ *
+ *  The times are host times, printed for a comparison between changes, not checked. On the device Audio::getStats()
+ *  reports srcCycles.
+ *
+ */
+#include "Arduino.h"
+#include "resampler/resampler.h"
+#include <chrono>
+#include <vector>
+
+static int s_failed = 0;
+
+#define CHECK(cond)                                                                                 \
+    do {                                                                                            \
+        if(!(cond)) {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                \
+            s_failed++;                                                                             \
+        }                                                                                           \
+    } while(0)
+
+// the whole input through the resampler in blocks the way Audio::playChunk() feeds it, flush() at the end
+static std::vector<int16_t> run(Resampler& src, const std::vector<int16_t>& in, size_t chunk, double* ns) {
+    std::vector<int16_t> out;
+    std::vector<int16_t> buf(chunk * 2);
+    size_t pos = 0, frames = in.size() / 2;
+    auto   t0 = std::chrono::steady_clock::now();
+    while(true) {
+        size_t free = 0;
+        int16_t* p = src.getWritePtr(&free);
+        size_t n = min(min(src.inputFramesFor(chunk), free), frames - pos);
+        memcpy(p, in.data() + pos * 2, n * 2 * sizeof(int16_t));
+        src.framesWritten(n);
+        pos += n;
+        if(pos == frames) src.flush();
+        size_t got = src.process(buf.data(), chunk);
+        out.insert(out.end(), buf.begin(), buf.begin() + got * 2);
+        if(!got && pos == frames) break;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    if(ns) *ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (out.size() / 2);
+    return out;
+}
+
+static std::vector<int16_t> sine(uint32_t rate, double hz, double amplitude, size_t frames) {
+    std::vector<int16_t> s(frames * 2);
+    for(size_t i = 0; i < frames; i++) s[2 * i] = s[2 * i + 1] = (int16_t)lround(amplitude * sin(2 * M_PI * hz * i / rate));
+    return s;
+}
+
+// residual after the best fitting sine of that frequency, relative to it, in dB (left channel)
+static double thdN(const std::vector<int16_t>& s, uint32_t rate, double hz, size_t from, size_t to) {
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+    for(size_t i = from; i < to; i++) {
+        double a = sin(2 * M_PI * hz * i / rate), b = cos(2 * M_PI * hz * i / rate), y = s[2 * i];
+        ss += a * a; cc += b * b; sc += a * b; ys += y * a; yc += y * b;
+    }
+    double det = ss * cc - sc * sc;
+    double ka = (ys * cc - yc * sc) / det, kb = (yc * ss - ys * sc) / det;
+    double sig = 0, res = 0;
+    for(size_t i = from; i < to; i++) {
+        double fit = ka * sin(2 * M_PI * hz * i / rate) + kb * cos(2 * M_PI * hz * i / rate);
+        sig += fit * fit;
+        res += (s[2 * i] - fit) * (s[2 * i] - fit);
+    }
+    return 10 * log10(res / sig);
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void testQuality() {
+    struct {
+        uint32_t in, out;
+        double   limit; // dB
+    } pairs[] = {{24000, 44100, -70}, {24000, 48000, -70}, {22050, 44100, -70}, {16000, 48000, -70},
+                 {44100, 48000, -70}, {48000, 44100, -70}, {96000, 44100, -70}};
+    printf("     in -> out    THD+N (dB)  ns/frame\n");
+    for(auto& p : pairs) {
+        Resampler src;
+        CHECK(src.setRates(p.in, p.out));
+        std::vector<int16_t> in = sine(p.in, 1000, 16384, p.in); // one second
+        double ns = 0;
+        std::vector<int16_t> out = run(src, in, 512, &ns);
+        size_t frames = out.size() / 2;
+        double d = thdN(out, p.out, 1000, p.out / 10, frames - p.out / 10); // without the ramps at both ends
+        printf("  %5u -> %5u  %10.1f  %8.1f\n", p.in, p.out, d, ns);
+        CHECK(d < p.limit);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void testTail() {
+    // every input frame comes out: the length is right and the end of a full scale DC input is not faded to silence
+    const uint32_t rates[][2] = {{24000, 44100}, {22050, 48000}, {48000, 44100}, {44100, 44100}};
+    for(auto& r : rates) {
+        for(size_t frames : {1u, 7u, 100u, 2048u, 24000u}) {
+            Resampler src;
+            CHECK(src.setRates(r[0], r[1]));
+            std::vector<int16_t> in(frames * 2, 8000);
+            std::vector<int16_t> out;
+            if(src.isBypass()) {
+                CHECK(src.delayFrames() == 0);
+                continue;
+            }
+            out = run(src, in, 256, NULL);
+            long want = (long)((uint64_t)frames * r[1] / r[0]);
+            long got = out.size() / 2;
+            if(labs(got - want) > 1) fprintf(stderr, "%u -> %u, %u frames: %ld out, %ld expected\n", r[0], r[1], (unsigned)frames, got, want);
+            CHECK(labs(got - want) <= 1);
+            CHECK(src.delayFrames() == 0);
+            if(frames >= 100) CHECK(out[out.size() - 2 * (r[1] / r[0] + 2)] > 6000); // a frame before the end, still DC
+        }
+    }
+
+    // input after a flush() continues the stream, the zeros are part of it
+    Resampler src;
+    CHECK(src.setRates(24000, 48000));
+    std::vector<int16_t> in(200 * 2, 1000);
+    run(src, in, 64, NULL);
+    size_t   free = 0;
+    int16_t* p = src.getWritePtr(&free);
+    for(int i = 0; i < 100 * 2; i++) p[i] = 1000;
+    src.framesWritten(100);
+    CHECK(src.delayFrames() > 0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+int main() {
+    testQuality();
+    testTail();
+    if(s_failed) {
+        fprintf(stderr, "%d checks failed\n", s_failed);
+        return 1;
+    }
+    printf("resampler: all checks passed\n");
+    return 0;
+}
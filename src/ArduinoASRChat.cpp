@@ -1,20 +1,24 @@
 #include "ArduinoASRChat.h"
+#include "log_ring/log_ring.h"
 
-ArduinoASRChat::ArduinoASRChat(const char* apiKey, const char* modelId) {
-  _apiKey = apiKey;
-  _modelId = modelId;
-
-  // Allocate send buffer
+ArduinoASRChat::ArduinoASRChat(const char* apiKey, const char* modelId) : _elevenLabs(apiKey, modelId) {
+  // Allocate send and receive buffers, they are used for the whole session
   _sendBuffer = new int16_t[_sendBatchSize / 2];
+  _rxBuffer = new uint8_t[ASR_RX_SIZE + 1];
+  _lastResultText.reserve(ASR_TEXT_MAX);
+  _recognizedText.reserve(ASR_TEXT_MAX);
 }
 
 void ArduinoASRChat::setApiConfig(const char* apiKey, const char* modelId) {
-  if (apiKey != nullptr) {
-    _apiKey = apiKey;
-  }
-  if (modelId != nullptr) {
-    _modelId = modelId;
+  _elevenLabs.setConfig(apiKey, modelId);
+}
+
+void ArduinoASRChat::setBackend(AsrBackend* backend) {
+  // The next connect uses it, an open socket belongs to the old one
+  if (_connectState == CONNECT_IDLE) {
+    disconnectWebSocket();
   }
+  _backend = backend != nullptr ? backend : &_elevenLabs;
 }
 
 void ArduinoASRChat::setMicrophoneType(MicrophoneType micType) {
@@ -40,11 +44,12 @@ bool ArduinoASRChat::initPDMMicrophone(int pdmClkPin, int pdmDataPin) {
   _I2S.setPinsPdmRx(pdmClkPin, pdmDataPin);
 
   if (!_I2S.begin(I2S_MODE_PDM_RX, _sampleRate, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO)) {
-    Serial.println("PDM I2S initialization failed!");
+    LOGR_E("ASR", "PDM I2S initialization failed!");
     return false;
   }
 
-  Serial.println("PDM microphone initialized");
+  LOGR_I("ASR", "PDM microphone initialized");
+  _frontend.begin(_sampleRate, _frontendConfig);
 
   // Wait for hardware to stabilize and clear buffer
   delay(500);
@@ -60,11 +65,12 @@ bool ArduinoASRChat::initINMP441Microphone(int i2sSckPin, int i2sWsPin, int i2sS
   _I2S.setPins(i2sSckPin, i2sWsPin, -1, i2sSdPin);
 
   if (!_I2S.begin(I2S_MODE_STD, _sampleRate, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO, I2S_STD_SLOT_LEFT)) {
-    Serial.println("INMP441 I2S initialization failed!");
+    LOGR_E("ASR", "INMP441 I2S initialization failed!");
     return false;
   }
 
-  Serial.println("INMP441 microphone initialized");
+  LOGR_I("ASR", "INMP441 microphone initialized");
+  _frontend.begin(_sampleRate, _frontendConfig);
 
   // Wait for hardware to stabilize and clear buffer
   delay(500);
@@ -89,41 +95,50 @@ String ArduinoASRChat::generateWebSocketKey() {
 }
 
 bool ArduinoASRChat::connectWebSocket() {
-  Serial.println("Connecting to ElevenLabs WebSocket...");
+  LOGR_I("ASR", "Connecting to %s WebSocket (%s:%u)...", _backend->name(), _backend->host(), _backend->port());
 
-  _client.setInsecure();
+  // TLS for the providers, plain ws:// for a local stand-in
+  if (_backend->tls()) {
+    _client.setInsecure();
+    _conn = &_client;
+  } else {
+    _conn = &_plainClient;
+  }
 
-  if (!_client.connect(_wsHost, _wsPort)) {
-    Serial.println("SSL connection failed");
+  if (!_conn->connect(_backend->host(), _backend->port())) {
+    LOGR_E("ASR", "%s connection failed", _backend->tls() ? "SSL" : "TCP");
     return false;
   }
 
   // Disable Nagle algorithm for immediate send
-  _client.setNoDelay(true);
-
-  // Construct Path with Model ID (defaulting to scribe_v2 if not set)
-  String modelParam = (_modelId != nullptr && strlen(_modelId) > 0) ? _modelId : "scribe_v2";
-  String fullPath = String(_wsPath) + "?model_id=" + modelParam;
+  if (_backend->tls()) {
+    _client.setNoDelay(true);
+  } else {
+    _plainClient.setNoDelay(true);
+  }
 
-  // Generate WebSocket Key and send handshake request
+  // Generate WebSocket Key and send handshake request, path and auth headers from the backend
   String ws_key = generateWebSocketKey();
-  String request = String("GET ") + fullPath + " HTTP/1.1\r\n";
-  request += String("Host: ") + _wsHost + "\r\n";
-  request += "Upgrade: websocket\r\n";
-  request += "Connection: Upgrade\r\n";
-  request += "Sec-WebSocket-Key: " + ws_key + "\r\n";
-  request += "Sec-WebSocket-Version: 13\r\n";
-  request += String("xi-api-key: ") + _apiKey + "\r\n"; // ElevenLabs Auth Header
-  request += "\r\n";
-
-  _client.print(request);
+  StreamString request;
+  request.print("GET ");
+  _backend->writePath(request);
+  request.print(" HTTP/1.1\r\n");
+  request.print(String("Host: ") + _backend->host() + "\r\n");
+  request.print("Upgrade: websocket\r\n");
+  request.print("Connection: Upgrade\r\n");
+  request.print("Sec-WebSocket-Key: " + ws_key + "\r\n");
+  request.print("Sec-WebSocket-Version: 13\r\n");
+  _backend->writeHeaders(request);
+  request.print("\r\n");
+
+  _conn->print(request);
 
   // Read response
   unsigned long timeout = millis();
-  while (_client.connected() && !_client.available()) {
+  while (_conn->connected() && !_conn->available()) {
     if (millis() - timeout > 5000) {
-      Serial.println("Response timeout");
-      _client.stop();
+      LOGR_E("ASR", "Response timeout");
+      _conn->stop();
       return false;
     }
     delay(10);
@@ -131,8 +146,8 @@ bool ArduinoASRChat::connectWebSocket() {
 
   String response = "";
   bool headers_complete = false;
-  while (_client.available() && !headers_complete) {
-    String line = _client.readStringUntil('\n');
+  while (_conn->available() && !headers_complete) {
+    String line = _conn->readStringUntil('\n');
     response += line + "\n";
     if (line == "\r" || line.length() == 0) {
       headers_complete = true;
@@ -141,45 +156,51 @@ bool ArduinoASRChat::connectWebSocket() {
 
   // Check response
   if (response.indexOf("101") >= 0 && response.indexOf("Switching Protocols") >= 0) {
-    Serial.println("WebSocket connected to ElevenLabs");
+    LOGR_I("ASR", "WebSocket connected to %s", _backend->name());
+    resetReceiver();
     _wsConnected = true;
     return true;
   } else {
-    Serial.println("WebSocket handshake failed");
-    Serial.println(response);
-    _client.stop();
+    LOGR_E("ASR", "WebSocket handshake failed: %s", response.c_str());
+    _conn->stop();
     return false;
   }
 }
 
 void ArduinoASRChat::disconnectWebSocket() {
   if (_wsConnected) {
-    _client.stop();
+    _conn->stop();
     _wsConnected = false;
-    Serial.println("WebSocket disconnected");
+    LOGR_I("ASR", "WebSocket disconnected");
   }
 }
 
 bool ArduinoASRChat::isWebSocketConnected() {
-  return _wsConnected && _client.connected();
+  return _wsConnected && _conn->connected();
 }
 
 bool ArduinoASRChat::startRecording() {
-  if (!_wsConnected) {
-    Serial.println("WebSocket not connected!");
-    if (!connectWebSocket()) {
-        return false;
-    }
-  }
-
   if (_isRecording) {
-    Serial.println("Already recording!");
+    LOGR_W("ASR", "Already recording!");
     return false;
   }
 
-  Serial.println("\n========================================");
-  Serial.println("ElevenLabs Recording started...");
-  Serial.println("========================================");
+  if (_connectState != CONNECT_IDLE) {
+    // a connect is running, this turn waits for it
+  } else if (!isWebSocketConnected()) {
+    LOGR_W("ASR", "WebSocket not connected!");
+    if (_reuseSession) {
+      if (!startConnect()) {
+        return false;
+      }
+    } else if (!connectWebSocket()) {
+      return false;
+    }
+  } else if (_stats.turns > 0) {
+    _stats.reused++;
+  }
+
+  LOGR_I("ASR", "%s Recording started...", _backend->name());
 
   _isRecording = true;
   _shouldStop = false;
@@ -191,10 +212,22 @@ bool ArduinoASRChat::startRecording() {
   _recordingStartTime = millis();
   _sendBufferPos = 0;
   _sameResultCount = 0;
+  _partialChangeTime = 0;
   _lastDotTime = millis();
-
-  // Send initial configuration frame
-  sendStartConfig();
+  _carryText = "";
+  _capturedSamples = 0;
+  _backlogLen = 0;
+  _replayPos = 0;
+  _backlogDropped = 0;
+  _stats.turns++;
+
+  // Send initial configuration frame, or buffer the audio until the socket is up
+  if (_connectState == CONNECT_IDLE) {
+    sendStartConfig();
+  } else {
+    _startPending = true;
+    LOGR_I("ASR", "Buffering audio until connected");
+  }
   
   return true;
 }
@@ -206,15 +239,29 @@ void ArduinoASRChat::stopRecording() {
 
   // Send remaining buffer
   if (_sendBufferPos > 0) {
-    sendAudioChunk((uint8_t*)_sendBuffer, _sendBufferPos * 2);
+    archiveSamples(_sendBuffer, _sendBufferPos);
+    queueAudio(_sendBuffer, _sendBufferPos);
     _sendBufferPos = 0;
   }
 
-  Serial.println("\n========================================");
-  Serial.println("Recording stopped");
-  Serial.print("Final result: ");
-  Serial.println(_lastResultText);
-  Serial.println("========================================\n");
+  bool online = _connectState == CONNECT_IDLE && _wsConnected;
+  if (online) {
+    replayBacklog(-1);
+  } else {
+    _backlogDropped += _backlogLen - _replayPos;  // stopped before the socket came up
+    _backlogLen = 0;
+    _replayPos = 0;
+    _startPending = false;
+  }
+
+  // Loss of this turn: samples due from the recording time, minus what was read and sent
+  size_t due = (uint64_t)(millis() - _recordingStartTime) * _sampleRate / 1000;
+  size_t lost = (due > _capturedSamples ? due - _capturedSamples : 0) + _backlogDropped;
+  _stats.lostMs += lost * 1000 / _sampleRate;
+
+  LOGR_I("ASR", "Recording stopped, final result: %s", _lastResultText.c_str());
+  LOGR_I("ASR", "Turn audio: %u ms read, %u ms lost", (unsigned)(_capturedSamples * 1000 / _sampleRate),
+         (unsigned)(lost * 1000 / _sampleRate));
 
   _isRecording = false;
   _shouldStop = true;
@@ -222,15 +269,19 @@ void ArduinoASRChat::stopRecording() {
   _hasNewResult = true;
 
   // Send End of Stream JSON
-  sendEndMarker();
+  if (online) {
+    sendEndMarker();
+  }
 
   // Trigger callback if set
   if (_resultCallback != nullptr && _recognizedText.length() > 0) {
     _resultCallback(_recognizedText);
   }
   
-  // Clean disconnect after session
-  disconnectWebSocket();
+  // Clean disconnect after session, unless the next turn reuses the socket
+  if (!_reuseSession && _connectState == CONNECT_IDLE) {
+    disconnectWebSocket();
+  }
 }
 
 bool ArduinoASRChat::isRecording() {
@@ -238,27 +289,49 @@ bool ArduinoASRChat::isRecording() {
 }
 
 void ArduinoASRChat::loop() {
+  if (!_isRecording) {
+    captureIdle();
+  }
+
+  // Background connect: the mic audio goes to the backlog meanwhile
+  if (_connectState == CONNECT_RUNNING) {
+    if (_isRecording && !_shouldStop) {
+      processAudioSending();
+      checkRecordingTimeout();
+    }
+    return;
+  }
+  if (_connectState != CONNECT_IDLE) {
+    finishConnect();
+  }
+
   if (!_wsConnected) {
     return;
   }
 
   // Check connection status
-  if (!_client.connected()) {
-    Serial.println("Connection lost");
+  if (!_conn->connected()) {
+    LOGR_W("ASR", "Connection lost");
     _wsConnected = false;
+    if (_isRecording && _reuseSession && startConnect()) {
+      _carryText = _lastResultText;  // the new socket only knows the audio from now on
+      _startPending = true;
+      return;
+    }
     _isRecording = false;
     return;
   }
 
   // Process audio sending during recording
   if (_isRecording && !_shouldStop) {
+    replayBacklog(4);  // a few chunks per call, the mic is read in between
     processAudioSending();
     checkRecordingTimeout();
     checkSilence();
   }
 
   // Process received data
-  if (_client.available()) {
+  if (_conn->available()) {
      handleWebSocketData();
   }
 }
@@ -266,45 +339,261 @@ void ArduinoASRChat::loop() {
 void ArduinoASRChat::processAudioSending() {
   // Print progress dot every second
   if (millis() - _lastDotTime > 1000) {
-    Serial.print(".");
+    logRing.text(LogRing::LVL_DEBUG, "ASR", ".");
     _lastDotTime = millis();
   }
 
-  // Read audio samples in a tight loop to keep up with I2S data rate
+  // Read audio samples in a tight loop to keep up with I2S data rate, the front-end runs on what was read
+  size_t start = _sendBufferPos;
   for (int i = 0; i < _samplesPerRead; i++) {
     if (!_I2S.available()) {
       break;  // No more data available
     }
 
     int sample = _I2S.read();
+    if (sample == -1) {
+      break;  // read failed, a 16 bit sample is 0..65535 here, 0 and 1 are valid
+    }
+    _capturedSamples++;
+    _sendBuffer[_sendBufferPos++] = (int16_t)sample;
+
+    // Buffer full, send batch immediately
+    if (_sendBufferPos >= _sendBatchSize / 2) {
+      filterSamples(_sendBuffer + start, _sendBufferPos - start);
+      archiveSamples(_sendBuffer, _sendBufferPos);
+      queueAudio(_sendBuffer, _sendBufferPos);
+      _sendBufferPos = 0;
+      start = 0;
+    }
+  }
+  filterSamples(_sendBuffer + start, _sendBufferPos - start);
 
-    // Filter invalid data
-    if (sample != 0 && sample != -1 && sample != 1) {
-      _sendBuffer[_sendBufferPos++] = (int16_t)sample;
+  yield();
+}
 
-      // Buffer full, send batch immediately
-      if (_sendBufferPos >= _sendBatchSize / 2) {
-        sendAudioChunk((uint8_t*)_sendBuffer, _sendBufferPos * 2);
-        _sendBufferPos = 0;
-      }
+void ArduinoASRChat::setSessionReuse(bool enable, int backlogSeconds) {
+  _reuseSession = enable;
+  if (backlogSeconds != _backlogSeconds && !_isRecording) {
+    free(_backlog);  // allocated again with the next backlog
+    _backlog = nullptr;
+    _backlogSize = 0;
+  }
+  _backlogSeconds = backlogSeconds;
+}
+
+void ArduinoASRChat::getAudioStats(AudioStats* stats, bool reset) {
+  if (stats != nullptr) {
+    *stats = _stats;
+  }
+  if (reset) {
+    _stats = {};
+  }
+}
+
+bool ArduinoASRChat::startConnect() {
+  _conn->stop();  // stale socket, if any
+  _wsConnected = false;
+  _connectStart = millis();
+  _connectState = CONNECT_RUNNING;
+  if (xTaskCreatePinnedToCore(_connectTask, "ASRConnect", 8192, this, 1, NULL, 0) != pdPASS) {
+    _connectState = CONNECT_IDLE;
+    LOGR_E("ASR", "Connect task not created");
+    return false;
+  }
+  _stats.connects++;
+  return true;
+}
+
+void ArduinoASRChat::_connectTask(void* param) {
+  ArduinoASRChat* asr = (ArduinoASRChat*)param;
+  asr->_connectState = asr->connectWebSocket() ? CONNECT_OK : CONNECT_FAILED;
+  vTaskDelete(NULL);
+}
+
+void ArduinoASRChat::finishConnect() {
+  bool ok = _connectState == CONNECT_OK;
+  _connectState = CONNECT_IDLE;
+  _stats.lastConnectMs = millis() - _connectStart;
+  size_t buffered = _backlogLen - _replayPos;
+
+  if (ok) {
+    LOGR_I("ASR", "Connected in %lu ms, %u ms of audio buffered", (unsigned long)_stats.lastConnectMs,
+           (unsigned)(buffered * 1000 / _sampleRate));
+    if (_isRecording && _startPending) {
+      sendStartConfig();  // the backlog follows from loop()
     }
+    _startPending = false;
+    return;
   }
 
-  yield();
+  LOGR_E("ASR", "Connect failed after %lu ms", (unsigned long)_stats.lastConnectMs);
+  if (_isRecording) {
+    // End the turn with what was recognized before, or as a turn without speech
+    bool speech = _hasSpeech;
+    stopRecording();
+    if (!speech && _timeoutNoSpeechCallback != nullptr) {
+      _timeoutNoSpeechCallback();
+    }
+  }
+}
+
+void ArduinoASRChat::queueAudio(int16_t* samples, size_t n) {
+  // Straight out while the socket is up and nothing waits before it, else behind the backlog
+  if (_connectState == CONNECT_IDLE && _wsConnected && _backlogLen == 0) {
+    sendAudioChunk(samples, n);
+    return;
+  }
+
+  if (_backlog == nullptr) {
+    _backlogSize = (size_t)_sampleRate * _backlogSeconds;
+    size_t bytes = _backlogSize * sizeof(int16_t);
+    _backlog = (int16_t*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    if (_backlog == nullptr) {
+      LOGR_E("ASR", "No memory for %d s backlog", _backlogSeconds);
+      _backlogSize = 0;
+    }
+  }
+
+  // Full: the newest audio is dropped, the start of the utterance matters more
+  size_t k = min(n, _backlogSize - _backlogLen);
+  if (k > 0) {
+    memcpy(_backlog + _backlogLen, samples, k * sizeof(int16_t));
+  }
+  _backlogLen += k;
+  _backlogDropped += n - k;
+}
+
+void ArduinoASRChat::replayBacklog(int maxChunks) {
+  while (_replayPos < _backlogLen && maxChunks-- != 0) {
+    size_t n = min(_backlogLen - _replayPos, (size_t)_sendBatchSize / 2);
+    sendAudioChunk(_backlog + _replayPos, n);
+    _replayPos += n;
+    _stats.replayedMs += n * 1000 / _sampleRate;
+  }
+  if (_replayPos == _backlogLen) {
+    _replayPos = 0;
+    _backlogLen = 0;
+  }
+}
+
+void ArduinoASRChat::captureIdle() {
+  // Only with an archive: read what the mic DMA has filled anyway, the last seconds become the pre-roll
+  if (_archive == nullptr) {
+    return;
+  }
+
+  int16_t samples[128];
+  int n = 0;
+  for (int i = 0; i < _samplesPerRead && _I2S.available(); i++) {
+    int sample = _I2S.read();
+    if (sample == -1) {
+      break;
+    }
+    samples[n++] = (int16_t)sample;
+    if (n == 128) {
+      filterSamples(samples, n);
+      archiveSamples(samples, n);
+      n = 0;
+    }
+  }
+  filterSamples(samples, n);
+  archiveSamples(samples, n);
+}
+
+void ArduinoASRChat::setFrontend(bool enable, const MicFrontend::config_t& cfg) {
+  _frontendEnabled = enable;
+  _frontendConfig = cfg;
+  _frontend.begin(_sampleRate, _frontendConfig);
+}
+
+void ArduinoASRChat::getFrontendStats(MicFrontend::stats_t* stats, bool reset) {
+  _frontend.getStats(stats, reset);
+}
+
+void ArduinoASRChat::filterSamples(int16_t* samples, size_t n) {
+  // In place, the archive and the backlog get what the recognizer gets
+  if (_frontendEnabled && n > 0) {
+    _frontend.process(samples, n);
+  }
+}
+
+void ArduinoASRChat::archiveSamples(const int16_t* samples, size_t n) {
+  if (_archive == nullptr || n == 0) {
+    return;
+  }
+
+  // Copy only, the recorder task encodes and writes the file
+  if (_archiveSession) {
+    _archive->pushMono(samples, n, _sampleRate);
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    _preRoll[_preRollPos++ % _preRollSize] = samples[i];
+  }
+}
+
+bool ArduinoASRChat::setArchive(PcmRecorder* recorder, int preRollMs) {
+  endArchiveSession();
+  free(_preRoll);
+  _preRoll = nullptr;
+  _preRollPos = 0;
+  _archive = nullptr;
+  if (recorder == nullptr) {
+    return true;
+  }
+
+  _preRollSize = max((size_t)_sampleRate * preRollMs / 1000, (size_t)128);
+  size_t bytes = _preRollSize * sizeof(int16_t);
+  _preRoll = (int16_t*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+  if (_preRoll == nullptr) {
+    LOGR_E("ASR", "No memory for %u ms pre-roll", preRollMs);
+    return false;
+  }
+  _archive = recorder;
+  return true;
+}
+
+bool ArduinoASRChat::beginArchiveSession(uint32_t id) {
+  if (_archive == nullptr) {
+    return false;
+  }
+  endArchiveSession();
+  if (!_archive->beginSession(id)) {
+    LOGR_W("ASR", "Archive queue full, session %lu not recorded", (unsigned long)id);
+    return false;
+  }
+
+  // Oldest first: the pre-roll is the start of the session file
+  size_t n = min(_preRollPos, _preRollSize);
+  size_t start = (_preRollPos - n) % _preRollSize;
+  size_t first = min(n, _preRollSize - start);
+  _archive->pushMono(_preRoll + start, first, _sampleRate);
+  _archive->pushMono(_preRoll, n - first, _sampleRate);
+  _archiveSession = true;
+  LOGR_I("ASR", "Archive session %lu, %u ms pre-roll", (unsigned long)id, (unsigned)(n * 1000 / _sampleRate));
+  return true;
+}
+
+void ArduinoASRChat::endArchiveSession() {
+  if (!_archiveSession) {
+    return;
+  }
+  _archiveSession = false;
+  _archive->endSession();
 }
 
 void ArduinoASRChat::checkRecordingTimeout() {
   // Check max duration
-  if (millis() - _recordingStartTime > _maxSeconds * 1000) {
-    Serial.println("\nMax duration reached");
+  if (millis() - _recordingStartTime > (unsigned long)_maxSeconds * 1000) {
+    LOGR_I("ASR", "Max duration reached");
 
     // If no speech detected and callback is set, trigger timeout callback
     if (!_hasSpeech && _timeoutNoSpeechCallback != nullptr) {
-      Serial.println("No speech detected during recording, exiting continuous mode");
+      LOGR_I("ASR", "No speech detected during recording, exiting continuous mode");
       stopRecording();
       _timeoutNoSpeechCallback();
     } else {
-      Serial.println("Stopping recording");
+      LOGR_I("ASR", "Stopping recording");
       stopRecording();
     }
   }
@@ -315,7 +604,7 @@ void ArduinoASRChat::checkSilence() {
   if (_hasSpeech && _lastSpeechTime > 0) {
     unsigned long silence = millis() - _lastSpeechTime;
     if (silence >= _silenceDuration) {
-      Serial.printf("\nSilence detected (%.1fs), stopping\n", silence / 1000.0);
+      LOGR_I("ASR", "Silence detected (%.1fs), stopping", silence / 1000.0);
       stopRecording();
     }
   }
@@ -333,6 +622,22 @@ void ArduinoASRChat::clearResult() {
   _hasNewResult = false;
 }
 
+String ArduinoASRChat::getPartialText() {
+  return _isRecording ? _lastResultText : String();
+}
+
+bool ArduinoASRChat::isPartialStable() {
+  if (!_isRecording || _shouldStop || _lastResultText.length() == 0) {
+    return false;
+  }
+  return _sameResultCount >= _stableRepeats || millis() - _partialChangeTime >= _stableHoldMs;
+}
+
+void ArduinoASRChat::setPartialStability(int repeats, unsigned long holdMs) {
+  _stableRepeats = repeats;
+  _stableHoldMs = holdMs;
+}
+
 void ArduinoASRChat::setResultCallback(ResultCallback callback) {
   _resultCallback = callback;
 }
@@ -342,54 +647,33 @@ void ArduinoASRChat::setTimeoutNoSpeechCallback(TimeoutNoSpeechCallback callback
 }
 
 void ArduinoASRChat::sendStartConfig() {
-    StaticJsonDocument<256> doc;
-    doc["type"] = "start";
-    
-    String json_str;
-    serializeJson(doc, json_str);
-    // Send as Text Frame (0x01)
-    sendWebSocketFrame((uint8_t*)json_str.c_str(), json_str.length(), 0x01);
+  _backend->start(*this, _sampleRate);
 }
 
-void ArduinoASRChat::sendAudioChunk(uint8_t* data, size_t len) {
-  // 1. Encode Audio to Base64
-  size_t output_len;
-  size_t base64_len = ((len + 2) / 3) * 4 + 1; // Approximation
-  unsigned char* base64_output = new unsigned char[base64_len];
-  
-  mbedtls_base64_encode(base64_output, base64_len, &output_len, data, len);
-  base64_output[output_len] = 0; // Null terminate
-
-  // 2. Wrap in JSON
-  // Standard ElevenLabs pattern: {"audio_event": "audio_chunk", "audio_base_64": "..."}
-  // Using manual string building to save JSON overhead in critical loop
-  String json_payload = "{\"audio_event\":\"audio_chunk\",\"audio_base_64\":\"";
-  json_payload += (char*)base64_output;
-  json_payload += "\"}";
-
-  // 3. Send as Text Frame
-  sendWebSocketFrame((uint8_t*)json_payload.c_str(), json_payload.length(), 0x01); // 0x01 = Text Frame
-
-  delete[] base64_output;
+void ArduinoASRChat::sendAudioChunk(const int16_t* samples, size_t n) {
+  // The backend encodes (base64 JSON, binary packet) into its own buffer, nothing is allocated per chunk
+  _backend->audio(*this, samples, n);
 }
 
 void ArduinoASRChat::sendEndMarker() {
-  // Send End of Stream JSON (empty chunk)
-  String eos = "{\"audio_event\":\"audio_chunk\",\"audio_base_64\":\"\"}"; 
-  sendWebSocketFrame((uint8_t*)eos.c_str(), eos.length(), 0x01);
-  Serial.println("End marker sent");
+  _backend->end(*this);
+  LOGR_D("ASR", "End marker sent");
+}
+
+void ArduinoASRChat::sendFrame(uint8_t opcode, uint8_t* data, size_t len) {
+  sendWebSocketFrame(data, len, opcode);
 }
 
-void ArduinoASRChat::sendPong() {
-  uint8_t pong_data[1] = {0};
-  sendWebSocketFrame(pong_data, 0, 0x0A);
+void ArduinoASRChat::sendPong(uint8_t* data, size_t len) {
+  // The payload of the ping goes back
+  sendWebSocketFrame(data, len, 0x0A);
 }
 
 void ArduinoASRChat::sendWebSocketFrame(uint8_t* data, size_t len, uint8_t opcode) {
-  if (!_wsConnected || !_client.connected()) return;
+  if (!_wsConnected || !_conn->connected()) return;
 
   // Build WebSocket frame header
-  uint8_t header[10];
+  uint8_t header[14];
   int header_len = 2;
 
   header[0] = 0x80 | opcode; // FIN bit set
@@ -420,115 +704,193 @@ void ArduinoASRChat::sendWebSocketFrame(uint8_t* data, size_t len, uint8_t opcod
   header_len += 4;
 
   // Send frame header
-  _client.write(header, header_len);
+  _conn->write(header, header_len);
 
   // Mask data and send
   for (size_t i = 0; i < len; i++) {
     data[i] ^= mask_key[i % 4];
   }
-  _client.write(data, len);
+  _conn->write(data, len);
+}
+
+void ArduinoASRChat::resetReceiver() {
+  _rxLen = 0;
+  _rxOverflow = false;
+  _rxMsgOpcode = 0;
+  _rxHeaderLen = 0;
+  _rxHeaderNeed = 2;
+  _rxInPayload = false;
+  _rxControlLen = 0;
 }
 
 void ArduinoASRChat::handleWebSocketData() {
-  // Read WebSocket frame
-  uint8_t header[2];
-  if (_client.readBytes(header, 2) != 2) {
-    return;
+  // Takes what the socket has and returns, a frame may end in a later call
+  uint8_t skip[64];
+  for (int reads = 0; reads < 8 && _wsConnected && _conn->available() > 0; reads++) {
+    if (!_rxInPayload) {
+      int n = _conn->read(_rxHeader + _rxHeaderLen, _rxHeaderNeed - _rxHeaderLen);
+      if (n <= 0) {
+        return;
+      }
+      _rxHeaderLen += n;
+      if (_rxHeaderLen == _rxHeaderNeed && parseFrameHeader() && _rxLeft == 0) {
+        finishFrame();
+      }
+      continue;
+    }
+
+    // Payload: control frames to their own buffer, data to the message, what does not fit is read and dropped
+    bool control = _rxOpcode & 0x08;
+    uint8_t* dst = control ? _rxControl + _rxControlLen : _rxBuffer + _rxLen;
+    size_t room = control ? sizeof(_rxControl) - _rxControlLen : (_rxOverflow ? 0 : ASR_RX_SIZE - _rxLen);
+    if (room == 0) {
+      dst = skip;
+      room = sizeof(skip);
+      _rxOverflow |= !control;
+    }
+    int n = _conn->read(dst, (size_t)min(_rxLeft, (uint64_t)room));
+    if (n <= 0) {
+      return;
+    }
+    if (_rxMasked) {
+      for (int i = 0; i < n; i++) {
+        dst[i] ^= _rxMask[(_rxPayloadPos + i) & 3];
+      }
+    }
+    _rxPayloadPos += n;
+    _rxLeft -= n;
+    if (dst == _rxControl + _rxControlLen) {
+      _rxControlLen += n;
+    } else if (dst == _rxBuffer + _rxLen) {
+      _rxLen += n;
+    }
+    if (_rxLeft == 0) {
+      finishFrame();
+    }
   }
+}
 
-  bool fin = header[0] & 0x80;
-  uint8_t opcode = header[0] & 0x0F;
-  bool masked = header[1] & 0x80;
-  uint64_t payload_len = header[1] & 0x7F;
-
-  // Handle extended length
-  if (payload_len == 126) {
-    uint8_t len_bytes[2];
-    _client.readBytes(len_bytes, 2);
-    payload_len = (len_bytes[0] << 8) | len_bytes[1];
-  } else if (payload_len == 127) {
-    uint8_t len_bytes[8];
-    _client.readBytes(len_bytes, 8);
-    payload_len = 0;
+bool ArduinoASRChat::parseFrameHeader() {
+  // 2 bytes, then 2 or 8 bytes of length and the mask key if set; false: more header bytes to come
+  uint8_t lenCode = _rxHeader[1] & 0x7F;
+  bool masked = _rxHeader[1] & 0x80;
+  uint8_t need = 2 + (lenCode == 126 ? 2 : lenCode == 127 ? 8 : 0) + (masked ? 4 : 0);
+  if (_rxHeaderLen < need) {
+    _rxHeaderNeed = need;
+    return false;
+  }
+
+  _rxFin = _rxHeader[0] & 0x80;
+  _rxOpcode = _rxHeader[0] & 0x0F;
+  _rxMasked = masked;
+  uint8_t pos = 2;
+  _rxLeft = lenCode;
+  if (lenCode == 126) {
+    _rxLeft = (_rxHeader[2] << 8) | _rxHeader[3];
+    pos = 4;
+  } else if (lenCode == 127) {
+    _rxLeft = 0;
     for (int i = 0; i < 8; i++) {
-      payload_len = (payload_len << 8) | len_bytes[i];
+      _rxLeft = (_rxLeft << 8) | _rxHeader[2 + i];
     }
+    pos = 10;
   }
-
-  // Read mask key
-  uint8_t mask_key[4] = {0};
   if (masked) {
-    _client.readBytes(mask_key, 4);
+    memcpy(_rxMask, _rxHeader + pos, 4);
   }
 
-  // Read payload
-  if (payload_len > 0 && payload_len < 100000) {
-    uint8_t* payload = new uint8_t[payload_len + 1];
-    size_t bytes_read = _client.readBytes(payload, payload_len);
-
-    if (bytes_read == payload_len) {
-      payload[payload_len] = 0; // Null terminate
-      
-      // Unmask if needed
-      if (masked) {
-        for (size_t i = 0; i < payload_len; i++) {
-          payload[i] ^= mask_key[i % 4];
-        }
-      }
+  _rxPayloadPos = 0;
+  _rxHeaderLen = 0;
+  _rxHeaderNeed = 2;
+  _rxInPayload = true;
+  if (_rxOpcode & 0x08) {
+    _rxControlLen = 0;
+  } else if (_rxOpcode != 0x00) {
+    // First frame of a message, continuations (0x00) are appended
+    _rxMsgOpcode = _rxOpcode;
+    _rxLen = 0;
+    _rxOverflow = false;
+  }
+  return true;
+}
 
-      // Handle Text Frames (JSON)
-      if (opcode == 0x01) { 
-        parseResponse(payload, payload_len);
-      } else if (opcode == 0x08) {
-        Serial.println("Server closed connection");
-        _wsConnected = false;
-        _client.stop();
-      } else if (opcode == 0x09) {
-        sendPong();
-      }
-    }
+void ArduinoASRChat::finishFrame() {
+  _rxInPayload = false;
+  if (_rxOpcode == 0x08) {
+    LOGR_W("ASR", "Server closed connection");
+    _wsConnected = false;
+    _conn->stop();
+    return;
+  } else if (_rxOpcode == 0x09) {
+    sendPong(_rxControl, _rxControlLen);
+    return;
+  } else if (_rxOpcode & 0x08) {
+    return;  // pong
+  }
 
-    delete[] payload;
+  if (!_rxFin) {
+    return;  // continuation follows
   }
+  if (_rxOverflow) {
+    LOGR_W("ASR", "Message over %u bytes dropped", (unsigned)ASR_RX_SIZE);
+  } else if (_rxMsgOpcode == 0x01 || _rxMsgOpcode == 0x02) {
+    // Text (JSON) or binary messages, the backend knows what it gets
+    _rxBuffer[_rxLen] = 0;
+    parseResponse(_rxBuffer, _rxLen, _rxMsgOpcode == 0x02);
+  }
+  _rxMsgOpcode = 0;
+  _rxLen = 0;
+  _rxOverflow = false;
 }
 
-void ArduinoASRChat::parseResponse(uint8_t* data, size_t len) {
-  StaticJsonDocument<2048> doc;
-  DeserializationError error = deserializeJson(doc, (char*)data);
-
-  if (error) {
-    Serial.print(F("deserializeJson() failed: "));
-    Serial.println(error.f_str());
+void ArduinoASRChat::parseResponse(uint8_t* data, size_t len, bool binary) {
+  // Late results of a finished turn on a reused socket belong to nobody
+  if (!_isRecording) {
     return;
   }
 
-  // Handle ElevenLabs Response Structure
-  if (doc.containsKey("text")) {
-    const char* text = doc["text"];
-    String current_text = String(text);
-    // ElevenLabs sends "is_final" boolean
-    bool is_final = doc["is_final"] | false; 
+  // The backend picks the text out of the message in place: no document, no heap.
+  // The text goes behind the transcript from before a lost connection, if there is one.
+  size_t pre = _carryText.length() > 0 ? min((size_t)_carryText.length() + 1, sizeof(_rxText) / 2) : 0;
+  bool is_final = false;
+  if (_backend->parse(data, len, binary, _rxText + pre, sizeof(_rxText) - pre, &is_final)) {
+    const char* text = _rxText + pre;
+
+    if (text[0] != '\0' && strcmp(text, " ") != 0) {
+      if (pre > 0) {
+        memcpy(_rxText, _carryText.c_str(), pre - 1);
+        _rxText[pre - 1] = ' ';
+        text = _rxText;
+      }
 
-    if (current_text.length() > 0 && current_text != " ") {
       if (!_hasSpeech) {
         _hasSpeech = true;
-        Serial.println("\nSpeech detected...");
+        LOGR_I("ASR", "Speech detected...");
       }
 
       // Update last speech time
       _lastSpeechTime = millis();
-      _lastResultText = current_text;
+
+      // Stability of the partial: how often the same text came in a row
+      if (_lastResultText == text) {
+        _sameResultCount++;
+      } else {
+        _sameResultCount = 0;
+        _partialChangeTime = millis();
+        _partialRevision++;
+      }
+      _lastResultText = text;  // within the reserved capacity
       
-      Serial.printf("Recognizing: %s\n", current_text.c_str());
+      LOGR_D("ASR", "Recognizing: %s", text);
 
-      // If ElevenLabs says it's final, we trust it
+      // If the provider says it's final, we trust it
       if (is_final) {
-          Serial.printf("Final Phrase: %s\n", current_text.c_str());
-          _recognizedText = current_text; 
+          LOGR_I("ASR", "Final Phrase: %s", text);
+          _recognizedText = text; 
           _hasNewResult = true;
           
           if (_isRecording && !_shouldStop) {
-             Serial.println("Received final result, stopping.");
+             LOGR_I("ASR", "Received final result, stopping.");
              stopRecording();
           }
       }
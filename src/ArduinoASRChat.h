@@ -7,6 +7,11 @@
 #include <ESP_I2S.h>
 #include <mbedtls/base64.h>
 #include <mbedtls/sha1.h>
+#include <atomic>
+#include <StreamString.h>
+#include "asr_backend/asr_backend.h"
+#include "pcm_recorder/pcm_recorder.h"
+#include "mic_frontend/mic_frontend.h"
 
 // Microphone type selection
 enum MicrophoneType {
@@ -14,13 +19,15 @@ enum MicrophoneType {
   MIC_TYPE_INMP441   // INMP441 I2S MEMS microphone
 };
 
-class ArduinoASRChat {
+class ArduinoASRChat : private AsrTransport {
   public:
-    // Constructor
+    // Constructor, ElevenLabs unless setBackend() chooses another provider
     ArduinoASRChat(const char* apiKey, const char* modelId = "scribe_v2");
 
     // Configuration methods
-    void setApiConfig(const char* apiKey, const char* modelId = nullptr);
+    void setApiConfig(const char* apiKey, const char* modelId = nullptr);  // of the ElevenLabs backend
+    void setBackend(AsrBackend* backend);                                   // not owned, nullptr: ElevenLabs
+    AsrBackend* getBackend() { return _backend; }
     void setMicrophoneType(MicrophoneType micType);
     void setAudioParams(int sampleRate = 16000, int bitsPerSample = 16, int channels = 1);
     void setSilenceDuration(unsigned long duration);
@@ -48,6 +55,12 @@ class ArduinoASRChat {
     bool hasNewResult();
     void clearResult();
 
+    // Partial transcript while recording, stable once it repeats or stops changing (speculative LLM requests)
+    String getPartialText();
+    bool isPartialStable();
+    uint32_t getPartialRevision() { return _partialRevision; }  // changes with every new partial text
+    void setPartialStability(int repeats, unsigned long holdMs);
+
     // Callback function type
     typedef void (*ResultCallback)(String text);
     void setResultCallback(ResultCallback callback);
@@ -56,15 +69,34 @@ class ArduinoASRChat {
     typedef void (*TimeoutNoSpeechCallback)();
     void setTimeoutNoSpeechCallback(TimeoutNoSpeechCallback callback);
 
+    // Visitor archive: the mic audio of a session, with the last preRollMs before it, goes to the recorder
+    // (one file per session id). While idle loop() keeps reading the mic into a PSRAM pre-roll ring.
+    bool setArchive(PcmRecorder* recorder, int preRollMs = 2000);
+    bool beginArchiveSession(uint32_t id);
+    void endArchiveSession();
+
+    // Mic front-end (DC blocker, high-pass, noise suppression, AGC) between I2S and everything else, on by default.
+    // Set up again with the sample rate by the init*Microphone() calls.
+    void setFrontend(bool enable, const MicFrontend::config_t& cfg = MicFrontend::defaultConfig());
+    void getFrontendStats(MicFrontend::stats_t* stats, bool reset = false);
+
+    // Session reuse: the socket stays open across turns (start/end message per utterance). A (re)connect runs in a
+    // task while the mic audio is buffered in PSRAM, the buffer is sent once the socket is up.
+    void setSessionReuse(bool enable, int backlogSeconds = 5);
+    struct AudioStats {
+      uint32_t turns;          // recordings started
+      uint32_t reused;         // ... on a socket that was already open
+      uint32_t connects;       // background (re)connects
+      uint32_t lastConnectMs;
+      uint32_t replayedMs;     // buffered while connecting, sent afterwards
+      uint32_t lostMs;         // due from the sample rate, but never captured or never sent
+    };
+    void getAudioStats(AudioStats* stats, bool reset = false);
+
   private:
-    // WebSocket configuration
-    const char* _apiKey;
-    const char* _modelId;
-    
-    // ElevenLabs API Configuration
-    const char* _wsHost = "api.elevenlabs.io";
-    const int _wsPort = 443;
-    const char* _wsPath = "/v1/speech-to-text/stream-input";
+    // Provider: connect parameters and the messages of a turn
+    ElevenLabsAsr _elevenLabs;
+    AsrBackend* _backend = &_elevenLabs;
 
     // Audio parameters
     int _sampleRate = 16000;
@@ -78,9 +110,14 @@ class ArduinoASRChat {
     // Microphone configuration
     MicrophoneType _micType = MIC_TYPE_INMP441;
     I2SClass _I2S;
+    MicFrontend _frontend;
+    MicFrontend::config_t _frontendConfig = MicFrontend::defaultConfig();
+    bool _frontendEnabled = true;
 
-    // WiFi client
+    // WiFi client, plain for a ws:// endpoint
     WiFiClientSecure _client;
+    WiFiClient _plainClient;
+    WiFiClient* _conn = &_client;
 
     // State flags
     bool _wsConnected = false;
@@ -96,11 +133,60 @@ class ArduinoASRChat {
     unsigned long _lastSpeechTime = 0;
     int _sameResultCount = 0;
     unsigned long _lastDotTime = 0;
+    unsigned long _partialChangeTime = 0;
+    uint32_t _partialRevision = 0;
+    int _stableRepeats = 2;              // same partial received this often ...
+    unsigned long _stableHoldMs = 400;   // ... or unchanged this long
 
     // Audio buffer
     int16_t* _sendBuffer;
     int _sendBufferPos = 0;
 
+    // Visitor archive
+    PcmRecorder* _archive = nullptr;
+    bool _archiveSession = false;
+    int16_t* _preRoll = nullptr;         // ring of the last mic samples
+    size_t _preRollSize = 0;             // in samples
+    size_t _preRollPos = 0;              // samples written, not modulo
+
+    // Session reuse, the connect task only touches the client and _wsConnected while _connectState is CONNECT_RUNNING
+    enum : uint8_t { CONNECT_IDLE = 0, CONNECT_RUNNING = 1, CONNECT_OK = 2, CONNECT_FAILED = 3 };
+    bool _reuseSession = true;
+    int _backlogSeconds = 5;
+    std::atomic<uint8_t> _connectState{CONNECT_IDLE};
+    unsigned long _connectStart = 0;
+    bool _startPending = false;          // start message goes out once connected
+    int16_t* _backlog = nullptr;         // audio captured while not connected, PSRAM
+    size_t _backlogSize = 0;             // in samples
+    size_t _backlogLen = 0;
+    size_t _replayPos = 0;
+    size_t _backlogDropped = 0;          // samples of this turn that did not fit
+    size_t _capturedSamples = 0;         // samples of this turn read from the mic
+    String _carryText = "";              // transcript from before a lost connection
+    AudioStats _stats = {};
+
+    // Receive path: frames are parsed as the bytes come, without blocking, messages (fragments appended) are put
+    // together in one buffer that lives as long as the object, control frames may come between the fragments
+    static const size_t ASR_RX_SIZE = 4096;    // longer messages are dropped
+    static const size_t ASR_TEXT_MAX = 512;
+    uint8_t* _rxBuffer;
+    size_t _rxLen = 0;
+    bool _rxOverflow = false;
+    uint8_t _rxMsgOpcode = 0;            // first frame of the message, 0: none open
+    uint8_t _rxHeader[14];
+    uint8_t _rxHeaderLen = 0;
+    uint8_t _rxHeaderNeed = 2;
+    bool _rxInPayload = false;
+    bool _rxFin = false;
+    bool _rxMasked = false;
+    uint8_t _rxOpcode = 0;               // current frame
+    uint8_t _rxMask[4];
+    uint64_t _rxLeft = 0;                // payload bytes of the frame still to come
+    uint64_t _rxPayloadPos = 0;
+    uint8_t _rxControl[125];
+    uint8_t _rxControlLen = 0;
+    char _rxText[ASR_TEXT_MAX];
+
     // Callback
     ResultCallback _resultCallback = nullptr;
     TimeoutNoSpeechCallback _timeoutNoSpeechCallback = nullptr;
@@ -108,16 +194,28 @@ class ArduinoASRChat {
     // Private helper methods
     String generateWebSocketKey();
     void handleWebSocketData();
+    void resetReceiver();
+    bool parseFrameHeader();
+    void finishFrame();
     void sendWebSocketFrame(uint8_t* data, size_t len, uint8_t opcode);
     
-    // Protocol Methods (ElevenLabs JSON)
+    // Protocol Methods, the backend builds the messages
     void sendStartConfig();
-    void sendAudioChunk(uint8_t* data, size_t len);
+    void sendAudioChunk(const int16_t* samples, size_t n);
     void sendEndMarker();
-    void sendPong();
-    void parseResponse(uint8_t* data, size_t len);
+    void sendFrame(uint8_t opcode, uint8_t* data, size_t len) override;
+    void sendPong(uint8_t* data, size_t len);
+    void parseResponse(uint8_t* data, size_t len, bool binary);
     
+    static void _connectTask(void* param);
+    bool startConnect();
+    void finishConnect();
+    void queueAudio(int16_t* samples, size_t n);
+    void replayBacklog(int maxChunks);
     void processAudioSending();
+    void captureIdle();
+    void filterSamples(int16_t* samples, size_t n);
+    void archiveSamples(const int16_t* samples, size_t n);
     void checkRecordingTimeout();
     void checkSilence();
 };
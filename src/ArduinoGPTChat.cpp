@@ -1,5 +1,6 @@
 #include "ArduinoGPTChat.h"
 #include <SPIFFS.h>
+#include <StreamString.h>
 
 // Default API configuration - users can modify these or set their own via setApiConfig()
 const char* DEFAULT_API_KEY = "";
@@ -457,8 +458,28 @@ void ArduinoGPTChat::enableMemory(bool enable) {
   }
 }
 
+void ArduinoGPTChat::setMemoryBudget(uint8_t maxPairs, uint16_t maxTokens, uint16_t maxBytes) {
+  _memory.setBudget(maxPairs, maxTokens, maxBytes);
+}
+
+void ArduinoGPTChat::enableMemorySummary(uint16_t maxBytes) {
+  _memory.enableSummary(maxBytes);
+}
+
+void ArduinoGPTChat::enableStreaming(bool enable) {
+  _chatOptions.stream = enable;
+}
+
+void ArduinoGPTChat::setChatOptions(const ChatOptions& options) {
+  _chatOptions = options;
+}
+
+void ArduinoGPTChat::setSpeechOptions(const SpeechOptions& options) {
+  _speechOptions = options;
+}
+
 void ArduinoGPTChat::clearMemory() {
-  _conversationHistory.clear();
+  _memory.clear();
   Serial.println("Conversation memory cleared");
 }
 
@@ -471,114 +492,238 @@ void ArduinoGPTChat::_updateApiUrls() {
   if(_apiBaseUrl.startsWith("https://")) {
     g_api_host = _apiBaseUrl.substring(8);
   } else if(_apiBaseUrl.startsWith("http://")) {
-    g_api_host = _apiBaseUrl.substring(7);
+    g_api_host = _apiBaseUrl; // openai_speech() connects without TLS, port from the URL (local stand-in servers)
   } else {
     g_api_host = _apiBaseUrl;
   }
 }
 
 String ArduinoGPTChat::sendMessage(String message) {
+  return sendMessage(message, _chatOptions);
+}
+
+String ArduinoGPTChat::sendMessage(String message, const ChatOptions& options) {
+  // The body is rendered from the prompt and the memory while it is sent, there is no payload String
+  JsonSource body([this, &message, &options](JsonWriter& w) { _renderPayload(w, message, options); });
+  String assistantResponse = _postCompletion(_apiUrl, String(_apiKey), body, options.stream);
+  _rememberTurn(message, assistantResponse);
+  return assistantResponse;
+}
+
+String ArduinoGPTChat::_postCompletion(const String& url, const String& apiKey, JsonSource& body, bool stream) {
   HTTPClient http;
-  http.begin(_apiUrl);
+  http.begin(url);
   http.addHeader("Content-Type", "application/json");
-  http.addHeader("Authorization", "Bearer " + String(_apiKey));
+  http.addHeader("Authorization", "Bearer " + apiKey);
 
-  String payload = _buildPayload(message);
-  int httpResponseCode = http.POST(payload);
+  int httpResponseCode = http.sendRequest("POST", &body, body.size());
 
+  StreamString assistantResponse;
   if (httpResponseCode == 200) {
-    String response = http.getString();
-    String assistantResponse = _processResponse(response);
+    // The body goes through the parser as it arrives, only the content is kept
+    JsonStream parser(stream ? "choices/0/delta/content" : "choices/0/message/content", &assistantResponse, stream);
+    http.writeToStream(&parser);
+    if (!parser.found()) {
+      Serial.println("Error: no content in the completion response");
+    }
+    assistantResponse.remove(assistantResponse.indexOf('\n'));
+  }
+  http.end();
+  return assistantResponse;
+}
 
-    // Save to conversation history if memory is enabled
-    if (_memoryEnabled && assistantResponse.length() > 0) {
-      _conversationHistory.push_back(std::make_pair(message, assistantResponse));
+void ArduinoGPTChat::_rememberTurn(const String& message, const String& response) {
+  // Save to conversation history if memory is enabled, the oldest pairs make room within the budgets
+  if (_memoryEnabled && response.length() > 0) {
+    _memory.add(message, response);
 
-      // Keep only the last N pairs to avoid memory overflow
-      while (_conversationHistory.size() > _maxHistoryPairs) {
-        _conversationHistory.erase(_conversationHistory.begin());
-      }
+    Serial.printf("Memory: %d/%d conversation pairs stored, ~%u tokens\n",
+                  _memory.count(), _memory.maxPairs(), (unsigned)_memory.tokens());
+  }
+}
 
-      Serial.printf("Memory: %d/%d conversation pairs stored\n",
-                    _conversationHistory.size(), _maxHistoryPairs);
+// Lower case letters and digits only, "Halo, paket!" and "halo paket" are the same utterance
+String ArduinoGPTChat::_normalizeUtterance(const String& text) {
+  String key;
+  key.reserve(text.length());
+  for (size_t i = 0; i < text.length(); i++) {
+    uint8_t c = text[i];
+    if (isalnum(c)) {
+      key += (char)tolower(c);
+    } else if (c >= 0x80) {
+      key += (char)c;  // UTF-8 passes unchanged
     }
+  }
+  return key;
+}
 
-    return assistantResponse;
+bool ArduinoGPTChat::beginSpeculative(String message) {
+  String key = _normalizeUtterance(message);
+  if (key.length() == 0) {
+    return false;
   }
-  return "";
+  if (_speculation != nullptr) {
+    if (_speculation->key == key) {
+      return true;  // already asked
+    }
+    cancelSpeculative();  // the partial moved on
+  }
+  if (_speculationsRunning >= MAX_SPECULATIONS) {
+    return false;
+  }
+
+  Speculation* spec = new Speculation();
+  spec->owner = this;
+  spec->message = message;
+  spec->key = key;
+  spec->payload = _buildPayload(message, _chatOptions);  // built here, the task never touches the history
+  spec->stream = _chatOptions.stream;
+  spec->started = millis();
+
+  _speculationsRunning++;
+  if (xTaskCreatePinnedToCore(_speculationTask, "GPTSpeculate", 8192, spec, 1, NULL, 0) != pdPASS) {
+    _speculationsRunning--;
+    delete spec;
+    return false;
+  }
+  _speculation = spec;
+  Serial.printf("Speculative request: %s\n", message.c_str());
+  return true;
 }
 
-String ArduinoGPTChat::_buildPayload(String message) {
-  // Calculate required buffer size based on history
-  size_t bufferSize = 768;
-  if (_memoryEnabled && _conversationHistory.size() > 0) {
-    bufferSize = 768 + (_conversationHistory.size() * 512);  // Extra space for history
+void ArduinoGPTChat::_speculationTask(void* param) {
+  Speculation* spec = (Speculation*)param;
+  ArduinoGPTChat* owner = spec->owner;
+  JsonSource body([spec](JsonWriter& w) { w.raw(spec->payload.c_str(), spec->payload.length()); });
+  spec->response = owner->_postCompletion(owner->_apiUrl, String(owner->_apiKey), body, spec->stream);
+  spec->state = spec->response.length() > 0 ? 1 : 2;
+  owner->_speculationsRunning--;
+  _releaseSpeculation(spec);
+  vTaskDelete(NULL);
+}
+
+void ArduinoGPTChat::_releaseSpeculation(Speculation* spec) {
+  if (--spec->refs == 0) {
+    delete spec;
   }
+}
 
-  DynamicJsonDocument doc(bufferSize);
-  doc["model"] = "gpt-4.1-nano";
-  JsonArray messages = doc.createNestedArray("messages");
+String ArduinoGPTChat::takeSpeculative(String finalMessage, uint32_t timeoutMs) {
+  Speculation* spec = _speculation;
+  if (spec == nullptr) {
+    return "";
+  }
+  if (spec->key != _normalizeUtterance(finalMessage)) {
+    Serial.println("Speculative request dropped, final transcript differs");
+    cancelSpeculative();
+    return "";
+  }
+
+  // Same words: waiting for the running request is always shorter than a new one
+  uint32_t start = millis();
+  while (spec->state == 0 && millis() - start < timeoutMs) {
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  String response = spec->state == 1 ? spec->response : String();
+  if (response.length() > 0) {
+    Serial.printf("Speculative request used, %u ms saved\n", (unsigned)(start - spec->started));
+    _rememberTurn(finalMessage, response);
+  }
+  _speculation = nullptr;
+  _releaseSpeculation(spec);
+  return response;
+}
+
+void ArduinoGPTChat::cancelSpeculative() {
+  // HTTPClient can't be interrupted, the task finishes on its own and the answer is thrown away
+  if (_speculation != nullptr) {
+    _releaseSpeculation(_speculation);
+    _speculation = nullptr;
+  }
+}
+
+bool ArduinoGPTChat::isSpeculating() {
+  return _speculation != nullptr;
+}
+
+String ArduinoGPTChat::_buildPayload(String message, const ChatOptions& options) {
+  // A copy of the request, for the speculative task that must not read the memory while it changes
+  StreamString output;
+  JsonWriter w(&output);
+  _renderPayload(w, message, options);
+  w.flush();
+  return output;
+}
+
+void ArduinoGPTChat::_renderPayload(JsonWriter& w, const String& message, const ChatOptions& options) {
+  w.raw("{\"model\":");
+  w.string(options.model);
+  w.raw(",");
+  if (options.temperature >= 0) {
+    char num[32];
+    snprintf(num, sizeof(num), "\"temperature\":%.2f,", options.temperature);
+    w.raw(num);
+  }
+  if (options.maxTokens > 0) {
+    char num[40];
+    snprintf(num, sizeof(num), "\"max_completion_tokens\":%u,", options.maxTokens);
+    w.raw(num);
+  }
+  if (options.stream) {
+    w.raw("\"stream\":true,");
+  }
+  w.raw("\"messages\":[");
+  bool comma = false;
 
   // Add system message if configured
   if (_systemPrompt.length() > 0) {
-    JsonObject sysMsg = messages.createNestedObject();
-    sysMsg["role"] = "system";
-    sysMsg["content"] = _systemPrompt;
-  }
-
-  // Add conversation history if memory is enabled
-  if (_memoryEnabled) {
-    for (size_t i = 0; i < _conversationHistory.size(); i++) {
-      // Add user message from history
-      JsonObject historyUserMsg = messages.createNestedObject();
-      historyUserMsg["role"] = "user";
-      historyUserMsg["content"] = _conversationHistory[i].first;
-
-      // Add assistant message from history
-      JsonObject historyAssistantMsg = messages.createNestedObject();
-      historyAssistantMsg["role"] = "assistant";
-      historyAssistantMsg["content"] = _conversationHistory[i].second;
-    }
+    w.raw("{\"role\":\"system\",\"content\":");
+    w.string(_systemPrompt.c_str(), _systemPrompt.length());
+    w.raw("}");
+    comma = true;
   }
 
-  // Add current user message
-  JsonObject userMsg = messages.createNestedObject();
-  userMsg["role"] = "user";
-  userMsg["content"] = message;
+  // Add conversation history (and the summary of older turns) if memory is enabled
+  if (_memoryEnabled && _memory.writeMessages(w, comma)) {
+    comma = true;
+  }
 
-  String output;
-  serializeJson(doc, output);
-  return output;
+  // Add current user message
+  if (comma) {
+    w.raw(",");
+  }
+  w.raw("{\"role\":\"user\",\"content\":");
+  w.string(message.c_str(), message.length());
+  w.raw("}]}");
 }
 
 String ArduinoGPTChat::_processResponse(String response) {
-  DynamicJsonDocument jsonDoc(1024);
-  deserializeJson(jsonDoc, response);
-  String outputText = jsonDoc["choices"][0]["message"]["content"];
+  StreamString outputText;
+  JsonStream parser("choices/0/message/content", &outputText);
+  parser.feed((const uint8_t*)response.c_str(), response.length());
   outputText.remove(outputText.indexOf('\n'));
   return outputText;
 }
 
 bool ArduinoGPTChat::textToSpeech(String text) {
-  // Create a temporary Audio object
+  return textToSpeech(text, _speechOptions);
+}
+
+bool ArduinoGPTChat::textToSpeech(String text, const SpeechOptions& options) {
   extern Audio audio;
 
-  // Use Audio library's openai_speech function
+  // Use Audio library's openai_speech function, it escapes the text
   return audio.openai_speech(
-    String(_apiKey),     // API key
-    "gpt-4o-mini-tts",   // Model
-    text,                // Input text
-    "alloy",             // Voice
-    "mp3",               // Response format
-    "1.0"                // Speed
+    String(_apiKey),                     // API key
+    options.model,                       // Model
+    text,                                // Input text
+    options.voice,                       // Voice
+    options.format,                      // Response format
+    String(options.speed),               // Speed
+    options.instructions ? options.instructions : ""
   );
 }
 
-String ArduinoGPTChat::_buildTTSPayload(String text) {
-  text.replace("\"", "\\\"");
-  return "{\"model\": \"gpt-4o-mini-tts\", \"input\": \"" + text + "\", \"voice\": \"alloy\"}";
-}
-
 String ArduinoGPTChat::speechToText(const char* audioFilePath) {
   String response = "";
 
@@ -9,16 +9,50 @@
 #include "SD.h"
 #include "ESP_I2S.h"
 #include <vector>
+#include <atomic>
+#include "json_stream/json_stream.h"
+#include "chat_memory/chat_memory.h"
 
 class ArduinoGPTChat {
   public:
+    // Request settings, per call or as defaults. Picked for a short time to the first word / the first sample.
+    struct ChatOptions {
+      const char* model = "gpt-4.1-nano";
+      float temperature = -1;            // < 0: server default
+      uint16_t maxTokens = 0;            // max_completion_tokens, 0: server default
+      bool stream = false;               // "stream": true, the answer comes as server-sent events
+    };
+    struct SpeechOptions {
+      const char* model = "gpt-4o-mini-tts";
+      const char* voice = "alloy";
+      const char* format = "wav";        // first samples soonest, no decoder; "aac", "mp3" at 1/6 of the bytes, "opus", "flac" (doorbell_sim --speech)
+      float speed = 1.0;
+      const char* instructions = nullptr;  // speaking style, gpt-4o-mini-tts only
+    };
+
     ArduinoGPTChat(const char* apiKey = nullptr, const char* apiBaseUrl = nullptr);
     void setApiConfig(const char* apiKey = nullptr, const char* apiBaseUrl = nullptr);
     void setSystemPrompt(const char* systemPrompt);
     void enableMemory(bool enable);
+    void enableStreaming(bool enable);  // ChatOptions::stream for the default options
+    void setChatOptions(const ChatOptions& options);
+    void setSpeechOptions(const SpeechOptions& options);
+    ChatOptions chatOptions() { return _chatOptions; }
+    SpeechOptions speechOptions() { return _speechOptions; }
     void clearMemory();
+    void setMemoryBudget(uint8_t maxPairs, uint16_t maxTokens, uint16_t maxBytes);  // clears the memory
+    void enableMemorySummary(uint16_t maxBytes);  // older pairs are kept as a short summary, 0: off
     String sendMessage(String message);
+    String sendMessage(String message, const ChatOptions& options);
+
+    // Speculative request: started on a stable partial transcript in its own task (own connection). The answer is
+    // used only if the final transcript matches, otherwise it is dropped. Memory is updated on take only.
+    bool beginSpeculative(String message);
+    String takeSpeculative(String finalMessage, uint32_t timeoutMs = 15000);  // "" -> use sendMessage()
+    void cancelSpeculative();
+    bool isSpeculating();
     bool textToSpeech(String text);
+    bool textToSpeech(String text, const SpeechOptions& options);
     String speechToText(const char* audioFilePath);
     String speechToTextFromBuffer(uint8_t* audioBuffer, size_t bufferSize);
     String sendImageMessage(const char* imageFilePath, String question);
@@ -42,16 +76,39 @@ class ArduinoGPTChat {
     String _ttsApiUrl;
     String _sttApiUrl;
     String _systemPrompt;
-    String _buildPayload(String message);
+    String _buildPayload(String message, const ChatOptions& options);
+    void _renderPayload(JsonWriter& w, const String& message, const ChatOptions& options);
     String _processResponse(String response);
-    String _buildTTSPayload(String text);
+    String _postCompletion(const String& url, const String& apiKey, JsonSource& body, bool stream);
+    void _rememberTurn(const String& message, const String& response);
+    static String _normalizeUtterance(const String& text);
     String _buildMultipartForm(const char* audioFilePath, String boundary);
     void _updateApiUrls();
 
+    ChatOptions _chatOptions;
+    SpeechOptions _speechOptions;
+
     // Conversation memory
     bool _memoryEnabled = false;
-    std::vector<std::pair<String, String>> _conversationHistory;  // pair<user_msg, assistant_msg>
-    const int _maxHistoryPairs = 5;  // Maximum conversation pairs to keep
+    ChatMemory _memory{5, 1024, 4096};  // pairs, estimated tokens, bytes
+
+    // Speculative request, shared with its task, the last of both frees it
+    struct Speculation {
+      ArduinoGPTChat* owner;
+      String message;
+      String key;          // normalized message
+      String payload;
+      bool stream;
+      String response;
+      uint32_t started;
+      std::atomic<uint8_t> state{0};  // 0 running, 1 done, 2 failed
+      std::atomic<uint8_t> refs{2};
+    };
+    static void _speculationTask(void* param);
+    static void _releaseSpeculation(Speculation* spec);
+    Speculation* _speculation = nullptr;
+    std::atomic<uint8_t> _speculationsRunning{0};
+    static const uint8_t MAX_SPECULATIONS = 2;  // TLS connections in flight, abandoned ones included
 
     // WAV file handling
     uint8_t* createWAVBuffer(int16_t* samples, size_t numSamples);
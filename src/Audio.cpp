@@ -14,6 +14,9 @@
 #include "mp3_decoder/mp3_decoder.h"
 #include "opus_decoder/opus_decoder.h"
 #include "vorbis_decoder/vorbis_decoder.h"
+#include "audio_arena/audio_arena.h"
+#include "json_stream/json_stream.h"
+#include <StreamString.h>
 
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 AudioBuffer::AudioBuffer(size_t maxBlockSize) {
@@ -157,6 +160,77 @@ uint32_t AudioBuffer::getWritePos() { return m_writePtr - m_buffer; }
 
 uint32_t AudioBuffer::getReadPos() { return m_readPtr - m_buffer; }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+PcmBuffer::PcmBuffer() {}
+
+PcmBuffer::~PcmBuffer() {
+    if(m_buffer) free(m_buffer);
+    m_buffer = NULL;
+}
+
+size_t PcmBuffer::init(size_t framesPSRAM, size_t framesRAM) {
+    if(m_buffer) free(m_buffer);
+    m_buffer = NULL;
+    framesPSRAM = roundUpPow2(framesPSRAM); // the free running counters must wrap around on a frame boundary
+    framesRAM = roundUpPow2(framesRAM);
+    if(psramInit() && framesPSRAM > 0) { // PSRAM found, PcmBuffer will be allocated in PSRAM
+        m_f_psram = true;
+        m_size = framesPSRAM;
+        m_buffer = (int16_t*)ps_calloc(m_size * 2, sizeof(int16_t));
+    }
+    if(m_buffer == NULL) { // PSRAM not found, not configured or not enough available
+        m_f_psram = false;
+        m_size = framesRAM;
+        m_buffer = (int16_t*)heap_caps_calloc(m_size * 2, sizeof(int16_t), MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL);
+    }
+    if(!m_buffer) {m_size = 0; return 0;}
+    m_f_init = true;
+    reset();
+    return m_size;
+}
+
+size_t PcmBuffer::roundUpPow2(size_t n) {
+    size_t p = 1;
+    while(p < n) p <<= 1;
+    return p;
+}
+
+size_t PcmBuffer::framesFilled() {
+    return m_wrCnt.load(std::memory_order_acquire) - m_rdCnt.load(std::memory_order_acquire);
+}
+
+size_t PcmBuffer::framesFree() {
+    return m_size - framesFilled();
+}
+
+size_t PcmBuffer::write(const int16_t* src, size_t frames) {
+    if(!m_f_init) return 0;
+    uint32_t wr = m_wrCnt.load(std::memory_order_relaxed);
+    size_t n = min(frames, m_size - (wr - m_rdCnt.load(std::memory_order_acquire)));
+    size_t pos = wr & (m_size - 1);
+    size_t n1 = min(n, m_size - pos); // up to the end of the buffer
+    memcpy(m_buffer + pos * 2, src, n1 * 2 * sizeof(int16_t));
+    if(n > n1) memcpy(m_buffer, src + n1 * 2, (n - n1) * 2 * sizeof(int16_t));
+    m_wrCnt.store(wr + n, std::memory_order_release);
+    return n;
+}
+
+size_t PcmBuffer::read(int16_t* dst, size_t frames) {
+    if(!m_f_init) return 0;
+    uint32_t rd = m_rdCnt.load(std::memory_order_relaxed);
+    size_t n = min(frames, (size_t)(m_wrCnt.load(std::memory_order_acquire) - rd));
+    size_t pos = rd & (m_size - 1);
+    size_t n1 = min(n, m_size - pos);
+    memcpy(dst, m_buffer + pos * 2, n1 * 2 * sizeof(int16_t));
+    if(n > n1) memcpy(dst + n1 * 2, m_buffer, (n - n1) * 2 * sizeof(int16_t));
+    m_rdCnt.store(rd + n, std::memory_order_release);
+    return n;
+}
+
+void PcmBuffer::reset() {
+    m_wrCnt.store(0);
+    m_rdCnt.store(0);
+}
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 // clang-format off
 Audio::Audio(uint8_t i2sPort) {
 
@@ -169,7 +243,10 @@ Audio::Audio(uint8_t i2sPort) {
     m_chbuf    = (char*) malloc(m_chbufSize);
     m_ibuff    = (char*) malloc(m_ibuffSize);
     m_outBuff  = (int16_t*)malloc(m_outbuffSize * sizeof(int16_t));
-    if(!m_chbuf || !m_outBuff || !m_ibuff) log_e("oom");
+    m_outChunk = (int16_t*)malloc(m_outChunkSize * 2 * sizeof(int16_t));
+    m_mixBuff    = (int32_t*)malloc(m_outChunkSize * 2 * sizeof(int32_t)); // mixer, here and not on the first voice:
+    m_voiceChunk = (int16_t*)malloc(m_outChunkSize * 2 * sizeof(int16_t)); // two callers must not both allocate them
+    if(!m_chbuf || !m_outBuff || !m_ibuff || !m_outChunk || !m_mixBuff || !m_voiceChunk) log_e("oom");
 
 #ifdef AUDIO_LOG
     m_f_Log = true;
@@ -200,6 +277,9 @@ Audio::Audio(uint8_t i2sPort) {
     m_i2s_std_cfg.clk_cfg.clk_src        = I2S_CLK_SRC_DEFAULT;        // Select PLL_F160M as the default source clock
     m_i2s_std_cfg.clk_cfg.mclk_multiple  = I2S_MCLK_MULTIPLE_512;      // mclk = sample_rate * 256
     i2s_channel_init_std_mode(m_i2s_tx_handle, &m_i2s_std_cfg);
+    i2s_event_callbacks_t i2s_cbs = {};
+    i2s_cbs.on_sent = &Audio::i2sOnSent;                                // wakes the audio task when a DMA descriptor is free
+    i2s_channel_register_event_callback(m_i2s_tx_handle, &i2s_cbs, this); // must be registered before the channel is enabled
     I2Sstart(m_i2s_num);
     m_sampleRate = 44100;
 
@@ -226,11 +306,15 @@ Audio::~Audio() {
     x_ps_free(&m_chbuf);
     x_ps_free(&m_lastHost);
     x_ps_free(&m_outBuff);
+    x_ps_free(&m_outChunk);
     x_ps_free(&m_ibuff);
     x_ps_free(&m_lastM3U8host);
     x_ps_free(&m_speechtxt);
 
     stopAudioTask();
+    for(uint8_t v = 0; v < AUDIO_MIX_VOICES; v++) releaseVoice(v);
+    if(m_mixBuff) free(m_mixBuff);
+    x_ps_free(&m_voiceChunk);
     vSemaphoreDelete(mutex_playAudioData);
     vSemaphoreDelete(mutex_audioTask);
 }
@@ -244,11 +328,49 @@ void Audio::setBufsize(int rambuf_sz, int psrambuf_sz) {
     InBuff.setBufsize(rambuf_sz, psrambuf_sz);
 };
 
+void Audio::setDecoderHotBudget(int32_t bytes) {
+    // internal SRAM for the hot set of the decoders, -1: automatic, 0: everything in PSRAM, takes effect with the next
+    // decoder initialization, compare the "decode: .. cycles per frame" line at the end of a stream to see the speedup
+    AudioArena::setHotBudget(bytes);
+}
+
+void Audio::logDecodeStats() {
+    // one line per stream, the same file played with setDecoderHotBudget(-1) and (0) shows what the hot set gains
+    if(!m_decodeFrames) return;
+    char report[160];
+    if(!AudioArena::report(report, sizeof(report))) strcpy(report, "no arena");
+    AUDIO_INFO("decode: %lu cycles per frame, %lu frames, %s", (long unsigned int)(m_decodeCycles / m_decodeFrames),
+               (long unsigned int)m_decodeFrames, report);
+    m_decodeFrames = 0;
+}
+
+void Audio::setOutputSampleRate(uint32_t sampleRate) {
+    // 0: I2S is reconfigured for every stream (default), otherwise the I2S rate is fixed and the decoded audio is
+    // converted by a polyphase resampler, takes effect with the next stream. The filters of the usual stream rates
+    // are designed here, in the caller's task, the audio task only looks them up.
+    m_outputSampleRate = sampleRate;
+    static const uint32_t rates[] = {16000, 22050, 24000, 32000, 44100, 48000};
+    if(sampleRate) for(uint32_t r : rates) Resampler::prepare(r, sampleRate);
+}
+
+void Audio::setPcmBufferTime(uint16_t ms) {
+    if(PcmBuff.isInitialized()) {
+        log_e("Audio::setPcmBufferTime must not be called after audio is initialized");
+        return;
+    }
+    m_pcmBuffTime = ms;
+}
+
 void Audio::initInBuff() {
     if(!InBuff.isInitialized()) {
         size_t size = InBuff.init();
         if(size > 0) { AUDIO_INFO("PSRAM %sfound, inputBufferSize: %u bytes", InBuff.havePSRAM() ? "" : "not ", size - 1); }
     }
+    if(!PcmBuff.isInitialized()) { // sized for 48kHz, in RAM max. 4096 frames (16KB)
+        size_t frames = (size_t)m_pcmBuffTime * 48;
+        size_t size = PcmBuff.init(frames, min(frames, (size_t)4096));
+        if(size > 0) { AUDIO_INFO("pcmBufferSize: %u frames in %s", size, PcmBuff.havePSRAM() ? "PSRAM" : "RAM"); }
+    }
     changeMaxBlockSize(1600); // default size mp3 or aac
 }
 
@@ -284,6 +406,10 @@ void Audio::setDefaults() {
     ts_parsePacket(0, 0, 0);                     // reset ts routine
     x_ps_free(&m_lastM3U8host);
     x_ps_free(&m_speechtxt);
+    x_ps_free(&m_seekPath);
+    m_seekIndex.clear();
+    m_f_seekIndexReady = false;
+    m_seekTimeMs = -1;
 
     AUDIO_INFO("buffers freed, free Heap: %lu bytes", (long unsigned int)ESP.getFreeHeap());
 
@@ -326,6 +452,12 @@ void Audio::setDefaults() {
     m_bitRate = 0;         // Bitrate still unknown
     m_bytesNotDecoded = 0; // counts all not decodable bytes
     m_chunkcount = 0;      // for chunked streams
+    m_chunkLineSize = 0;
+    m_chunkLineDigits = 0;
+    m_f_chunkExt = false;
+    m_f_chunkLine = false;
+    m_rxPos = 0;           // staged bytes belong to the last connection
+    m_rxLen = 0;
     m_contentlength = 0;   // If Content-Length is known, count it
     m_curSample = 0;
     m_metaint = 0;        // No metaint yet
@@ -341,6 +473,7 @@ void Audio::setDefaults() {
     m_M4A_objectType = 0;
     m_M4A_sampleRate = 0;
     m_sumBytesDecoded = 0;
+    m_speechStart = 0;
     m_vuLeft = m_vuRight = 0; // #835
 }
 
@@ -358,14 +491,25 @@ void Audio::setConnectionTimeout(uint16_t timeout_ms, uint16_t timeout_ms_ssl) {
     model (string) [Required] - One of the available TTS models: tts-1 or tts-1-hd
     input (string) [Required] - The text to generate audio for. The maximum length is 4096 characters.
     voice (string) [Required] - The voice to use when generating the audio. Supported voices are alloy, echo, fable, onyx, nova, and shimmer.
-    response_format (string) [Optional] - Defaults to mp3. The format to audio in. Supported formats are mp3, opus, aac, and flac.
+    response_format (string) [Optional] - Defaults to mp3. The format to audio in. Supported formats are mp3, opus, aac, flac and wav.
+                                          wav needs no decoding and starts playing first, opus is the smallest.
     speed (number) [Optional] - Defaults to 1. The speed of the generated audio. Select a value from 0.25 to 4.0. 1.0 is the default.
+    instructions (string) [Optional] - How the voice should speak (gpt-4o-mini-tts only).
 
     Usage: audio.openai_speech(OPENAI_API_KEY, "tts-1", input, "shimmer", "mp3", "1");
+
+    The time from the request to the first decoded samples is logged ("first audio after ... ms"), to compare formats.
 */
-bool Audio::openai_speech(const String& api_key, const String& model, const String& input, const String& voice, const String& response_format, const String& speed) {
+bool Audio::openai_speech(const String& api_key, const String& model, const String& input, const String& voice, const String& response_format, const String& speed, const String& instructions) {
     extern String g_api_host;
     String hostStr = (g_api_host.length() > 0) ? g_api_host : "api.chatanywhere.tech";
+    bool tls = !hostStr.startsWith("http://"); // "http://host:port" from a plain base URL, e.g. asr_mock.py
+    int port = tls ? 443 : 80;
+    if(!tls) {
+        hostStr.remove(0, 7);
+        int colon = hostStr.indexOf(':');
+        if(colon > 0) { port = hostStr.substring(colon + 1).toInt(); hostStr.remove(colon); }
+    }
     const char* host = hostStr.c_str();
     char path[] = "/v1/audio/speech";
 
@@ -377,28 +521,22 @@ bool Audio::openai_speech(const String& api_key, const String& model, const Stri
     xSemaphoreTakeRecursive(mutex_playAudioData, 0.3 * configTICK_RATE_HZ);
 
     setDefaults();
-    m_f_ssl = true;
-
-    String input_clean = "";
-    for (int i = 0; i < input.length(); i++) {
-        char c = input.charAt(i);
-        if (c == '\"') {
-            input_clean += "\\\"";
-        } else if (c == '\n') {
-            input_clean += "\\n";
-        } else {
-            input_clean += c;
-        }
+    m_f_ssl = tls;
+
+    StreamString post_body; // the input is escaped completely, quotes, backslashes and control characters
+    {
+        char sp[16];
+        snprintf(sp, sizeof(sp), "%.2f", speed.toFloat() > 0 ? speed.toFloat() : 1.0f); // a number, not a string
+        JsonWriter w(&post_body);
+        w.raw("{\"model\":");            w.string(model.c_str(), model.length());
+        w.raw(",\"input\":");            w.string(input.c_str(), input.length());
+        w.raw(",\"voice\":");            w.string(voice.c_str(), voice.length());
+        w.raw(",\"response_format\":");  w.string(response_format.c_str(), response_format.length());
+        w.raw(",\"speed\":");            w.raw(sp);
+        if(instructions.length()) { w.raw(",\"instructions\":"); w.string(instructions.c_str(), instructions.length()); }
+        w.raw("}");
     }
 
-    String post_body = "{"
-        "\"model\": \"" + model + "\"," +
-        "\"input\": \"" + input_clean + "\"," +
-        "\"voice\": \"" + voice + "\"," +
-        "\"response_format\": \"" + response_format + "\"," +
-        "\"speed\": \"" + speed + "\"" +
-    "}";
-
     String http_request =
         "POST " + String(path) + " HTTP/1.0\r\n" // UNKNOWN ERROR CODE (0050) - crashing on HTTP/1.1 need to use HTTP/1.0
         + "Host: " + String(host) + "\r\n"
@@ -412,17 +550,17 @@ bool Audio::openai_speech(const String& api_key, const String& model, const Stri
     ;
 
     bool res = true;
-    int port = 443;
-    _client = static_cast<WiFiClient*>(&clientsecure);
+    if(m_f_ssl) _client = static_cast<WiFiClient*>(&clientsecure);
+    else        _client = static_cast<WiFiClient*>(&client);
 
     uint32_t t = millis();
     AUDIO_INFO("Connect to: \"%s\"", host);
-    res = _client->connect(host, port, m_timeout_ms_ssl);
+    res = _client->connect(host, port, m_f_ssl ? m_timeout_ms_ssl : m_timeout_ms);
     if (res) {
         uint32_t dt = millis() - t;
         x_ps_free(&m_lastHost);
         m_lastHost = x_ps_strdup(host);
-        AUDIO_INFO("%s has been established in %lu ms, free Heap: %lu bytes", "SSL", (long unsigned int) dt, (long unsigned int) ESP.getFreeHeap());
+        AUDIO_INFO("%s has been established in %lu ms, free Heap: %lu bytes", m_f_ssl ? "SSL" : "Connection", (long unsigned int) dt, (long unsigned int) ESP.getFreeHeap());
         m_f_running = true;
     }
 
@@ -435,6 +573,8 @@ bool Audio::openai_speech(const String& api_key, const String& model, const Stri
         if (response_format == "opus") m_expectedCodec  = CODEC_OPUS;
         if (response_format == "aac") m_expectedCodec  = CODEC_AAC;
         if (response_format == "flac") m_expectedCodec  = CODEC_FLAC;
+        if (response_format == "wav") m_expectedCodec  = CODEC_WAV;
+        m_speechStart = millis();
         m_dataMode = HTTP_RESPONSE_HEADER;
         m_streamType = ST_WEBSTREAM;
     } else {
@@ -657,6 +797,7 @@ bool Audio::httpPrint(const char* host) {
             return false;
         }
     }
+    rxFlush();
     _client->print(rqh);
 
     if(     endsWith(extension, ".mp3"))       m_expectedCodec  = CODEC_MP3;
@@ -753,6 +894,7 @@ bool Audio::httpRange(const char* host, uint32_t range){
 log_e("%s", rqh);
 
     _client->stop();
+    rxFlush();
     if(m_f_ssl) { _client = static_cast<WiFiClient*>(&clientsecure); if(m_f_ssl && port == 80) port = 443;}
     else        { _client = static_cast<WiFiClient*>(&client); }
     AUDIO_INFO("The host has disconnected, reconnecting");
@@ -860,6 +1002,10 @@ bool Audio::connecttoFS(fs::FS& fs, const char* path, int32_t fileStartPos) {
     audiofile = fs.open(audioPath);
     m_dataMode = AUDIO_LOCALFILE;
     m_fileSize = audiofile.size();
+    if(m_f_seekIndex) {
+        m_seekFs = &fs;
+        m_seekPath = x_ps_strdup(audioPath);
+    }
 
     res = initializeDecoder(codec);
     m_codec = codec;
@@ -1288,13 +1434,17 @@ int Audio::read_WAV_Header(uint8_t* data, size_t len) {
 
     if(m_controlCounter == 8) {
         m_controlCounter++;
-        size_t cs = *(data + 0) + (*(data + 1) << 8) + (*(data + 2) << 16) + (*(data + 3) << 24); // read chunkSize
+        uint32_t cs = (uint32_t)*(data + 0) + ((uint32_t)*(data + 1) << 8) + ((uint32_t)*(data + 2) << 16) + ((uint32_t)*(data + 3) << 24); // read chunkSize
         headerSize += 4;
         if(m_dataMode == AUDIO_LOCALFILE) m_contentlength = getFileSize();
-        if(cs) { m_audioDataSize = cs - 44; }
-        else { // sometimes there is nothing here
+        if(cs && cs != 0xFFFFFFFF) { m_audioDataSize = cs > 44 ? cs - 44 : cs; }
+        else { // unknown, a streamed WAV (e.g. TTS) is sent before its length is known
+            m_audioDataSize = 0; // play until EOF
             if(m_dataMode == AUDIO_LOCALFILE) m_audioDataSize = getFileSize() - headerSize;
-            if(m_streamType == ST_WEBFILE) m_audioDataSize = m_contentlength - headerSize;
+            if(m_streamType == ST_WEBFILE && m_contentlength > headerSize) m_audioDataSize = m_contentlength - headerSize;
+        }
+        if(m_streamType == ST_WEBFILE && m_contentlength > headerSize && m_audioDataSize > m_contentlength - headerSize) {
+            m_audioDataSize = m_contentlength - headerSize; // never more than the body
         }
         AUDIO_INFO("Audio-Length: %u", m_audioDataSize);
         return 4;
@@ -1448,6 +1598,11 @@ int Audio::read_FLAC_Header(uint8_t* data, size_t len) {
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if(m_controlCounter == FLAC_SEEK) { /* SEEKTABLE */
         size_t l = bigEndian(data, 3);
+        if(m_f_seekIndex && m_dataMode == AUDIO_LOCALFILE && len > 3) {
+            m_seekIndex.addFlacSeekTable(data + 3, min(l, len - 3), m_flacSampleRate);
+            if(m_seekIndex.count()) AUDIO_INFO("seek index: %u points from the SEEKTABLE", m_seekIndex.count());
+            m_f_seekIndexReady = m_seekIndex.count() > 0;
+        }
         m_controlCounter = FLAC_MBH;
         retvalue = l + 3;
         headerSize += retvalue;
@@ -2213,6 +2368,9 @@ uint32_t Audio::stopSong() {
             }
             if(_client->connected()) _client->stop();
         }
+        m_readAhead.stopJob(); // the seek index, before the files are closed
+        if(m_seekFile) m_seekFile.close();
+        m_readAhead.end();
         if(audiofile) {
             // added this before putting 'm_f_localfile = false' in stopSong(); shoulf never occur....
             AUDIO_INFO("Closing audio file \"%s\"", audiofile.name());
@@ -2220,6 +2378,9 @@ uint32_t Audio::stopSong() {
         }
         memset(m_filterBuff, 0, sizeof(m_filterBuff)); // Clear FilterBuffer
         m_validSamples = 0;
+        m_curSample = 0;
+        m_f_pcmFlush = true; // the audio task discards the PCM FIFO
+        wakeAudioTask();
         m_audioCurrentTime = 0;
         m_audioFileDuration = 0;
         m_codec = CODEC_NONE;
@@ -2240,105 +2401,343 @@ bool Audio::pauseResume() {
         }
     }
     xSemaphoreGive(mutex_audioTask);
+    wakeAudioTask();
     return retVal;
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-void Audio::playChunk() {
+void Audio::pushPcm() {
+    // decoder output -> PCM FIFO, what doesn't fit stays in m_outBuff and is pushed before the next frame is decoded
+    if(m_speechStart && m_validSamples > 0) {
+        AUDIO_INFO("first audio after %lu ms", (long unsigned int)(millis() - m_speechStart));
+        m_speechStart = 0;
+    }
+    size_t n = PcmBuff.write(m_outBuff + m_curSample * 2, m_validSamples);
+    m_validSamples -= n;
+    m_curSample += n;
+    if(m_validSamples <= 0) { m_validSamples = 0; m_curSample = 0; }
+}
+
+bool Audio::pcmPending() {
+    return m_validSamples > 0 || PcmBuff.framesFilled() > 0 || m_outChunkValid > 0 || SRC.delayFrames() > 0;
+}
+
+uint32_t Audio::playChunk() {
+    // output stage: PCM FIFO -> mixer -> VU, filterchain, gain -> I2S, returns the number of frames written to I2S
 
-    int16_t validSamples = 0;
-    static uint16_t count = 0;
     size_t i2s_bytesConsumed = 0;
-    int16_t* sample[2] = {0};
-    int16_t* s2;
+    int16_t* sample;
     int sampleSize = 4; // 2 bytes per sample (int16_t) * 2 channels
     esp_err_t err = ESP_OK;
-    int i= 0;
-
-    if(count > 0) goto i2swrite;
 
-    if(getChannels() == 1){
-        for (int i = m_validSamples - 1; i >= 0; --i) {
-            int16_t sample = m_outBuff[i];
-            m_outBuff[2 * i] = sample;
-            m_outBuff[2 * i + 1] = sample;
+    if(!m_outChunkValid) {
+        m_outChunkPos = 0;
+        uint16_t frames = 0;
+        if(m_f_running) { // not paused
+            if(SRC.isBypass()) {
+                frames = PcmBuff.read(m_outChunk, m_outChunkSize);
+            }
+            else {
+                size_t freeFrames = 0;
+                int16_t* p = SRC.getWritePtr(&freeFrames);
+                SRC.framesWritten(PcmBuff.read(p, min(SRC.inputFramesFor(m_outChunkSize), freeFrames)));
+                if(m_f_eof && !m_validSamples && !PcmBuff.framesFilled()) SRC.flush(); // the last frames are in its delay line
+                uint32_t t = ESP.getCycleCount();
+                frames = SRC.process(m_outChunk, m_outChunkSize);
+                m_srcCycles += ESP.getCycleCount() - t;
+                m_srcFrames += frames;
+            }
+            uint32_t filled = PcmBuff.framesFilled();
+            if(filled < m_pcmMinFilled) m_pcmMinFilled = filled;
+            if(!frames) {
+                // FIFO ran dry, count it once if the decoder should have delivered (not at the end of the file)
+                if(!m_f_pcmUnderrun && !m_validSamples && m_f_stream && !m_f_eof) m_pcmUnderruns++;
+                m_f_pcmUnderrun = true;
+            }
+            else m_f_pcmUnderrun = false;
         }
-    //    m_validSamples *= 2;
-    }
-
-    validSamples = m_validSamples;
+        if(mixerActive()) frames = mixVoices(frames);
+        m_outChunkValid = frames;
+        if(!m_outChunkValid) return 0;
 
-    while(validSamples) {
-        *sample = m_outBuff + i;
-        computeVUlevel(*sample);
+        for(int i = 0; i < m_outChunkValid; i++) {
+            sample = m_outChunk + i * 2;
+            computeVUlevel(sample);
 
-        //---------- Filterchain, can commented out if not used-------------
-        {
-            if(m_corr > 1) {
-                s2 = *sample;
-                s2[LEFTCHANNEL] /= m_corr;
-                s2[RIGHTCHANNEL] /= m_corr;
+            //---------- Filterchain, can commented out if not used-------------
+            {
+                if(m_corr > 1) {
+                    sample[LEFTCHANNEL] /= m_corr;
+                    sample[RIGHTCHANNEL] /= m_corr;
+                }
+                IIR_filterChain0(sample);
+                IIR_filterChain1(sample);
+                IIR_filterChain2(sample);
+            }
+            //------------------------------------------------------------------
+            if(m_f_forceMono && m_channels == 2){
+                int32_t xy = (sample[RIGHTCHANNEL] + sample[LEFTCHANNEL]) / 2;
+                sample[RIGHTCHANNEL] = (int16_t)xy;
+                sample[LEFTCHANNEL]  = (int16_t)xy;
+            }
+            Gain(sample);
+        }
+        if(audio_process_i2s) {
+            // processing the audio samples from external before forwarding them to i2s
+            bool continueI2S = false;
+            audio_process_i2s(m_outChunk, m_outChunkValid, 16, 2, &continueI2S);
+            if(!continueI2S) {
+                m_outChunkValid = 0;
+                return 0;
             }
-            IIR_filterChain0(*sample);
-            IIR_filterChain1(*sample);
-            IIR_filterChain2(*sample);
-        }
-        //------------------------------------------------------------------
-        if(m_f_forceMono && m_channels == 2){
-            int32_t xy = ((*sample)[RIGHTCHANNEL] + (*sample)[LEFTCHANNEL]) / 2;
-            (*sample)[RIGHTCHANNEL] = (int16_t)xy;
-            (*sample)[LEFTCHANNEL]  = (int16_t)xy;
-        }
-        Gain(*sample);
-        i += 2;
-        validSamples -= 1;
-    }
-    if(audio_process_i2s) {
-        // processing the audio samples from external before forwarding them to i2s
-        bool continueI2S = false;
-        audio_process_i2s((int16_t*)m_outBuff, m_validSamples, 16, 2, &continueI2S);
-        if(!continueI2S) {
-            m_validSamples = 0;
-            count = 0;
-            return;
         }
+        if(m_recorder && m_outChunkValid) m_recorder->push(m_outChunk, m_outChunkValid, m_i2s_std_cfg.clk_cfg.sample_rate_hz); // copies, never waits
     }
 
-i2swrite:
-
-    validSamples = m_validSamples;
-
-    err = i2s_channel_write(m_i2s_tx_handle, (int16_t*)m_outBuff + count, validSamples * sampleSize, &i2s_bytesConsumed, 10);
+    err = i2s_channel_write(m_i2s_tx_handle, m_outChunk + m_outChunkPos * 2, m_outChunkValid * sampleSize, &i2s_bytesConsumed, 0); // don't block, the rest goes out after the next i2sOnSent()
     if( ! (err == ESP_OK || err == ESP_ERR_TIMEOUT)) goto exit;
-    m_validSamples -= i2s_bytesConsumed / sampleSize;
-    count += i2s_bytesConsumed / 2;
-    if(m_validSamples < 0) { m_validSamples = 0; }
-    if(m_validSamples == 0) { count = 0; }
-
-// ---- statistics, bytes written to I2S (every 10s)
-    // static int cnt = 0;
-    // static uint32_t t = millis();
-
-    // if(t + 10000 < millis()){
-    //     log_w("%i", cnt);
-    //     cnt = 0;
-    //     t = millis();
-    // }
-    // cnt+= i2s_bytesConsumed;
-//-------------------------------------------
+    m_outChunkValid -= i2s_bytesConsumed / sampleSize;
+    m_outChunkPos   += i2s_bytesConsumed / sampleSize;
+    m_pcmFramesOut  += i2s_bytesConsumed / sampleSize;
+    return i2s_bytesConsumed / sampleSize;
 
-
-    return;
 exit:
-    if     (err == ESP_OK) return;
-    else if(err == ESP_ERR_INVALID_ARG)   log_e("NULL pointer or this handle is not tx handle");
-    else if(err == ESP_ERR_TIMEOUT)       log_e("Writing timeout, no writing event received from ISR within ticks_to_wait");
+    if(err == ESP_ERR_INVALID_ARG)        log_e("NULL pointer or this handle is not tx handle");
     else if(err == ESP_ERR_INVALID_STATE) log_e("I2S is not ready to write");
     else log_e("i2s err %i", err);
+    return 0;
+}
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+//    M I X E R
+//------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+int8_t Audio::allocVoice() {
+    // the slot is claimed with one compare and swap, two tasks starting a voice at the same time get different ones;
+    // the audio task skips it until the caller sets VOICE_ACTIVE
+    if(!m_mixBuff || !m_voiceChunk) return -1;
+    for(uint8_t v = 0; v < AUDIO_MIX_VOICES; v++) {
+        uint8_t state = VOICE_IDLE;
+        if(!m_voice[v].state.compare_exchange_strong(state, VOICE_CLAIMED, std::memory_order_acq_rel)) continue;
+        m_voice[v].pcm = NULL;
+        m_voice[v].owned = NULL;
+        m_voice[v].frames = 0;
+        m_voice[v].pos = 0;
+        m_voice[v].sampleRate = 0;
+        m_voice[v].channels = 2;
+        m_voice[v].phase = 0;
+        m_voice[v].phaseInc = 0;
+        m_voice[v].gain = 32768;
+        m_voice[v].duck = false;
+        return v;
+    }
+    AUDIO_INFO("mixer: no free voice");
+    return -1;
+}
+
+int8_t Audio::playPCM(const int16_t* pcm, uint32_t frames, uint32_t sampleRate, uint8_t channels, uint8_t gain, bool duck) {
+    // the clip is not copied, it must be valid until isVoiceActive() returns false
+    if(!pcm || !frames || !sampleRate || (channels != 1 && channels != 2)) return -1;
+    int8_t v = allocVoice();
+    if(v < 0) return -1;
+    Resampler::prepare(sampleRate, m_i2s_std_cfg.clk_cfg.sample_rate_hz); // not in the audio task
+    m_voice[v].pcm = pcm;
+    m_voice[v].frames = frames;
+    m_voice[v].sampleRate = sampleRate;
+    m_voice[v].channels = channels;
+    m_voice[v].gain = (int32_t)min(gain, (uint8_t)100) * 32768 / 100;
+    m_voice[v].duck = duck;
+    m_voice[v].state.store(VOICE_ACTIVE, std::memory_order_release);
+    wakeAudioTask();
+    return v;
+}
+
+int8_t Audio::playWAV(fs::FS &fs, const char* path, uint8_t gain, bool duck) {
+    File file = fs.open(path);
+    if(!file) { AUDIO_INFO("file not found: %s", path); return -1; }
+    uint8_t  hdr[12];
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t sampleRate = 0, dataSize = 0;
+    if(file.read(hdr, 12) == 12 && !memcmp(hdr, "RIFF", 4) && !memcmp(hdr + 8, "WAVE", 4)) {
+        while(file.read(hdr, 8) == 8) { // walk through the chunks up to "data"
+            uint32_t len = hdr[4] | hdr[5] << 8 | hdr[6] << 16 | hdr[7] << 24;
+            if(!memcmp(hdr, "data", 4)) { dataSize = len; break; }
+            if(!memcmp(hdr, "fmt ", 4) && len >= 16) {
+                uint8_t f[16];
+                if(file.read(f, 16) != 16) break;
+                format = f[0] | f[1] << 8;
+                channels = f[2] | f[3] << 8;
+                sampleRate = f[4] | f[5] << 8 | f[6] << 16 | f[7] << 24;
+                bits = f[14] | f[15] << 8;
+                len -= 16;
+            }
+            file.seek(file.position() + len + (len & 1));
+        }
+    }
+    if(format != 1 || bits != 16 || (channels != 1 && channels != 2) || !sampleRate || !dataSize) {
+        AUDIO_INFO("%s: only 16 bit PCM wav files can be mixed", path);
+        file.close();
+        return -1;
+    }
+    if(dataSize > file.size() - file.position()) dataSize = file.size() - file.position();
+    int16_t* clip = (int16_t*)(psramFound() ? ps_malloc(dataSize) : malloc(dataSize));
+    if(!clip) { log_e("oom"); file.close(); return -1; }
+    uint32_t frames = file.read((uint8_t*)clip, dataSize) / (2 * channels);
+    file.close();
+    int8_t v = frames ? allocVoice() : -1; // a claimed voice has to be started
+    if(v < 0) { free(clip); return -1; }
+    Resampler::prepare(sampleRate, m_i2s_std_cfg.clk_cfg.sample_rate_hz);
+    m_voice[v].pcm = clip;
+    m_voice[v].owned = clip;
+    m_voice[v].frames = frames;
+    m_voice[v].sampleRate = sampleRate;
+    m_voice[v].channels = channels;
+    m_voice[v].gain = (int32_t)min(gain, (uint8_t)100) * 32768 / 100;
+    m_voice[v].duck = duck;
+    m_voice[v].state.store(VOICE_ACTIVE, std::memory_order_release);
+    wakeAudioTask();
+    return v;
+}
+
+int8_t Audio::playTone(uint16_t freq, uint16_t ms, uint8_t gain, bool duck) {
+    uint32_t sampleRate = m_i2s_std_cfg.clk_cfg.sample_rate_hz; // generated at the I2S rate
+    if(!freq || !ms || freq >= sampleRate / 2) return -1;
+    int8_t v = allocVoice();
+    if(v < 0) return -1;
+    m_voice[v].frames = (uint32_t)ms * sampleRate / 1000;
+    m_voice[v].sampleRate = sampleRate;
+    m_voice[v].phaseInc = 2 * PI * freq / sampleRate;
+    m_voice[v].gain = (int32_t)min(gain, (uint8_t)100) * 32768 / 100;
+    m_voice[v].duck = duck;
+    m_voice[v].state.store(VOICE_ACTIVE, std::memory_order_release);
+    wakeAudioTask();
+    return v;
+}
+
+void Audio::stopVoice(int8_t voice) {
+    if(voice < 0 || voice >= AUDIO_MIX_VOICES) return;
+    uint8_t state = VOICE_ACTIVE;
+    m_voice[voice].state.compare_exchange_strong(state, VOICE_STOP); // released by the audio task
+    wakeAudioTask();
+}
+
+bool Audio::isVoiceActive(int8_t voice) {
+    if(voice < 0 || voice >= AUDIO_MIX_VOICES) return false;
+    return m_voice[voice].state.load(std::memory_order_acquire) != VOICE_IDLE;
+}
+
+void Audio::setVoiceGain(int8_t voice, uint8_t gain) {
+    if(voice < 0 || voice >= AUDIO_MIX_VOICES) return;
+    m_voice[voice].gain = (int32_t)min(gain, (uint8_t)100) * 32768 / 100;
+}
+
+void Audio::setDuckLevel(uint8_t percent) {
+    m_duckLevel = (int32_t)min(percent, (uint8_t)100) * 32768 / 100;
+}
+
+void Audio::releaseVoice(uint8_t v) { // audio task only
+    x_ps_free(&m_voice[v].owned);
+    m_voice[v].pcm = NULL;
+    m_voice[v].state.store(VOICE_IDLE, std::memory_order_release);
+}
+
+bool Audio::mixerActive() {
+    if(m_duckGain != 32768) return true; // ramp back to the full level
+    for(uint8_t v = 0; v < AUDIO_MIX_VOICES; v++) {
+        uint8_t state = m_voice[v].state.load(std::memory_order_relaxed);
+        if(state != VOICE_IDLE && state != VOICE_CLAIMED) return true;
+    }
+    return false;
+}
+
+uint16_t Audio::renderVoice(uint8_t v, int16_t* out, uint16_t frames) {
+    // returns the number of frames at the I2S rate, less than frames: the voice is finished
+    voice_t& vc = m_voice[v];
+    uint32_t busRate = m_i2s_std_cfg.clk_cfg.sample_rate_hz;
+    uint16_t n = 0;
+
+    if(!vc.pcm) { // tone, 5ms fade in and fade out against clicks
+        uint32_t fade = busRate / 200 + 1;
+        while(n < frames && vc.pos < vc.frames) {
+            uint32_t edge = min(vc.pos, vc.frames - 1 - vc.pos);
+            float env = edge < fade ? (float)edge / fade : 1.0f;
+            int16_t smp = (int16_t)(sinf(vc.phase) * env * 32767);
+            vc.phase += vc.phaseInc;
+            if(vc.phase > 2 * PI) vc.phase -= 2 * PI;
+            out[2 * n] = smp;
+            out[2 * n + 1] = smp;
+            n++;
+            vc.pos++;
+        }
+        return n;
+    }
+
+    Resampler& src = m_voiceSRC[v];
+    if(vc.pos == 0 || src.getOutRate() != busRate) src.setRates(vc.sampleRate, busRate); // new clip: clear the history
+    int16_t* dst = out;
+    size_t   in  = frames;
+    if(!src.isBypass()) {
+        size_t freeFrames = 0;
+        dst = src.getWritePtr(&freeFrames);
+        in = min(src.inputFramesFor(frames), freeFrames);
+    }
+    if(in > vc.frames - vc.pos) in = vc.frames - vc.pos;
+    const int16_t* p = vc.pcm + vc.pos * vc.channels;
+    for(size_t i = 0; i < in; i++) { // mono -> stereo
+        dst[2 * i]     = p[i * vc.channels];
+        dst[2 * i + 1] = p[i * vc.channels + vc.channels - 1];
+    }
+    vc.pos += in;
+    if(src.isBypass()) return in;
+    src.framesWritten(in);
+    return src.process(out, frames);
+}
+
+int16_t Audio::softClip(int32_t x) {
+    // linear up to -3dB, above that the sum saturates smoothly towards full scale instead of wrapping or hard clipping
+    const int32_t knee = 23170, room = 32767 - knee;
+    if(x > knee)  { int32_t d =  x - knee; return  knee + (int32_t)((int64_t)room * d / (d + room)); }
+    if(x < -knee) { int32_t d = -x - knee; return -knee - (int32_t)((int64_t)room * d / (d + room)); }
+    return x;
+}
+
+uint16_t Audio::mixVoices(uint16_t frames) {
+    // frames: stream frames in m_outChunk, the voices are added on top, without stream the voices set the length
+    uint16_t len = frames ? frames : m_outChunkSize;
+    uint16_t voiceLen = 0;
+    bool     duck = false;
+    memset(m_mixBuff, 0, len * 2 * sizeof(int32_t));
+    for(uint8_t v = 0; v < AUDIO_MIX_VOICES; v++) {
+        uint8_t state = m_voice[v].state.load(std::memory_order_acquire);
+        if(state == VOICE_IDLE || state == VOICE_CLAIMED) continue; // claimed: the caller is still setting it up
+        if(state == VOICE_STOP) { releaseVoice(v); continue; }
+        uint16_t n = renderVoice(v, m_voiceChunk, len);
+        int32_t  g = m_voice[v].gain;
+        for(int i = 0; i < n * 2; i++) m_mixBuff[i] += (m_voiceChunk[i] * g) >> 15;
+        if(n > voiceLen) voiceLen = n;
+        if(m_voice[v].duck) duck = true;
+        if(n < len) releaseVoice(v); // end of clip or tone
+    }
+    int32_t target = duck ? m_duckLevel : 32768;
+    if(!frames) {
+        if(!duck) m_duckGain = 32768; // nothing to ramp
+        len = voiceLen;
+        if(!len) return 0;
+    }
+    int32_t step = 32768 * 50 / m_i2s_std_cfg.clk_cfg.sample_rate_hz + 1; // 20ms ramp
+    for(int i = 0; i < frames; i++) {
+        if(m_duckGain < target)      m_duckGain = min(m_duckGain + step, target);
+        else if(m_duckGain > target) m_duckGain = max(m_duckGain - step, target);
+        m_mixBuff[2 * i]     += (m_outChunk[2 * i]     * m_duckGain) >> 15;
+        m_mixBuff[2 * i + 1] += (m_outChunk[2 * i + 1] * m_duckGain) >> 15;
+    }
+    for(int i = 0; i < len * 2; i++) m_outChunk[i] = softClip(m_mixBuff[i]);
+    return len;
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 void Audio::loop() {
     if(!m_f_running) return;
 
+    size_t inBuffFilled = InBuff.bufferFilled();
+    bool   f_stream     = m_f_stream;
+
     if(m_playlistFormat != FORMAT_M3U8) { // normal process
         switch(m_dataMode) {
             case AUDIO_LOCALFILE:
@@ -2363,6 +2762,7 @@ void Audio::loop() {
                 if(m_streamType == ST_WEBFILE) processWebFile();
                 break;
         }
+        if(InBuff.bufferFilled() > inBuffFilled || m_f_stream != f_stream) wakeAudioTask(); // new data for the decoder
     }
     else { // m3u8 datastream only
         const char* host = NULL;
@@ -2404,16 +2804,24 @@ void Audio::loop() {
                 }
                 break;
         }
+        if(InBuff.bufferFilled() > inBuffFilled || m_f_stream != f_stream) wakeAudioTask(); // new data for the decoder
     }
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool Audio::readPlayListData() {
     if(m_dataMode != AUDIO_PLAYLISTINIT) return false;
-    if(_client->available() == 0) return false;
+    if(rxAvailable() == 0) return false;
 
     uint32_t chunksize = 0;
     uint8_t  readedBytes = 0;
-    if(m_f_chunked) chunksize = chunkedDataTransfer(&readedBytes);
+    if(m_f_chunked) {
+        uint32_t t = millis();
+        do { // the playlist is read in one go, wait for the whole chunk size line
+            chunksize = chunkedDataTransfer(&readedBytes);
+            if(!m_f_chunkLine) break;
+            vTaskDelay(1);
+        } while(millis() - t < 2000);
+    }
 
     // reads the content of the playlist and stores it in the vector m_contentlength
     // m_contentlength is a table of pointers to the lines
@@ -2430,8 +2838,8 @@ bool Audio::readPlayListData() {
 
         while(true) { // inner while
             uint16_t pos = 0;
-            while(_client->available()) { // super inner while :-))
-                pl[pos] = _client->read();
+            while(rxAvailable()) { // super inner while :-))
+                pl[pos] = rxRead();
                 ctl++;
                 if(pl[pos] == '\n') {
                     pl[pos] = '\0';
@@ -2493,14 +2901,14 @@ bool Audio::readPlayListData() {
         // 2. no contentLength, but Transfer-Encoding:chunked -> compute chunksize and read until chunksize is reached
         // 3. no chunksize and no contentlengt, but Connection: close -> read all available chars
         if(ctl == m_contentlength) {
-            while(_client->available()) _client->read();
+            rxFlush();
             break;
         } // read '\n\n' if exists
         if(ctl == chunksize) {
-            while(_client->available()) _client->read();
+            rxFlush();
             break;
         }
-        if(!_client->connected() && _client->available() == 0) break;
+        if(!_client->connected() && rxAvailable() == 0) break;
 
     } // outer while
     lines = m_playlistContent.size();
@@ -3068,7 +3476,9 @@ void Audio::processLocalFile() {
         return;
     }
     availableBytes = InBuff.writeSpace();
-    int32_t bytesAddedToBuffer = audiofile.read(InBuff.getWritePtr(), availableBytes);
+    int32_t bytesAddedToBuffer;
+    if(m_readAhead.active()) bytesAddedToBuffer = m_readAhead.read(InBuff.getWritePtr(), availableBytes); // from a ready block, no card access here
+    else                     bytesAddedToBuffer = audiofile.read(InBuff.getWritePtr(), availableBytes);
     if(bytesAddedToBuffer > 0) {InBuff.bytesWritten(bytesAddedToBuffer);}
     if(!m_f_stream) {
         if(m_codec == CODEC_OGG) { // log_i("determine correct codec here");
@@ -3092,6 +3502,8 @@ void Audio::processLocalFile() {
         else {
             m_f_stream = true;
             AUDIO_INFO("stream ready");
+            if(m_f_readAhead) m_readAhead.begin(&audiofile, audiofile.position()); // the header is done, the file belongs to the task
+            startSeekIndex();
         }
     }
 
@@ -3101,20 +3513,31 @@ void Audio::processLocalFile() {
     }
 
     if(m_resumeFilePos >= 0) {
+        std::atomic_thread_fence(std::memory_order_acquire); // pairs with setFilePos(), m_seekTimeMs belongs to this position
+        bool indexed = false;
+        if(m_readAhead.active()) m_readAhead.pause(); // the scans below use the file
+        if(seekIndexReady()) { // a frame start from the index, no byte scan, else the scan until the index is done
+            int32_t                   ms = m_seekTimeMs;
+            const SeekIndex::entry_t* e = ms >= 0 ? m_seekIndex.atTime(ms)
+                                                  : m_seekIndex.atPos(max(m_resumeFilePos - (int32_t)m_audioDataStart, (int32_t)0));
+            if(e) {m_resumeFilePos = m_audioDataStart + e->pos; m_seekTimeMs = e->ms; indexed = true;}
+        }
+        if(!indexed) m_seekTimeMs = -1;
         if(m_resumeFilePos <  (int32_t)m_audioDataStart) m_resumeFilePos = m_audioDataStart;
         if(m_resumeFilePos >= (int32_t)m_audioDataStart + m_audioDataSize) {goto exit;}
         m_haveNewFilePos = m_resumeFilePos;
 
-        if(m_codec == CODEC_M4A) {m_resumeFilePos = m4a_correctResumeFilePos(m_resumeFilePos);   if(m_resumeFilePos == -1) goto exit;}
+        if(m_codec == CODEC_M4A && !indexed) {m_resumeFilePos = m4a_correctResumeFilePos(m_resumeFilePos);   if(m_resumeFilePos == -1) goto exit;}
         if(m_codec == CODEC_WAV) {while((m_resumeFilePos % 4) != 0){m_resumeFilePos++; if(m_resumeFilePos >= m_fileSize)   goto exit;}}  // must divisible by four
-        if(m_codec == CODEC_FLAC) {m_resumeFilePos = flac_correctResumeFilePos(m_resumeFilePos); if(m_resumeFilePos == -1) goto exit; FLACDecoderReset();}
-        if(m_codec == CODEC_MP3) { m_resumeFilePos = mp3_correctResumeFilePos(m_resumeFilePos);  if(m_resumeFilePos == -1) goto exit; MP3Decoder_ClearBuffer();}
+        if(m_codec == CODEC_FLAC) {if(!indexed) m_resumeFilePos = flac_correctResumeFilePos(m_resumeFilePos); if(m_resumeFilePos == -1) goto exit; FLACDecoderReset();}
+        if(m_codec == CODEC_MP3) { if(!indexed) m_resumeFilePos = mp3_correctResumeFilePos(m_resumeFilePos);  if(m_resumeFilePos == -1) goto exit; MP3Decoder_ClearBuffer();}
         if(m_codec == CODEC_VORBIS){m_resumeFilePos = ogg_correctResumeFilePos(m_resumeFilePos); if(m_resumeFilePos == -1) goto exit; VORBISDecoder_ClearBuffers();}
         if(m_codec == CODEC_OPUS){m_resumeFilePos = ogg_correctResumeFilePos(m_resumeFilePos);   if(m_resumeFilePos == -1) goto exit; OPUSDecoder_ClearBuffers();}
 
         m_f_lockInBuffer = true;                          // lock the buffer, the InBuffer must not be re-entered in playAudioData()
             while(m_f_audioTaskIsDecoding) vTaskDelay(1); // We can't reset the InBuffer while the decoding is in progress
-            audiofile.seek(m_resumeFilePos);
+            if(m_readAhead.active()) m_readAhead.seek(m_resumeFilePos);
+            else                     audiofile.seek(m_resumeFilePos);
             InBuff.resetBuffer();
             m_sumBytesDecoded = m_haveNewFilePos = m_resumeFilePos;
             m_resumeFilePos = -1;
@@ -3126,16 +3549,19 @@ void Audio::processLocalFile() {
     if(m_f_eof){ // m_f_eof and m_f_ID3v1TagFound will be set in playAudioData()
         if(m_f_loop){ // file loop
             m_sumBytesDecoded = m_haveNewFilePos = m_audioDataStart;
-            audiofile.seek(m_audioDataStart);
+            if(m_readAhead.active()) m_readAhead.seek(m_audioDataStart);
+            else                     audiofile.seek(m_audioDataStart);
             InBuff.resetBuffer();
             AUDIO_INFO("file loop");
             m_f_eof = false;
             return;
         }
+        if(pcmPending()) return; // let the PCM FIFO play out
         if(m_f_ID3v1TagFound) readID3V1Tag();
 exit:
         char* afn = NULL;
         if(audiofile) afn = strdup(audiofile.name()); // store temporary the name
+        logDecodeStats();
         stopSong();
 
         if(m_codec == CODEC_MP3) MP3Decoder_FreeBuffers();
@@ -3175,7 +3601,7 @@ void Audio::processWebStream() {
         m_metacount = m_metaint;
         readMetadata(0, true); // reset all static vars
     }
-    uint32_t availableBytes = _client->available(); // available from stream
+    uint32_t availableBytes = rxAvailable(); // available from stream
 
     // chunked data tramsfer - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if(m_f_chunked && availableBytes) {
@@ -3200,7 +3626,7 @@ void Audio::processWebStream() {
     // buffer fill routine - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if(availableBytes) {
         availableBytes = min(availableBytes, (uint32_t)InBuff.writeSpace());
-        int32_t bytesAddedToBuffer = _client->read(InBuff.getWritePtr(), availableBytes);
+        int32_t bytesAddedToBuffer = rxRead(InBuff.getWritePtr(), availableBytes);
         if(bytesAddedToBuffer > 0) {
 
             if(m_f_metadata) m_metacount -= bytesAddedToBuffer;
@@ -3242,7 +3668,7 @@ void Audio::processWebFile() {
     }
 
 
-    uint32_t availableBytes = _client->available(); // available from stream
+    uint32_t availableBytes = rxAvailable(); // available from stream
 
     // chunked data tramsfer - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if(m_f_chunked && availableBytes) {
@@ -3254,7 +3680,7 @@ void Audio::processWebFile() {
         availableBytes = min(availableBytes, chunkSize - byteCounter);
     }
 
-    if(!m_contentlength && !chunkSize) {
+    if(!m_contentlength && !chunkSize && !m_f_chunkLine) {
         log_e("webfile is not chunked or is without contentlength!");
         stopSong();
         return;
@@ -3263,7 +3689,7 @@ void Audio::processWebFile() {
     // if the buffer is often almost empty issue a warning - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if(m_f_stream) {if(streamDetection(availableBytes)) return;}
     availableBytes = min(availableBytes, (uint32_t)InBuff.writeSpace());
-    int32_t bytesAddedToBuffer = _client->read(InBuff.getWritePtr(), availableBytes);
+    int32_t bytesAddedToBuffer = rxRead(InBuff.getWritePtr(), availableBytes);
     if(bytesAddedToBuffer > 0) {
         m_webFilePos += bytesAddedToBuffer;
         byteCounter += bytesAddedToBuffer;
@@ -3298,10 +3724,12 @@ void Audio::processWebFile() {
 
     // end of webfile reached? - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if(m_f_eof) { // m_f_eof and m_f_ID3v1TagFound will be set in playAudioData()
+        if(pcmPending()) return; // let the PCM FIFO play out
         if(m_f_ID3v1TagFound) readID3V1Tag();
 
         m_f_running = false;
         m_streamType = ST_NONE;
+        logDecodeStats();
         if(m_codec == CODEC_MP3) MP3Decoder_FreeBuffers();
         if(m_codec == CODEC_AAC) AACDecoder_FreeBuffers();
         if(m_codec == CODEC_M4A) AACDecoder_FreeBuffers();
@@ -3349,7 +3777,7 @@ void Audio::processWebStreamTS() {
 
     if(m_dataMode != AUDIO_DATA) return; // guard
 
-    availableBytes = _client->available();
+    availableBytes = rxAvailable();
     if(availableBytes) {
 
         /* If the m3u8 stream uses 'chunked data transfer' no content length is supplied. Then the chunk size determines the audio data to be processed.
@@ -3362,7 +3790,7 @@ void Audio::processWebStreamTS() {
         if(chunkSize) minBytes = min3(availableBytes, ts_packetsize - ts_packetPtr, chunkSize - byteCounter);
         else          minBytes = min(availableBytes, (uint32_t)(ts_packetsize - ts_packetPtr));
 
-        int res = _client->read(ts_packet + ts_packetPtr, minBytes);
+        int res = rxRead(ts_packet + ts_packetPtr, minBytes);
         if(res > 0) {
             ts_packetPtr += res;
             byteCounter += res;
@@ -3401,8 +3829,8 @@ void Audio::processWebStreamTS() {
             if (byteCounter == m_contentlength || byteCounter == chunkSize) {
                 f_chunkFinished = true;
                 byteCounter = 0;
-                int av = _client->available();
-                if(av == 7) for(int i = 0; i < av; i++) _client->read(); // waste last chunksize: 0x0D 0x0A 0x30 0x0D 0x0A 0x0D 0x0A (==0, end of chunked data transfer)
+                int av = rxAvailable();
+                if(av == 7) for(int i = 0; i < av; i++) rxRead(); // waste last chunksize: 0x0D 0x0A 0x30 0x0D 0x0A 0x0D 0x0A (==0, end of chunked data transfer)
             }
             if(m_contentlength && byteCounter > m_contentlength) {log_e("byteCounter overflow, byteCounter: %d, contentlength: %d", byteCounter, m_contentlength); return;}
             if(chunkSize       && byteCounter > chunkSize)       {log_e("byteCounter overflow, byteCounter: %d, chunkSize: %d",     byteCounter, chunkSize); return;}
@@ -3468,7 +3896,7 @@ void Audio::processWebStreamHLS() {
 
     if(m_dataMode != AUDIO_DATA) return; // guard
 
-    availableBytes = _client->available();
+    availableBytes = rxAvailable();
     if(availableBytes) { // an ID3 header could come here
         uint8_t readedBytes = 0;
 
@@ -3479,7 +3907,7 @@ void Audio::processWebStreamHLS() {
 
         if(firstBytes) {
             if(ID3WritePtr < ID3BuffSize) {
-                ID3WritePtr += _client->readBytes(&ID3Buff[ID3WritePtr], ID3BuffSize - ID3WritePtr);
+                ID3WritePtr += rxRead(&ID3Buff[ID3WritePtr], ID3BuffSize - ID3WritePtr);
                 return;
             }
             if(m_controlCounter < 100) {
@@ -3514,9 +3942,9 @@ void Audio::processWebStreamHLS() {
         size_t bytesWasWritten = 0;
         if(InBuff.writeSpace() >= availableBytes) {
         //    if(availableBytes > 1024) availableBytes = 1024; // 1K throttle
-            bytesWasWritten = _client->read(InBuff.getWritePtr(), availableBytes);
+            bytesWasWritten = rxRead(InBuff.getWritePtr(), availableBytes);
         }
-        else { bytesWasWritten = _client->read(InBuff.getWritePtr(), InBuff.writeSpace()); }
+        else { bytesWasWritten = rxRead(InBuff.getWritePtr(), InBuff.writeSpace()); }
         InBuff.bytesWritten(bytesWasWritten);
 
         byteCounter += bytesWasWritten;
@@ -3570,7 +3998,7 @@ void Audio::playAudioData() {
         else                                     f_isFile = false;
     }
 
-    if(m_validSamples) {playChunk(); return;}    // play samples first
+    if(m_validSamples) {pushPcm(); return;}      // queue the rest of the last frame first
     if(m_f_eof) return;
 
     if(m_f_lockInBuffer) return;
@@ -3620,7 +4048,7 @@ bool Audio::parseHttpResponseHeader() { // this is the response to a GET / reque
 
     static uint32_t stime;
     static bool     f_time = false;
-    if(_client->available() == 0) {
+    if(rxAvailable() == 0) {
         if(!f_time) {
             stime = millis();
             f_time = true;
@@ -3643,8 +4071,8 @@ bool Audio::parseHttpResponseHeader() { // this is the response to a GET / reque
             m_f_timeout = true;
             goto exit;
         }
-        while(_client->available()) {
-            uint8_t b = _client->read();
+        int b;
+        while((b = rxRead()) >= 0) { // the header comes out of the staging buffer, the bytes after it stay there for InBuff
             if(b == '\n') {
                 if(!pos) { // empty line received, is the last line of this responseHeader
                     if(ct_seen) goto lastToDo;
@@ -3667,7 +4095,7 @@ bool Audio::parseHttpResponseHeader() { // this is the response to a GET / reque
         } // inner while
 
         if(!pos) {
-            vTaskDelay(5);
+            vTaskDelay(1); // nothing received yet
             continue;
         }
 
@@ -3715,7 +4143,7 @@ bool Audio::parseHttpResponseHeader() { // this is the response to a GET / reque
                                 m_f_m3u8data = true;
                             }
                             httpPrint(c_host);
-                            while(_client->available()) _client->read(); // empty client buffer
+                            rxFlush(); // empty client buffer
                             return true;
                         }
                     }
@@ -3813,6 +4241,7 @@ bool Audio::parseHttpResponseHeader() { // this is the response to a GET / reque
                 m_f_chunked = true;
                 AUDIO_INFO("chunked data transfer");
                 m_chunkcount = 0; // Expect chunkcount in DATA
+                m_f_chunkLine = true; // the first chunk size line is still to come
             }
         }
 
@@ -3951,6 +4380,12 @@ bool Audio::initializeDecoder(uint8_t codec) {
             break;
         default: goto exit; break;
     }
+    {
+        char report[160];
+        if(AudioArena::report(report, sizeof(report))) AUDIO_INFO("decoder memory: %s", report);
+    }
+    m_decodeCycles = 0;
+    m_decodeFrames = 0;
     return true;
 
 exit:
@@ -3994,6 +4429,7 @@ bool Audio::parseContentType(char* ct) {
     else if(!strcmp(ct, "audio/x-ms-asx"))                ct_val = CT_ASX;  // #413
     else if(!strcmp(ct, "application/ogg"))               ct_val = CT_OGG;
     else if(!strcmp(ct, "audio/ogg"))                     ct_val = CT_OGG;
+    else if(!strcmp(ct, "audio/opus"))                    ct_val = CT_OGG;  // OpenAI speech, Ogg encapsulated
     else if(!strcmp(ct, "application/vnd.apple.mpegurl")) ct_val = CT_M3U8;
     else if(!strcmp(ct, "application/x-mpegurl"))         ct_val = CT_M3U8;
     else if(!strcmp(ct, "application/octet-stream"))      ct_val = CT_TXT;  // ??? listen.radionomy.com/1oldies before redirection
@@ -4367,6 +4803,7 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
     if(m_codec == CODEC_NONE && m_playlistFormat == FORMAT_M3U8) return 0; // can happen when the m3u8 playlist is loaded
     if(!m_f_decode_ready) return 0; // find sync first
 
+    uint32_t t = ESP.getCycleCount();
     switch(m_codec) {
         case CODEC_WAV:  m_decodeError = 0; bytesLeft = 0; break;
         case CODEC_MP3:  m_decodeError = MP3Decode(data, &bytesLeft, m_outBuff, 0); break;
@@ -4380,6 +4817,7 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
             stopSong();
         }
     }
+    m_decodeCycles += ESP.getCycleCount() - t;
 
     // m_decodeError - possible values are:
     //                   0: okay, no error
@@ -4499,13 +4937,21 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
         m_PlayingStartTime = millis();
     }
 
+    m_decodeFrames += m_validSamples;
     uint16_t bytesDecoderOut = m_validSamples;
     if(m_channels == 2) bytesDecoderOut /= 2;
     if(m_bitsPerSample == 16) bytesDecoderOut *= 2;
     computeAudioTime(bytesDecoded, bytesDecoderOut);
 
+    if(getChannels() == 1){ // the PCM FIFO holds stereo frames
+        for (int i = m_validSamples - 1; i >= 0; --i) {
+            int16_t sample = m_outBuff[i];
+            m_outBuff[2 * i] = sample;
+            m_outBuff[2 * i + 1] = sample;
+        }
+    }
     m_curSample = 0;
-    playChunk();
+    pushPcm();
     return bytesDecoded;
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -4574,6 +5020,11 @@ void Audio::computeAudioTime(uint16_t bytesDecoderIn, uint16_t bytesDecoderOut)
         uint32_t newTime = posWhithinAudioBlock / (m_avr_bitrate / 8);
         m_audioCurrentTime = newTime;
         sumBytesIn = posWhithinAudioBlock;
+        int32_t seekMs = m_seekTimeMs.exchange(-1);
+        if(seekMs >= 0) { // the index knows the time of the frame, count on from there
+            m_audioCurrentTime = seekMs / 1000.0;
+            sumBytesIn = (uint64_t)seekMs * m_avr_bitrate / 8000;
+        }
         m_haveNewFilePos = 0;
     }
 }
@@ -4736,6 +5187,7 @@ uint32_t Audio::getFileSize() { // returns the size of webfile or local file
 uint32_t Audio::getFilePos() {
     if(m_dataMode == AUDIO_LOCALFILE){
         if(!audiofile) return 0;
+        if(m_readAhead.active()) return m_readAhead.position(); // the file itself is ahead
         return audiofile.position();
     }
     if(m_streamType == ST_WEBFILE){
@@ -4764,7 +5216,9 @@ uint32_t Audio::getAudioFileDuration() {
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 uint32_t Audio::getAudioCurrentTime() { // return current time in seconds
-    return round(m_audioCurrentTime);
+    float t = m_audioCurrentTime;
+    if(m_sampleRate) t -= (float)PcmBuff.framesFilled() / m_sampleRate; // decoded but not played yet
+    return t > 0 ? round(t) : 0;
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool Audio::setAudioPlayPosition(uint16_t sec) {
@@ -4772,9 +5226,13 @@ bool Audio::setAudioPlayPosition(uint16_t sec) {
     //if(m_codec == CODEC_VORBIS) return false; // not impl. yet
     // Jump to an absolute position in time within an audio file
     // e.g. setAudioPlayPosition(300) sets the pointer at pos 5 min
-    if(sec > getAudioFileDuration()) sec = getAudioFileDuration();
+    bool indexed = seekIndexReady();
+    if(sec > getAudioFileDuration() && !indexed) sec = getAudioFileDuration(); // the index stops at its last frame
     uint32_t filepos = m_audioDataStart + (m_avr_bitrate * sec / 8);
-    if(m_dataMode == AUDIO_LOCALFILE) return setFilePos(filepos);
+    if(m_dataMode == AUDIO_LOCALFILE) {
+        if(indexed) filepos = min(filepos, (uint32_t)(m_audioDataStart + m_audioDataSize - 1));
+        return setFilePos(filepos, indexed ? sec * 1000 : -1); // the time is resolved in processLocalFile()
+    }
 //    if(m_streamType == ST_WEBFILE) return httpRange(m_lastHost, filepos);
     return false;
 }
@@ -4797,6 +5255,10 @@ bool Audio::setTimeOffset(int sec) { // fast forward or rewind the current posit
     if(m_dataMode == AUDIO_LOCALFILE && !audiofile) return false;
     if(!m_avr_bitrate) return false;
     if(m_codec == CODEC_AAC) return false; // not impl. yet
+    if(seekIndexReady()) {
+        int32_t t = getAudioCurrentTime() + sec;
+        return setAudioPlayPosition(t < 0 ? 0 : t);
+    }
     uint32_t oneSec = m_avr_bitrate / 8;                 // bytes decoded in one sec
     int32_t  offset = oneSec * sec;                      // bytes to be wind/rewind
     uint32_t startAB = m_audioDataStart;                 // audioblock begin
@@ -4811,13 +5273,17 @@ bool Audio::setTimeOffset(int sec) { // fast forward or rewind the current posit
     return true;
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-bool Audio::setFilePos(uint32_t pos) {
+bool Audio::setFilePos(uint32_t pos, int32_t timeMs) {
     if(m_dataMode == AUDIO_LOCALFILE && !audiofile) return false;
     if(m_codec == CODEC_AAC) return false;   // not impl. yet
     memset(m_outBuff, 0, m_outbuffSize * sizeof(int16_t));
     m_validSamples = 0;
+    m_curSample = 0;
+    m_f_pcmFlush = true; // don't play the decoded frames of the old position
     m_haveNewFilePos = pos; // used in computeAudioCurrentTime()
+    m_seekTimeMs = timeMs;  // before the position: the audio task may take the position at once
     if(m_dataMode == AUDIO_LOCALFILE){
+        std::atomic_thread_fence(std::memory_order_release);
         m_resumeFilePos = pos;  // used in processLocalFile()
         return true;
     }
@@ -4856,10 +5322,22 @@ uint8_t Audio::getChannels() {
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 void Audio::reconfigI2S(){
 
+    uint32_t streamRate = getSampleRate();
+    if(getBitsPerSample() == 8 && getChannels() == 2) streamRate *= 2;
+
+    if(m_outputSampleRate) { // fixed I2S rate, no gap and no pop between streams with different sample rates
+        if(!SRC.setRates(streamRate, m_outputSampleRate)) log_e("oom, sample rate converter");
+        if(m_i2s_std_cfg.clk_cfg.sample_rate_hz == m_outputSampleRate) {
+            memset(m_filterBuff, 0, sizeof(m_filterBuff)); // Clear FilterBuffer
+            IIR_calculateCoefficients(m_gain0, m_gain1, m_gain2);
+            return;
+        }
+    }
+    else SRC.setRates(streamRate, streamRate); // bypass
+
     I2Sstop(0);
 
-    if(getBitsPerSample() == 8 && getChannels() == 2) m_i2s_std_cfg.clk_cfg.sample_rate_hz = getSampleRate() * 2;
-    else m_i2s_std_cfg.clk_cfg.sample_rate_hz = getSampleRate();
+    m_i2s_std_cfg.clk_cfg.sample_rate_hz = m_outputSampleRate ? m_outputSampleRate : streamRate;
 
     if(!m_f_commFMT) m_i2s_std_cfg.slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO);
     else             m_i2s_std_cfg.slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO);
@@ -5083,7 +5561,8 @@ void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2) { // Infi
     // G3 - gain high shelf  set between -40 ... +6 dB
     // https://www.earlevel.com/main/2012/11/26/biquad-c-source-code/
 
-    if(getSampleRate() < 1000) return; // fuse
+    uint32_t sampleRate = SRC.isBypass() ? getSampleRate() : SRC.getOutRate(); // the filters run behind the sample rate converter
+    if(sampleRate < 1000) return; // fuse
 
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -5098,8 +5577,8 @@ void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2) { // Infi
     const float FcPKEQ = 3000; // Frequency PeakEQ[Hz]
     float       FcHS = 6000;   // Frequency HighShelf[Hz]
 
-    if(getSampleRate() < FcHS * 2 - 100) { // Prevent HighShelf filter from clogging
-        FcHS = getSampleRate() / 2 - 100;
+    if(sampleRate < FcHS * 2 - 100) { // Prevent HighShelf filter from clogging
+        FcHS = sampleRate / 2 - 100;
         // according to the sampling theorem, the sample rate must be at least 2 * 6000 >= 12000Hz for a filter
         // frequency of 6000Hz. If this is not the case, the filter frequency (plus a reserve of 100Hz) is lowered
         AUDIO_INFO("Highshelf frequency lowered, from 6000Hz to %luHz", (long unsigned int)FcHS);
@@ -5107,7 +5586,7 @@ void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2) { // Infi
     float K, norm, Q, Fc, V;
 
     // LOWSHELF
-    Fc = (float)FcLS / (float)getSampleRate(); // Cutoff frequency
+    Fc = (float)FcLS / (float)sampleRate; // Cutoff frequency
     K = tanf((float)PI * Fc);
     V = powf(10, fabs(G0) / 20.0);
 
@@ -5129,7 +5608,7 @@ void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2) { // Infi
     }
 
     // PEAK EQ
-    Fc = (float)FcPKEQ / (float)getSampleRate(); // Cutoff frequency
+    Fc = (float)FcPKEQ / (float)sampleRate; // Cutoff frequency
     K = tanf((float)PI * Fc);
     V = powf(10, fabs(G1) / 20.0);
     Q = 2.5;      // Quality factor
@@ -5151,7 +5630,7 @@ void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2) { // Infi
     }
 
     // HIGHSHELF
-    Fc = (float)FcHS / (float)getSampleRate(); // Cutoff frequency
+    Fc = (float)FcHS / (float)sampleRate; // Cutoff frequency
     K = tanf((float)PI * Fc);
     V = powf(10, fabs(G2) / 20.0);
     if(G2 >= 0) { // boost
@@ -5533,7 +6012,7 @@ uint16_t Audio::readMetadata(uint16_t maxBytes, bool first) {
     if(!maxBytes) return 0; // guard
 
     if(!metalen) {
-        int b = _client->read(); // First byte of metadata?
+        int b = rxRead();        // First byte of metadata?
         metalen = b * 16;        // New count for metadata including length byte, max 4096
         pos_ml = 0;
         m_chbuf[pos_ml] = 0; // Prepare for new line
@@ -5544,7 +6023,7 @@ uint16_t Audio::readMetadata(uint16_t maxBytes, bool first) {
         return res;
     } // metalen is 0
     if(metalen < m_chbufSize) {
-        uint16_t a = _client->readBytes(&m_chbuf[pos_ml], min((uint16_t)(metalen - pos_ml), (uint16_t)(maxBytes - 1)));
+        uint16_t a = rxRead((uint8_t*)&m_chbuf[pos_ml], min((uint16_t)(metalen - pos_ml), (uint16_t)(maxBytes - 1)));
         res += a;
         pos_ml += a;
     }
@@ -5552,8 +6031,8 @@ uint16_t Audio::readMetadata(uint16_t maxBytes, bool first) {
         uint8_t c = 0;
         int8_t  i = 0;
         while(pos_ml != metalen) {
-            i = _client->read(&c, 1); // fake read
-            if(i != -1) {
+            i = rxRead(&c, 1); // fake read
+            if(i > 0) {
                 pos_ml++;
                 res++;
             }
@@ -5587,30 +6066,69 @@ uint16_t Audio::readMetadata(uint16_t maxBytes, bool first) {
 }
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 size_t Audio::chunkedDataTransfer(uint8_t* bytes) {
-    uint8_t  byteCounter = 0;
-    size_t   chunksize = 0;
-    int      b = 0;
-    uint32_t ctime = millis();
-    uint32_t timeout = 2000; // ms
-    while(true) {
-        if(ctime + timeout < millis()) {
-            log_e("timeout");
-            stopSong();
-            return 0;
-        }
-        b = _client->read();  // e.g. 0x66 0x34 0x31 0x37 0x0D 0x0A --> 62487 Bytes + CR LF
-        byteCounter++;        //      0x30 0x0D 0x0A   --> last chunk, CAN
-        if(b < 0) continue;   // -1 nothing to read
-        if(b == '\n') break;
-        if(b < '0') continue;
+    // reads the chunk size line from the staged bytes, e.g. 0x66 0x34 0x31 0x37 0x0D 0x0A --> 62487 Bytes + CR LF
+    // 0x30 0x0D 0x0A --> last chunk. The CR LF after the previous chunk and ";extensions" are skipped. A line that is
+    // not complete yet is continued with the next call (returns 0, m_f_chunkLine stays true), nothing waits here.
+    uint8_t byteCounter = 0;
+    int     b;
+    while(byteCounter < 255 && (b = rxRead()) >= 0) {
+        byteCounter++;
+        m_f_chunkLine = true;
+        if(b == '\n') {
+            if(!m_chunkLineDigits) continue; // empty line, ends the previous chunk
+            size_t chunksize = m_chunkLineSize;
+            m_chunkLineSize = 0;
+            m_chunkLineDigits = 0;
+            m_f_chunkExt = false;
+            m_f_chunkLine = false;
+            // if(m_f_Log) log_i("chunksize %d", chunksize);
+            *bytes = byteCounter;
+            return chunksize;
+        }
+        if(b == ';') m_f_chunkExt = true;
+        if(m_f_chunkExt || !isxdigit(b)) continue;
         // We have received a hexadecimal character.  Decode it and add to the result.
-        b = toupper(b) - '0'; // Be sure we have uppercase
-        if(b > 9) b = b - 7;  // Translate A..F to 10..15
-        chunksize = (chunksize << 4) + b;
+        b = toupper(b) - '0';  // Be sure we have uppercase
+        if(b > 9) b = b - 7;   // Translate A..F to 10..15
+        m_chunkLineSize = (m_chunkLineSize << 4) + b;
+        m_chunkLineDigits++;
     }
-    // if(m_f_Log) log_i("chunksize %d", chunksize);
     *bytes = byteCounter;
-    return chunksize;
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+int Audio::rxAvailable() {
+    return (m_rxLen - m_rxPos) + _client->available();
+}
+
+int Audio::rxRead() {
+    if(m_rxPos == m_rxLen) { // refill with one bulk read, a TLS record is decrypted once and not per byte
+        m_rxPos = 0;
+        m_rxLen = 0;
+        int av = _client->available();
+        if(av <= 0) return -1;
+        int n = _client->read(m_rx, min(av, (int)sizeof(m_rx)));
+        if(n <= 0) return -1;
+        m_rxLen = n;
+    }
+    return m_rx[m_rxPos++];
+}
+
+int Audio::rxRead(uint8_t* buf, size_t len) {
+    size_t n = min(len, (size_t)(m_rxLen - m_rxPos)); // bytes left over from the header or a chunk line
+    memcpy(buf, m_rx + m_rxPos, n);
+    m_rxPos += n;
+    if(n < len && _client->available() > 0) { // the rest goes from the socket straight into buf (InBuff)
+        int r = _client->read(buf + n, len - n);
+        if(r > 0) n += r;
+    }
+    return n;
+}
+
+void Audio::rxFlush() {
+    m_rxPos = 0;
+    m_rxLen = 0;
+    if(_client) while(_client->available() > 0 && _client->read(m_rx, sizeof(m_rx)) > 0) {}
 }
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 bool Audio::readID3V1Tag() {
@@ -6000,6 +6518,62 @@ uint32_t Audio::m4a_correctResumeFilePos(uint32_t resumeFilePos) {
     return pos;
 }
 //-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+void Audio::setSeekIndex(bool enable, bool cache) {
+    // the index is made while the file plays, from "<file>.sidx" if it matches, otherwise from the file itself (MP3: all
+    // frame headers, M4A: stsz), FLAC files bring it along in the SEEKTABLE. Takes effect with the next file.
+    m_f_seekIndex = enable;
+    m_f_seekCache = cache;
+}
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+void Audio::setReadAhead(bool enable, uint16_t blockSize) {
+    // local files are read by a task into two blocks of blockSize (sector multiple, internal RAM), processLocalFile()
+    // only copies from a ready block into InBuff. Starts with the next file, getReadAheadStats() shows how it goes.
+    m_f_readAhead = enable;
+    m_readAhead.setBlockSize(blockSize);
+}
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+void Audio::startSeekIndex() {
+    // MP3 and M4A: the read-ahead task loads or builds the index in steps while the file plays, on a File of its own.
+    // The seeks use the estimate until it is ready. FLAC: the SEEKTABLE of the header is ready at once, or nothing.
+    if(!m_f_seekIndex || !m_seekPath || seekIndexReady()) return;
+    if(m_codec != CODEC_MP3 && m_codec != CODEC_M4A) return;
+    m_seekFile = m_seekFs->open(m_seekPath);
+    if(!m_seekFile) {log_w("no seek index, %s can't be opened twice", m_seekPath); return;}
+    m_f_seekBuilding = false;
+    m_seekT0 = millis();
+    if(!m_readAhead.startJob(seekIndexJob, this)) m_seekFile.close();
+}
+
+bool Audio::seekIndexJob(void* param) {
+    return static_cast<Audio*>(param)->seekIndexStep();
+}
+
+bool Audio::seekIndexStep() { // read-ahead task, stopSong() waits for a running step
+    uint32_t date = (uint32_t)m_seekFile.getLastWrite();
+    if(!m_f_seekBuilding) {
+        if(m_f_seekCache && m_seekIndex.load(*m_seekFs, m_seekPath, m_fileSize, m_audioDataStart, date)) {
+            log_i("seek index: %u entries from cache", m_seekIndex.count());
+            m_seekFile.close();
+            m_f_seekIndexReady.store(true, std::memory_order_release);
+            return false;
+        }
+        bool ok = false;
+        if(m_codec == CODEC_MP3) ok = m_seekIndex.beginMp3(m_audioDataStart, min((uint32_t)m_audioDataSize, (uint32_t)(m_fileSize - m_audioDataStart)));
+        if(m_codec == CODEC_M4A) ok = m_seekIndex.beginStsz(m_stsz_position, m_stsz_numEntries, getSampleRate());
+        if(!ok) {log_w("no seek index"); m_seekFile.close(); return false;}
+        m_f_seekBuilding = true;
+        return true;
+    }
+    int8_t r = m_seekIndex.build(m_seekFile);
+    if(r == SeekIndex::BUILD_MORE) return true;
+    m_seekFile.close();
+    if(r == SeekIndex::BUILD_FAILED) {log_w("no seek index"); return false;}
+    log_i("seek index: %u entries in %lu ms", m_seekIndex.count(), (long unsigned)(millis() - m_seekT0));
+    if(m_f_seekCache) m_seekIndex.save(*m_seekFs, m_seekPath, m_fileSize, m_audioDataStart, date);
+    m_f_seekIndexReady.store(true, std::memory_order_release);
+    return false;
+}
+//-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 uint32_t Audio::ogg_correctResumeFilePos(uint32_t resumeFilePos) {
     // The starting point is the next OggS magic word
     vTaskDelay(1);
@@ -6149,8 +6723,9 @@ uint8_t Audio::determineOggCodec(uint8_t* data, uint16_t len) {
     return CODEC_NONE;
 }
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// separate task for decoding and outputting the data. 'playAudioData()' is started periodically and fetches the data from the InBuffer. This ensures
-// that the I2S-DMA is always sufficiently filled, even if the Arduino 'loop' is stuck.
+// separate task for decoding and outputting the data. 'playAudioData()' fetches the data from the InBuffer. This ensures that the I2S-DMA is always
+// sufficiently filled, even if the Arduino 'loop' is stuck. The task sleeps until there is something to do: the I2S driver notifies it from
+// the ISR when a DMA descriptor has been sent (see i2sOnSent), 'loop()' notifies it when new data has arrived in the InBuffer.
 //------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 void Audio::setAudioTaskCore(uint8_t coreID){  // Recommendation:If the ARDUINO RUNNING CORE is 1, the audio task should be core 0 or vice versa
@@ -6190,8 +6765,9 @@ void Audio::stopAudioTask()  {
     xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ);
     m_f_audioTaskIsRunning = false;
     if (m_audioTaskHandle != nullptr) {
-        vTaskDelete(m_audioTaskHandle);
-        m_audioTaskHandle = nullptr;
+        TaskHandle_t handle = m_audioTaskHandle;
+        m_audioTaskHandle = nullptr; // i2sOnSent() must not notify a deleted task
+        vTaskDelete(handle);
     }
     xSemaphoreGive(mutex_audioTask);
 }
@@ -6202,24 +6778,96 @@ void Audio::taskWrapper(void *param) {
 }
 
 void Audio::audioTask() {
+    uint32_t loadTime = micros();
+    uint32_t busyTime = 0;
+    bool     f_wait   = true;
     while (m_f_audioTaskIsRunning) {
-        vTaskDelay(1 / portTICK_PERIOD_MS);  // periodically every x ms
-        performAudioTask();
+        if(f_wait) {
+            m_f_waitForDMA = m_outChunkValid > 0; // only a chunk that I2S didn't take needs a free DMA descriptor
+            // The 1000 ms wait can't stall playback: it is used only while no stream runs, and then nothing is waiting
+            // for the task except mixer voices, which wake it in playPCM(), playWAV() and playTone(). A new stream is
+            // woken by loop() as soon as its first bytes land in the InBuffer, stop and pauseResume() wake it too.
+            // While a stream runs, loop() and i2sOnSent() wake the task, the 20 ms only covers a lost notification.
+            ulTaskNotifyTake(pdTRUE, m_f_running ? 20 / portTICK_PERIOD_MS : 1000 / portTICK_PERIOD_MS); // timeout is a fuse only
+            m_f_waitForDMA = false;
+        }
+        uint32_t t = micros();
+        f_wait = !performAudioTask();
+        busyTime += micros() - t;
+
+        t = micros() - loadTime;
+        if(t >= 1000000) { // CPU load of this task in permille, averaged over one second
+            m_audioTaskLoad = (uint64_t)busyTime * 1000 / t;
+            busyTime = 0;
+            loadTime = micros();
+        }
     }
     vTaskDelete(nullptr);  // Delete this task
 }
 
-void Audio::performAudioTask() {
-    if(!m_f_running) return;
-    if(!m_f_stream) return;
-    if(m_codec == CODEC_NONE) return; // wait for codec is  set
-    if(m_codec == CODEC_OGG)  return; // wait for FLAC, VORBIS or OPUS
+bool Audio::performAudioTask() { // returns true if there was progress, false if the task has to wait for data or for a free DMA descriptor
+    if(m_f_pcmFlush) { // requested by stopSong() or setFilePos(), only this task reads and writes the PCM FIFO
+        PcmBuff.reset();
+        SRC.reset();
+        m_outChunkValid = 0;
+        m_f_pcmUnderrun = true;
+        m_f_pcmFlush = false;
+    }
+    if(!m_f_running && !mixerActive()) return false;
     xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ);
-    while(m_validSamples) {vTaskDelay(20 / portTICK_PERIOD_MS); playChunk();} // I2S buffer full
-    playAudioData();
+    bool progress = playChunk() > 0; // output stage first, keeps the DMA busy while decoding ahead
+    if(m_f_running && m_f_stream && m_codec != CODEC_NONE && m_codec != CODEC_OGG) { // decode stage, wait for codec is set, OGG: wait for FLAC, VORBIS or OPUS
+        if(m_validSamples) {
+            int16_t validSamples = m_validSamples;
+            pushPcm(); // rest of the last frame, PCM FIFO was full
+            progress |= m_validSamples != validSamples;
+        }
+        if(!m_validSamples && PcmBuff.framesFree() > 0) {
+            uint32_t readPos = InBuff.getReadPos();
+            bool     playing = m_f_playing;
+            playAudioData();
+            progress |= InBuff.getReadPos() != readPos || m_f_playing != playing; // frame decoded or syncword found
+        }
+    }
     xSemaphoreGive(mutex_audioTask);
+    return progress;
 }
+
+void Audio::wakeAudioTask() {
+    if(m_audioTaskHandle) xTaskNotifyGive(m_audioTaskHandle);
+}
+
+bool IRAM_ATTR Audio::i2sOnSent(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) { // ISR context
+    Audio* self = static_cast<Audio*>(user_ctx);
+    if(!self->m_f_waitForDMA || !self->m_audioTaskHandle) return false; // auto_clear sends silence all the time, wake up on demand only
+    BaseType_t highTaskWoken = pdFALSE;
+    self->m_f_waitForDMA = false;
+    vTaskNotifyGiveFromISR(self->m_audioTaskHandle, &highTaskWoken);
+    return highTaskWoken == pdTRUE;
+}
+
 uint32_t Audio::getHighWatermark(){
     UBaseType_t highWaterMark = uxTaskGetStackHighWaterMark(m_audioTaskHandle);
     return highWaterMark; // dwords
 }
+
+void Audio::getPcmStats(pcmStats_t* stats, bool reset){
+    stats->size      = PcmBuff.size();
+    stats->filled    = PcmBuff.framesFilled();
+    stats->filledMs  = m_sampleRate ? (uint64_t)stats->filled * 1000 / m_sampleRate : 0;
+    stats->minFilled = m_pcmMinFilled == UINT32_MAX ? stats->filled : m_pcmMinFilled;
+    stats->underruns = m_pcmUnderruns;
+    stats->framesOut = m_pcmFramesOut;
+    stats->srcCycles = m_srcFrames ? m_srcCycles / m_srcFrames : 0;
+    if(reset) {
+        m_srcCycles = 0;
+        m_srcFrames = 0;
+        m_pcmMinFilled = UINT32_MAX;
+        m_pcmUnderruns = 0;
+        m_pcmFramesOut = 0;
+    }
+}
+
+uint16_t Audio::getAudioTaskLoad(){
+    return m_audioTaskLoad; // permille
+}
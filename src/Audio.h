@@ -26,6 +26,10 @@
 #include <atomic>
 #include <codecvt>
 #include <locale>
+#include "resampler/resampler.h"
+#include "seek_index/seek_index.h"
+#include "file_reader/file_reader.h"
+#include "pcm_recorder/pcm_recorder.h"
 
 #if ESP_ARDUINO_VERSION_MAJOR >= 3
 #include <NetworkClient.h>
@@ -133,6 +137,43 @@ protected:
 };
 //----------------------------------------------------------------------------------------------------------------------
 
+class PcmBuffer {
+// FIFO for decoded PCM between the decoder and the I2S output stage, one frame = interleaved int16_t L/R.
+// Allocated in PSRAM, if PSRAM is not available or has not enough space the FIFO will be allocated in RAM with
+// reduced size. One writer and one reader, the counters run free, the size is rounded up to a power of two.
+//
+//  m_buffer            m_rdCnt % m_size           m_wrCnt % m_size
+//   |                       |<------framesFilled----->|
+//   ▼                       ▼                         ▼
+//   ----------------------------------------------------------------------------------
+//   |                             <--m_size (frames)-->                              |
+//   ----------------------------------------------------------------------------------
+
+public:
+    PcmBuffer();                                // constructor
+    ~PcmBuffer();                               // frees the buffer
+    size_t   init(size_t framesPSRAM, size_t framesRAM); // allocate, returns the size in frames
+    bool     isInitialized() { return m_f_init; };
+    bool     havePSRAM() { return m_f_psram; };
+    size_t   size() { return m_size; };         // capacity in frames
+    size_t   framesFilled();                    // frames ready for output
+    size_t   framesFree();                      // frames that can be written
+    size_t   write(const int16_t* src, size_t frames); // returns the number of frames written
+    size_t   read(int16_t* dst, size_t frames); // returns the number of frames read
+    void     reset();                           // discard all frames, writer and reader must be idle
+
+protected:
+    size_t   roundUpPow2(size_t n);
+
+    int16_t*              m_buffer = NULL;
+    size_t                m_size   = 0;
+    std::atomic<uint32_t> m_wrCnt  = {0};
+    std::atomic<uint32_t> m_rdCnt  = {0};
+    bool                  m_f_init  = false;
+    bool                  m_f_psram = false;
+};
+//----------------------------------------------------------------------------------------------------------------------
+
 static const size_t AUDIO_STACK_SIZE = 3300;
 static StaticTask_t __attribute__((unused)) xAudioTaskBuffer;
 static StackType_t  __attribute__((unused)) xAudioStack[AUDIO_STACK_SIZE];
@@ -140,20 +181,27 @@ static StackType_t  __attribute__((unused)) xAudioStack[AUDIO_STACK_SIZE];
 class Audio : private AudioBuffer{
 
     AudioBuffer InBuff; // instance of input buffer
+    PcmBuffer   PcmBuff; // decoded frames waiting for I2S
+    Resampler   SRC;     // PcmBuff (stream rate) -> I2S (output rate)
 
 public:
     Audio(uint8_t i2sPort = I2S_NUM_0);
     ~Audio();
     void setBufsize(int rambuf_sz, int psrambuf_sz);
-    bool openai_speech(const String& api_key, const String& model, const String& input, const String& voice, const String& response_format, const String& speed);
+    bool openai_speech(const String& api_key, const String& model, const String& input, const String& voice, const String& response_format, const String& speed, const String& instructions = "");
     bool connecttohost(const char* host, const char* user = "", const char* pwd = "");
     bool connecttospeech(const char* speech, const char* lang);
     bool connecttoFS(fs::FS &fs, const char* path, int32_t m_fileStartPos = -1);
     bool setFileLoop(bool input);//TEST loop
     void setConnectionTimeout(uint16_t timeout_ms, uint16_t timeout_ms_ssl);
     bool setAudioPlayPosition(uint16_t sec);
-    bool setFilePos(uint32_t pos);
+    bool setFilePos(uint32_t pos, int32_t timeMs = -1); // timeMs: the play time at pos if known (seek index)
     bool setTimeOffset(int sec);
+    void setSeekIndex(bool enable, bool cache = true); // local MP3/FLAC/M4A: exact seeks from a time -> position index
+    uint16_t getSeekIndexEntries() {return m_seekIndex.count();}
+    void setReadAhead(bool enable, uint16_t blockSize = 4096); // local files: a task reads ahead, see FileReader
+    void getReadAheadStats(FileReader::stats_t* stats, bool reset = false) {m_readAhead.getStats(stats, reset);}
+    void setRecorder(PcmRecorder* recorder) {m_recorder = recorder;} // gets what goes to I2S, NULL: off
     bool setPinout(uint8_t BCLK, uint8_t LRC, uint8_t DOUT, int8_t MCLK = I2S_GPIO_UNUSED);
     bool pauseResume();
     bool isRunning() {return m_f_running;}
@@ -182,6 +230,29 @@ public:
     uint32_t inBufferFilled(); // returns the number of stored bytes in the inputbuffer
     uint32_t inBufferFree();   // returns the number of free bytes in the inputbuffer
     uint32_t inBufferSize();   // returns the size of the inputbuffer in bytes
+    typedef struct {
+        uint32_t size;        // capacity of the PCM FIFO in frames
+        uint32_t filled;      // decoded frames waiting for I2S
+        uint32_t filledMs;    // the same in milliseconds at the current sample rate
+        uint32_t minFilled;   // low-water mark in frames since the last reset of the statistics
+        uint32_t underruns;   // FIFO ran dry while the stream was still delivering data
+        uint32_t framesOut;   // frames written to I2S
+        uint32_t srcCycles;   // CPU cycles per output frame of the sample rate converter, 0 if not used
+    } pcmStats_t;
+    void setPcmBufferTime(uint16_t ms); // size of the decoded PCM FIFO, must be called before the first connect
+    void setOutputSampleRate(uint32_t sampleRate); // fixed I2S rate, streams are resampled, 0: I2S follows the stream
+    void setDecoderHotBudget(int32_t bytes); // internal SRAM for the hot decoder state, -1: auto, 0: all in PSRAM
+
+    // mixer, the stream is voice 0, the voices below are played on top of it (chimes, earcons, prompt tones)
+    // gain in percent, duck: the stream is attenuated to the duck level while the voice plays, returns voice or -1
+    int8_t playPCM(const int16_t* pcm, uint32_t frames, uint32_t sampleRate, uint8_t channels, uint8_t gain = 100, bool duck = false);
+    int8_t playWAV(fs::FS &fs, const char* path, uint8_t gain = 100, bool duck = false); // 16 bit PCM, loaded into PSRAM
+    int8_t playTone(uint16_t freq, uint16_t ms, uint8_t gain = 30, bool duck = false);
+    void   stopVoice(int8_t voice);
+    bool   isVoiceActive(int8_t voice);
+    void   setVoiceGain(int8_t voice, uint8_t gain);
+    void   setDuckLevel(uint8_t percent); // stream level while a ducking voice plays, default 30%
+    void getPcmStats(pcmStats_t* stats, bool reset = false);
     void setTone(int8_t gainLowPass, int8_t gainBandPass, int8_t gainHighPass);
     void setI2SCommFMT_LSB(bool commFMT);
     int getCodec() {return m_codec;}
@@ -237,7 +308,7 @@ private:
   bool            setChannels(int channels);
   void            reconfigI2S();
   bool            setBitrate(int br);
-  void            playChunk();
+  uint32_t        playChunk();      // output stage, PCM FIFO -> I2S
   void            computeVUlevel(int16_t sample[2]);
   void            computeLimit();
   void            Gain(int16_t* sample);
@@ -250,7 +321,7 @@ private:
   void            IIR_filterChain0(int16_t iir_in[2], bool clear = false);
   void            IIR_filterChain1(int16_t iir_in[2], bool clear = false);
   void            IIR_filterChain2(int16_t iir_in[2], bool clear = false);
-  inline uint32_t streamavail() { return _client ? _client->available() : 0; }
+  inline uint32_t streamavail() { return _client ? rxAvailable() : 0; }
   void            IIR_calculateCoefficients(int8_t G1, int8_t G2, int8_t G3);
   bool            ts_parsePacket(uint8_t* packet, uint8_t* packetStart, uint8_t* packetLength);
   uint32_t        find_m4a_atom(uint32_t fileSize, const char* atomType, uint32_t depth = 0);
@@ -259,21 +330,41 @@ private:
 public:
   void            setAudioTaskCore(uint8_t coreID);
   uint32_t        getHighWatermark();
+  uint16_t        getAudioTaskLoad(); // CPU load of the audio task in permille (averaged over 1s)
 private:
   void            startAudioTask(); // starts a task for decode and play
   void            stopAudioTask();  // stops task for audio
   static void     taskWrapper(void *param);
   void            audioTask();
-  void            performAudioTask();
+  bool            performAudioTask();
+  void            pushPcm();        // decoded samples from m_outBuff into the PCM FIFO
+  bool            pcmPending();     // decoded samples not yet written to I2S, the delay line of SRC included
+  void            logDecodeStats(); // decoder cycles per frame and memory of the stream that ends
+  int8_t          allocVoice();
+  bool            mixerActive();
+  uint16_t        mixVoices(uint16_t frames);  // stream frames in m_outChunk + voices -> m_outChunk, returns frames
+  uint16_t        renderVoice(uint8_t v, int16_t* out, uint16_t frames);
+  void            releaseVoice(uint8_t v);
+  int16_t         softClip(int32_t x);
+  void            wakeAudioTask();  // new data in InBuff, the task can decode
+  static bool     i2sOnSent(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx); // I2S DMA callback (ISR)
 
   //+++ W E B S T R E A M  -  H E L P   F U N C T I O N S +++
   uint16_t readMetadata(uint16_t b, bool first = false);
   size_t   chunkedDataTransfer(uint8_t* bytes);
+  int      rxAvailable();                       // staged bytes + bytes in the socket
+  int      rxRead();                            // one byte, -1: nothing there
+  int      rxRead(uint8_t* buf, size_t len);    // staged bytes first, then straight from the socket
+  void     rxFlush();
   bool     readID3V1Tag();
   boolean  streamDetection(uint32_t bytesAvail);
   void     seek_m4a_stsz();
   void     seek_m4a_ilst();
   uint32_t m4a_correctResumeFilePos(uint32_t resumeFilePos);
+  bool     seekIndexReady() { return m_f_seekIndex && m_f_seekIndexReady.load(std::memory_order_acquire); }
+  void     startSeekIndex();
+  static bool seekIndexJob(void* param);
+  bool     seekIndexStep();
   uint32_t ogg_correctResumeFilePos(uint32_t resumeFilePos);
   int32_t  flac_correctResumeFilePos(uint32_t resumeFilePos);
   int32_t  mp3_correctResumeFilePos(uint32_t resumeFilePos);
@@ -331,7 +422,7 @@ void trim(char *str) {
         const char *p = base;
         for (; startIndex > 0; startIndex--)
             if (*p++ == '\0') return -1;
-        char* pos = strstr(p, str);
+        const char* pos = strstr(p, str);
         if (pos == nullptr) return -1;
         return pos - base;
     }
@@ -341,7 +432,7 @@ void trim(char *str) {
         const char *p = base;
         for (; startIndex > 0; startIndex--)
             if (*p++ == '\0') return -1;
-        char *pos = strchr(p, ch);
+        const char* pos = strchr(p, ch);
         if (pos == nullptr) return -1;
         return pos - base;
     }
@@ -593,6 +684,7 @@ private:
     const size_t    m_frameSizeOPUS   = 1024;
     const size_t    m_frameSizeVORBIS = 4096 * 2;
     const size_t    m_outbuffSize     = 4096 * 2;
+    const size_t    m_outChunkSize    = 256;        // frames, one DMA descriptor
 
     static const uint8_t m_tsPacketSize  = 188;
     static const uint8_t m_tsHeaderSize  = 4;
@@ -638,6 +730,7 @@ private:
     uint8_t         m_M4A_chConfig = 0;             // set in read_M4A_Header
     uint16_t        m_M4A_sampleRate = 0;           // set in read_M4A_Header
     int16_t*        m_outBuff = NULL;               // Interleaved L/R
+    int16_t*        m_outChunk = NULL;              // Interleaved L/R, output stage, RAM
     int16_t         m_validSamples = {0};           // #144
     int16_t         m_curSample{0};
     uint16_t        m_dataMode{0};                  // Statemaschine
@@ -653,6 +746,13 @@ private:
     uint32_t        m_flacTotalSamplesInStream = 0; // can be read out in the FLAC file header
     uint32_t        m_metaint = 0;                  // Number of databytes between metadata
     uint32_t        m_chunkcount = 0 ;              // Counter for chunked transfer
+    uint32_t        m_chunkLineSize = 0;            // chunk size line "1f40;ext\r\n" read so far
+    uint8_t         m_chunkLineDigits = 0;          // hex digits seen in that line, 0: CR LF of the previous chunk
+    bool            m_f_chunkExt = false;           // ';' seen, the rest of the line is ignored
+    bool            m_f_chunkLine = false;          // a chunk size line is not complete yet
+    uint8_t         m_rx[1024];                     // socket staging buffer, bulk reads for header and chunk lines
+    uint16_t        m_rxPos = 0;
+    uint16_t        m_rxLen = 0;
     uint32_t        m_t0 = 0;                       // store millis(), is needed for a small delay
     uint32_t        m_contentlength = 0;            // Stores the length if the stream comes from fileserver
     uint32_t        m_bytesNotDecoded = 0;          // pictures or something else that comes with the stream
@@ -664,6 +764,7 @@ private:
     uint32_t        m_stsz_position = 0;            // pos of stsz atom within file
     uint32_t        m_haveNewFilePos = 0;           // user changed the file position
     uint32_t        m_sumBytesDecoded = 0;          // used for streaming
+    uint32_t        m_speechStart = 0;              // millis() of the last openai_speech() request until the first samples
     uint32_t        m_webFilePos = 0;               // same as audiofile.position() for SD files
     bool            m_f_metadata = false;           // assume stream without metadata
     bool            m_f_unsync = false;             // set within ID3 tag but not used
@@ -696,7 +797,56 @@ private:
     bool            m_f_eof = false;                // end of file
     bool            m_f_lockInBuffer = false;       // lock inBuffer for manipulation
     bool            m_f_audioTaskIsDecoding = false;
+    volatile bool   m_f_waitForDMA = false;         // audio task waits for a free DMA descriptor, set and cleared by the task, cleared in i2sOnSent()
+    uint16_t        m_audioTaskLoad = 0;            // permille, see getAudioTaskLoad()
+    uint32_t        m_outputSampleRate = 0;         // see setOutputSampleRate()
+    uint64_t        m_srcCycles = 0;                // statistics of the sample rate converter
+    uint32_t        m_srcFrames = 0;
+    uint64_t        m_decodeCycles = 0;             // decoder time of the current stream, logDecodeStats()
+    uint32_t        m_decodeFrames = 0;
+    static const uint8_t AUDIO_MIX_VOICES = 3;      // voices on top of the stream
+    enum : uint8_t {VOICE_IDLE = 0, VOICE_ACTIVE = 1, VOICE_STOP = 2, VOICE_CLAIMED = 3};
+    typedef struct {
+        std::atomic<uint8_t> state;                 // written by the user (IDLE -> CLAIMED -> ACTIVE, -> STOP), released by the audio task
+        const int16_t*  pcm;                        // clip, NULL for a tone
+        int16_t*        owned;                      // clip loaded by playWAV(), freed with the voice
+        uint32_t        frames;                     // clip length or tone length in frames
+        uint32_t        pos;                        // next frame to play
+        uint32_t        sampleRate;
+        uint8_t         channels;
+        float           phase;                      // tone
+        float           phaseInc;
+        int32_t         gain;                       // Q15
+        bool            duck;
+    } voice_t;
+    voice_t         m_voice[AUDIO_MIX_VOICES] = {};
+    Resampler       m_voiceSRC[AUDIO_MIX_VOICES];   // voice rate -> I2S rate
+    int32_t*        m_mixBuff = NULL;               // Interleaved L/R, m_outChunkSize frames, allocated with m_outChunk
+    int16_t*        m_voiceChunk = NULL;            // Interleaved L/R, m_outChunkSize frames, allocated with m_outChunk
+    int32_t         m_duckGain = 32768;             // Q15, current gain of the stream, ramps to m_duckLevel and back
+    int32_t         m_duckLevel = 32768 * 30 / 100; // Q15
+    std::atomic<bool> m_f_pcmFlush = {false};       // discard the PCM FIFO, done by the audio task
+    bool            m_f_pcmUnderrun = true;         // FIFO is empty, no new underrun will be counted
+    uint16_t        m_pcmBuffTime = 500;            // ms, see setPcmBufferTime()
+    uint16_t        m_outChunkValid = 0;            // processed frames in m_outChunk, not yet consumed by I2S
+    uint16_t        m_outChunkPos = 0;              // first frame in m_outChunk to write
+    uint32_t        m_pcmUnderruns = 0;
+    uint32_t        m_pcmMinFilled = UINT32_MAX;
+    uint32_t        m_pcmFramesOut = 0;
     bool            m_f_acceptRanges = false;
+    SeekIndex       m_seekIndex;                    // see setSeekIndex()
+    fs::FS*         m_seekFs = NULL;                // file system of the index cache
+    char*           m_seekPath = NULL;              // audio file of the index, "<path>.sidx" is the cache
+    bool            m_f_seekIndex = false;          // resolve seeks of local files with the index
+    bool            m_f_seekCache = true;           // load and save "<path>.sidx"
+    std::atomic<bool> m_f_seekIndexReady = {false}; // the index is complete, the seeks may use it
+    bool            m_f_seekBuilding = false;       // the job walks the file, else it tries the cache first
+    File            m_seekFile;                     // own handle of the index job
+    uint32_t        m_seekT0 = 0;
+    std::atomic<int32_t> m_seekTimeMs = {-1};       // time of the pending seek, -1: the position is all we know
+    FileReader      m_readAhead;                    // see setReadAhead()
+    bool            m_f_readAhead = false;
+    PcmRecorder*    m_recorder = NULL;              // see setRecorder()
     uint8_t         m_f_channelEnabled = 3;         //
     uint32_t        m_audioFileDuration = 0;
     float           m_audioCurrentTime = 0;
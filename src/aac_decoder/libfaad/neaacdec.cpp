@@ -136,8 +136,10 @@ int8_t can_decode_ot(const uint8_t object_type) {
     return -1;
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+static uint32_t s_allocCount = 0; /* heap allocations of the library, NeAACDecGetAllocCount() */
 void* faad_malloc(size_t size) {
     char* ps_str = NULL;
+    s_allocCount++;
     if(psramFound()){ps_str = (char*) ps_malloc(size);}
     else             {ps_str = (char*)    malloc(size);}
     return ps_str;
@@ -145,6 +147,7 @@ void* faad_malloc(size_t size) {
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void* faad_calloc(size_t len, size_t size) {
     char* ps_str = NULL;
+    s_allocCount++;
     if(psramFound()){ps_str = (char*) ps_calloc(len, size);}
     else            {ps_str = (char*)    calloc(len, size);}
     return ps_str;
@@ -156,6 +159,44 @@ void faad_free(freeType** b){
     if(*b){free(*b); *b = NULL;}
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/* scratch buffers of the decode path come from the workspace of the running decoder (allocated in NeAACDecOpen), taken
+   from the top like a stack. Releasing a buffer also releases all buffers above it, the nested buffers of a function are
+   released together at its end. If the workspace is exhausted or missing the buffer comes from the heap. */
+#define FAAD_WS_ALIGN 8
+static faad_workspace* s_ws = NULL; /* set by NeAACDecInit and aac_frame_decode */
+
+void* faad_ws_malloc(size_t size) {
+    faad_workspace* ws = s_ws;
+    size = (size + FAAD_WS_ALIGN - 1) & ~(FAAD_WS_ALIGN - 1);
+    if(ws && ws->base && ws->top + size <= ws->size) {
+        void* p = ws->base + ws->top;
+        ws->top += size;
+        if(ws->top > ws->peak) ws->peak = ws->top;
+        return p;
+    }
+    if(ws) ws->overflows++;
+    return faad_malloc(size);
+}
+//——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void* faad_ws_calloc(size_t len, size_t size) {
+    void* p = faad_ws_malloc(len * size);
+    if(p) memset(p, 0, len * size);
+    return p;
+}
+//——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+template <typename freeType>
+void faad_ws_free(freeType** b){
+    faad_workspace* ws = s_ws;
+    uint8_t* p = (uint8_t*)*b;
+    if(!p) return;
+    if(ws && p >= ws->base && p < ws->base + ws->size) {
+        uint32_t ofs = p - ws->base;
+        if(ofs < ws->top) ws->top = ofs; // else: already released together with a buffer below
+    }
+    else free(p);
+    *b = NULL;
+}
+//——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 const uint8_t Parity[256] = { // parity
     0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
     1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 0, 1,
@@ -436,6 +477,36 @@ uint32_t NeAACDecGetCapabilities(void) {
 const unsigned char mes[] = {0x67, 0x20, 0x61, 0x20, 0x20, 0x20, 0x6f, 0x20, 0x72, 0x20, 0x65, 0x20, 0x6e, 0x20, 0x20, 0x20, 0x74,
                              0x20, 0x68, 0x20, 0x67, 0x20, 0x69, 0x20, 0x72, 0x20, 0x79, 0x20, 0x70, 0x20, 0x6f, 0x20, 0x63};
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/* deepest nesting of the scratch buffers, the comments name the functions that take them */
+static uint32_t faad_workspace_size() {
+#define WS(n) ((uint32_t)(((n) + FAAD_WS_ALIGN - 1) & ~(FAAD_WS_ALIGN - 1)))
+#define WS_MAX(a, b) ((a) > (b) ? (a) : (b))
+    uint32_t mdct = WS(512 * sizeof(complex_t));                                        // faad_imdct, faad_mdct
+    uint32_t filt = WS(2 * 1024 * sizeof(real_t)) + mdct;                               // ifilter_bank, filter_bank_ltp
+    uint32_t ltp  = 2 * WS(2048 * sizeof(real_t)) + filt;                               // lt_prediction
+    uint32_t recon = WS_MAX(filt, ltp);
+    uint32_t syntax = WS(512 * sizeof(codeword_t)) + WS(512 * sizeof(bits_t));          // reordered_spectral_data
+#ifdef SBR_DEC
+    uint32_t tables = WS_MAX(4 * WS(64 * sizeof(int32_t)), WS(100 * sizeof(int32_t)) + WS(64)); // master_/limiter_frequency_table
+    syntax = WS_MAX(syntax, tables);
+    uint32_t gen  = 2 * WS(64 * sizeof(complex_t)) + WS(64 * sizeof(real_t)) + tables;  // hf_generation
+    uint32_t adj  = WS(sizeof(sbr_hfadj_info)) + 3 * WS(MAX_M * sizeof(real_t));        // hf_adjustment, calculate_gain
+    uint32_t qmfs = WS(398 * sizeof(int32_t));                                          // DCT4_32, DST4_32
+    uint32_t chan = WS_MAX(WS_MAX(gen, adj), qmfs);
+    recon = WS_MAX(recon, WS(MAX_NTSR * 64 * sizeof(qmf_t)) + chan);                    // sbrDecodeCoupleFrame, sbrDecodeSingleFrame
+    #ifdef PS_DEC
+    uint32_t ps = 2 * WS(32 * 32 * sizeof(qmf_t)) + 2 * WS(32 * 34 * sizeof(real_t));   // ps_decode, ps_decorrelate
+    recon = WS_MAX(recon, 2 * WS(38 * 64 * sizeof(qmf_t)) + WS_MAX(chan, ps));          // sbrDecodeSingleFramePS
+    #endif
+#endif
+    recon += 2 * WS(1024 * sizeof(real_t));                                              // reconstruct_channel_pair
+    uint32_t ele = WS(sizeof(element)) + 2 * WS(1024 * sizeof(int16_t)) + WS_MAX(syntax, recon); // channel_pair_element
+    uint32_t init = WS(sizeof(adif_header)) + WS(sizeof(adts_header)) + WS(sizeof(bitfile)); // NeAACDecInit
+    return WS_MAX(ele, init);
+#undef WS
+#undef WS_MAX
+}
+//——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 NeAACDecHandle      NeAACDecOpen(void) {
     uint8_t         i;
     NeAACDecStruct* hDecoder = NULL;
@@ -480,6 +551,12 @@ NeAACDecHandle      NeAACDecOpen(void) {
     for(i = 0; i < MAX_SYNTAX_ELEMENTS; i++) { hDecoder->sbr[i] = NULL; }
 #endif
     hDecoder->drc = drc_init(REAL_CONST(1.0), REAL_CONST(1.0));
+    hDecoder->ws.size = faad_workspace_size();
+    hDecoder->ws.base = (uint8_t*)faad_malloc(hDecoder->ws.size);
+    if(!hDecoder->ws.base) {
+        log_e("libfaad: no memory for the %u bytes workspace, scratch buffers come from the heap", hDecoder->ws.size);
+        hDecoder->ws.size = 0;
+    }
     return hDecoder;
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -541,10 +618,11 @@ long NeAACDecInit(NeAACDecHandle hpDecoder, unsigned char* buffer, uint32_t buff
     // bitfile         ld;
     // adif_header     adif;
     // adts_header     adts;
-    adif_header* adif = (adif_header*)faad_malloc(1 * sizeof(adif_header));
-    adts_header* adts = (adts_header*)faad_malloc(1 * sizeof(adts_header));
-    bitfile*       ld = (bitfile*)faad_malloc(1 * sizeof(bitfile));
     NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+    if(hDecoder) {s_ws = &hDecoder->ws; s_ws->top = 0;}
+    adif_header* adif = (adif_header*)faad_ws_malloc(1 * sizeof(adif_header));
+    adts_header* adts = (adts_header*)faad_ws_malloc(1 * sizeof(adts_header));
+    bitfile*       ld = (bitfile*)faad_ws_malloc(1 * sizeof(bitfile));
     if((hDecoder == NULL) || (samplerate == NULL) || (channels == NULL) || (buffer_size == 0)){
         ret = -1;
         goto exit;
@@ -640,9 +718,9 @@ long NeAACDecInit(NeAACDecHandle hpDecoder, unsigned char* buffer, uint32_t buff
     ret = bits;
     goto exit;
 exit:
-    faad_free(&ld);
-    faad_free(&adif);
-    faad_free(&adts);
+    faad_ws_free(&adif);
+    faad_ws_free(&adts);
+    faad_ws_free(&ld);
     return ret;
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -771,9 +849,19 @@ void NeAACDecClose(NeAACDecHandle hpDecoder) {
         if (hDecoder->sbr[i]) sbrDecodeEnd(hDecoder->sbr[i]);
     }
 #endif
+    if (s_ws == &hDecoder->ws) s_ws = NULL;
+    if (hDecoder->ws.base) faad_free(&hDecoder->ws.base);
     if (hDecoder) faad_free(&hDecoder);
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/* heap allocations of the library since boot, does not change while a stream is decoded */
+uint32_t NeAACDecGetAllocCount(void) { return s_allocCount; }
+//——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint32_t NeAACDecGetWorkspacePeak(NeAACDecHandle hpDecoder) {
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+    return hDecoder ? hDecoder->ws.peak : 0;
+}
+//——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void NeAACDecPostSeekReset(NeAACDecHandle hpDecoder, long frame) {
     NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
     if(hDecoder) {
@@ -1009,6 +1097,8 @@ void* aac_frame_decode(NeAACDecStruct* hDecoder, NeAACDecFrameInfo* hInfo, unsig
 #endif
     /* safety checks */
     if((hDecoder == NULL) || (hInfo == NULL) || (buffer == NULL)) { return NULL; }
+    s_ws = &hDecoder->ws;
+    s_ws->top = 0; /* drops buffers an error path of the previous frame left behind */
 #if 0
     printf("%d\n", buffer_size*8);
 #endif
@@ -3879,7 +3969,7 @@ void faad_imdct(mdct_info* mdct, real_t* X_in, real_t* X_out) {
     #endif
 #endif
     // complex_t Z1[512];
-    complex_t* Z1 = (complex_t*)ps_malloc(512 * sizeof(complex_t));
+    complex_t* Z1 = (complex_t*)faad_ws_malloc(512 * sizeof(complex_t));
     complex_t*      sincos = mdct->sincos;
     uint16_t N = mdct->N;
     uint16_t N2 = N >> 1;
@@ -3948,7 +4038,7 @@ void faad_imdct(mdct_info* mdct, real_t* X_in, real_t* X_out) {
     mdct->fft_cycles += count1;
     mdct->cycles += (count2 - count1);
 #endif
-    faad_free(&Z1);
+    faad_ws_free(&Z1);
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef LTP_DEC
@@ -3956,7 +4046,7 @@ void faad_mdct(mdct_info* mdct, real_t* X_in, real_t* X_out) {
     uint16_t k;
     complex_t       x;
     // complex_t Z1[512];
-    complex_t* Z1 = (complex_t*)ps_malloc(512 * sizeof(complex_t));
+    complex_t* Z1 = (complex_t*)faad_ws_malloc(512 * sizeof(complex_t));
     complex_t*      sincos = mdct->sincos;
     uint16_t N = mdct->N;
     uint16_t N2 = N >> 1;
@@ -4002,7 +4092,7 @@ void faad_mdct(mdct_info* mdct, real_t* X_in, real_t* X_out) {
         X_out[N2 + n] = -IM(x);
         X_out[N - 1 - n] = RE(x);
     }
-    if(Z1)free(Z1);
+    faad_ws_free(&Z1);
 }
 #endif
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -4096,7 +4186,7 @@ void mdct(fb_info* fb, real_t* in_data, real_t* out_data, uint16_t len) {
 void ifilter_bank(fb_info* fb, uint8_t window_sequence, uint8_t window_shape, uint8_t window_shape_prev, real_t* freq_in, real_t* time_out, real_t* overlap, uint8_t object_type, uint16_t frame_len) {
     int16_t i;
     //    real_t transf_buf[2*1024] = {0};
-    real_t* transf_buf = (real_t*)faad_calloc(2 * 1024, sizeof(real_t));
+    real_t* transf_buf = (real_t*)faad_ws_calloc(2 * 1024, sizeof(real_t));
     const real_t* window_long = NULL;
     const real_t* window_long_prev = NULL;
     const real_t* window_short = NULL;
@@ -4224,7 +4314,7 @@ void ifilter_bank(fb_info* fb, uint8_t window_sequence, uint8_t window_shape, ui
     count = faad_get_ts() - count;
     fb->cycles += count;
 #endif
-    faad_free(&transf_buf);
+    faad_ws_free(&transf_buf);
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef LTP_DEC
@@ -4232,7 +4322,7 @@ void ifilter_bank(fb_info* fb, uint8_t window_sequence, uint8_t window_shape, ui
 void filter_bank_ltp(fb_info* fb, uint8_t window_sequence, uint8_t window_shape, uint8_t window_shape_prev, real_t* in_data, real_t* out_mdct, uint8_t object_type, uint16_t frame_len) {
     int16_t i;
     // real_t windowed_buf[2*1024] = {0};
-    real_t* windowed_buf = (real_t*)faad_calloc(2 * 1024, sizeof(real_t));
+    real_t* windowed_buf = (real_t*)faad_ws_calloc(2 * 1024, sizeof(real_t));
     const real_t* window_long = NULL;
     const real_t* window_long_prev = NULL;
     const real_t* window_short = NULL;
@@ -4278,7 +4368,7 @@ void filter_bank_ltp(fb_info* fb, uint8_t window_sequence, uint8_t window_shape,
             mdct(fb, windowed_buf, out_mdct, 2 * nlong);
             break;
     }
-    faad_free(&windowed_buf);
+    faad_ws_free(&windowed_buf);
 }
 #endif
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -4403,8 +4493,8 @@ uint8_t reordered_spectral_data(NeAACDecStruct* hDecoder, ic_stream* ics, bitfil
     uint16_t numberOfSegments, numberOfSets, numberOfCodewords;
     // codeword_t codeword[512];
     // bits_t     segment[512];
-    codeword_t* codeword = (codeword_t*)ps_malloc(sizeof(codeword_t) * 512);
-    bits_t* segment = (bits_t*)ps_malloc(sizeof(bits_t) * 512);
+    codeword_t* codeword = (codeword_t*)faad_ws_malloc(sizeof(codeword_t) * 512);
+    bits_t* segment = (bits_t*)faad_ws_malloc(sizeof(bits_t) * 512);
     uint16_t sp_offset[8];
     uint16_t g, i, sortloop, set, bitsread;
     /*uint16_t bitsleft, codewordsleft*/;
@@ -4542,8 +4632,8 @@ uint8_t reordered_spectral_data(NeAACDecStruct* hDecoder, ic_stream* ics, bitfil
     #endif
     ret = 0;
 exit:
-    faad_free(&codeword);
-    faad_free(&segment);
+    faad_ws_free(&codeword);
+    faad_ws_free(&segment);
     return ret;
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -4551,7 +4641,7 @@ exit:
 #ifdef SBR_DEC
 void DCT4_32(real_t* y, real_t* x) {
     // printf(ANSI_ESC_YELLOW "dct4_32" ANSI_ESC_WHITE "\n");
-    int32_t* f = (int32_t*)faad_malloc(397 * sizeof(int32_t));
+    int32_t* f = (int32_t*)faad_ws_malloc(398 * sizeof(int32_t)); // f[0] ... f[397]
     f[0] = x[15] - x[16];
     f[1] = x[15] + x[16];
     f[2] = MUL_F(FRAC_CONST(0.7071067811865476), f[1]);
@@ -4952,16 +5042,14 @@ void DCT4_32(real_t* y, real_t* x) {
     f[397] = MUL_C(COEF_CONST(1.0708550202783576), f[300]);
     y[30] = f[395] + f[396];
     y[1] = f[397] - f[396];
-    if(f) {
-        faad_free(&f);
-    }
+    faad_ws_free(&f);
 }
 #endif // SBR_DEC
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 void DST4_32(real_t* y, real_t* x) {
     // printf(ANSI_ESC_YELLOW "DST4_32" ANSI_ESC_WHITE "\n");
-    int32_t* f = (int32_t*)faad_malloc(336 * sizeof(int32_t));
+    int32_t* f = (int32_t*)faad_ws_malloc(336 * sizeof(int32_t));
     f[0] = x[0] - x[1];
     f[1] = x[2] - x[1];
     f[2] = x[2] - x[3];
@@ -5330,9 +5418,7 @@ void DST4_32(real_t* y, real_t* x) {
     y[2] = MUL_C(COEF_CONST(4.0846110781292477), f[308]);
     y[1] = MUL_C(COEF_CONST(6.7967507116736332), f[306]);
     y[0] = MUL_R(REAL_CONST(20.3738781672314530), f[304]);
-    if(f) {
-        faad_free(&f);
-    }
+    faad_ws_free(&f);
 }
 #endif // SBR_DEC
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -7185,7 +7271,7 @@ static uint8_t allocate_channel_pair(NeAACDecStruct* hDecoder, uint8_t channel,
 uint8_t reconstruct_single_channel(NeAACDecStruct* hDecoder, ic_stream* ics, element* sce, int16_t* spec_data) {
     uint8_t retval = 0;
     int     output_channels;
-    real_t* spec_coef = (real_t*)faad_malloc(1024 * sizeof(real_t));
+    real_t* spec_coef = (real_t*)faad_ws_malloc(1024 * sizeof(real_t));
 #ifdef PROFILE
     int64_t count = faad_get_ts();
 #endif
@@ -7346,7 +7432,7 @@ uint8_t reconstruct_single_channel(NeAACDecStruct* hDecoder, ic_stream* ics, ele
 #endif
     retval = 0;
 exit:
-    faad_free(&spec_coef);
+    faad_ws_free(&spec_coef);
     return retval;
 }
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -7354,8 +7440,8 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct* hDecoder, ic_stream* ics1, ic_s
     uint8_t retval;
     // real_t spec_coef1[1024];
     // real_t spec_coef2[1024];
-    real_t* spec_coef1 = (real_t*)faad_malloc(1024 * sizeof(real_t));
-    real_t* spec_coef2 = (real_t*)faad_malloc(1024 * sizeof(real_t));
+    real_t* spec_coef1 = (real_t*)faad_ws_malloc(1024 * sizeof(real_t));
+    real_t* spec_coef2 = (real_t*)faad_ws_malloc(1024 * sizeof(real_t));
 #ifdef PROFILE
     int64_t count = faad_get_ts();
 #endif
@@ -7519,8 +7605,8 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct* hDecoder, ic_stream* ics1, ic_s
 #endif
     retval = 0;
 exit:
-    faad_free(&spec_coef1);
-    faad_free(&spec_coef2);
+    faad_ws_free(&spec_coef2);
+    faad_ws_free(&spec_coef1);
     return retval;
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -8049,10 +8135,10 @@ void raw_data_block(NeAACDecStruct* hDecoder, NeAACDecFrameInfo* hInfo, bitfile*
 uint8_t single_lfe_channel_element(NeAACDecStruct* hDecoder, bitfile* ld, uint8_t channel, uint8_t* tag) {
     uint8_t retval = 0;
     //  element       sce = {0};
-    element*   sce = (element*)faad_calloc(1, sizeof(element));
+    element*   sce = (element*)faad_ws_calloc(1, sizeof(element));
     ic_stream* ics = &(sce->ics1);
     // int16_t spec_data[1024] = {0};
-    int16_t* spec_data = (int16_t*)faad_calloc(1024, sizeof(int16_t));
+    int16_t* spec_data = (int16_t*)faad_ws_calloc(1024, sizeof(int16_t));
     sce->element_instance_tag = (uint8_t)faad_getbits(ld, LEN_TAG);
     *tag = sce->element_instance_tag;
     sce->channel = channel;
@@ -8078,8 +8164,8 @@ uint8_t single_lfe_channel_element(NeAACDecStruct* hDecoder, bitfile* ld, uint8_
     if (retval > 0) goto exit;
     retval = 0;
 exit:
-    faad_free(&sce);
-    faad_free(&spec_data);
+    faad_ws_free(&spec_data);
+    faad_ws_free(&sce);
     return retval;
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -8087,10 +8173,10 @@ exit:
 uint8_t channel_pair_element(NeAACDecStruct* hDecoder, bitfile* ld, uint8_t channels, uint8_t* tag) {
     // int16_t spec_data1[1024] = {0};
     // int16_t spec_data2[1024] = {0};
-    int16_t* spec_data1 = (int16_t*)faad_calloc(1024, sizeof(int16_t));
-    int16_t* spec_data2 = (int16_t*)faad_calloc(1024, sizeof(int16_t));
+    int16_t* spec_data1 = (int16_t*)faad_ws_calloc(1024, sizeof(int16_t));
+    int16_t* spec_data2 = (int16_t*)faad_ws_calloc(1024, sizeof(int16_t));
     // element    cpe = {0};
-    element*   cpe = (element*)faad_calloc(1, sizeof(element));
+    element*   cpe = (element*)faad_ws_calloc(1, sizeof(element));
     ic_stream* ics1 = &(cpe->ics1);
     ic_stream* ics2 = &(cpe->ics2);
     uint8_t    result;
@@ -8166,9 +8252,9 @@ uint8_t channel_pair_element(NeAACDecStruct* hDecoder, bitfile* ld, uint8_t chan
     if ((result = reconstruct_channel_pair(hDecoder, ics1, ics2, cpe, spec_data1, spec_data2)) > 0) { goto exit; }
     result = 0;
 exit:
-    faad_free(&spec_data1);
-    faad_free(&spec_data2);
-    faad_free(&cpe);
+    faad_ws_free(&cpe);
+    faad_ws_free(&spec_data2);
+    faad_ws_free(&spec_data1);
     return result;
 }
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -9953,7 +10039,7 @@ void ssr_ifilter_bank(fb_info* fb, uint8_t window_sequence, uint8_t window_shape
     uint16_t nshort = frame_len / 8;
     uint16_t trans = nshort / 2; (void)trans;
     uint16_t nflat_ls = (nlong - nshort) / 2;
-    transf_buf = (real_t*)faad_malloc(2 * nlong * sizeof(real_t));
+    transf_buf = (real_t*)faad_ws_malloc(2 * nlong * sizeof(real_t));
     window_long = (real_t*)fb->long_window[window_shape];
     window_long_prev = (real_t*)fb->long_window[window_shape_prev];
     window_short = (real_t*)fb->short_window[window_shape];
@@ -10009,7 +10095,7 @@ void ssr_ifilter_bank(fb_info* fb, uint8_t window_sequence, uint8_t window_shape
             for (i = 0; i < nlong; i++) time_out[nlong + i] = MUL_R_C(transf_buf[nlong + i], window_long[nlong - 1 - i]);
             break;
     }
-    faad_free(&transf_buf);
+    faad_ws_free(&transf_buf);
 }
 #endif
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -10044,8 +10130,8 @@ void lt_prediction(ic_stream* ics, ltp_info* ltp, real_t* spec, int16_t* lt_pred
     uint16_t     bin, i, num_samples;
     // real_t x_est[2048];
     // real_t X_est[2048];
-    real_t* x_est = (real_t*)faad_malloc(2048 * sizeof(real_t));
-    real_t* X_est = (real_t*)faad_malloc(2048 * sizeof(real_t));
+    real_t* x_est = (real_t*)faad_ws_malloc(2048 * sizeof(real_t));
+    real_t* X_est = (real_t*)faad_ws_malloc(2048 * sizeof(real_t));
     if(ics->window_sequence != EIGHT_SHORT_SEQUENCE) {
         if(ltp->data_present) {
             num_samples = frame_len << 1;
@@ -10074,8 +10160,8 @@ void lt_prediction(ic_stream* ics, ltp_info* ltp, real_t* spec, int16_t* lt_pred
             }
         }
     }
-    if(x_est)free(x_est);
-    if(X_est)free(X_est);
+    faad_ws_free(&X_est);
+    faad_ws_free(&x_est);
 }
 #endif // LPT_DEC
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -10825,9 +10911,9 @@ void ps_decorrelate(ps_info* ps, qmf_t X_left[38][64], qmf_t X_right[38][64], qm
     uint8_t          temp_delay_ser[NO_ALLPASS_LINKS];
     real_t           P_SmoothPeakDecayDiffNrg, nrg;
     // real_t           P[32][34];
-    real_t (*P)[34] = (real_t (*)[34])faad_malloc(32 * sizeof(real_t[34]));
+    real_t (*P)[34] = (real_t (*)[34])faad_ws_malloc(32 * sizeof(real_t[34]));
     // real_t           G_TransientRatio[32][34] = {{0}};
-    real_t (*G_TransientRatio)[34] = (real_t (*)[34])faad_calloc(32, sizeof(real_t[34]));
+    real_t (*G_TransientRatio)[34] = (real_t (*)[34])faad_ws_calloc(32, sizeof(real_t[34]));
     complex_t        inputLeft;
     /* chose hybrid filterbank: 20 or 34 band case */
     if(ps->use34hybrid_bands) { Phi_Fract_SubQmf = Phi_Fract_SubQmf34; }
@@ -11064,8 +11150,8 @@ void ps_decorrelate(ps_info* ps, qmf_t X_left[38][64], qmf_t X_right[38][64], qm
     /* update delay indices */
     ps->saved_delay = temp_delay;
     for(m = 0; m < NO_ALLPASS_LINKS; m++) ps->delay_buf_index_ser[m] = temp_delay_ser[m];
-    if(P)free(P);
-    if(G_TransientRatio)free(G_TransientRatio);
+    faad_ws_free(&G_TransientRatio);
+    faad_ws_free(&P);
 }
 #endif //  PS_DEC
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -11567,8 +11653,8 @@ ps_info* ps_init(uint8_t sr_index, uint8_t numTimeSlotsRate) {
 uint8_t ps_decode(ps_info* ps, qmf_t X_left[38][64], qmf_t X_right[38][64]) {
     // qmf_t X_hybrid_left[32][32] = {{{0}}};
     // qmf_t X_hybrid_right[32][32] = {{{0}}};
-    qmf_t (*X_hybrid_left)[32] = (qmf_t (*)[32])faad_calloc(32, 32 * sizeof(qmf_t));
-    qmf_t (*X_hybrid_right)[32] = (qmf_t (*)[32])faad_calloc(32, 32 * sizeof(qmf_t));
+    qmf_t (*X_hybrid_left)[32] = (qmf_t (*)[32])faad_ws_calloc(32, 32 * sizeof(qmf_t));
+    qmf_t (*X_hybrid_right)[32] = (qmf_t (*)[32])faad_ws_calloc(32, 32 * sizeof(qmf_t));
     /* delta decoding of the bitstream data */
     ps_data_decode(ps);
     /* set up some parameters depending on filterbank type */
@@ -11597,8 +11683,8 @@ uint8_t ps_decode(ps_info* ps, qmf_t X_left[38][64], qmf_t X_right[38][64]) {
     /* hybrid synthesis, to rebuild the SBR QMF matrices */
     hybrid_synthesis((hyb_info*)ps->hyb, X_left, X_hybrid_left, ps->use34hybrid_bands, ps->numTimeSlotsRate);
     hybrid_synthesis((hyb_info*)ps->hyb, X_right, X_hybrid_right, ps->use34hybrid_bands, ps->numTimeSlotsRate);
-    faad_free((void**)&X_hybrid_left);
-    faad_free((void**)&X_hybrid_right);
+    faad_ws_free((void**)&X_hybrid_right);
+    faad_ws_free((void**)&X_hybrid_left);
     return 0;
 }
 #endif //  PS_DEC
@@ -12076,7 +12162,7 @@ uint8_t sbrDecodeCoupleFrame(sbr_info* sbr, real_t* left_chan, real_t* right_cha
     uint8_t dont_process = 0;
     uint8_t ret = 0;
     // qmf_t X[MAX_NTSR][64];
-    qmf_t(*X)[64] = (qmf_t(*)[64])faad_malloc(MAX_NTSR * 64 * sizeof(qmf_t));
+    qmf_t(*X)[64] = (qmf_t(*)[64])faad_ws_malloc(MAX_NTSR * 64 * sizeof(qmf_t));
     if (sbr == NULL) {
         ret = 20;
         goto exit;
@@ -12131,7 +12217,7 @@ uint8_t sbrDecodeCoupleFrame(sbr_info* sbr, real_t* left_chan, real_t* right_cha
     #endif
     ret = 0;
 exit:
-    faad_free((void**)&(X));
+    faad_ws_free((void**)&X);
     return ret;
 }
 #endif // #ifdef SBR_DEC
@@ -12141,7 +12227,7 @@ uint8_t sbrDecodeSingleFrame(sbr_info* sbr, real_t* channel, const uint8_t just_
     uint8_t dont_process = 0;
     uint8_t ret = 0;
     // qmf_t X[MAX_NTSR][64];
-    qmf_t(*X)[64] = (qmf_t(*)[64])faad_malloc(MAX_NTSR * 64 * sizeof(qmf_t));
+    qmf_t(*X)[64] = (qmf_t(*)[64])faad_ws_malloc(MAX_NTSR * 64 * sizeof(qmf_t));
     if (sbr == NULL) {
         ret = 20;
         goto exit;
@@ -12185,7 +12271,7 @@ uint8_t sbrDecodeSingleFrame(sbr_info* sbr, real_t* channel, const uint8_t just_
     #endif
     ret = 0;
 exit:
-    faad_free((void**)&X);
+    faad_ws_free((void**)&X);
     return ret;
 }
 #endif // #ifdef SBR_DEC
@@ -12198,8 +12284,8 @@ uint8_t sbrDecodeSingleFramePS(sbr_info* sbr, real_t* left_channel, real_t* righ
     uint8_t ret = 0;
     // qmf_t X_left[38][64] = {{{0}}};
     // qmf_t X_right[38][64] = {{{0}}}; /* must set this to 0 */
-    qmf_t(*X_left)[64] = (qmf_t(*)[64])faad_calloc(38, 64 * sizeof(qmf_t));
-    qmf_t(*X_right)[64] = (qmf_t(*)[64])faad_calloc(38, 64 * sizeof(qmf_t));
+    qmf_t(*X_left)[64] = (qmf_t(*)[64])faad_ws_calloc(38, 64 * sizeof(qmf_t));
+    qmf_t(*X_right)[64] = (qmf_t(*)[64])faad_ws_calloc(38, 64 * sizeof(qmf_t));
     if (sbr == NULL) {
         ret = 20;
         goto exit;
@@ -12261,8 +12347,8 @@ uint8_t sbrDecodeSingleFramePS(sbr_info* sbr, real_t* left_channel, real_t* righ
     sbr->frame++;
     ret = 0;
 exit:
-    faad_free((void**)&X_left);
-    faad_free((void**)&X_right);
+    faad_ws_free((void**)&X_right);
+    faad_ws_free((void**)&X_left);
     return ret;
 }
     #endif // (defined(PS_DEC) || defined(DRM_PS))
@@ -12754,10 +12840,10 @@ uint8_t master_frequency_table(sbr_info* sbr, uint8_t k0, uint8_t k2, uint8_t bs
     uint8_t nrBand0, nrBand1;
     // int32_t vDk0[64] = {0}, vDk1[64] = {0};
     // int32_t vk0[64] = {0}, vk1[64] = {0};
-    int32_t* vDk0 = (int32_t*) faad_calloc(64, sizeof(int32_t));
-    int32_t* vDk1 = (int32_t*) faad_calloc(64, sizeof(int32_t));
-    int32_t* vk0  = (int32_t*) faad_calloc(64, sizeof(int32_t));
-    int32_t* vk1  = (int32_t*) faad_calloc(64, sizeof(int32_t));
+    int32_t* vDk0 = (int32_t*) faad_ws_calloc(64, sizeof(int32_t));
+    int32_t* vDk1 = (int32_t*) faad_ws_calloc(64, sizeof(int32_t));
+    int32_t* vk0  = (int32_t*) faad_ws_calloc(64, sizeof(int32_t));
+    int32_t* vk1  = (int32_t*) faad_ws_calloc(64, sizeof(int32_t));
     uint8_t temp1[] = {6, 5, 4};
     real_t  q, qk;
     int32_t A_1;
@@ -12873,10 +12959,10 @@ uint8_t master_frequency_table(sbr_info* sbr, uint8_t k0, uint8_t k2, uint8_t bs
     #endif
     ret = 0;
 exit:
-    faad_free(&vDk0);
-    faad_free(&vDk1);
-    faad_free(&vk0);
-    faad_free(&vk1);
+    faad_ws_free(&vk1);
+    faad_ws_free(&vk0);
+    faad_ws_free(&vDk1);
+    faad_ws_free(&vDk0);
     return ret;
 }
 #endif
@@ -12993,8 +13079,8 @@ void limiter_frequency_table(sbr_info* sbr) {
     }
     printf("\n");
     #endif
-    int32_t* limTable = (int32_t*)faad_malloc(100 * sizeof(int32_t));
-    uint8_t* patchBorders = (uint8_t*)faad_malloc(64 * sizeof(uint8_t));
+    int32_t* limTable = (int32_t*)faad_ws_malloc(100 * sizeof(int32_t));
+    uint8_t* patchBorders = (uint8_t*)faad_ws_malloc(64 * sizeof(uint8_t));
     for(s = 1; s < 4; s++) {
         memset(limTable, 0, 100 * sizeof(int32_t));
         memset(patchBorders, 0, 64 * sizeof(uint8_t));
@@ -13077,8 +13163,8 @@ void limiter_frequency_table(sbr_info* sbr) {
     #endif
     }
 exit:
-    faad_free(&limTable);
-    faad_free(&patchBorders);
+    faad_ws_free(&patchBorders);
+    faad_ws_free(&limTable);
 }
 #endif // SBR_DEC
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -14413,7 +14499,7 @@ void sinusoidal_coding(bitfile* ld, sbr_info* sbr, uint8_t ch) {
 #ifdef SBR_DEC
 uint8_t hf_adjustment(sbr_info* sbr, qmf_t Xsbr[MAX_NTSRHFG][64], real_t* deg /* aliasing degree */, uint8_t ch) {
     // sbr_hfadj_info adj = {0};
-    sbr_hfadj_info* adj = (sbr_hfadj_info*)faad_calloc(1, sizeof(sbr_hfadj_info));
+    sbr_hfadj_info* adj = (sbr_hfadj_info*)faad_ws_calloc(1, sizeof(sbr_hfadj_info));
     uint8_t        ret = 0;
     if (sbr->bs_frame_class[ch] == FIXFIX) {
         sbr->l_A[ch] = -1;
@@ -14438,7 +14524,7 @@ uint8_t hf_adjustment(sbr_info* sbr, qmf_t Xsbr[MAX_NTSRHFG][64], real_t* deg /*
     hf_assembly(sbr, adj, Xsbr, ch);
     ret = 0;
 exit:
-    if(adj)free(adj);
+    faad_ws_free(&adj);
     return ret;
 }
 #endif // SBR_DEC
@@ -14666,9 +14752,9 @@ void calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch) {
     // real_t G_lim[MAX_M];
     // real_t S_M[MAX_M];
     real_t G_boost;
-    real_t* Q_M_lim = (real_t*)faad_malloc(MAX_M * sizeof(real_t));
-    real_t* G_lim = (real_t*)faad_malloc(MAX_M * sizeof(real_t));
-    real_t* S_M = (real_t*)faad_malloc(MAX_M * sizeof(real_t));
+    real_t* Q_M_lim = (real_t*)faad_ws_malloc(MAX_M * sizeof(real_t));
+    real_t* G_lim = (real_t*)faad_ws_malloc(MAX_M * sizeof(real_t));
+    real_t* S_M = (real_t*)faad_ws_malloc(MAX_M * sizeof(real_t));
     for (l = 0; l < sbr->L_E[ch]; l++) {
         uint8_t current_f_noise_band = 0;
         uint8_t current_res_band = 0;
@@ -14829,9 +14915,9 @@ void calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch) {
             }
         }
     }
-    if(Q_M_lim)free(Q_M_lim);
-    if(G_lim)free(G_lim);
-    if(S_M)free(S_M);
+    faad_ws_free(&S_M);
+    faad_ws_free(&G_lim);
+    faad_ws_free(&Q_M_lim);
 }
     #endif // FIXED_POINT
 #endif // SBR_DEC
@@ -14862,11 +14948,11 @@ float QUANTISE2INT(float val) {
 void hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf_t Xhigh[MAX_NTSRHFG][64], real_t* deg, uint8_t ch) {
     uint8_t l, i, x;
     //    complex_t alpha_0[64], alpha_1[64];
-    complex_t* alpha_0 = (complex_t*)faad_malloc(64 * sizeof(complex_t));
-    complex_t* alpha_1 = (complex_t*)faad_malloc(64 * sizeof(complex_t));
+    complex_t* alpha_0 = (complex_t*)faad_ws_malloc(64 * sizeof(complex_t));
+    complex_t* alpha_1 = (complex_t*)faad_ws_malloc(64 * sizeof(complex_t));
     #ifdef SBR_LOW_POWER
     // real_t rxx[64];
-    real_t* rxx = faad_malloc(64 * sizeof(real_t));
+    real_t* rxx = (real_t*)faad_ws_malloc(64 * sizeof(real_t));
     #endif
         uint8_t offset = sbr->tHFAdj;
     uint8_t     first = sbr->t_E[ch][0];
@@ -14947,11 +15033,11 @@ void hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf_t Xhigh[MAX_N
         }
     }
     if (sbr->Reset) { limiter_frequency_table(sbr); }
-    faad_free(&alpha_0);
-    faad_free(&alpha_1);
     #ifdef SBR_LOW_POWER
-    faad_free(&rxx);
+    faad_ws_free(&rxx);
     #endif
+    faad_ws_free(&alpha_1);
+    faad_ws_free(&alpha_0);
 }
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
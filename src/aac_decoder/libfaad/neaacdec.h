@@ -376,6 +376,7 @@ typedef const int8_t (*drm_ps_huff_tab)[2];
 //        *y1 = (_MulHigh(x1, c1) + _MulHigh(x2, c2)) << (FRAC_SIZE - FRAC_BITS);
 //        *y2 = (_MulHigh(x2, c1) - _MulHigh(x1, c2)) << (FRAC_SIZE - FRAC_BITS);
 //    }
+#ifdef __XTENSA__
 static inline void ComplexMult(int32_t* y1, int32_t* y2, int32_t x1, int32_t x2, int32_t c1, int32_t c2) {
     asm volatile (
         //  y1 = (x1 * c1) + (x2 * c2)
@@ -395,6 +396,12 @@ static inline void ComplexMult(int32_t* y1, int32_t* y2, int32_t x1, int32_t x2,
         : "a2", "a3"                              // Clobbers
     );
 }
+#else // same result as mulsh (high word of the product) on other targets, e.g. the host build in extras/host
+static inline void ComplexMult(int32_t* y1, int32_t* y2, int32_t x1, int32_t x2, int32_t c1, int32_t c2) {
+    *y1 = (int32_t)((uint32_t)((int32_t)(((int64_t)x1 * c1) >> 32) + (int32_t)(((int64_t)x2 * c2) >> 32)) << 1);
+    *y2 = (int32_t)((uint32_t)((int32_t)(((int64_t)x2 * c1) >> 32) - (int32_t)(((int64_t)x1 * c2) >> 32)) << 1);
+}
+#endif
 
 
     #define DIV(A, B) (((int64_t)A << REAL_BITS) / B)
@@ -600,6 +607,10 @@ int8_t   can_decode_ot(const uint8_t object_type);
 void*    faad_malloc(size_t size);
 template <typename freeType>
 void     faad_free(freeType** b);
+void*    faad_ws_malloc(size_t size);
+void*    faad_ws_calloc(size_t len, size_t size);
+template <typename freeType>
+void     faad_ws_free(freeType** b);
 
 drc_info*                drc_init(real_t cut, real_t boost);
 void                     drc_end(drc_info* drc);
@@ -650,6 +661,8 @@ char                     NeAACDecInit2(NeAACDecHandle hpDecoder, unsigned char*
 unsigned char            NeAACDecSetConfiguration(NeAACDecHandle hpDecoder, NeAACDecConfigurationPtr config);
 void                     NeAACDecClose(NeAACDecHandle hpDecoder);
 NeAACDecConfigurationPtr NeAACDecGetCurrentConfiguration(NeAACDecHandle hpDecoder);
+uint32_t                 NeAACDecGetAllocCount(void);
+uint32_t                 NeAACDecGetWorkspacePeak(NeAACDecHandle hpDecoder);
 void* aac_frame_decode(NeAACDecStruct* hDecoder, NeAACDecFrameInfo* hInfo, unsigned char* buffer, uint32_t buffer_size, void** sample_buffer2, uint32_t sample_buffer_size);
 void  create_channel_config(NeAACDecStruct* hDecoder, NeAACDecFrameInfo* hInfo);
 void  ssr_filter_bank_end(fb_info* fb);
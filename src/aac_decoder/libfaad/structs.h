@@ -496,6 +496,13 @@ typedef struct{
     uint8_t bs_df_env[2][9];
     uint8_t bs_df_noise[2][3];
 } sbr_info;
+typedef struct { /* per-decoder scratch of the decode path, used like a stack */
+    uint8_t* base;
+    uint32_t size;
+    uint32_t top;       /* first free byte */
+    uint32_t peak;      /* high water mark */
+    uint32_t overflows; /* requests that went to the heap */
+} faad_workspace;
 typedef struct {
     uint8_t adts_header_present;
     uint8_t adif_header_present;
@@ -553,6 +560,7 @@ typedef struct {
     latm_header          latm_config;
     const unsigned char* cmes;
     uint8_t              isPS;
+    faad_workspace       ws;
 } NeAACDecStruct;
 /* 1st step table */
 typedef struct {
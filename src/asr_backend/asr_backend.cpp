@@ -0,0 +1,306 @@
+/*
+ * asr_backend.cpp
+ *
+ *  provider protocols of the streaming speech recognition: connect parameters, start/audio/end messages and the
+ *  text of the responses for ElevenLabs, ByteDance (Volcengine) and OpenAI Whisper
+ *
+ */
+#include "asr_backend.h"
+#include <mbedtls/base64.h>
+
+// Print into a fixed buffer, cut at the end, always terminated
+class TextSink : public Print {
+
+public:
+    TextSink(char* buf, size_t size) : m_buf(buf), m_size(size) { m_buf[0] = '\0'; };
+    size_t write(uint8_t c) override {
+        if(m_len + 1 >= m_size) return 0;
+        m_buf[m_len++] = c;
+        m_buf[m_len] = '\0';
+        return 1;
+    }
+    using Print::write;
+
+private:
+    char*  m_buf;
+    size_t m_size;
+    size_t m_len = 0;
+};
+
+AsrBackend::AsrBackend(const char* host, const char* path) {
+    strlcpy(m_host, host, sizeof(m_host));
+    strlcpy(m_path, path, sizeof(m_path));
+}
+
+AsrBackend::~AsrBackend() {
+    free(m_frame);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void AsrBackend::setEndpoint(const char* host, uint16_t port, bool tls, const char* path) {
+    if(host) strlcpy(m_host, host, sizeof(m_host));
+    if(path) strlcpy(m_path, path, sizeof(m_path));
+    m_port = port;
+    m_tls = tls;
+}
+
+uint8_t* AsrBackend::frame(size_t size) {
+    if(size > m_frameSize) {
+        free(m_frame);
+        m_frameSize = (size + 255) & ~(size_t)255; // a little more, the chunks vary by a few bytes
+        m_frame = (uint8_t*)(psramFound() ? ps_malloc(m_frameSize) : malloc(m_frameSize));
+        if(!m_frame) { log_e("AsrBackend: no memory for %u bytes", (unsigned)m_frameSize); m_frameSize = 0; }
+    }
+    return m_frame;
+}
+
+void AsrBackend::sendText(AsrTransport& t, const char* json) {
+    size_t   len = strlen(json);
+    uint8_t* buf = frame(len);
+    if(!buf) return;
+    memcpy(buf, json, len); // masked in place, the literal stays as it is
+    t.sendFrame(0x01, buf, len);
+}
+
+void AsrBackend::sendBase64Json(AsrTransport& t, const char* before, const int16_t* samples, size_t n, const char* after) {
+    // {"...":"<base64>"} in one buffer: prefix, the encoded PCM behind it, suffix
+    size_t   lb = strlen(before), la = strlen(after);
+    size_t   enc = (n * 2 + 2) / 3 * 4;
+    uint8_t* buf = frame(lb + enc + la + 1);
+    if(!buf) return;
+    memcpy(buf, before, lb);
+    size_t out = 0;
+    mbedtls_base64_encode(buf + lb, enc + 1, &out, (const uint8_t*)samples, n * 2);
+    memcpy(buf + lb + out, after, la);
+    t.sendFrame(0x01, buf, lb + out + la);
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool AsrBackend::jsonText(JsonStream& reader, const uint8_t* data, size_t len, char* text, size_t size) {
+    TextSink sink(text, size);
+    reader.reset();
+    reader.setOutput(&sink);
+    reader.feed(data, len);
+    reader.setOutput(NULL);
+    return reader.found();
+}
+
+bool AsrBackend::jsonTrue(const uint8_t* data, size_t len, const char* key) {
+    // "key": true, a key inside a string value is escaped (\"key\") and does not match
+    size_t k = strlen(key);
+    for(size_t i = 0; i + k + 2 < len; i++) {
+        if(data[i] != '"' || (i > 0 && data[i - 1] == '\\') || memcmp(data + i + 1, key, k) || data[i + k + 1] != '"') continue;
+        size_t p = i + k + 2;
+        while(p < len && (data[p] == ' ' || data[p] == ':')) p++;
+        return p + 4 <= len && !memcmp(data + p, "true", 4);
+    }
+    return false;
+}
+
+bool AsrBackend::jsonNegative(const uint8_t* data, size_t len, const char* key) {
+    // "key": -n
+    size_t k = strlen(key);
+    for(size_t i = 0; i + k + 2 < len; i++) {
+        if(data[i] != '"' || (i > 0 && data[i - 1] == '\\') || memcmp(data + i + 1, key, k) || data[i + k + 1] != '"') continue;
+        size_t p = i + k + 2;
+        while(p < len && (data[p] == ' ' || data[p] == ':')) p++;
+        return p < len && data[p] == '-';
+    }
+    return false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+//    E L E V E N L A B S
+//----------------------------------------------------------------------------------------------------------------------
+ElevenLabsAsr::ElevenLabsAsr(const char* apiKey, const char* modelId)
+    : AsrBackend("api.elevenlabs.io", "/v1/speech-to-text/stream-input"), m_apiKey(apiKey), m_modelId(modelId) {}
+
+void ElevenLabsAsr::setConfig(const char* apiKey, const char* modelId) {
+    if(apiKey) m_apiKey = apiKey;
+    if(modelId) m_modelId = modelId;
+}
+
+void ElevenLabsAsr::writePath(Print& out) {
+    out.print(m_path);
+    out.print("?model_id=");
+    out.print(m_modelId && *m_modelId ? m_modelId : "scribe_v2");
+}
+
+void ElevenLabsAsr::writeHeaders(Print& out) {
+    out.print("xi-api-key: ");
+    out.print(m_apiKey);
+    out.print("\r\n");
+}
+
+void ElevenLabsAsr::start(AsrTransport& t, int sampleRate) {
+    if(sampleRate != 16000) log_w("ElevenLabsAsr: %d Hz audio, the stream-input session expects 16 kHz", sampleRate);
+    sendText(t, "{\"type\":\"start\"}");
+}
+
+void ElevenLabsAsr::audio(AsrTransport& t, const int16_t* samples, size_t n) {
+    sendBase64Json(t, "{\"audio_event\":\"audio_chunk\",\"audio_base_64\":\"", samples, n, "\"}");
+}
+
+void ElevenLabsAsr::end(AsrTransport& t) {
+    sendText(t, "{\"audio_event\":\"audio_chunk\",\"audio_base_64\":\"\"}"); // end of stream: empty chunk
+}
+
+bool ElevenLabsAsr::parse(const uint8_t* data, size_t len, bool binary, char* text, size_t size, bool* isFinal) {
+    // {"text":"...","is_final":false}
+    if(binary || !jsonText(m_text, data, len, text, size)) return false;
+    *isFinal = jsonTrue(data, len, "is_final");
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+//    B Y T E D A N C E
+//----------------------------------------------------------------------------------------------------------------------
+//  every message: 4 byte header (version 1 | header size 1, type | flags, serialization | compression, 0),
+//  payload size (32 bit, big endian), payload. The full client request (JSON) starts the utterance, audio follows as
+//  raw PCM, FLAG_LAST marks the end. The responses carry the whole text so far, a negative sequence is the last one.
+
+ByteDanceAsr::ByteDanceAsr(const char* appId, const char* token, const char* cluster)
+    : AsrBackend("openspeech.bytedance.com", "/api/v2/asr"), m_appId(appId), m_token(token), m_cluster(cluster) {}
+
+void ByteDanceAsr::writeHeaders(Print& out) {
+    out.print("Authorization: Bearer; ");
+    out.print(m_token);
+    out.print("\r\n");
+}
+
+void ByteDanceAsr::sendPacket(AsrTransport& t, uint8_t type, uint8_t flags, uint8_t serialization, size_t payload) {
+    // the payload is already at m_frame + 8
+    m_frame[0] = 0x11;
+    m_frame[1] = (type << 4) | flags;
+    m_frame[2] = serialization << 4; // no compression
+    m_frame[3] = 0;
+    for(uint8_t i = 0; i < 4; i++) m_frame[4 + i] = payload >> (24 - 8 * i);
+    t.sendFrame(0x02, m_frame, 8 + payload);
+}
+
+void ByteDanceAsr::start(AsrTransport& t, int sampleRate) {
+    char reqid[33];
+    for(uint8_t i = 0; i < 32; i++) reqid[i] = "0123456789abcdef"[random(16)];
+    reqid[32] = '\0';
+    auto render = [&](JsonWriter& w) {
+        w.raw("{\"app\":{\"appid\":"); w.string(m_appId);
+        w.raw(",\"cluster\":");         w.string(m_cluster);
+        w.raw(",\"token\":");           w.string(m_token);
+        w.raw("},\"user\":{\"uid\":\"escher-doorbell\"},\"audio\":{\"format\":\"raw\",\"codec\":\"raw\",\"rate\":");
+        char num[12];
+        itoa(sampleRate, num, 10);
+        w.raw(num);
+        w.raw(",\"bits\":16,\"channel\":1},\"request\":{\"reqid\":\"");
+        w.raw(reqid);
+        w.raw("\",\"sequence\":1,\"nbest\":1,\"workflow\":\"audio_in,resample,partition,vad,fe,itn\",\"result_type\":\"full\"}}");
+    };
+    JsonWriter count(NULL);
+    render(count);
+    size_t len = count.total();
+    if(!frame(8 + len)) return;
+    {
+        JsonWriter w(m_frame + 8, 0, len);
+        render(w);
+    }
+    sendPacket(t, MSG_FULL_REQUEST, 0, SER_JSON, len);
+}
+
+void ByteDanceAsr::audio(AsrTransport& t, const int16_t* samples, size_t n) {
+    if(!frame(8 + n * 2)) return;
+    memcpy(m_frame + 8, samples, n * 2); // little endian PCM as it is
+    sendPacket(t, MSG_AUDIO, 0, SER_NONE, n * 2);
+}
+
+void ByteDanceAsr::end(AsrTransport& t) {
+    if(!frame(8)) return;
+    sendPacket(t, MSG_AUDIO, FLAG_LAST, SER_NONE, 0);
+}
+
+bool ByteDanceAsr::parse(const uint8_t* data, size_t len, bool binary, char* text, size_t size, bool* isFinal) {
+    if(!binary || len < 4) return false;
+    size_t  hdr = (data[0] & 0x0F) * 4;
+    uint8_t type = data[1] >> 4;
+    if(hdr < 4 || len < hdr + 4) return false;
+    auto be32 = [&](size_t p) { return (uint32_t)data[p] << 24 | data[p + 1] << 16 | data[p + 2] << 8 | data[p + 3]; };
+
+    if(type == MSG_ERROR && len >= hdr + 8) {
+        size_t msgLen = min((size_t)be32(hdr + 4), len - hdr - 8);
+        log_w("ByteDanceAsr: error %u %.*s", be32(hdr), (int)msgLen, data + hdr + 8);
+        return false;
+    }
+    if(type != MSG_FULL_RESPONSE) return false;
+    if(data[2] & 0x0F) { log_w("ByteDanceAsr: compressed response"); return false; } // requested without compression
+    size_t payload = min((size_t)be32(hdr), len - hdr - 4);
+    const uint8_t* json = data + hdr + 4;
+    if(!jsonText(m_text, json, payload, text, size)) return false;
+    *isFinal = jsonNegative(json, payload, "sequence");
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+//    W H I S P E R
+//----------------------------------------------------------------------------------------------------------------------
+//  realtime transcription session: the server detects the end of speech (server_vad) and commits the audio buffer,
+//  end() commits what is left. Deltas are collected until the "completed" event brings the whole transcript.
+
+WhisperAsr::WhisperAsr(const char* apiKey, const char* model)
+    : AsrBackend("api.openai.com", "/v1/realtime?intent=transcription"), m_apiKey(apiKey), m_model(model) {}
+
+void WhisperAsr::writeHeaders(Print& out) {
+    out.print("Authorization: Bearer ");
+    out.print(m_apiKey);
+    out.print("\r\nOpenAI-Beta: realtime=v1\r\n");
+}
+
+void WhisperAsr::start(AsrTransport& t, int sampleRate) {
+    m_rate = sampleRate > 0 ? sampleRate : 16000;
+    m_phase = 0;
+    m_prev = 0;
+    m_acc[0] = '\0';
+    char json[256];
+    snprintf(json, sizeof(json), "{\"type\":\"transcription_session.update\",\"session\":{\"input_audio_format\":\"pcm16\","
+             "\"input_audio_transcription\":{\"model\":\"%s\"},\"turn_detection\":{\"type\":\"server_vad\"}}}", m_model);
+    sendText(t, json);
+}
+
+void WhisperAsr::audio(AsrTransport& t, const int16_t* samples, size_t n) {
+    // linear interpolation to 24 kHz, the position is kept from chunk to chunk: 0 = last sample of the previous chunk,
+    // WHISPER_RATE = samples[0]
+    size_t out = 0;
+    while(n) {
+        uint32_t k = m_phase / WHISPER_RATE;
+        if(k >= n) {
+            m_phase -= n * WHISPER_RATE;
+            m_prev = samples[n - 1];
+            break;
+        }
+        int32_t a = k ? samples[k - 1] : m_prev;
+        int32_t b = samples[k];
+        m_resampled[out++] = a + (b - a) * (int32_t)(m_phase % WHISPER_RATE) / (int32_t)WHISPER_RATE;
+        m_phase += m_rate;
+        if(out == sizeof(m_resampled) / sizeof(m_resampled[0])) {
+            sendBase64Json(t, "{\"type\":\"input_audio_buffer.append\",\"audio\":\"", m_resampled, out, "\"}");
+            out = 0;
+        }
+    }
+    if(out) sendBase64Json(t, "{\"type\":\"input_audio_buffer.append\",\"audio\":\"", m_resampled, out, "\"}");
+}
+
+void WhisperAsr::end(AsrTransport& t) {
+    sendText(t, "{\"type\":\"input_audio_buffer.commit\"}");
+}
+
+bool WhisperAsr::parse(const uint8_t* data, size_t len, bool binary, char* text, size_t size, bool* isFinal) {
+    char type[64];
+    if(binary || !jsonText(m_type, data, len, type, sizeof(type))) return false;
+    if(!strcmp(type, "conversation.item.input_audio_transcription.delta")) {
+        size_t l = strlen(m_acc);
+        jsonText(m_delta, data, len, m_acc + l, sizeof(m_acc) - l);
+        strlcpy(text, m_acc, size);
+        *isFinal = false;
+        return true;
+    }
+    if(!strcmp(type, "conversation.item.input_audio_transcription.completed")) {
+        jsonText(m_transcript, data, len, text, size);
+        m_acc[0] = '\0';
+        *isFinal = true;
+        return true;
+    }
+    if(!strcmp(type, "error")) log_w("WhisperAsr: %.*s", (int)min(len, (size_t)200), (const char*)data);
+    return false;
+}
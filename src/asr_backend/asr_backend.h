@@ -0,0 +1,131 @@
+// streaming speech recognition providers: what goes over the WebSocket of ArduinoASRChat, one class per provider
+#pragma once
+
+#include "Arduino.h"
+#include "json_stream/json_stream.h"
+
+//  ArduinoASRChat owns the socket (connect, frames, reconnects, mic capture), a backend only knows the provider:
+//
+//  connect:  host(), port(), tls(), writePath(), writeHeaders()  ->  GET <path> HTTP/1.1 ... Upgrade: websocket
+//  turn:     start() -> audio() ... audio() -> end()                frames go out through AsrTransport::sendFrame()
+//  receive:  parse(message) -> text so far, final or not
+//
+//  ElevenLabsAsr  scribe realtime, JSON text frames, base64 PCM
+//  ByteDanceAsr   Volcengine streaming ASR v2, binary frames (4 byte header, size, JSON or raw PCM), no compression
+//  WhisperAsr     OpenAI realtime transcription, JSON text frames, base64 PCM16 at 24 kHz (resampled from the mic)
+//
+//  The frames are built in one send buffer of the backend that only grows, a turn allocates nothing after the first
+//  chunk. setEndpoint() points any backend to another server, e.g. the mock in examples/Doorbell/asr_mock (ws://).
+
+class AsrTransport {
+
+public:
+    virtual void sendFrame(uint8_t opcode, uint8_t* data, size_t len) = 0; // data is masked in place
+};
+
+class AsrBackend {
+
+public:
+    AsrBackend(const char* host, const char* path);
+    virtual ~AsrBackend();
+    void            setEndpoint(const char* host, uint16_t port, bool tls, const char* path = NULL);
+    const char*     host() { return m_host; };
+    uint16_t        port() { return m_port; };
+    bool            tls() { return m_tls; };
+
+    virtual const char* name() = 0;
+    virtual void    writePath(Print& out) { out.print(m_path); };
+    virtual void    writeHeaders(Print& out) = 0;                  // "Name: value\r\n" lines, authentication
+    virtual void    start(AsrTransport& t, int sampleRate) = 0;    // one utterance
+    virtual void    audio(AsrTransport& t, const int16_t* samples, size_t n) = 0;
+    virtual void    end(AsrTransport& t) = 0;
+    virtual bool    parse(const uint8_t* data, size_t len, bool binary, char* text, size_t size, bool* isFinal) = 0;
+
+protected:
+    uint8_t*        frame(size_t size);                            // send buffer, NULL: no memory
+    void            sendText(AsrTransport& t, const char* json);
+    void            sendBase64Json(AsrTransport& t, const char* before, const int16_t* samples, size_t n, const char* after);
+    static bool     jsonText(JsonStream& reader, const uint8_t* data, size_t len, char* text, size_t size);
+    static bool     jsonTrue(const uint8_t* data, size_t len, const char* key);
+    static bool     jsonNegative(const uint8_t* data, size_t len, const char* key);
+
+    char            m_host[64];
+    char            m_path[96];
+    uint16_t        m_port = 443;
+    bool            m_tls = true;
+    uint8_t*        m_frame = NULL;
+    size_t          m_frameSize = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class ElevenLabsAsr : public AsrBackend {
+
+public:
+    ElevenLabsAsr(const char* apiKey, const char* modelId = "scribe_v2");
+    void        setConfig(const char* apiKey, const char* modelId); // NULL: unchanged
+    const char* name() override { return "ElevenLabs"; };
+    void        writePath(Print& out) override;
+    void        writeHeaders(Print& out) override;
+    void        start(AsrTransport& t, int sampleRate) override;
+    void        audio(AsrTransport& t, const int16_t* samples, size_t n) override;
+    void        end(AsrTransport& t) override;
+    bool        parse(const uint8_t* data, size_t len, bool binary, char* text, size_t size, bool* isFinal) override;
+
+private:
+    const char* m_apiKey;
+    const char* m_modelId;
+    JsonStream  m_text{"text"};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class ByteDanceAsr : public AsrBackend {
+
+public:
+    ByteDanceAsr(const char* appId, const char* token, const char* cluster);
+    const char* name() override { return "ByteDance"; };
+    void        writeHeaders(Print& out) override;
+    void        start(AsrTransport& t, int sampleRate) override;
+    void        audio(AsrTransport& t, const int16_t* samples, size_t n) override;
+    void        end(AsrTransport& t) override;
+    bool        parse(const uint8_t* data, size_t len, bool binary, char* text, size_t size, bool* isFinal) override;
+
+private:
+    enum : uint8_t {MSG_FULL_REQUEST = 0x1, MSG_AUDIO = 0x2, MSG_FULL_RESPONSE = 0x9, MSG_ERROR = 0xF};
+    enum : uint8_t {FLAG_LAST = 0x2, SER_NONE = 0x0, SER_JSON = 0x1};
+    void        sendPacket(AsrTransport& t, uint8_t type, uint8_t flags, uint8_t serialization, size_t payload);
+
+    const char* m_appId;
+    const char* m_token;
+    const char* m_cluster;
+    JsonStream  m_text{"result/0/text"};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class WhisperAsr : public AsrBackend {
+
+public:
+    WhisperAsr(const char* apiKey, const char* model = "whisper-1");
+    const char* name() override { return "Whisper"; };
+    void        writeHeaders(Print& out) override;
+    void        start(AsrTransport& t, int sampleRate) override;
+    void        audio(AsrTransport& t, const int16_t* samples, size_t n) override;
+    void        end(AsrTransport& t) override;
+    bool        parse(const uint8_t* data, size_t len, bool binary, char* text, size_t size, bool* isFinal) override;
+
+    static const uint32_t WHISPER_RATE = 24000; // the only PCM16 rate of the realtime API
+
+private:
+    const char* m_apiKey;
+    const char* m_model;
+    int         m_rate = 16000;
+    uint32_t    m_phase = 0;                    // resampler position between two input samples, 1/WHISPER_RATE steps
+    int16_t     m_prev = 0;                     // last input sample of the previous chunk
+    int16_t     m_resampled[1200];              // 50 ms at 24 kHz per piece
+    JsonStream  m_type{"type"};
+    JsonStream  m_delta{"delta"};
+    JsonStream  m_transcript{"transcript"};
+    char        m_acc[512] = "";                // deltas of the utterance so far
+};
@@ -0,0 +1,105 @@
+/*
+ * audio_arena.cpp
+ *
+ *  one-shot allocator for the decoder state, no per-frame malloc, hot set in internal SRAM
+ *
+ */
+#include "audio_arena.h"
+
+AudioArena* AudioArena::s_first = NULL;
+int32_t     AudioArena::s_hotBudget = -1;
+
+AudioArena::AudioArena(const char* name) {
+    m_name = name;
+    m_next = s_first; // the arenas are static objects of the decoders, never destroyed before the program ends
+    s_first = this;
+}
+
+AudioArena::~AudioArena() {
+    release();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void AudioArena::reset() {
+    release();
+    m_blocks = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void AudioArena::add(void** ptr, size_t size, uint8_t heat) {
+    if(m_blocks >= ARENA_MAX_BLOCKS) { log_e("%s: too many blocks", m_name); return; }
+    m_block[m_blocks].ptr = ptr;
+    m_block[m_blocks].size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    m_block[m_blocks].heat = heat;
+    m_block[m_blocks].internal = false;
+    m_blocks++;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool AudioArena::allocate() {
+    release();
+    size_t budget = 0;
+    if(s_hotBudget < 0) {
+        size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        budget = largest > ARENA_RESERVE ? largest - ARENA_RESERVE : 0;
+    }
+    else budget = s_hotBudget;
+
+    size_t sizeInternal = 0, sizeOther = 0;
+    m_hotInPSRAM = 0;
+    for(int i = 0; i < m_blocks; i++) { // hot blocks in order of declaration as long as they fit
+        block_t& b = m_block[i];
+        b.internal = (b.heat == HOT && sizeInternal + b.size <= budget);
+        if(b.internal) sizeInternal += b.size;
+        else {
+            sizeOther += b.size;
+            if(b.heat == HOT) m_hotInPSRAM += b.size;
+        }
+    }
+    if(sizeInternal) m_internal = (uint8_t*)heap_caps_calloc(1, sizeInternal, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if(sizeInternal && !m_internal) { // fragmented meanwhile, everything goes to the other region
+        for(int i = 0; i < m_blocks; i++) m_block[i].internal = false;
+        sizeOther += sizeInternal;
+        sizeInternal = 0;
+    }
+    if(sizeOther) {
+        if(psramFound()) m_psram = (uint8_t*)ps_calloc(1, sizeOther);
+        else             m_psram = (uint8_t*)heap_caps_calloc(1, sizeOther, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if(!m_psram) { release(); return false; }
+    }
+    uint8_t* pI = m_internal;
+    uint8_t* pP = m_psram;
+    for(int i = 0; i < m_blocks; i++) {
+        block_t& b = m_block[i];
+        if(b.internal) { *b.ptr = pI; pI += b.size; }
+        else           { *b.ptr = pP; pP += b.size; }
+    }
+    m_bytesInternal = sizeInternal;
+    m_bytesPSRAM = psramFound() ? sizeOther : 0;
+    if(!psramFound()) m_bytesInternal += sizeOther;
+    log_i("%s: %u bytes internal, %u bytes PSRAM, %u hot bytes in PSRAM", m_name, m_bytesInternal, m_bytesPSRAM, m_hotInPSRAM);
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void AudioArena::release() {
+    for(int i = 0; i < m_blocks; i++) *m_block[i].ptr = NULL;
+    if(m_internal) { free(m_internal); m_internal = NULL; }
+    if(m_psram)    { free(m_psram);    m_psram = NULL; }
+    m_bytesInternal = 0;
+    m_bytesPSRAM = 0;
+    m_hotInPSRAM = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void AudioArena::setHotBudget(int32_t bytes) {
+    s_hotBudget = bytes; // takes effect with the next allocate()
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t AudioArena::report(char* buf, size_t size) {
+    size_t n = 0;
+    if(size) buf[0] = '\0';
+    for(AudioArena* a = s_first; a; a = a->m_next) {
+        if(!a->isAllocated()) continue;
+        int r = snprintf(buf + n, size - n, "%s%s: %u internal, %u PSRAM (hot in PSRAM %u)", n ? ", " : "", a->m_name,
+                         (unsigned)a->m_bytesInternal, (unsigned)a->m_bytesPSRAM, (unsigned)a->m_hotInPSRAM);
+        if(r < 0 || n + r >= size) break;
+        n += r;
+    }
+    return n;
+}
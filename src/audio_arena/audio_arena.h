@@ -0,0 +1,55 @@
+// one-shot allocator for the decoder state, hot blocks in internal SRAM, the rest in PSRAM
+#pragma once
+
+#include "Arduino.h"
+
+//  the blocks are declared in order of their access frequency, allocate() places the hot blocks in one internal SRAM
+//  region as long as the hot budget allows, all other blocks in one PSRAM region (internal SRAM if there is no PSRAM)
+//
+//  add(&a, 4096, HOT) add(&b, 8192, HOT) add(&c, 512, COLD)
+//
+//   internal  | a | b |          budget = largest free internal block - reserve, setHotBudget()
+//   PSRAM     | c |              b goes to PSRAM too if it does not fit into the budget
+
+class AudioArena {
+
+public:
+    enum : uint8_t {COLD = 0, HOT = 1};
+    AudioArena(const char* name);
+    ~AudioArena();
+    void    reset();                                  // release and forget all declarations
+    void    add(void** ptr, size_t size, uint8_t heat); // declare a block, *ptr is set in allocate()
+    bool    allocate();                               // two mallocs at most, false if out of memory
+    void    release();                                // frees both regions, the declared pointers become NULL
+    bool    isAllocated() { return m_internal || m_psram; };
+    size_t  bytesInternal() { return m_bytesInternal; };
+    size_t  bytesPSRAM() { return m_bytesPSRAM; };
+    size_t  hotInPSRAM() { return m_hotInPSRAM; };   // hot bytes that didn't fit into internal SRAM
+
+    static void   setHotBudget(int32_t bytes);        // -1: automatic (default), 0: everything in PSRAM (benchmark)
+    static size_t report(char* buf, size_t size);     // bytes per region of all allocated arenas
+
+private:
+    static const uint8_t ARENA_MAX_BLOCKS = 16;
+    static const size_t  ARENA_ALIGN      = 8;
+    static const size_t  ARENA_RESERVE    = 48 * 1024; // internal SRAM left for WiFi, TLS and the tasks
+    typedef struct {
+        void**  ptr;
+        size_t  size;
+        uint8_t heat;
+        bool    internal;
+    } block_t;
+
+    const char*  m_name;
+    block_t      m_block[ARENA_MAX_BLOCKS];
+    uint8_t      m_blocks = 0;
+    uint8_t*     m_internal = NULL;
+    uint8_t*     m_psram = NULL;
+    size_t       m_bytesInternal = 0;
+    size_t       m_bytesPSRAM = 0;
+    size_t       m_hotInPSRAM = 0;
+    AudioArena*  m_next = NULL;
+
+    static AudioArena* s_first;
+    static int32_t     s_hotBudget;
+};
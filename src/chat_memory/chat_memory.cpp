@@ -0,0 +1,132 @@
+/*
+ * chat_memory.cpp
+ *
+ *  question/answer pairs for the LLM in fixed slots and a circular text arena, bounded by pairs, bytes and
+ *  estimated tokens, pushed out pairs can be kept as a short summary
+ *
+ */
+#include "chat_memory.h"
+
+ChatMemory::ChatMemory(uint8_t maxPairs, uint16_t maxTokens, uint16_t maxBytes) {
+    setBudget(maxPairs, maxTokens, maxBytes);
+}
+
+ChatMemory::~ChatMemory() {
+    free(m_arena);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ChatMemory::setBudget(uint8_t maxPairs, uint16_t maxTokens, uint16_t maxBytes) {
+    clear();
+    free(m_arena);
+    m_arena = NULL;
+    m_maxPairs = constrain(maxPairs, 1, CHAT_MAX_PAIRS);
+    m_maxTokens = maxTokens;
+    m_maxBytes = max(maxBytes, (uint16_t)64);
+}
+
+void ChatMemory::clear() {
+    m_first = 0;
+    m_count = 0;
+    m_head = 0;
+    m_tokens = 0;
+    m_summary = "";
+}
+
+void ChatMemory::enableSummary(uint16_t maxBytes) {
+    m_summaryMax = maxBytes;
+    if(!maxBytes) m_summary = "";
+}
+//----------------------------------------------------------------------------------------------------------------------
+uint16_t ChatMemory::approxTokens(const char* s, size_t len) {
+    uint32_t tokens = 0;
+    size_t   word = 0;
+    for(size_t i = 0; i <= len; i++) {
+        uint8_t c = i < len ? s[i] : ' ';
+        if(c < 0x80 && isalnum(c)) { word++; continue; }
+        tokens += (word + 3) / 4;
+        word = 0;
+        if(c <= ' ') continue;                 // white space belongs to the next word
+        if(c < 0x80 || (c & 0xC0) != 0x80) tokens++; // punctuation, one per UTF-8 character
+    }
+    return min(tokens, (uint32_t)UINT16_MAX);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ChatMemory::dropOldest() {
+    const slot_t& s = m_slot[m_first];
+    if(m_summaryMax) {
+        const char* user = text(s);
+        const char* ai = user + s.userLen + 1;
+        if(m_summarizer) m_summarizer(m_summary, user, ai, m_summaryMax);
+        else keepGuest(m_summary, user, ai, m_summaryMax);
+    }
+    m_tokens -= s.tokens;
+    m_first = (m_first + 1) % CHAT_MAX_PAIRS;
+    m_count--;
+    m_evicted++;
+}
+
+bool ChatMemory::add(const String& user, const String& assistant) {
+    if(!m_arena) {
+        m_arena = (char*)(psramFound() ? ps_malloc(m_maxBytes) : malloc(m_maxBytes));
+        if(!m_arena) { log_e("ChatMemory: no memory for %u bytes", m_maxBytes); return false; }
+    }
+    size_t ulen = JsonWriter::cutLength(user.c_str(), user.length(), m_maxBytes / 2 - 1);
+    size_t alen = JsonWriter::cutLength(assistant.c_str(), assistant.length(), m_maxBytes - ulen - 2);
+    size_t len = ulen + 1 + alen + 1; // both '\0' terminated
+    uint16_t t = approxTokens(user.c_str(), ulen) + approxTokens(assistant.c_str(), alen);
+
+    uint32_t pos = m_head;
+    if(pos % m_maxBytes + len > m_maxBytes) pos += m_maxBytes - pos % m_maxBytes; // no wrap inside a pair
+    while(m_count && (m_count >= m_maxPairs || m_tokens + t > m_maxTokens || pos + len - m_slot[m_first].pos > m_maxBytes))
+        dropOldest();
+
+    char* p = m_arena + pos % m_maxBytes;
+    memcpy(p, user.c_str(), ulen);
+    p[ulen] = '\0';
+    memcpy(p + ulen + 1, assistant.c_str(), alen);
+    p[ulen + 1 + alen] = '\0';
+    slot_t& s = m_slot[(m_first + m_count) % CHAT_MAX_PAIRS];
+    s.pos = pos;
+    s.userLen = ulen;
+    s.aiLen = alen;
+    s.tokens = t;
+    m_count++;
+    m_tokens += t;
+    m_head = pos + len;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ChatMemory::keepGuest(String& summary, const char* user, const char* /*assistant*/, uint16_t maxBytes) {
+    // what the guest said says who is at the door, the answers can be asked again
+    if(summary.length()) summary += ' ';
+    summary += "Guest: ";
+    summary += user;
+    if(summary.length() > maxBytes) { // the oldest go first, whole entries if possible, otherwise whole words
+        int cut = summary.indexOf(" Guest: ", summary.length() - maxBytes);
+        if(cut < 0) cut = summary.indexOf(' ', summary.length() - maxBytes);
+        summary.remove(0, cut < 0 ? summary.length() : cut + 1);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool ChatMemory::writeMessages(JsonWriter& w, bool comma) {
+    bool wrote = false;
+    if(m_summary.length()) {
+        if(comma) w.raw(",", 1);
+        w.raw("{\"role\":\"system\",\"content\":\"Earlier in this conversation: ");
+        w.escaped(m_summary.c_str(), m_summary.length());
+        w.raw("\"}", 2);
+        wrote = true;
+    }
+    for(uint8_t i = 0; i < m_count; i++) {
+        const slot_t& s = m_slot[(m_first + i) % CHAT_MAX_PAIRS];
+        if(comma || wrote) w.raw(",", 1);
+        w.raw("{\"role\":\"user\",\"content\":");
+        w.string(text(s), s.userLen);
+        w.raw("},{\"role\":\"assistant\",\"content\":");
+        w.string(text(s) + s.userLen + 1, s.aiLen);
+        w.raw("}", 1);
+        wrote = true;
+    }
+    return wrote;
+}
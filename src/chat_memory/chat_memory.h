@@ -0,0 +1,69 @@
+// memory of the LLM conversation: question/answer pairs in a ring, bounded by pairs, bytes and estimated tokens
+#pragma once
+
+#include "Arduino.h"
+#include <functional>
+#include "../json_stream/json_stream.h"
+
+//  Every pair takes one slot, both texts are stored back to back in a circular arena (a pair never wraps). A new pair
+//  pushes out the oldest ones until it fits all three budgets, each step is O(1), nothing is moved or reallocated:
+//
+//  slots:  | 0 | 1 | 2 | 3 |           (m_first ... m_first + m_count - 1, modulo CHAT_MAX_PAIRS)
+//  arena:  |user|assistant|user|assistant|...
+//
+//  Tokens are estimated, not counted: a word of n letters or digits ~ (n + 3) / 4 tokens, every other character 1,
+//  close enough to the BPE tokenizers to keep a request below a budget.
+//
+//  Pushed out pairs can be folded into a short summary (enableSummary()), it goes into the request as a system
+//  message. The default keeps what the guest said, newest last, setSummarizer() replaces that.
+//
+//  writeMessages() writes the messages straight into a JsonWriter:
+//  {"role":"system","content":"Earlier: ..."},{"role":"user","content":".."},{"role":"assistant","content":".."}
+
+class ChatMemory {
+
+public:
+    typedef std::function<void(String& summary, const char* user, const char* assistant, uint16_t maxBytes)> summarizer_t;
+
+    ChatMemory(uint8_t maxPairs = 5, uint16_t maxTokens = 1024, uint16_t maxBytes = 4096);
+    ~ChatMemory();
+    void     setBudget(uint8_t maxPairs, uint16_t maxTokens, uint16_t maxBytes); // clears the memory
+    bool     add(const String& user, const String& assistant);                // false: no memory
+    void     clear();
+    void     enableSummary(uint16_t maxBytes);                                   // 0: off
+    void     setSummarizer(summarizer_t summarizer) { m_summarizer = summarizer; };
+    bool     writeMessages(JsonWriter& w, bool comma);                           // true if something was written
+    uint8_t  count() { return m_count; };
+    uint8_t  maxPairs() { return m_maxPairs; };
+    uint32_t tokens() { return m_tokens; };
+    uint32_t evicted() { return m_evicted; };
+    static uint16_t approxTokens(const char* s, size_t len);
+
+    static const uint8_t CHAT_MAX_PAIRS = 16;
+
+private:
+    struct slot_t {
+        uint32_t pos;     // arena position, not modulo
+        uint16_t userLen;
+        uint16_t aiLen;
+        uint16_t tokens;
+    };
+
+    void        dropOldest();
+    const char* text(const slot_t& s) { return m_arena + s.pos % m_maxBytes; };
+    static void keepGuest(String& summary, const char* user, const char* assistant, uint16_t maxBytes);
+
+    slot_t       m_slot[CHAT_MAX_PAIRS];
+    char*        m_arena = NULL;     // allocated with the first pair
+    uint8_t      m_maxPairs;
+    uint16_t     m_maxTokens;
+    uint16_t     m_maxBytes;
+    uint8_t      m_first = 0;
+    uint8_t      m_count = 0;
+    uint32_t     m_head = 0;         // next free arena position (not modulo)
+    uint32_t     m_tokens = 0;
+    uint32_t     m_evicted = 0;
+    String       m_summary;
+    uint16_t     m_summaryMax = 0;
+    summarizer_t m_summarizer = NULL;
+};
@@ -0,0 +1,206 @@
+/*
+ * conversation_store.cpp
+ *
+ *  turns of the current session in fixed slots and a circular text arena, JSON is produced while writing,
+ *  finished sessions are stored as binary records in flash
+ *
+ */
+#include "conversation_store.h"
+
+ConversationStore::ConversationStore(uint16_t slots, uint16_t arenaBytes) : m_slots(slots), m_arenaSize(arenaBytes) {}
+
+ConversationStore::~ConversationStore() {
+    free(m_slot);
+    free(m_arena);
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool ConversationStore::begin(fs::FS* fs, const char* dir, uint8_t keep) {
+    if(!m_slot) {
+        m_slot = (slot_t*)(psramFound() ? ps_malloc(m_slots * sizeof(slot_t)) : malloc(m_slots * sizeof(slot_t)));
+        m_arena = (char*)(psramFound() ? ps_malloc(m_arenaSize) : malloc(m_arenaSize));
+        if(!m_slot || !m_arena) {
+            log_e("ConversationStore: no memory for %u slots / %u bytes", m_slots, m_arenaSize);
+            free(m_slot); m_slot = NULL;
+            free(m_arena); m_arena = NULL;
+            return false;
+        }
+    }
+    m_fs = fs;
+    m_dir = dir;
+    m_keep = keep;
+    if(!m_fs || !m_keep) return true;
+
+    // continue the numbering of the stored sessions
+    if(!m_fs->exists(m_dir.c_str())) m_fs->mkdir(m_dir.c_str());
+    for(uint8_t i = 0; i < m_keep; i++) {
+        File f = m_fs->open(storedPath(i), FILE_READ);
+        if(!f) continue;
+        uint32_t hdr[2] = {0, 0};
+        if(f.read((uint8_t*)hdr, sizeof(hdr)) == sizeof(hdr) && hdr[0] == CONV_MAGIC && hdr[1] > m_seq) m_seq = hdr[1];
+        f.close();
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ConversationStore::startSession() {
+    m_first = 0;
+    m_count = 0;
+    m_head = 0;
+    m_overwritten = 0;
+    m_seq++;
+    m_f_active = true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ConversationStore::dropOldest() {
+    m_first = (m_first + 1) % m_slots;
+    m_count--;
+    m_overwritten++;
+}
+
+bool ConversationStore::add(role_t role, const char* txt) {
+    if(!m_slot || !m_f_active || !txt) return false;
+    size_t len = JsonWriter::cutLength(txt, strlen(txt), min((size_t)CONV_MAX_TEXT, (size_t)m_arenaSize));
+
+    uint32_t pos = m_head;
+    if(pos % m_arenaSize + len > m_arenaSize) pos += m_arenaSize - pos % m_arenaSize; // no wrap inside a text
+    if(m_count == m_slots) dropOldest();
+    while(m_count && pos + len - m_slot[m_first].pos > m_arenaSize) dropOldest(); // arena full
+
+    memcpy(m_arena + pos % m_arenaSize, txt, len);
+    slot_t& s = m_slot[(m_first + m_count) % m_slots];
+    s.time = (uint32_t)time(NULL);
+    s.pos = pos;
+    s.len = len;
+    s.role = role;
+    m_count++;
+    m_head = pos + len;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool ConversationStore::endSession() {
+    if(!m_f_active) return false;
+    m_f_active = false;
+    if(!m_fs || !m_keep || !m_slot) return true;
+
+    File f = m_fs->open(storedPath(m_seq % m_keep), FILE_WRITE); // overwrites the oldest stored session
+    if(!f) { log_e("ConversationStore: can't write %s", storedPath(m_seq % m_keep).c_str()); return false; }
+    uint32_t hdr[2] = {CONV_MAGIC, m_seq};
+    bool     ok = f.write((const uint8_t*)hdr, sizeof(hdr)) == sizeof(hdr);
+    ok &= f.write((const uint8_t*)&m_count, 2) == 2;
+    for(uint16_t i = 0; i < m_count && ok; i++) {
+        const slot_t& s = m_slot[(m_first + i) % m_slots];
+        uint8_t rec[7];
+        rec[0] = s.role;
+        memcpy(rec + 1, &s.time, 4);
+        memcpy(rec + 5, &s.len, 2);
+        ok &= f.write(rec, sizeof(rec)) == sizeof(rec);
+        ok &= f.write((const uint8_t*)text(s), s.len) == s.len;
+    }
+    f.close();
+    if(!ok) log_e("ConversationStore: session %u not completely written", m_seq);
+    return ok;
+}
+//----------------------------------------------------------------------------------------------------------------------
+const char* ConversationStore::roleName(role_t role) {
+    switch(role) {
+        case ROLE_GUEST: return "guest";
+        case ROLE_AI:    return "ai";
+        default:         return "system";
+    }
+}
+
+void ConversationStore::turnHead(JsonWriter& w, role_t role, uint32_t time) {
+    char tmp[48];
+    snprintf(tmp, sizeof(tmp), "{\"role\":\"%s\",\"t\":%u,\"text\":\"", roleName(role), (unsigned)time);
+    w.raw(tmp);
+}
+
+void ConversationStore::serialize(JsonWriter& w) {
+    w.raw("[", 1);
+    for(uint16_t i = 0; i < m_count; i++) {
+        const slot_t& s = m_slot[(m_first + i) % m_slots];
+        if(i) w.raw(",", 1);
+        turnHead(w, s.role, s.time);
+        w.escaped(text(s), s.len);
+        w.raw("\"}", 2);
+    }
+    w.raw("]", 1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t ConversationStore::writeJSON(Print& out) {
+    JsonWriter w(&out);
+    serialize(w);
+    w.flush();
+    return w.total();
+}
+
+size_t ConversationStore::jsonLength() {
+    JsonWriter w(NULL);
+    serialize(w);
+    return w.total();
+}
+
+String ConversationStore::turnJSON(uint16_t i) {
+    class StringPrint : public Print {
+    public:
+        StringPrint(String& s) : m_s(s) {}
+        size_t write(uint8_t c) override { return m_s.concat((char)c) ? 1 : 0; }
+        size_t write(const uint8_t* b, size_t len) override { return m_s.concat((const char*)b, len) ? len : 0; }
+        String& m_s;
+    };
+    String str;
+    if(i >= m_count) return str;
+    const slot_t& s = m_slot[(m_first + i) % m_slots];
+    str.reserve(s.len + 64);
+    StringPrint sp(str);
+    JsonWriter  w(&sp);
+    turnHead(w, s.role, s.time);
+    w.escaped(text(s), s.len);
+    w.raw("\"}", 2);
+    w.flush();
+    return str;
+}
+//----------------------------------------------------------------------------------------------------------------------
+String ConversationStore::storedPath(uint32_t idx) {
+    return m_dir + "/" + String(idx) + ".bin";
+}
+
+size_t ConversationStore::writeStored(Print* out, uint8_t back) {
+    if(!m_fs || !m_keep || !back || back > m_keep) return 0;
+    uint32_t last = m_f_active ? m_seq - 1 : m_seq;
+    if(back > last) return 0;
+    uint32_t seq = last - (back - 1);
+    File     f = m_fs->open(storedPath(seq % m_keep), FILE_READ);
+    if(!f) return 0;
+    uint32_t hdr[2] = {0, 0};
+    uint16_t count = 0;
+    if(f.read((uint8_t*)hdr, sizeof(hdr)) != sizeof(hdr) || hdr[0] != CONV_MAGIC || hdr[1] != seq ||
+       f.read((uint8_t*)&count, 2) != 2) {
+        f.close();
+        return 0;
+    }
+    JsonWriter w(out);
+    char       chunk[64]; // the texts are read in pieces, a stored session never has to fit into RAM
+    w.raw("[", 1);
+    for(uint16_t i = 0; i < count; i++) {
+        uint8_t  rec[7];
+        uint32_t time;
+        uint16_t len;
+        if(f.read(rec, sizeof(rec)) != sizeof(rec)) break; // truncated file, the JSON is still closed
+        memcpy(&time, rec + 1, 4);
+        memcpy(&len, rec + 5, 2);
+        if(i) w.raw(",", 1);
+        turnHead(w, (role_t)rec[0], time);
+        while(len) {
+            size_t n = f.read((uint8_t*)chunk, min((size_t)len, sizeof(chunk)));
+            if(!n) break;
+            w.escaped(chunk, n);
+            len -= n;
+        }
+        w.raw("\"}", 2);
+    }
+    w.raw("]", 1);
+    w.flush();
+    f.close();
+    return w.total();
+}
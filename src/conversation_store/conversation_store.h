@@ -0,0 +1,78 @@
+// bounded store for the turns of a visitor session, streamed as JSON, finished sessions kept in flash
+#pragma once
+
+#include "Arduino.h"
+#include <FS.h>
+#include <time.h>
+#include "../json_stream/json_stream.h"
+
+//  Every turn takes one fixed slot (role, time, position in the text arena), the texts are stored back to back in a
+//  circular arena. When the slots or the arena run out the oldest turns of the session are overwritten, memory use is
+//  fixed at begin() no matter how long a visitor talks.
+//
+//  slots:  | 0 guest | 1 ai | 2 guest | 3 ai | ...            (m_first ... m_first + m_count - 1, modulo slots)
+//  arena:  |guest text|ai text|guest text|ai text|...          (a text never wraps, the unused tail is skipped)
+//
+//  writeJSON() escapes the texts on the fly into a small buffer and writes to any Print (WiFiClient, PubSubClient
+//  between beginPublish/endPublish, File), jsonLength() gives the exact size beforehand:
+//
+//  [{"role":"guest","t":1700000000,"text":"Paket untuk..."},{"role":"ai","t":1700000003,"text":"Baik, ..."}]
+//
+//  endSession() appends the session to <dir>/<seq % keep>.bin, the last 'keep' sessions can be read back with
+//  writeStoredJSON(out, 1) (last one), writeStoredJSON(out, 2) ...
+
+class ConversationStore {
+
+public:
+    enum role_t : uint8_t { ROLE_GUEST = 0, ROLE_AI, ROLE_SYSTEM };
+
+    ConversationStore(uint16_t slots = 48, uint16_t arenaBytes = 8192);
+    ~ConversationStore();
+    bool     begin(fs::FS* fs = NULL, const char* dir = "/conv", uint8_t keep = 4); // fs NULL: RAM only
+    void     startSession();
+    bool     add(role_t role, const char* text);          // false: no session or no memory
+    bool     add(role_t role, const String& text) { return add(role, text.c_str()); };
+    bool     endSession();                                // closes the session and writes it to flash (if any)
+    size_t   writeJSON(Print& out);                       // current (or last closed) session as JSON array
+    size_t   jsonLength();
+    String   turnJSON(uint16_t i);                        // one turn as JSON object, 0 = oldest
+    size_t   writeStoredJSON(Print& out, uint8_t back) { return writeStored(&out, back); }; // 1 = last stored session
+    size_t   storedJSONLength(uint8_t back) { return writeStored(NULL, back); };            // 0: not found
+    uint16_t count() { return m_count; };
+    uint32_t session() { return m_seq; };
+    bool     active() { return m_f_active; };
+    uint32_t overwritten() { return m_overwritten; };     // turns lost to the bounds in this session
+
+    static const uint16_t CONV_MAX_TEXT = 1024; // longer texts are cut, one turn can't push out the whole session
+    static const uint32_t CONV_MAGIC    = 0x564E4F43; // "CONV"
+
+private:
+    struct slot_t {
+        uint32_t time;  // epoch seconds if the clock is set, otherwise seconds since boot
+        uint32_t pos;   // position of the text in the arena, counted since startSession() (not modulo)
+        uint16_t len;
+        role_t   role;
+    };
+
+    void        dropOldest();
+    const char* text(const slot_t& s) { return m_arena + s.pos % m_arenaSize; };
+    void        turnHead(JsonWriter& w, role_t role, uint32_t time);
+    void        serialize(JsonWriter& w);
+    String      storedPath(uint32_t seq);
+    size_t      writeStored(Print* out, uint8_t back);
+    static const char* roleName(role_t role);
+
+    slot_t*   m_slot = NULL;
+    char*     m_arena = NULL;
+    uint16_t  m_slots;
+    uint16_t  m_arenaSize;
+    uint16_t  m_first = 0;
+    uint16_t  m_count = 0;
+    uint32_t  m_head = 0;        // next free arena position (not modulo)
+    uint32_t  m_seq = 0;         // session number, continues over reboots when fs is set
+    uint32_t  m_overwritten = 0;
+    bool      m_f_active = false;
+    fs::FS*   m_fs = NULL;
+    String    m_dir;
+    uint8_t   m_keep = 0;
+};
@@ -0,0 +1,178 @@
+/*
+ * event_feed.cpp
+ *
+ *  Server-Sent Events for the dashboard, the frames are queued in a ring buffer and written by a separate task,
+ *  the caller (loop) never waits for a slow browser
+ *
+ */
+#include "event_feed.h"
+
+EventFeed::EventFeed(uint16_t port) : m_port(port), m_server(port) {}
+
+EventFeed::~EventFeed() {
+    end();
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool EventFeed::begin(size_t queueBytes, uint8_t core, UBaseType_t prio) {
+    if(m_task) return true;
+    m_ring = xRingbufferCreate(queueBytes, RINGBUF_TYPE_NOSPLIT);
+    m_done = xSemaphoreCreateBinary();
+    if(!m_ring || !m_done) {
+        log_e("EventFeed: no memory for %u bytes queue", (unsigned)queueBytes);
+        if(m_ring) vRingbufferDelete(m_ring);
+        if(m_done) vSemaphoreDelete(m_done);
+        m_ring = NULL;
+        m_done = NULL;
+        return false;
+    }
+    m_server.begin();
+    m_server.setNoDelay(true);
+    m_f_run = true;
+    if(xTaskCreatePinnedToCore(feedTask, "EventFeed", 4096, this, prio, &m_task, core) != pdPASS) {
+        m_f_run = false;
+        m_server.end();
+        vRingbufferDelete(m_ring);
+        vSemaphoreDelete(m_done);
+        m_ring = NULL;
+        m_done = NULL;
+        m_task = NULL;
+        return false;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void EventFeed::end() {
+    if(!m_task) return;
+    m_f_run = false;
+    xSemaphoreTake(m_done, portMAX_DELAY); // the task closes the clients, signals and deletes itself
+    m_task = NULL;
+    m_server.end();
+    vRingbufferDelete(m_ring);
+    vSemaphoreDelete(m_done);
+    m_ring = NULL;
+    m_done = NULL;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool EventFeed::publish(const char* event, const char* data) {
+    if(!m_ring || !event || !data) return false;
+    if(!m_clients) return true; // nobody listens, the page fetches a snapshot when it connects
+
+    // event: <event>\n  data: <line>\n ...  \n    ('\r' is a line end in SSE, it is dropped)
+    size_t len = 7 + strlen(event) + 1 + 1;
+    const char* p = data;
+    while(true) {
+        const char* nl = strchr(p, '\n');
+        size_t      n = nl ? (size_t)(nl - p) : strlen(p);
+        for(size_t i = 0; i < n; i++) if(p[i] != '\r') len++;
+        len += 6 + 1;
+        if(!nl) break;
+        p = nl + 1;
+    }
+    char* buf = NULL;
+    if(xRingbufferSendAcquire(m_ring, (void**)&buf, len, 0) != pdTRUE) { m_dropped++; return false; }
+    char* w = buf;
+    w += sprintf(w, "event: %s\n", event);
+    p = data;
+    while(true) {
+        memcpy(w, "data: ", 6);
+        w += 6;
+        while(*p && *p != '\n') {
+            if(*p != '\r') *w++ = *p;
+            p++;
+        }
+        *w++ = '\n';
+        if(!*p) break;
+        p++; // '\n'
+    }
+    *w++ = '\n';
+    xRingbufferSendComplete(m_ring, buf);
+    return true;
+}
+
+bool EventFeed::publish(const char* event, int32_t value) {
+    char tmp[12];
+    itoa(value, tmp, 10);
+    return publish(event, tmp);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void EventFeed::feedTask(void* param) {
+    EventFeed* feed = (EventFeed*)param;
+    feed->run();
+    xSemaphoreGive(feed->m_done); // the last access to the object, end() may free it from here on
+    vTaskDelete(NULL);
+}
+
+void EventFeed::run() {
+    while(m_f_run) {
+        acceptClient();
+        size_t   len = 0;
+        uint8_t* item = (uint8_t*)xRingbufferReceive(m_ring, &len, pdMS_TO_TICKS(100));
+        if(item) {
+            sendAll(item, len);
+            vRingbufferReturnItem(m_ring, item);
+        }
+        else if(m_clients && millis() - m_lastSend > FEED_PING_MS) {
+            sendAll((const uint8_t*)": ping\n\n", 8);
+        }
+    }
+    for(int i = 0; i < FEED_MAX_CLIENTS; i++) m_client[i].stop();
+    m_clients = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void EventFeed::acceptClient() {
+    WiFiClient c = m_server.accept();
+    if(!c) return;
+    uint32_t t = millis(); // every path gets the feed, only the Origin header is looked at
+    uint8_t  blank = 0;
+    char     line[64];
+    uint8_t  n = 0;
+    bool     ownPage = false;
+    String   origin = "http://" + c.localIP().toString(); // the page on port 80 of the same address
+    while(c.connected() && millis() - t < 500 && blank < 4) {
+        if(!c.available()) { vTaskDelay(2); continue; }
+        char ch = c.read();
+        if(ch == '\r' || ch == '\n') {
+            line[n] = '\0';
+            if(n && !strncasecmp(line, "Origin:", 7)) {
+                const char* v = line + 7;
+                while(*v == ' ') v++;
+                ownPage = origin == v;
+            }
+            n = 0;
+            blank++;
+        }
+        else {
+            if(n < sizeof(line) - 1) line[n++] = ch;
+            blank = 0;
+        }
+    }
+    int slot = -1;
+    for(int i = 0; i < FEED_MAX_CLIENTS; i++) {
+        if(!m_client[i].connected()) { slot = i; break; }
+    }
+    if(slot < 0) {
+        c.print("HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+        c.stop();
+        return;
+    }
+    c.print("HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n");
+    if(ownPage) c.print("Access-Control-Allow-Origin: " + origin + "\r\nVary: Origin\r\n"); // no other site reads the feed
+    c.print("Connection: keep-alive\r\n\r\n"
+            "retry: 2000\n\n");
+    m_client[slot] = c;
+    m_clients++;
+    m_lastSend = millis();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void EventFeed::sendAll(const uint8_t* buf, size_t len) {
+    uint8_t n = 0;
+    for(int i = 0; i < FEED_MAX_CLIENTS; i++) {
+        if(!m_client[i]) continue;
+        if(!m_client[i].connected() || m_client[i].write(buf, len) != len) { m_client[i].stop(); continue; }
+        n++;
+    }
+    m_clients = n;
+    m_lastSend = millis();
+}
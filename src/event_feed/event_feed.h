@@ -0,0 +1,52 @@
+// Server-Sent Events push channel for the dashboard, served by its own task
+#pragma once
+
+#include "Arduino.h"
+#include <WiFi.h>
+#include <atomic>
+#include <freertos/ringbuf.h>
+
+//  publish() formats the SSE frame directly into a FreeRTOS ring buffer and returns, it never blocks and may be called
+//  from any task. The feed task takes the frames out and writes them to all connected EventSource clients.
+//
+//  publish("log", "Listening...\n")   ->  event: log\n data: Listening...\n data: \n \n
+//
+//  loop() / other tasks --publish()--> | ring buffer | --feed task--> client 0 ... client FEED_MAX_CLIENTS - 1
+//
+//  Browser side: new EventSource('http://' + location.hostname + ':81/events'), the page fetches one snapshot on
+//  (re)connect and applies the incremental events after that. The feed is cross-origin for the page (port 80), the
+//  CORS header is only sent back to the device's own page, http://<the address the browser connected to>.
+
+class EventFeed {
+
+public:
+    EventFeed(uint16_t port = 81);
+    ~EventFeed();
+    bool     begin(size_t queueBytes = 6144, uint8_t core = 0, UBaseType_t prio = 1);
+    void     end();
+    bool     publish(const char* event, const char* data);     // false if the frame didn't fit, counted in dropped()
+    bool     publish(const char* event, const String& data) { return publish(event, data.c_str()); };
+    bool     publish(const char* event, int32_t value);
+    uint8_t  clients() { return m_clients; };
+    uint32_t dropped() { return m_dropped; };
+
+    static const uint8_t  FEED_MAX_CLIENTS = 3;
+    static const uint32_t FEED_PING_MS     = 15000; // comment frame, detects dead connections
+
+private:
+    static void feedTask(void* param);
+    void        run();
+    void        acceptClient();
+    void        sendAll(const uint8_t* buf, size_t len);
+
+    uint16_t              m_port;
+    WiFiServer            m_server;
+    WiFiClient            m_client[FEED_MAX_CLIENTS];
+    RingbufHandle_t       m_ring = NULL;
+    TaskHandle_t          m_task = NULL;
+    SemaphoreHandle_t     m_done = NULL;     // given by the task right before it deletes itself
+    std::atomic<bool>     m_f_run{false};
+    std::atomic<uint8_t>  m_clients{0};
+    std::atomic<uint32_t> m_dropped{0};
+    uint32_t              m_lastSend = 0;
+};
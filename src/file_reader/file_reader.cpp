@@ -0,0 +1,192 @@
+/*
+ * file_reader.cpp
+ *
+ *  read-ahead task for local audio files, sector aligned block reads into a double buffer, the player copies from
+ *  a ready block and never waits for the card
+ *
+ */
+#include "file_reader.h"
+
+FileReader::FileReader(uint16_t blockSize) {
+    setBlockSize(blockSize);
+}
+
+FileReader::~FileReader() {
+    end();
+    if(m_lock) xSemaphoreTake(m_lock, portMAX_DELAY); // the task must not hold it when it goes
+    if(m_task) vTaskDelete(m_task);
+    if(m_lock) vSemaphoreDelete(m_lock);
+    for(uint8_t i = 0; i < 2; i++) free(m_block[i].data);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FileReader::setBlockSize(uint16_t blockSize) {
+    blockSize -= blockSize % SECTOR;
+    m_blockSize = max(blockSize, (uint16_t)SECTOR);
+}
+
+bool FileReader::begin(File* file, uint32_t pos) {
+    end();
+    if(m_allocSize != m_blockSize) { // internal RAM, the SD driver reads into it by DMA
+        for(uint8_t i = 0; i < 2; i++) {
+            free(m_block[i].data);
+            m_block[i].data = (uint8_t*)heap_caps_malloc(m_blockSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+        m_allocSize = m_blockSize;
+        if(!m_block[0].data || !m_block[1].data) {
+            log_e("FileReader: no memory for 2 x %u bytes", m_blockSize);
+            for(uint8_t i = 0; i < 2; i++) { free(m_block[i].data); m_block[i].data = NULL; }
+            m_allocSize = 0;
+            return false;
+        }
+    }
+    if(!startTask()) return false;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_file = file;
+    xSemaphoreGive(m_lock);
+    seek(pos);
+    return true;
+}
+
+bool FileReader::startTask() {
+    if(!m_lock) m_lock = xSemaphoreCreateMutex();
+    if(!m_lock) return false;
+    // 4096: a job opens and writes files, the block reads alone get along with less
+    if(!m_task && xTaskCreatePinnedToCore(taskWrapper, "AudioReadAhead", 4096, this, 3, &m_task, tskNO_AFFINITY) != pdPASS) {
+        m_task = NULL;
+        log_e("FileReader: task not created");
+        return false;
+    }
+    return true;
+}
+
+void FileReader::end() {
+    if(!m_lock) return;
+    xSemaphoreTake(m_lock, portMAX_DELAY); // a running read is finished when we get it
+    m_file = NULL;
+    drop();
+    xSemaphoreGive(m_lock);
+}
+
+void FileReader::pause() {
+    if(!m_lock) return;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_f_paused = true;
+    xSemaphoreGive(m_lock);
+}
+
+void FileReader::seek(uint32_t pos) {
+    if(!m_lock) return;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    drop();
+    m_next = pos;
+    m_pos = pos;
+    m_f_reposition = true;
+    m_f_paused = false;
+    xSemaphoreGive(m_lock);
+    if(m_task) xTaskNotifyGive(m_task);
+}
+
+bool FileReader::startJob(job_t job, void* arg) {
+    if(!startTask()) return false;
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_job = job;
+    m_jobArg = arg;
+    xSemaphoreGive(m_lock);
+    xTaskNotifyGive(m_task);
+    return true;
+}
+
+void FileReader::stopJob() {
+    if(!m_lock) return;
+    xSemaphoreTake(m_lock, portMAX_DELAY); // a running step is finished when we get it
+    m_job = NULL;
+    m_jobArg = NULL;
+    xSemaphoreGive(m_lock);
+}
+
+void FileReader::drop() { // with the lock, the task is not inside a read
+    m_fillIdx = 0;
+    m_readIdx = 0;
+    m_f_eof = false;
+    for(uint8_t i = 0; i < 2; i++) {
+        m_block[i].len = 0;
+        m_block[i].off = 0;
+        m_block[i].state.store(BLOCK_FREE, std::memory_order_release);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t FileReader::read(uint8_t* dst, size_t len) {
+    size_t n = 0;
+    while(n < len) {
+        block_t& b = m_block[m_readIdx];
+        if(b.state.load(std::memory_order_acquire) != BLOCK_READY) {
+            if(!n && !m_f_eof && m_file && !m_f_paused) m_stats.stalls++;
+            break;
+        }
+        size_t k = min(len - n, (size_t)(b.len - b.off));
+        memcpy(dst + n, b.data + b.off, k);
+        b.off += k;
+        n += k;
+        if(b.off == b.len) { // back to the task
+            b.state.store(BLOCK_FREE, std::memory_order_release);
+            m_readIdx ^= 1;
+            xTaskNotifyGive(m_task);
+        }
+    }
+    m_pos += n;
+    return n;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FileReader::taskWrapper(void* param) {
+    static_cast<FileReader*>(param)->task();
+}
+
+void FileReader::task() {
+    while(true) {
+        ulTaskNotifyTake(pdTRUE, m_job ? 1 : pdMS_TO_TICKS(20)); // a job goes on after a tick, read() wakes us earlier
+        while(true) {
+            xSemaphoreTake(m_lock, portMAX_DELAY);
+            block_t& b = m_block[m_fillIdx];
+            if(!m_file || m_f_paused || m_f_eof || b.state.load(std::memory_order_acquire) != BLOCK_FREE) {
+                xSemaphoreGive(m_lock);
+                break;
+            }
+            if(m_f_reposition) {
+                m_file->seek(m_next);
+                m_f_reposition = false;
+            }
+            uint16_t want = m_allocSize - (m_next % SECTOR); // after a seek: up to the next sector boundary
+            uint32_t t = micros();
+            int      r = m_file->read(b.data, want);
+            t = micros() - t;
+            if(r > 0) {
+                b.len = r;
+                b.off = 0;
+                m_next += r;
+                b.state.store(BLOCK_READY, std::memory_order_release);
+                m_fillIdx ^= 1;
+                m_stats.bytes += r;
+                m_stats.reads++;
+                if(t > m_stats.maxReadUs) m_stats.maxReadUs = t;
+                m_readUs += t;
+            }
+            if(r < want) m_f_eof = true;
+            xSemaphoreGive(m_lock);
+        }
+        xSemaphoreTake(m_lock, portMAX_DELAY); // the blocks are full (or not used), one step of the job
+        if(m_job && !m_job(m_jobArg)) {
+            m_job = NULL;
+            m_jobArg = NULL;
+        }
+        xSemaphoreGive(m_lock);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FileReader::getStats(stats_t* stats, bool reset) {
+    m_stats.kBps = m_readUs ? (uint32_t)((uint64_t)m_stats.bytes * 1000 / m_readUs) : 0;
+    if(stats) *stats = m_stats;
+    if(reset) {
+        m_stats = {};
+        m_readUs = 0;
+    }
+}
@@ -0,0 +1,82 @@
+// read-ahead for local audio files: a task reads sector aligned blocks into a double buffer, the player only copies
+#pragma once
+
+#include "Arduino.h"
+#include "FS.h"
+#include <atomic>
+
+//  The reader task keeps both blocks filled, the player (processLocalFile) takes the bytes with read() and never
+//  waits for the card. The first read after a seek ends on a sector boundary, all later reads are whole blocks that
+//  start on a sector boundary, so FATFS can pass them to the SD driver as multi-sector reads without a bounce copy:
+//
+//  file:   |....seek|  block 0  |  block 1  |  block 0  | ...     (SECTOR aligned from the second read on)
+//                    ^ task fills FREE blocks, READY blocks go to the player, read() frees them again
+//
+//  The task and the player share the File: everything else that touches it (header, scans for a frame start) calls
+//  pause() first, seek() hands the file back to the task.
+//
+//  A job (the seek index of the player) runs in the same task in steps, one step whenever both blocks are full, with
+//  its own File. It never delays a block, pause() / seek() / end() wait for one step at most. startJob() starts the
+//  task by itself, without begin() the task runs the job only.
+
+class FileReader {
+
+public:
+    typedef bool (*job_t)(void* arg);          // one step, false when the job is done
+
+    typedef struct {
+        uint32_t bytes;       // read from the file
+        uint32_t reads;
+        uint32_t stalls;      // read() found no block ready before the end of the file
+        uint32_t maxReadUs;   // slowest single read
+        uint32_t kBps;        // throughput of the reads alone
+    } stats_t;
+
+    FileReader(uint16_t blockSize = 4096);
+    ~FileReader();
+    void     setBlockSize(uint16_t blockSize);  // multiple of SECTOR, takes effect with the next begin()
+    bool     begin(File* file, uint32_t pos);   // starts the task on the first call
+    void     end();                             // the file is not used any more, waits for a running read
+    void     pause();                           // the caller may use the file until seek()
+    void     seek(uint32_t pos);                // drops the blocks, the task goes on reading from pos
+    size_t   read(uint8_t* dst, size_t len);    // what is ready, never waits
+    bool     startJob(job_t job, void* arg);    // replaces a running job
+    void     stopJob();                         // waits for a running step
+    bool     active() { return m_file != NULL; };
+    uint32_t position() { return m_pos; };      // next byte for read()
+    void     getStats(stats_t* stats, bool reset = false);
+
+    static const uint16_t SECTOR = 512;
+
+private:
+    enum : uint8_t {BLOCK_FREE = 0, BLOCK_READY = 1};
+    typedef struct {
+        std::atomic<uint8_t> state;
+        uint8_t*             data;
+        uint16_t             len;
+        uint16_t             off;               // consumed by read()
+    } block_t;
+
+    static void taskWrapper(void* param);
+    bool        startTask();
+    void        task();
+    void        drop();
+
+    File*             m_file = NULL;
+    block_t           m_block[2] = {};
+    uint16_t          m_blockSize;
+    uint16_t          m_allocSize = 0;
+    uint8_t           m_fillIdx = 0;         // task side
+    uint8_t           m_readIdx = 0;         // player side
+    uint32_t          m_next = 0;            // file position of the next read of the task
+    uint32_t          m_pos = 0;
+    bool              m_f_reposition = false;
+    bool              m_f_paused = false;
+    std::atomic<bool> m_f_eof = {false};
+    SemaphoreHandle_t m_lock = NULL;         // the task holds it for each read, the player for pause/seek/end
+    TaskHandle_t      m_task = NULL;
+    job_t             m_job = NULL;          // with the lock
+    void*             m_jobArg = NULL;
+    stats_t           m_stats = {};
+    uint64_t          m_readUs = 0;
+};
@@ -10,6 +10,7 @@
  *
  */
 #include "flac_decoder.h"
+#include "../audio_arena/audio_arena.h"
 #include "vector"
 using namespace std;
 
@@ -55,40 +56,25 @@ int32_t          s_nBytes = 0;
 //          FLAC INI SECTION
 //----------------------------------------------------------------------------------------------------------------------
 
-// prefer PSRAM
-#define __malloc_heap_psram(size) \
-    heap_caps_malloc_prefer(size, 2, MALLOC_CAP_DEFAULT|MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT|MALLOC_CAP_INTERNAL)
+AudioArena s_flacArena("flac");
+int32_t*   s_flacChannelBuff[MAX_CHANNELS];
 
 bool FLACDecoder_AllocateBuffers(void){
-
-    if(!FLACFrameHeader)    {FLACFrameHeader    = (FLACFrameHeader_t*)    __malloc_heap_psram(sizeof(FLACFrameHeader_t));}
-    if(!FLACMetadataBlock)  {FLACMetadataBlock  = (FLACMetadataBlock_t*)  __malloc_heap_psram(sizeof(FLACMetadataBlock_t));}
-    if(!s_flacStreamTitle)  {s_flacStreamTitle  = (char*)                 __malloc_heap_psram(256);}
-
-    if(!FLACFrameHeader || !FLACMetadataBlock || !s_flacStreamTitle){
-        log_e("not enough memory to allocate flacdecoder buffers");
-        return false;
-    }
-
-    if(psramFound()){
-        s_samplesBuffer = (int32_t**)ps_malloc(MAX_CHANNELS * sizeof(int32_t*));
+    // one region, the sample buffers (2 x 64KB) are too big for the internal SRAM and are read sequentially
+    if(!s_flacArena.isAllocated()) {
+        s_flacArena.reset();
+        s_flacArena.add((void**)&FLACFrameHeader,   sizeof(FLACFrameHeader_t),        AudioArena::HOT);
+        s_flacArena.add((void**)&s_samplesBuffer,   MAX_CHANNELS * sizeof(int32_t*),  AudioArena::HOT);
         for (int32_t i = 0; i < MAX_CHANNELS; i++){
-            s_samplesBuffer[i] = (int32_t*)ps_malloc(s_maxBlocksize * sizeof(int32_t));
-            if(!s_samplesBuffer[i]){
-                log_e("not enough memory to allocate flacdecoder buffers");
-                return false;
-            }
+            s_flacArena.add((void**)&s_flacChannelBuff[i], s_maxBlocksize * sizeof(int32_t), AudioArena::COLD);
         }
-    }
-    else  {
-        s_samplesBuffer = (int32_t**)malloc(MAX_CHANNELS * sizeof(int32_t*));
-        for (int32_t i = 0; i < MAX_CHANNELS; i++){
-            s_samplesBuffer[i] = (int32_t*)malloc(s_maxBlocksize * sizeof(int32_t));
-            if(!s_samplesBuffer[i]){
-                log_e("not enough memory to allocate flacdecoder buffers");
-                return false;
-            }
+        s_flacArena.add((void**)&FLACMetadataBlock, sizeof(FLACMetadataBlock_t),     AudioArena::COLD);
+        s_flacArena.add((void**)&s_flacStreamTitle, 256,                              AudioArena::COLD);
+        if(!s_flacArena.allocate()){
+            log_e("not enough memory to allocate flacdecoder buffers");
+            return false;
         }
+        for (int32_t i = 0; i < MAX_CHANNELS; i++) s_samplesBuffer[i] = s_flacChannelBuff[i];
     }
 
     FLACDecoder_ClearBuffer();
@@ -113,17 +99,9 @@ void FLACDecoder_ClearBuffer(){
 }
 //----------------------------------------------------------------------------------------------------------------------
 void FLACDecoder_FreeBuffers(){
-    if(FLACFrameHeader)    {free(FLACFrameHeader);    FLACFrameHeader    = NULL;}
-    if(FLACMetadataBlock)  {free(FLACMetadataBlock);  FLACMetadataBlock  = NULL;}
-    if(s_flacStreamTitle)  {free(s_flacStreamTitle);  s_flacStreamTitle  = NULL;}
+    s_flacArena.release(); // FLACFrameHeader, FLACMetadataBlock, s_flacStreamTitle, s_samplesBuffer become NULL
     if(s_flacVendorString) {free(s_flacVendorString); s_flacVendorString = NULL;}
 
-    if(s_samplesBuffer){
-        for (int32_t i = 0; i < MAX_CHANNELS; i++){
-            if(s_samplesBuffer[i]){free(s_samplesBuffer[i]);}
-        }
-        free(s_samplesBuffer); s_samplesBuffer = NULL;
-    }
     coefs.clear(); coefs.shrink_to_fit();
     s_flacSegmTableVec.clear(); s_flacSegmTableVec.shrink_to_fit();
     s_flacBlockPicItem.clear(); s_flacBlockPicItem.shrink_to_fit();
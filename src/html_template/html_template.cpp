@@ -0,0 +1,126 @@
+/*
+ * html_template.cpp
+ *
+ *  chunked template rendering without a copy of the page, gzip assets from flash, ETag / If-None-Match
+ *
+ */
+#include "html_template.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+void HtmlTemplate::collectHeaders(WebServer& server) {
+    const char* keys[] = {"If-None-Match"};
+    server.collectHeaders(keys, 1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t HtmlTemplate::fnv1a(const void* data, size_t len, uint32_t hash) {
+    const uint8_t* p = (const uint8_t*)data;
+    while(len--) {
+        hash ^= *p++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool HtmlTemplate::notModified(WebServer& server, const char* etag) {
+    server.sendHeader("ETag", etag);
+    if(!server.hasHeader("If-None-Match") || server.header("If-None-Match") != etag) return false;
+    server.send(304);
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void HtmlTemplate::sendGzip(WebServer& server, const char* type, const uint8_t* gz, size_t len, const char* etag) {
+    server.sendHeader("Cache-Control", "no-cache"); // revalidated with the ETag, the body comes from the browser cache
+    if(notModified(server, etag)) return;
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, type, (const char*)gz, len);
+}
+//----------------------------------------------------------------------------------------------------------------------
+const char* HtmlTemplate::nextPlaceholder(const char* p, const char** name, size_t* nameLen) {
+    // returns the position of the next "{{name}}" or NULL, name is [a-zA-Z0-9_] only so JS and CSS braces pass through
+    while((p = strstr(p, "{{")) != NULL) {
+        const char* n = p + 2;
+        const char* e = n;
+        while(isalnum((uint8_t)*e) || *e == '_') e++;
+        if(e > n && e - n < TPL_MAX_NAME && e[0] == '}' && e[1] == '}') {
+            *name = n;
+            *nameLen = e - n;
+            return p;
+        }
+        p += 2;
+    }
+    return NULL;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void HtmlTemplate::render(WebServer& server, const char* tmpl, resolver_t resolve) {
+    char        name[TPL_MAX_NAME];
+    const char* n;
+    size_t      nLen;
+
+    // pass 1: ETag over the template and the values, nothing is sent
+    uint32_t    hash = fnv1a(tmpl, strlen(tmpl));
+    const char* p = tmpl;
+    const char* ph;
+    while((ph = nextPlaceholder(p, &n, &nLen)) != NULL) {
+        memcpy(name, n, nLen);
+        name[nLen] = '\0';
+        const char* v = resolve(name);
+        if(v) hash = fnv1a(v, strlen(v), hash);
+        hash = fnv1a("\0", 1, hash); // "a" + "" != "" + "a"
+        p = n + nLen + 2;
+    }
+    char etag[12];
+    snprintf(etag, sizeof(etag), "\"%08x\"", (unsigned)hash);
+    server.sendHeader("Cache-Control", "no-cache");
+    if(notModified(server, etag)) return;
+
+    // pass 2: chunked response
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/html", "");
+    HtmlTemplate out(server);
+    p = tmpl;
+    while((ph = nextPlaceholder(p, &n, &nLen)) != NULL) {
+        out.literal(p, ph - p);
+        memcpy(name, n, nLen);
+        name[nLen] = '\0';
+        const char* v = resolve(name);
+        if(v) out.value(v);
+        p = n + nLen + 2;
+    }
+    out.literal(p, strlen(p));
+    out.flush();
+    server.sendContent("", 0); // last chunk
+}
+//----------------------------------------------------------------------------------------------------------------------
+void HtmlTemplate::literal(const char* p, size_t len) {
+    if(len <= (size_t)(TPL_BUFF - m_len)) { // short runs between two values are merged into one chunk
+        memcpy(m_buff + m_len, p, len);
+        m_len += len;
+        return;
+    }
+    flush();
+    m_server.sendContent(p, len); // directly from flash
+}
+//----------------------------------------------------------------------------------------------------------------------
+void HtmlTemplate::value(const char* v) {
+    for(; *v; v++) {
+        const char* esc = NULL;
+        switch(*v) {
+            case '&':  esc = "&amp;"; break;
+            case '<':  esc = "&lt;"; break;
+            case '>':  esc = "&gt;"; break;
+            case '"':  esc = "&quot;"; break;
+            case '\'': esc = "&#39;"; break;
+        }
+        size_t n = esc ? strlen(esc) : 1;
+        if(m_len + n > TPL_BUFF) flush();
+        if(esc) memcpy(m_buff + m_len, esc, n);
+        else m_buff[m_len] = *v;
+        m_len += n;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void HtmlTemplate::flush() {
+    if(!m_len) return;
+    m_server.sendContent(m_buff, m_len);
+    m_len = 0;
+}
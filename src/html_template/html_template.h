@@ -0,0 +1,42 @@
+// streams a page template from flash with {{name}} placeholders, serves gzip assets, ETag revalidation
+#pragma once
+
+#include "Arduino.h"
+#include <WebServer.h>
+#include <functional>
+
+//  The template is never copied: literal runs go from flash straight into the chunked response, only the resolved
+//  values pass through a small buffer (HTML escaped). The ETag is a hash over the template and the resolved values,
+//  an unchanged page is answered with 304.
+//
+//  <input id="ssid" value="{{ssid}}">   resolve("ssid") -> "MyWiFi"   ->   <input id="ssid" value="MyWiFi">
+//
+//  HtmlTemplate::collectHeaders(server);   // once, before server.begin()
+//  HtmlTemplate::render(server, page, [](const char* name) -> const char* { ... });
+//  HtmlTemplate::sendGzip(server, "text/css", css_gz, sizeof(css_gz), css_etag);
+
+class HtmlTemplate {
+
+public:
+    typedef std::function<const char*(const char* name)> resolver_t; // NULL: the placeholder is left empty
+
+    static void     collectHeaders(WebServer& server);
+    static void     render(WebServer& server, const char* tmpl, resolver_t resolve);
+    static void     sendGzip(WebServer& server, const char* type, const uint8_t* gz, size_t len, const char* etag);
+    static bool     notModified(WebServer& server, const char* etag); // true: 304 already sent
+    static uint32_t fnv1a(const void* data, size_t len, uint32_t hash = 2166136261u);
+
+    static const uint8_t  TPL_MAX_NAME = 24;
+    static const uint16_t TPL_BUFF     = 512; // values are collected here, literal runs above this size bypass it
+
+private:
+    HtmlTemplate(WebServer& server) : m_server(server) {}
+    void        literal(const char* p, size_t len);
+    void        value(const char* v);
+    void        flush();
+    static const char* nextPlaceholder(const char* p, const char** name, size_t* nameLen);
+
+    WebServer& m_server;
+    char       m_buff[TPL_BUFF];
+    uint16_t   m_len = 0;
+};
@@ -0,0 +1,276 @@
+/*
+ * json_stream.cpp
+ *
+ *  pull one string value out of a JSON document (or a stream of server-sent events) byte by byte, only the path to
+ *  the current value is kept; write JSON with escaping on the fly, also as a readable Stream for request bodies
+ *
+ */
+#include "json_stream.h"
+
+JsonStream::JsonStream(const char* path, Print* out, bool sse) : m_out(out), m_sse(sse) {
+    strlcpy(m_pathBuf, path ? path : "", sizeof(m_pathBuf));
+    char* p = m_pathBuf;
+    while(*p && m_pathLen < JSON_MAX_PATH) { // "choices/0/message/content"
+        m_path[m_pathLen++] = p;
+        p = strchr(p, '/');
+        if(!p) break;
+        *p++ = '\0';
+    }
+    reset();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void JsonStream::reset() {
+    newDocument();
+    m_f_found = false;
+    m_f_done = false;
+    m_valueLen = 0;
+    m_lineLen = 0;
+    m_f_data = false;
+    m_buffLen = 0;
+}
+
+void JsonStream::newDocument() {
+    m_depth = 0;
+    m_f_string = false;
+    m_f_key = false;
+    m_f_expectKey = false;
+    m_f_emit = false;
+    m_f_escape = false;
+    m_hexLeft = 0;
+    m_highSurrogate = 0;
+    m_donePos = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t JsonStream::feed(const uint8_t* data, size_t len) {
+    for(size_t i = 0; i < len && !m_f_done; i++) {
+        uint8_t c = data[i];
+        if(!m_sse) { parse(c); continue; }
+
+        if(c == '\n') { m_lineLen = 0; m_f_data = false; continue; } // an event line is over
+        if(c == '\r') continue;
+        if(!m_f_data) {
+            if(m_lineLen < 5 && c == "data:"[m_lineLen]) {
+                if(++m_lineLen == 5) { m_f_data = true; newDocument(); }
+            }
+            else m_lineLen = 6; // "event:", "id:", ": keep-alive" ... skipped up to the line end
+            continue;
+        }
+        if(m_donePos < 6) { // "data: [DONE]"
+            if(c == "[DONE]"[m_donePos]) { if(++m_donePos == 6) m_f_done = true; }
+            else if(c != ' ' || m_donePos) m_donePos = 6;
+        }
+        parse(c);
+    }
+    flush();
+    return len;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void JsonStream::parse(uint8_t c) {
+    if(m_f_string) { stringChar(c); return; }
+    level_t* top = m_depth && m_depth <= JSON_MAX_DEPTH ? &m_level[m_depth - 1] : NULL;
+    switch(c) {
+        case '"':
+            m_f_string = true;
+            m_f_key = top && !top->array && m_f_expectKey;
+            if(m_f_key) top->keyLen = 0;
+            else m_f_emit = pathMatches();
+            if(m_f_emit) m_f_found = true;
+            break;
+        case '{':
+        case '[':
+            if(m_depth < JSON_MAX_DEPTH) {
+                m_level[m_depth].array = c == '[';
+                m_level[m_depth].index = 0;
+                m_level[m_depth].keyLen = 0;
+                m_level[m_depth].key[0] = '\0';
+            }
+            m_depth++;
+            m_f_expectKey = c == '{';
+            break;
+        case '}':
+        case ']':
+            if(m_depth) m_depth--;
+            m_f_expectKey = false;
+            if(!m_depth && !m_sse) m_f_done = true;
+            break;
+        case ',':
+            if(top && top->array) top->index++;
+            else m_f_expectKey = true;
+            break;
+        case ':':
+            m_f_expectKey = false;
+            break;
+        default: break; // whitespace, numbers, true, false, null
+    }
+}
+
+bool JsonStream::pathMatches() {
+    if(m_depth != m_pathLen || m_depth > JSON_MAX_DEPTH) return false;
+    for(uint8_t i = 0; i < m_depth; i++) {
+        const level_t& l = m_level[i];
+        const char*    p = m_path[i];
+        if(l.array) {
+            if(!isdigit((uint8_t)*p) || (uint16_t)atoi(p) != l.index) return false;
+        }
+        else if(l.keyLen > JSON_MAX_KEY || strcmp(l.key, p)) return false;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void JsonStream::stringChar(uint8_t c) {
+    if(m_hexLeft) {
+        uint8_t d = isdigit(c) ? c - '0' : isxdigit(c) ? (tolower(c) - 'a' + 10) : 0;
+        m_hex = (m_hex << 4) | d;
+        if(--m_hexLeft) return;
+        uint16_t u = m_hex;
+        if(u >= 0xD800 && u < 0xDC00) { // high surrogate, the low one follows as the next \u
+            loneSurrogate();
+            m_highSurrogate = u;
+        }
+        else if(u >= 0xDC00 && u < 0xE000) {
+            uint32_t cp = m_highSurrogate ? 0x10000 + ((uint32_t)(m_highSurrogate - 0xD800) << 10) + (u - 0xDC00) : 0xFFFD;
+            m_highSurrogate = 0;
+            codePoint(cp);
+        }
+        else codePoint(u);
+        return;
+    }
+    if(m_f_escape) {
+        m_f_escape = false;
+        switch(c) {
+            case 'u': m_hexLeft = 4; m_hex = 0; return;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            default: break; // \" \\ \/
+        }
+        codePoint(c);
+        return;
+    }
+    if(c == '\\') { m_f_escape = true; return; }
+    if(c == '"') {
+        loneSurrogate();
+        m_f_string = false;
+        m_f_emit = false;
+        if(m_f_key) {
+            level_t& l = m_level[m_depth - 1];
+            l.key[l.keyLen <= JSON_MAX_KEY ? l.keyLen : JSON_MAX_KEY] = '\0';
+        }
+        m_f_key = false;
+        return;
+    }
+    loneSurrogate();
+    put(c); // raw bytes, UTF-8 passes unchanged
+}
+
+void JsonStream::loneSurrogate() {
+    if(!m_highSurrogate) return;
+    m_highSurrogate = 0;
+    codePoint(0xFFFD); // a high surrogate without its low half
+}
+
+void JsonStream::codePoint(uint32_t cp) {
+    loneSurrogate();
+    if(cp < 0x80) { put(cp); return; }
+    if(cp < 0x800) { put(0xC0 | (cp >> 6)); }
+    else {
+        if(cp < 0x10000) { put(0xE0 | (cp >> 12)); }
+        else { put(0xF0 | (cp >> 18)); put(0x80 | ((cp >> 12) & 0x3F)); }
+        put(0x80 | ((cp >> 6) & 0x3F));
+    }
+    put(0x80 | (cp & 0x3F));
+}
+//----------------------------------------------------------------------------------------------------------------------
+void JsonStream::put(uint8_t c) {
+    if(m_f_key) {
+        level_t& l = m_level[m_depth - 1];
+        if(l.keyLen <= JSON_MAX_KEY) {
+            if(l.keyLen < JSON_MAX_KEY) l.key[l.keyLen] = c;
+            l.keyLen++; // JSON_MAX_KEY + 1 marks a key that is too long
+        }
+        return;
+    }
+    if(!m_f_emit) return;
+    m_valueLen++;
+    if(!m_out) return;
+    if(m_buffLen == sizeof(m_buff)) flush();
+    m_buff[m_buffLen++] = c;
+}
+
+void JsonStream::flush() {
+    if(m_out && m_buffLen) m_out->write(m_buff, m_buffLen);
+    m_buffLen = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void JsonWriter::escaped(const char* s, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        uint8_t c = s[i];
+        switch(c) {
+            case '"':  raw("\\\"", 2); break;
+            case '\\': raw("\\\\", 2); break;
+            case '\n': raw("\\n", 2); break;
+            case '\r': raw("\\r", 2); break;
+            case '\t': raw("\\t", 2); break;
+            default:
+                if(c < 0x20) { char u[7]; snprintf(u, sizeof(u), "\\u%04x", c); raw(u, 6); }
+                else put(c); // UTF-8 passes unchanged
+        }
+    }
+}
+
+void JsonWriter::flush() {
+    if(m_out && m_len) m_out->write(m_buff, m_len);
+    m_len = 0;
+}
+
+size_t JsonWriter::cutLength(const char* s, size_t len, size_t max) {
+    if(len <= max) return len;
+    while(max && ((uint8_t)s[max] & 0xC0) == 0x80) max--; // s[max] would be the first byte after the cut
+    return max;
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t JsonSource::size() {
+    if(m_size == SIZE_MAX) {
+        JsonWriter w(NULL);
+        m_render(w);
+        m_size = w.total();
+    }
+    return m_size;
+}
+
+bool JsonSource::fill() {
+    if(m_winPos < m_winLen) return true;
+    m_winStart += m_winLen;
+    m_winPos = 0;
+    m_winLen = 0;
+    if(m_winStart >= size()) return false;
+    JsonWriter w(m_win, m_winStart, sizeof(m_win));
+    m_render(w);
+    m_winLen = min(m_size - m_winStart, sizeof(m_win));
+    return true;
+}
+
+int JsonSource::available() {
+    return size() - m_winStart - m_winPos;
+}
+
+int JsonSource::read() {
+    return fill() ? m_win[m_winPos++] : -1;
+}
+
+int JsonSource::peek() {
+    return fill() ? m_win[m_winPos] : -1;
+}
+
+size_t JsonSource::readBytes(char* buffer, size_t length) {
+    size_t n = 0;
+    while(n < length && fill()) {
+        size_t k = min(length - n, (size_t)(m_winLen - m_winPos));
+        memcpy(buffer + n, m_win + m_winPos, k);
+        m_winPos += k;
+        n += k;
+    }
+    return n;
+}
@@ -0,0 +1,163 @@
+// streaming JSON: a reader that picks one string value out of a document while it arrives, a writer that escapes on
+// the fly and a Stream that renders a request body piece by piece, no document is ever held in memory
+#pragma once
+
+#include "Arduino.h"
+#include <functional>
+
+//  The bytes are fed as they come from the socket (feed() or HTTPClient::writeToStream()). The parser keeps only the
+//  path to the current value (object keys, array indices). A string at the wanted path is unescaped (\n, \", \uXXXX
+//  and surrogate pairs -> UTF-8) and written to the output, everything else is skipped:
+//
+//  {"id":"..","choices":[{"index":0,"message":{"role":"assistant","content":"Halo, selamat sore ..."}}],"usage":{..}}
+//              path "choices/0/message/content"  --------------------------------^ -> out
+//
+//  sse = true: the input is a text/event-stream, every "data: {...}" line is a document of its own, the values of all
+//  events are appended (path "choices/0/delta/content"), "data: [DONE]" ends the stream.
+//
+//  The JSON is not validated, a broken document gives a shorter or empty value, never more than the input.
+
+class JsonStream : public Stream {
+
+public:
+    JsonStream(const char* path, Print* out = NULL, bool sse = false);
+    void   reset();
+    void   setOutput(Print* out) { m_out = out; };
+    size_t feed(const uint8_t* data, size_t len);
+    bool   found() { return m_f_found; };     // the path was seen, the value may still be ""
+    bool   done() { return m_f_done; };       // document closed, [DONE] in sse mode
+    size_t valueLength() { return m_valueLen; };
+
+    // a Stream so that HTTPClient::writeToStream() can feed it (it decodes chunked transfer), nothing to read back
+    size_t write(uint8_t c) override { return feed(&c, 1); };
+    size_t write(const uint8_t* data, size_t len) override { return feed(data, len); };
+    int    available() override { return 0; };
+    int    read() override { return -1; };
+    int    peek() override { return -1; };
+
+    static const uint8_t JSON_MAX_DEPTH = 12;   // deeper values are skipped
+    static const uint8_t JSON_MAX_PATH  = 8;
+    static const uint8_t JSON_MAX_KEY   = 23;   // longer keys never match
+
+private:
+    struct level_t {
+        bool     array;
+        uint16_t index;
+        uint8_t  keyLen;                // JSON_MAX_KEY + 1: too long
+        char     key[JSON_MAX_KEY + 1];
+    };
+
+    void put(uint8_t c);
+    void parse(uint8_t c);
+    void stringChar(uint8_t c);
+    void codePoint(uint32_t cp);
+    void loneSurrogate();
+    bool pathMatches();
+    void flush();
+    void newDocument();
+
+    Print*   m_out;
+    bool     m_sse;
+    char     m_pathBuf[64];
+    char*    m_path[JSON_MAX_PATH];
+    uint8_t  m_pathLen = 0;
+
+    level_t  m_level[JSON_MAX_DEPTH];
+    uint8_t  m_depth = 0;             // may be larger than JSON_MAX_DEPTH
+    bool     m_f_string = false;
+    bool     m_f_key = false;         // the string is an object key
+    bool     m_f_expectKey = false;
+    bool     m_f_emit = false;        // the string is the wanted value
+    bool     m_f_escape = false;
+    uint8_t  m_hexLeft = 0;           // \uXXXX digits still to come
+    uint32_t m_hex = 0;
+    uint16_t m_highSurrogate = 0;
+    bool     m_f_found = false;
+    bool     m_f_done = false;
+    size_t   m_valueLen = 0;
+
+    uint8_t  m_lineLen = 0;           // sse: position in the line, "data:" is checked on the first 5 chars
+    bool     m_f_data = false;        // sse: inside a data line
+    uint8_t  m_donePos = 0;           // sse: matched chars of "[DONE]"
+
+    uint8_t  m_buff[64];              // output is written in pieces
+    uint8_t  m_buffLen = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+//  JsonWriter collects the output in a small buffer and writes it to a Print in pieces, out == NULL only counts.
+//  With a window only the bytes [skip, skip + size) are copied, the rest is counted (used by JsonSource).
+//
+//  w.raw("{\"role\":\"user\",\"content\":");  w.string(text);  w.raw("}");
+
+class JsonWriter {
+
+public:
+    JsonWriter(Print* out) : m_out(out) {};
+    JsonWriter(uint8_t* window, size_t skip, size_t size) : m_window(window), m_skip(skip), m_size(size) {};
+    ~JsonWriter() { flush(); };
+    void   raw(const char* s) { raw(s, strlen(s)); };
+    void   raw(const char* s, size_t len) { while(len--) put(*s++); };
+    void   escaped(const char* s, size_t len);                        // string content without the quotes
+    void   string(const char* s, size_t len) { put('"'); escaped(s, len); put('"'); };
+    void   string(const char* s) { string(s, strlen(s)); };
+    void   flush();
+    size_t total() { return m_total; };
+
+    // the length of s cut to at most max bytes, never inside a UTF-8 character: a cut one would not be valid JSON text
+    static size_t cutLength(const char* s, size_t len, size_t max);
+
+private:
+    void put(char c) {
+        if(m_window) {
+            if(m_total >= m_skip && m_total - m_skip < m_size) m_window[m_total - m_skip] = c;
+        }
+        else {
+            if(m_len == sizeof(m_buff)) flush();
+            m_buff[m_len++] = c;
+        }
+        m_total++;
+    }
+    Print*   m_out = NULL;
+    uint8_t* m_window = NULL;
+    size_t   m_skip = 0;
+    size_t   m_size = 0;
+    uint8_t  m_buff[128];
+    uint16_t m_len = 0;
+    size_t   m_total = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+//  JsonSource is a readable Stream over a render function, e.g. for HTTPClient::sendRequest("POST", &src, src.size()).
+//  size() renders once without output, every refill of the small window renders again and keeps only the next piece,
+//  so the body is produced from the original data (history, prompt) and never copied into a String.
+//  The data must not change until the request is sent.
+
+class JsonSource : public Stream {
+
+public:
+    typedef std::function<void(JsonWriter& w)> render_t;
+
+    JsonSource(render_t render) : m_render(render) {};
+    size_t size();
+    int    available() override;
+    int    read() override;
+    int    peek() override;
+    size_t readBytes(char* buffer, size_t length) override;
+    using  Stream::readBytes;
+    size_t write(uint8_t) override { return 0; };
+
+    static const uint16_t JSON_WINDOW = 512;
+
+private:
+    bool fill();
+
+    render_t m_render;
+    size_t   m_size = SIZE_MAX;  // not rendered yet
+    size_t   m_winStart = 0;     // body position of m_win[0]
+    uint16_t m_winLen = 0;
+    uint16_t m_winPos = 0;
+    uint8_t  m_win[JSON_WINDOW];
+};
@@ -0,0 +1,277 @@
+/*
+ * log_ring.cpp
+ *
+ *  fixed size log ring without locks, the writers store the format pointer and the binary arguments, the readers
+ *  format the text when they need it
+ *
+ */
+#include "log_ring.h"
+
+LogRing logRing;
+
+static const uint32_t LOG_BUSY = 0x80000000; // seq ^ LOG_BUSY while a writer fills the slot
+
+LogRing::LogRing() {
+    for(uint16_t i = 0; i < LOG_SLOTS; i++) m_slot[i].seq.store(i - LOG_SLOTS); // "previous lap", not readable yet
+}
+//----------------------------------------------------------------------------------------------------------------------
+const char* LogRing::spec(const char* p, char* s, char* conv, uint8_t* size) {
+    // p points to '%', copies the conversion into s ("%-08.3lu"), returns the position after it, '*' is not supported
+    uint8_t n = 0;
+    s[n++] = *p++;
+    while(*p && strchr("-+ #0123456789.", *p) && n < 12) s[n++] = *p++;
+    *size = 0;
+    while(*p && strchr("hlzjt", *p) && n < 14) {
+        if(*p == 'l' || *p == 'z' || *p == 'j' || *p == 't') *size += 1;
+        s[n++] = *p++;
+    }
+    if(*size > 2) *size = 2;
+    *conv = *p;
+    if(*p) s[n++] = *p++;
+    s[n] = '\0';
+    return p;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void LogRing::log(level_t level, const char* tag, const char* fmt, ...) {
+    // the record is written straight into its slots: no buffer of LOG_MAX_REC bytes on the stack of the caller,
+    // the audio task logs through here. The first pass measures, the second one stores what the first one measured.
+    if(level > m_level || !fmt) return;
+    va_list ap;
+    va_start(ap, fmt);
+    size_t len = pack(fmt, ap, LOG_MAX_REC, UINT32_MAX);
+    va_end(ap);
+    uint32_t idx = reserve(len);
+    hdr_t    h = {(uint32_t)millis(), level, 0, (uint16_t)(len - sizeof(hdr_t)), tag, fmt};
+    put(idx, len, 0, &h, sizeof(h));
+    va_start(ap, fmt);
+    pack(fmt, ap, len, idx);
+    va_end(ap);
+    publish(idx, len);
+}
+
+void LogRing::text(level_t level, const char* tag, const char* str, size_t len) {
+    if(level > m_level || !str || !len) return;
+    if(len > LOG_MAX_REC - sizeof(hdr_t)) len = LOG_MAX_REC - sizeof(hdr_t);
+    uint32_t idx = reserve(sizeof(hdr_t) + len);
+    hdr_t    h = {(uint32_t)millis(), level, 0, (uint16_t)len, tag, NULL};
+    put(idx, sizeof(h) + len, 0, &h, sizeof(h));
+    put(idx, sizeof(h) + len, sizeof(h), str, len);
+    publish(idx, sizeof(h) + len);
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t LogRing::pack(const char* fmt, va_list ap, size_t limit, uint32_t idx) {
+    // the arguments after the header, idx == UINT32_MAX only measures; returns the length of the record
+    size_t  n = sizeof(hdr_t);
+    char    s[16];
+    char    conv;
+    uint8_t sz;
+    for(const char* p = strchr(fmt, '%'); p; p = strchr(p, '%')) {
+        p = spec(p, s, &conv, &sz);
+        uint64_t v = 0;
+        switch(conv) {
+            case 'd': case 'i':
+                v = sz == 2 ? (int64_t)va_arg(ap, long long) : sz == 1 ? (int64_t)va_arg(ap, long) : (int64_t)va_arg(ap, int);
+                break;
+            case 'u': case 'x': case 'X': case 'o': case 'c':
+                v = sz == 2 ? va_arg(ap, unsigned long long) : sz == 1 ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+                break;
+            case 'p':
+                v = (uintptr_t)va_arg(ap, void*);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                double d = va_arg(ap, double);
+                memcpy(&v, &d, 8);
+                break;
+            }
+            case 's': {
+                const char* str = va_arg(ap, const char*);
+                if(!str) str = "(null)";
+                if(n + 3 > limit) return n;
+                size_t len = strlen(str); // may have changed since the first pass, the cut at limit keeps the record
+                if(len > limit - n - 3) len = limit - n - 3; // cut, the terminator is kept
+                uint16_t l16 = len + 1;
+                if(idx != UINT32_MAX) {
+                    put(idx, limit, n, &l16, 2);
+                    put(idx, limit, n + 2, str, len);
+                    put(idx, limit, n + 2 + len, "", 1);
+                }
+                n += 2 + len + 1;
+                continue;
+            }
+            default: continue; // "%%"
+        }
+        if(n + 8 > limit) return n;
+        if(idx != UINT32_MAX) put(idx, limit, n, &v, 8);
+        n += 8;
+    }
+    return n;
+}
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t LogRing::reserve(size_t len) {
+    uint8_t  k = (len + LOG_SLOT_DATA - 1) / LOG_SLOT_DATA;
+    uint32_t idx = m_next.fetch_add(k, std::memory_order_relaxed); // the only point where writers meet
+    for(uint8_t i = 0; i < k; i++) {
+        slot_t& s = m_slot[(idx + i) % LOG_SLOTS];
+        s.seq.store((idx + i) ^ LOG_BUSY, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.slots = i ? 0 : k;
+    }
+    return idx;
+}
+
+void LogRing::put(uint32_t idx, size_t len, size_t pos, const void* src, size_t n) {
+    // bytes at pos of the record that starts in slot idx, nothing beyond len (the reserved length)
+    const uint8_t* b = (const uint8_t*)src;
+    if(pos >= len) return;
+    if(n > len - pos) n = len - pos;
+    while(n) {
+        size_t off = pos % LOG_SLOT_DATA;
+        size_t m = min(n, (size_t)(LOG_SLOT_DATA - off));
+        memcpy(m_slot[(idx + pos / LOG_SLOT_DATA) % LOG_SLOTS].data + off, b, m);
+        b += m;
+        pos += m;
+        n -= m;
+    }
+}
+
+void LogRing::publish(uint32_t idx, size_t len) {
+    uint8_t k = (len + LOG_SLOT_DATA - 1) / LOG_SLOT_DATA;
+    for(uint8_t i = 0; i < k; i++) m_slot[(idx + i) % LOG_SLOTS].seq.store(idx + i, std::memory_order_release);
+}
+//----------------------------------------------------------------------------------------------------------------------
+LogRing::cursor_t LogRing::cursor(level_t level, bool oldest) {
+    uint32_t head = m_next;
+    uint32_t back = oldest ? head - m_base : 0;
+    if(back > LOG_SLOTS) back = LOG_SLOTS;
+    return {head - back, 0, level, true};
+}
+
+bool LogRing::fetch(cursor_t& c, uint8_t* rec, size_t& len) {
+    while(true) {
+        uint32_t head = m_next.load(std::memory_order_acquire);
+        uint32_t base = m_base;
+        if((int32_t)(base - c.next) > 0) c.next = base;
+        if(c.next == head) return false;
+        if(head - c.next > LOG_SLOTS) { // this reader was too slow
+            c.lost += head - LOG_SLOTS - c.next;
+            c.next = head - LOG_SLOTS;
+        }
+        slot_t&  s = m_slot[c.next % LOG_SLOTS];
+        uint32_t q = s.seq.load(std::memory_order_acquire);
+        if(q != c.next) {
+            if(q == (c.next ^ LOG_BUSY) || (int32_t)(q - c.next) < 0) return false; // reserved, not yet written
+            c.next++; // overwritten in the meantime
+            c.lost++;
+            continue;
+        }
+        uint8_t k = s.slots;
+        if(k == 0 || k > LOG_MAX_SLOTS) { c.next++; continue; } // continuation, the start of the record is gone
+        bool ok = true;
+        for(uint8_t i = 0; i < k && ok; i++) {
+            slot_t& t = m_slot[(c.next + i) % LOG_SLOTS];
+            q = t.seq.load(std::memory_order_acquire);
+            if(q == ((c.next + i) ^ LOG_BUSY) || (int32_t)(q - (c.next + i)) < 0) return false;
+            ok = q == c.next + i;
+            memcpy(rec + i * LOG_SLOT_DATA, t.data, LOG_SLOT_DATA);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        for(uint8_t i = 0; i < k && ok; i++) ok = m_slot[(c.next + i) % LOG_SLOTS].seq.load(std::memory_order_relaxed) == c.next + i;
+        if(!ok) { c.next++; c.lost++; continue; } // a writer came round while copying
+        c.next += k;
+        len = k * LOG_SLOT_DATA;
+        return true;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t LogRing::format(const uint8_t* rec, size_t len, char* out, size_t size) {
+    hdr_t h;
+    memcpy(&h, rec, sizeof(h));
+    const uint8_t* a = rec + sizeof(h);
+    const uint8_t* end = a + h.len;
+    if(end > rec + len) end = rec + len;
+    if(!h.fmt) { // text
+        size_t n = end - a < (ptrdiff_t)size - 1 ? end - a : size - 1;
+        memcpy(out, a, n);
+        out[n] = '\0';
+        return n;
+    }
+    size_t      o = 0;
+    char        s[16];
+    char        conv;
+    uint8_t     sz;
+    const char* p = h.fmt;
+    while(*p && o < size - 1) {
+        if(*p != '%') { out[o++] = *p++; continue; }
+        p = spec(p, s, &conv, &sz);
+        int      r = 0;
+        uint64_t v = 0;
+        if(conv == '%') { out[o++] = '%'; continue; }
+        if(conv == 's') {
+            uint16_t l16 = 0;
+            if(a + 2 > end) break;
+            memcpy(&l16, a, 2);
+            if(a + 2 + l16 > end) break;
+            r = snprintf(out + o, size - o, s, (const char*)(a + 2));
+            a += 2 + l16;
+        }
+        else if(conv && strchr("diuxXocpfFeEgGaA", conv)) {
+            if(a + 8 > end) break; // the record was cut
+            memcpy(&v, a, 8);
+            a += 8;
+            switch(conv) {
+                case 'd': case 'i':
+                    if(sz == 2) r = snprintf(out + o, size - o, s, (long long)v);
+                    else if(sz == 1) r = snprintf(out + o, size - o, s, (long)v);
+                    else r = snprintf(out + o, size - o, s, (int)v);
+                    break;
+                case 'p':
+                    r = snprintf(out + o, size - o, s, (void*)(uintptr_t)v);
+                    break;
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                    double d;
+                    memcpy(&d, &v, 8);
+                    r = snprintf(out + o, size - o, s, d);
+                    break;
+                }
+                default:
+                    if(sz == 2) r = snprintf(out + o, size - o, s, (unsigned long long)v);
+                    else if(sz == 1) r = snprintf(out + o, size - o, s, (unsigned long)v);
+                    else r = snprintf(out + o, size - o, s, (unsigned int)v);
+            }
+        }
+        if(r > 0) o += r;
+        if(o > size - 1) o = size - 1;
+    }
+    out[o] = '\0';
+    return o;
+}
+
+size_t LogRing::read(cursor_t& c, char* out, size_t size, bool prefix) {
+    uint8_t rec[LOG_MAX_REC];
+    size_t  len;
+    if(!out || size < 2) return 0;
+    while(fetch(c, rec, len)) {
+        hdr_t h;
+        memcpy(&h, rec, sizeof(h));
+        if(h.level > c.level) continue;
+        size_t o = 0;
+        if(h.fmt && !c.lineStart) { // a log() line after an unfinished text() starts on its own line
+            out[o++] = '\n';
+            c.lineStart = true;
+        }
+        if(prefix && c.lineStart) {
+            int r = snprintf(out + o, size - o, "%4u.%03u %c %s: ", (unsigned)(h.ms / 1000), (unsigned)(h.ms % 1000), "-EWID"[h.level <= LVL_DEBUG ? h.level : 0], h.tag ? h.tag : "");
+            o = r < 0 ? o : o + r < size ? o + r : size - 1;
+        }
+        o += format(rec, len, out + o, size - o);
+        if(h.fmt && (o == 0 || out[o - 1] != '\n')) { // log() records are whole lines
+            if(o == size - 1) o--;
+            out[o++] = '\n';
+            out[o] = '\0';
+        }
+        if(!o) continue;
+        c.lineStart = out[o - 1] == '\n';
+        return o;
+    }
+    return 0;
+}
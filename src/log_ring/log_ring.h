@@ -0,0 +1,85 @@
+// lock-free log ring: binary records with level, time and tag, formatted only when a reader takes them
+#pragma once
+
+#include "Arduino.h"
+#include <atomic>
+
+//  A writer reserves consecutive slots with one atomic add, fills them and publishes every slot by storing its
+//  sequence number last (seqlock). No mutex, no heap, it never waits, so it can be used from the audio task
+//  (audio_info), the ASR client and loop() at the same time. A writer builds its record in the slots it reserved,
+//  with a few dozen bytes of stack.
+//
+//  slot:    | seq | slots | 59 bytes data |           a record takes 1 ... LOG_MAX_SLOTS slots
+//  record:  | ms | level | flags | len | tag* | fmt* | args ...
+//
+//  log() keeps the format string as a pointer and stores the arguments binary (%s strings are copied), the text is
+//  produced by read(). text() stores a finished string. tag and fmt must be string literals.
+//
+//  Every reader has its own cursor (web page, serial, MQTT ...). A reader that falls behind loses the oldest records,
+//  they are counted in cursor_t::lost, the writers are never held up.
+//
+//  LOGR_I("ASR", "Recognizing: %s", text.c_str());        -> "  12.345 I ASR: Recognizing: halo\n"
+//  logRing.text(LogRing::LVL_INFO, "App", "Thinking...");  -> "Thinking..." (no line end added)
+
+class LogRing {
+
+public:
+    enum level_t : uint8_t { LVL_NONE = 0, LVL_ERROR, LVL_WARN, LVL_INFO, LVL_DEBUG };
+
+    struct cursor_t {
+        uint32_t next;
+        uint32_t lost;       // records overwritten before this reader got them
+        level_t  level;      // records above this level are skipped
+        bool     lineStart;
+    };
+
+    LogRing();
+    void     log(level_t level, const char* tag, const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+    void     text(level_t level, const char* tag, const char* str, size_t len);
+    void     text(level_t level, const char* tag, const char* str) { text(level, tag, str, strlen(str)); };
+    void     setLevel(level_t level) { m_level = level; };     // records above are not stored
+    void     clear() { m_base = m_next.load(); };               // the readers continue with the next record
+    cursor_t cursor(level_t level = LVL_DEBUG, bool oldest = true);
+    size_t   read(cursor_t& c, char* out, size_t size, bool prefix = true); // 0: nothing new, out is '\0' terminated
+    uint32_t written() { return m_next; };
+
+    static const uint16_t LOG_SLOTS     = 128;   // * 64 bytes
+    static const uint8_t  LOG_SLOT_DATA = 59;
+    static const uint8_t  LOG_MAX_SLOTS = 8;     // longer records are cut
+    static const uint16_t LOG_MAX_REC   = LOG_MAX_SLOTS * LOG_SLOT_DATA;
+
+private:
+    struct slot_t {
+        std::atomic<uint32_t> seq;
+        uint8_t               slots;  // record length in slots, 0 = continuation
+        uint8_t               data[LOG_SLOT_DATA];
+    };
+    struct hdr_t {
+        uint32_t    ms;
+        level_t     level;
+        uint8_t     flags;
+        uint16_t    len;             // bytes after the header
+        const char* tag;
+        const char* fmt;             // NULL: the payload is the text
+    };
+
+    size_t      pack(const char* fmt, va_list ap, size_t limit, uint32_t idx);
+    uint32_t    reserve(size_t len);
+    void        put(uint32_t idx, size_t len, size_t pos, const void* src, size_t n);
+    void        publish(uint32_t idx, size_t len);
+    bool        fetch(cursor_t& c, uint8_t* rec, size_t& len);
+    size_t      format(const uint8_t* rec, size_t len, char* out, size_t size);
+    static const char* spec(const char* p, char* s, char* conv, uint8_t* size);
+
+    slot_t                m_slot[LOG_SLOTS];
+    std::atomic<uint32_t> m_next{0};
+    std::atomic<uint32_t> m_base{0};
+    level_t               m_level = LVL_DEBUG;
+};
+
+extern LogRing logRing;
+
+#define LOGR_E(tag, fmt, ...) logRing.log(LogRing::LVL_ERROR, tag, fmt, ##__VA_ARGS__)
+#define LOGR_W(tag, fmt, ...) logRing.log(LogRing::LVL_WARN, tag, fmt, ##__VA_ARGS__)
+#define LOGR_I(tag, fmt, ...) logRing.log(LogRing::LVL_INFO, tag, fmt, ##__VA_ARGS__)
+#define LOGR_D(tag, fmt, ...) logRing.log(LogRing::LVL_DEBUG, tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,235 @@
+/*
+ * mic_frontend.cpp
+ *
+ *  speech front-end of the capture path: DC blocker, high-pass, spectral noise suppression and AGC
+ *  mono int16_t, Q14 filter and Q15 window/twiddle coefficients, integer sample path
+ *
+ */
+#include "mic_frontend.h"
+#include <stdlib.h>
+#include <math.h>
+
+static const int32_t MF_DC_POLE   = 32735; // 0.999 in Q15, corner at about 2.5 Hz for 16 kHz
+static const uint8_t MF_FRAC      = 8;     // extra fraction bits of the filters
+static const uint8_t MF_FFT_LOG2  = 8;
+static const uint8_t MF_FFT_FRAC  = 4;     // extra bits in the FFT, 2^15 * 2^4 * MF_FFT stays in int32
+static const int32_t MF_OVERSUB   = 81920; // 2.5 in Q15, the minima lie well below the mean of the noise
+static const int32_t MF_AGC_MIN   = 64;    // Q8, -12 dB
+static const int32_t MF_AGC_PEAK  = 30000; // the AGC keeps the peaks of a hop below this
+
+static inline int16_t sat16(int32_t v) {
+    return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)v);
+}
+
+MicFrontend::MicFrontend() {
+    m_cfg = defaultConfig();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::begin(uint32_t sampleRate, const config_t& cfg) {
+    m_cfg = cfg;
+    if(sampleRate == 0) sampleRate = 16000;
+
+    // high-pass, 2nd order Butterworth (bilinear transform, Q = 1/sqrt(2))
+    if(m_cfg.highPassHz && m_cfg.highPassHz * 4 < sampleRate) {
+        double w0 = 2.0 * M_PI * m_cfg.highPassHz / sampleRate;
+        double alpha = sin(w0) / (2.0 * M_SQRT1_2);
+        double a0 = 1.0 + alpha;
+        m_b0 = lround((1.0 + cos(w0)) / 2.0 / a0 * 16384.0);
+        m_b1 = -2 * m_b0;
+        m_b2 = m_b0;
+        m_a1 = lround(-2.0 * cos(w0) / a0 * 16384.0);
+        m_a2 = lround((1.0 - alpha) / a0 * 16384.0);
+    }
+    else m_cfg.highPassHz = 0;
+
+    // sqrt-Hann (periodic): the squares of two overlapping windows add up to 1, analysis and synthesis use it
+    for(int i = 0; i < MF_FFT; i++) {
+        m_window[i] = (int16_t)lround(32767.0 * sqrt(0.5 - 0.5 * cos(2.0 * M_PI * i / MF_FFT)));
+    }
+    for(int k = 0; k < MF_FFT / 2; k++) {
+        m_cos[k] = (int16_t)lround(32767.0 * cos(2.0 * M_PI * k / MF_FFT));
+        m_sin[k] = (int16_t)lround(32767.0 * sin(2.0 * M_PI * k / MF_FFT));
+    }
+    m_floor = (int16_t)lround(32767.0 * pow(10.0, -m_cfg.suppressDb / 20.0));
+    m_agcMax = lround(256.0 * pow(10.0, m_cfg.maxGainDb / 20.0));
+
+    reset();
+    m_f_ready = true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::reset() {
+    m_dcX = m_dcY = 0;
+    m_x1 = m_x2 = m_y1 = m_y2 = 0;
+    memset(m_hopIn, 0, sizeof(m_hopIn));
+    memset(m_hopOut, 0, sizeof(m_hopOut));
+    memset(m_prev, 0, sizeof(m_prev));
+    memset(m_ola, 0, sizeof(m_ola));
+    for(int k = 0; k < MF_BINS; k++) m_gain[k] = 32767;
+    m_pos = 0;
+    m_f_noiseInit = false;
+    m_agcGain = 256;
+    m_agcNoise = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::process(int16_t* samples, size_t n) {
+    if(!m_f_ready) return;
+
+    for(size_t i = 0; i < n; i++) {
+        int32_t x = (int32_t)samples[i] << MF_FRAC;
+        int32_t y = x - m_dcX + (int32_t)(((int64_t)m_dcY * MF_DC_POLE) >> 15);
+        m_dcX = x;
+        m_dcY = y;
+        if(m_cfg.highPassHz) {
+            int64_t acc = (int64_t)m_b0 * y + (int64_t)m_b1 * m_x1 + (int64_t)m_b2 * m_x2
+                        - (int64_t)m_a1 * m_y1 - (int64_t)m_a2 * m_y2;
+            m_x2 = m_x1;
+            m_x1 = y;
+            y = (int32_t)(acc >> 14);
+            m_y2 = m_y1;
+            m_y1 = y;
+        }
+        samples[i] = m_hopOut[m_pos];
+        m_hopIn[m_pos] = sat16((y + (1 << (MF_FRAC - 1))) >> MF_FRAC);
+        if(++m_pos == MF_HOP) {
+            hop();
+            m_pos = 0;
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::hop() {
+    if(m_cfg.suppressDb) suppress();
+    else memcpy(m_hopOut, m_hopIn, sizeof(m_hopOut));
+    if(m_cfg.maxGainDb) agc(m_hopOut);
+    m_stats.hops++;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::suppress() {
+    // frame = previous hop + this hop
+    for(int i = 0; i < MF_HOP; i++) {
+        m_re[i]          = ((int32_t)m_prev[i]  * m_window[i])          >> (15 - MF_FFT_FRAC);
+        m_re[MF_HOP + i] = ((int32_t)m_hopIn[i] * m_window[MF_HOP + i]) >> (15 - MF_FFT_FRAC);
+    }
+    memset(m_im, 0, sizeof(m_im));
+    memcpy(m_prev, m_hopIn, sizeof(m_prev));
+    fft(m_re, m_im, false);
+
+    for(int k = 0; k < MF_BINS; k++) {
+        int32_t a = abs(m_re[k]), b = abs(m_im[k]);
+        int32_t mag = a > b ? a + ((b * 3) >> 3) : b + ((a * 3) >> 3); // |X| within a few percent
+
+        // noise: follows the minima of the smoothed magnitude, rises about 0.2% per hop (1 dB in 0.6 s at 16 kHz)
+        int32_t& smooth = m_smooth[k];
+        int32_t& noise = m_noise[k];
+        if(!m_f_noiseInit) smooth = noise = mag;
+        smooth += (mag - smooth) >> 2;
+        if(smooth < noise) noise -= (noise - smooth) >> 2;
+        else {
+            noise += (noise >> 9) + 1;
+            if(noise > smooth) noise = smooth;
+        }
+
+        int32_t g = 0;
+        if(mag > 0) {
+            int64_t sub = (int64_t)noise * MF_OVERSUB / mag;
+            g = sub >= 32767 ? 0 : 32767 - (int32_t)sub;
+        }
+        if(g < m_floor) g = m_floor;
+        if(g > m_gain[k]) m_gain[k] += (g - m_gain[k] + 1) >> 1;  // opens fast
+        else              m_gain[k] -= (m_gain[k] - g) >> 2;      // closes slowly
+        g = m_gain[k];
+
+        m_re[k] = (int32_t)(((int64_t)m_re[k] * g) >> 15);
+        m_im[k] = (int32_t)(((int64_t)m_im[k] * g) >> 15);
+        if(k > 0 && k < MF_FFT / 2) { // the mirrored half of a real signal
+            m_re[MF_FFT - k] = m_re[k];
+            m_im[MF_FFT - k] = -m_im[k];
+        }
+    }
+    m_f_noiseInit = true;
+
+    fft(m_re, m_im, true);
+    const uint8_t sh = MF_FFT_LOG2 + MF_FFT_FRAC;
+    for(int i = 0; i < MF_HOP; i++) {
+        int32_t first  = (int32_t)(((int64_t)m_re[i] * m_window[i]) >> 15);
+        int32_t second = (int32_t)(((int64_t)m_re[MF_HOP + i] * m_window[MF_HOP + i]) >> 15);
+        m_hopOut[i] = sat16((m_ola[i] + first + (1 << (sh - 1))) >> sh);
+        m_ola[i] = second;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::agc(int16_t* s) {
+    int32_t sum = 0, peak = 0;
+    for(int i = 0; i < MF_HOP; i++) {
+        int32_t a = abs(s[i]);
+        sum += a;
+        if(a > peak) peak = a;
+    }
+    int32_t level = sum / MF_HOP;
+
+    // noise floor of the hops, same tracking as the suppressor
+    if(m_agcNoise == 0 || level < m_agcNoise) m_agcNoise -= (m_agcNoise - level) >> (m_agcNoise ? 2 : 0);
+    else {
+        m_agcNoise += (m_agcNoise >> 8) + 1;
+        if(m_agcNoise > level) m_agcNoise = level;
+    }
+
+    int32_t g0 = m_agcGain;
+    if(level > 30 && level > m_agcNoise * 3) { // speech, else the gain is held
+        int32_t target = m_cfg.targetLevel * 256 / level;
+        if(target < MF_AGC_MIN) target = MF_AGC_MIN;
+        if(target > m_agcMax) target = m_agcMax;
+        if(target < m_agcGain) m_agcGain -= (m_agcGain - target + 1) >> 1; // down fast
+        else                   m_agcGain += (target - m_agcGain + 63) >> 6; // up in about 0.5 s
+    }
+    if(peak > 0 && (int64_t)peak * m_agcGain > MF_AGC_PEAK * 256) { // this hop at once
+        m_agcGain = MF_AGC_PEAK * 256 / peak;
+        if(g0 > m_agcGain) g0 = m_agcGain;
+    }
+
+    for(int i = 0; i < MF_HOP; i++) { // ramp from the last gain, no steps
+        int32_t g = g0 + (m_agcGain - g0) * (i + 1) / MF_HOP;
+        int32_t v = (s[i] * g + 128) >> 8;
+        if(v > 32767 || v < -32768) m_stats.clipped++;
+        s[i] = sat16(v);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::fft(int32_t* re, int32_t* im, bool inverse) { // radix 2, in place, not scaled
+    for(int i = 1, j = 0; i < MF_FFT; i++) {
+        int bit = MF_FFT >> 1;
+        for(; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if(i < j) {
+            int32_t t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for(int len = 2; len <= MF_FFT; len <<= 1) {
+        int half = len >> 1, step = MF_FFT / len;
+        for(int i = 0; i < MF_FFT; i += len) {
+            for(int k = 0; k < half; k++) {
+                int32_t wr = m_cos[k * step];
+                int32_t wi = inverse ? m_sin[k * step] : -m_sin[k * step];
+                int32_t* ar = &re[i + k]; int32_t* ai = &im[i + k];
+                int32_t* br = &re[i + k + half]; int32_t* bi = &im[i + k + half];
+                int32_t tr = (int32_t)(((int64_t)*br * wr - (int64_t)*bi * wi) >> 15);
+                int32_t ti = (int32_t)(((int64_t)*br * wi + (int64_t)*bi * wr) >> 15);
+                *br = *ar - tr;
+                *bi = *ai - ti;
+                *ar += tr;
+                *ai += ti;
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MicFrontend::getStats(stats_t* stats, bool reset) {
+    m_stats.gain = m_agcGain;
+    m_stats.noiseLevel = m_agcNoise;
+    if(stats) *stats = m_stats;
+    if(reset) {
+        m_stats.hops = 0;
+        m_stats.clipped = 0;
+    }
+}
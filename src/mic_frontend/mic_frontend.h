@@ -0,0 +1,86 @@
+// microphone front-end for speech: DC blocker, high-pass, spectral noise suppression and AGC, mono int16_t, fixed point
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+//  process() works in place on the capture blocks of any length, the stages after the filters run per hop:
+//
+//  mic -> DC blocker -> high-pass -> | hop | -> noise suppressor -> AGC -> | hop | -> out
+//
+//  DC blocker   first order, pole at 0.999, takes the offset of the INMP441 out before the other stages
+//  high-pass    2nd order Butterworth, 100 Hz by default, wind and road rumble
+//  suppressor   MF_FFT point FFT, sqrt-Hann windows with 50% overlap. The noise magnitude of each bin follows the
+//               minima of its smoothed magnitude (down fast, up slowly, so speech hardly raises it). Spectral subtraction with a gain floor
+//               (suppressDb), the gain opens fast and closes slowly, which keeps the musical noise down.
+//  AGC          mean level of a hop towards targetLevel, up slowly to maxGainDb, down fast, peaks limited. The gain is
+//               held while only the noise floor is there, pauses are not pumped up.
+//
+//  Delay: MF_HOP samples, MF_FFT with the suppressor (8 / 16 ms at 16 kHz). Coefficients and windows are designed
+//  in double in begin(), the sample path is integer only. The filters run with 8 extra fraction bits, the poles of
+//  a 100 Hz high-pass at 16 kHz are close to 1 and would amplify the rounding noise otherwise.
+
+class MicFrontend {
+
+public:
+    typedef struct {
+        uint16_t highPassHz;     // 0: off, the DC blocker stays
+        uint8_t  suppressDb;     // max. attenuation of noise, 0: suppressor off
+        uint8_t  maxGainDb;      // AGC, 0: off
+        int16_t  targetLevel;    // mean absolute level the AGC aims at, 2000 is about -24 dBFS
+    } config_t;
+    typedef struct {
+        uint32_t hops;
+        uint32_t clipped;        // samples limited after the AGC
+        uint16_t gain;           // AGC gain now, Q8
+        uint16_t noiseLevel;     // mean absolute level of the quiet hops (after the suppressor)
+    } stats_t;
+
+    MicFrontend();
+    static config_t defaultConfig() { return {100, 12, 24, 2000}; };
+    void     begin(uint32_t sampleRate, const config_t& cfg = defaultConfig());
+    void     reset();                                   // filters, noise estimate and gain start over
+    void     process(int16_t* samples, size_t n);
+    uint16_t latency() { return m_cfg.suppressDb ? MF_FFT : MF_HOP; }; // samples
+    void     getStats(stats_t* stats, bool reset = false);
+
+    static const uint16_t MF_FFT  = 256;
+    static const uint16_t MF_HOP  = MF_FFT / 2;
+    static const uint16_t MF_BINS = MF_FFT / 2 + 1;
+
+private:
+    void     hop();
+    void     suppress();
+    void     agc(int16_t* s);
+    void     fft(int32_t* re, int32_t* im, bool inverse);
+
+    config_t m_cfg;
+    bool     m_f_ready = false;
+
+    int32_t  m_dcX = 0, m_dcY = 0;                      // DC blocker, Q8
+    int32_t  m_b0 = 0, m_b1 = 0, m_b2 = 0, m_a1 = 0, m_a2 = 0; // high-pass, Q14
+    int32_t  m_x1 = 0, m_x2 = 0, m_y1 = 0, m_y2 = 0;   // high-pass state, Q8
+
+    int16_t  m_hopIn[MF_HOP];                           // filtered input of the running hop
+    int16_t  m_hopOut[MF_HOP];                          // processed output of the previous hop
+    uint16_t m_pos = 0;
+
+    int16_t  m_window[MF_FFT];                          // sqrt-Hann, Q15
+    int16_t  m_cos[MF_FFT / 2];                         // twiddles, Q15
+    int16_t  m_sin[MF_FFT / 2];
+    int16_t  m_prev[MF_HOP];                            // first half of the next frame
+    int32_t  m_ola[MF_HOP];                             // second half of the last frame, overlap-add
+    int32_t  m_re[MF_FFT];
+    int32_t  m_im[MF_FFT];
+    int32_t  m_smooth[MF_BINS];                         // magnitude per bin, smoothed over a few hops
+    int32_t  m_noise[MF_BINS];                          // noise magnitude per bin
+    int16_t  m_gain[MF_BINS];                           // smoothed suppression gain, Q15
+    int16_t  m_floor = 0;                               // gain floor, Q15
+    bool     m_f_noiseInit = false;
+
+    int32_t  m_agcGain = 256;                           // Q8
+    int32_t  m_agcMax = 256;
+    int32_t  m_agcNoise = 0;                            // mean level of the quiet hops
+
+    stats_t  m_stats = {};
+};
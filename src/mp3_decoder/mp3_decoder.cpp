@@ -6,6 +6,7 @@
  *  Updated on: 09.09.2024
  */
 #include "mp3_decoder.h"
+#include "../audio_arena/audio_arena.h"
 /* clip to range [-2^n, 2^n - 1] */
 #if 0 //Fast on ARM:
 #define CLIP_2N(y, n) { \
@@ -1575,32 +1576,25 @@ void MP3Decoder_ClearBuffer(void) {
  *
  **********************************************************************************************************************/
 
-#ifdef CONFIG_IDF_TARGET_ESP32S3
-    // ESP32-S3: If there is PSRAM, prefer it
-    #define __malloc_heap_psram(size) \
-        heap_caps_malloc_prefer(size, 2, MALLOC_CAP_DEFAULT|MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT|MALLOC_CAP_INTERNAL)
-#else
-    // ESP32, PSRAM is too slow, prefer SRAM
-    #define __malloc_heap_psram(size) \
-        heap_caps_malloc_prefer(size, 2, MALLOC_CAP_DEFAULT|MALLOC_CAP_INTERNAL, MALLOC_CAP_DEFAULT|MALLOC_CAP_SPIRAM)
-#endif
+AudioArena s_mp3Arena("mp3");
 
 bool MP3Decoder_AllocateBuffers(void) {
-    if(!m_MP3DecInfo)       {m_MP3DecInfo    = (MP3DecInfo_t*)    __malloc_heap_psram(sizeof(MP3DecInfo_t)   );}
-    if(!m_FrameHeader)      {m_FrameHeader   = (FrameHeader_t*)   __malloc_heap_psram(sizeof(FrameHeader_t)  );}
-    if(!m_SideInfo)         {m_SideInfo      = (SideInfo_t*)      __malloc_heap_psram(sizeof(SideInfo_t)     );}
-    if(!m_ScaleFactorJS)    {m_ScaleFactorJS = (ScaleFactorJS_t*) __malloc_heap_psram(sizeof(ScaleFactorJS_t));}
-    if(!m_HuffmanInfo)      {m_HuffmanInfo   = (HuffmanInfo_t*)   __malloc_heap_psram(sizeof(HuffmanInfo_t)  );}
-    if(!m_DequantInfo)      {m_DequantInfo   = (DequantInfo_t*)   __malloc_heap_psram(sizeof(DequantInfo_t)  );}
-    if(!m_IMDCTInfo)        {m_IMDCTInfo     = (IMDCTInfo_t*)     __malloc_heap_psram(sizeof(IMDCTInfo_t)    );}
-    if(!m_SubbandInfo)      {m_SubbandInfo   = (SubbandInfo_t*)   __malloc_heap_psram(sizeof(SubbandInfo_t)  );}
-    if(!m_MP3FrameInfo)     {m_MP3FrameInfo  = (MP3FrameInfo_t*)  __malloc_heap_psram(sizeof(MP3FrameInfo_t) );}
-
-    if(!m_MP3DecInfo || !m_FrameHeader || !m_SideInfo || !m_ScaleFactorJS || !m_HuffmanInfo ||
-       !m_DequantInfo || !m_IMDCTInfo || !m_SubbandInfo || !m_MP3FrameInfo) {
-        MP3Decoder_FreeBuffers();
-        log_e("not enough memory to allocate mp3decoder buffers");
-        return false;
+    // one region, hot set first (accessed for every granule), it gets internal SRAM if there is enough
+    if(!s_mp3Arena.isAllocated()) {
+        s_mp3Arena.reset();
+        s_mp3Arena.add((void**)&m_SubbandInfo,   sizeof(SubbandInfo_t),   AudioArena::HOT);
+        s_mp3Arena.add((void**)&m_IMDCTInfo,     sizeof(IMDCTInfo_t),     AudioArena::HOT);
+        s_mp3Arena.add((void**)&m_HuffmanInfo,   sizeof(HuffmanInfo_t),   AudioArena::HOT);
+        s_mp3Arena.add((void**)&m_DequantInfo,   sizeof(DequantInfo_t),   AudioArena::HOT);
+        s_mp3Arena.add((void**)&m_ScaleFactorJS, sizeof(ScaleFactorJS_t), AudioArena::HOT);
+        s_mp3Arena.add((void**)&m_SideInfo,      sizeof(SideInfo_t),      AudioArena::HOT);
+        s_mp3Arena.add((void**)&m_FrameHeader,   sizeof(FrameHeader_t),   AudioArena::HOT);
+        s_mp3Arena.add((void**)&m_MP3DecInfo,    sizeof(MP3DecInfo_t),    AudioArena::HOT);  // bit reservoir
+        s_mp3Arena.add((void**)&m_MP3FrameInfo,  sizeof(MP3FrameInfo_t),  AudioArena::COLD);
+        if(!s_mp3Arena.allocate()) {
+            log_e("not enough memory to allocate mp3decoder buffers");
+            return false;
+        }
     }
     MP3Decoder_ClearBuffer();
     return true;
@@ -1639,19 +1633,7 @@ bool MP3Decoder_IsInit(void) {
  **********************************************************************************************************************/
 void MP3Decoder_FreeBuffers()
 {
-//    uint32_t i = ESP.getFreeHeap();
-
-    if(m_MP3DecInfo)        {free(m_MP3DecInfo);      m_MP3DecInfo=NULL;}
-    if(m_FrameHeader)       {free(m_FrameHeader);     m_FrameHeader=NULL;}
-    if(m_SideInfo)          {free(m_SideInfo);        m_SideInfo=NULL;}
-    if(m_ScaleFactorJS )    {free(m_ScaleFactorJS);   m_ScaleFactorJS=NULL;}
-    if(m_HuffmanInfo)       {free(m_HuffmanInfo);     m_HuffmanInfo=NULL;}
-    if(m_DequantInfo)       {free(m_DequantInfo);     m_DequantInfo=NULL;}
-    if(m_IMDCTInfo)         {free(m_IMDCTInfo);       m_IMDCTInfo=NULL;}
-    if(m_SubbandInfo)       {free(m_SubbandInfo);     m_SubbandInfo=NULL;}
-    if(m_MP3FrameInfo)      {free(m_MP3FrameInfo);    m_MP3FrameInfo=NULL;}
-
-//    log_i("MP3Decoder: %lu bytes memory was freed", ESP.getFreeHeap() - i);
+    s_mp3Arena.release(); // all pointers become NULL
 }
 
 /***********************************************************************************************************************
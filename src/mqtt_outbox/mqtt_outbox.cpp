@@ -0,0 +1,330 @@
+/*
+ * mqtt_outbox.cpp
+ *
+ *  MQTT publisher task, small messages are queued in RAM, large ones are spooled to flash and streamed from there,
+ *  the caller never waits for the broker
+ *
+ */
+#include "mqtt_outbox.h"
+
+MqttOutbox::MqttOutbox(PubSubClient& client) : m_client(client) {}
+
+MqttOutbox::~MqttOutbox() {
+    end();
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool MqttOutbox::begin(connect_t connect, fs::FS* fs, const char* dir, uint8_t core, UBaseType_t prio) {
+    if(m_task) return true;
+    m_connect = connect;
+    m_fs = fs;
+    m_dir = dir;
+    m_queue = xQueueCreate(OUTBOX_QUEUE, sizeof(item_t));
+    m_done = xSemaphoreCreateBinary();
+    if(!m_queue || !m_done) {
+        log_e("MqttOutbox: no memory for the queue");
+        if(m_queue) vQueueDelete(m_queue);
+        if(m_done) vSemaphoreDelete(m_done);
+        m_queue = NULL;
+        m_done = NULL;
+        return false;
+    }
+    if(m_fs) scanSpool();
+    m_lastAttempt = millis() - m_backoff; // first attempt right away
+    m_f_run = true;
+    if(xTaskCreatePinnedToCore(outboxTask, "MqttOutbox", 6144, this, prio, &m_task, core) != pdPASS) {
+        m_f_run = false;
+        vQueueDelete(m_queue);
+        vSemaphoreDelete(m_done);
+        m_queue = NULL;
+        m_done = NULL;
+        m_task = NULL;
+        return false;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MqttOutbox::end() {
+    if(!m_task) return;
+    m_f_run = false;
+    xSemaphoreTake(m_done, portMAX_DELAY); // the task disconnects, signals and deletes itself
+    m_task = NULL;
+    vSemaphoreDelete(m_done);
+    m_done = NULL;
+    item_t it;
+    while(xQueueReceive(m_queue, &it, 0) == pdTRUE) free(it.data); // the spool stays in flash for the next begin()
+    vQueueDelete(m_queue);
+    m_queue = NULL;
+}
+//----------------------------------------------------------------------------------------------------------------------
+String MqttOutbox::spoolPath(uint32_t seq) {
+    return m_dir + "/" + String(seq) + ".msg";
+}
+
+void MqttOutbox::scanSpool() {
+    // files left over from the last run are sent first, the numbering continues after them
+    if(!m_fs->exists(m_dir.c_str())) m_fs->mkdir(m_dir.c_str());
+    File d = m_fs->open(m_dir.c_str());
+    uint32_t lo = UINT32_MAX, hi = 0;
+    if(d && d.isDirectory()) {
+        for(File f = d.openNextFile(); f; f = d.openNextFile()) {
+            const char* n = f.name();
+            const char* slash = strrchr(n, '/');
+            if(slash) n = slash + 1;
+            char*    e;
+            uint32_t seq = strtoul(n, &e, 10);
+            if(e == n || strcmp(e, ".msg")) { f.close(); continue; }
+            uint32_t hdr[2] = {0, 0};
+            if(f.read((uint8_t*)hdr, sizeof(hdr)) == sizeof(hdr) && hdr[0] == OUTBOX_MAGIC && hdr[1] >= m_nextId) m_nextId = hdr[1] + 1;
+            f.close();
+            if(seq < lo) lo = seq;
+            if(seq > hi) hi = seq;
+        }
+        d.close();
+    }
+    if(lo <= hi) {
+        m_spoolFirst = lo;
+        m_spoolNext = hi + 1;
+        log_i("MqttOutbox: %u message(s) from flash to deliver", hi + 1 - lo);
+    }
+    m_bootFirst = m_spoolNext;
+}
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t MqttOutbox::enqueue(uint32_t id, const char* topic, uint8_t* data, uint32_t len, bool retained) {
+    item_t it;
+    it.id = id;
+    it.queued = millis();
+    strlcpy(it.topic, topic, sizeof(it.topic));
+    it.data = data;
+    it.len = len;
+    it.retained = retained;
+    if(xQueueSend(m_queue, &it, 0) != pdTRUE) {
+        free(data);
+        log_w("MqttOutbox: queue full, message to %s dropped", topic);
+        portENTER_CRITICAL(&m_mux);
+        m_stats.dropped++;
+        portEXIT_CRITICAL(&m_mux);
+        return 0;
+    }
+    portENTER_CRITICAL(&m_mux);
+    m_stats.queued++;
+    portEXIT_CRITICAL(&m_mux);
+    return it.id;
+}
+
+uint32_t MqttOutbox::publish(const char* topic, const char* payload, bool retained, prio_t prio) {
+    if(!m_queue || !topic || !payload) return 0;
+    if(strlen(topic) >= OUTBOX_MAX_TOPIC) { log_e("MqttOutbox: topic too long %s", topic); return 0; }
+    if(prio == PRIO_LOW && (m_spoolNext != m_spoolFirst || uxQueueSpacesAvailable(m_queue) < OUTBOX_QUEUE / 2)) {
+        portENTER_CRITICAL(&m_mux); // a backlog: the room is kept for the messages that matter
+        m_stats.rejected++;
+        portEXIT_CRITICAL(&m_mux);
+        return 0;
+    }
+    uint32_t len = strlen(payload);
+    uint8_t* data = (uint8_t*)malloc(len + 1);
+    if(!data) return 0;
+    memcpy(data, payload, len);
+    return enqueue(m_nextId++, topic, data, len, retained);
+}
+
+uint32_t MqttOutbox::publish(const char* topic, writer_t writer, bool retained) {
+    if(!m_queue || !topic || !writer) return 0;
+    uint8_t topicLen = strlen(topic);
+    if(strlen(topic) >= OUTBOX_MAX_TOPIC) { log_e("MqttOutbox: topic too long %s", topic); return 0; }
+    uint32_t id = m_nextId++;
+
+    size_t space = m_fs && m_spoolSpace ? m_spoolSpace() : SIZE_MAX;
+    if(space < OUTBOX_MIN_FREE) log_w("MqttOutbox: %u bytes left in flash, message kept in RAM", (unsigned)space);
+    else if(m_fs) { // <magic><id><queued ms><retained><topic len><topic><payload ...>
+        uint32_t seq = m_spoolNext;
+        String   path = spoolPath(seq);
+        File     f = m_fs->open(path.c_str(), FILE_WRITE);
+        if(f) {
+            uint32_t hdr[3] = {OUTBOX_MAGIC, id, (uint32_t)millis()};
+            uint8_t  flags[2] = {retained, topicLen};
+            bool     ok = f.write((const uint8_t*)hdr, sizeof(hdr)) == sizeof(hdr);
+            ok &= f.write(flags, 2) == 2;
+            ok &= f.write((const uint8_t*)topic, topicLen) == topicLen;
+            size_t n = writer(f);
+            ok &= f.size() == sizeof(hdr) + 2 + topicLen + n;
+            f.close();
+            if(ok) {
+                m_spoolNext = seq + 1; // now the task may take it
+                portENTER_CRITICAL(&m_mux);
+                m_stats.queued++;
+                portEXIT_CRITICAL(&m_mux);
+                return id;
+            }
+            m_fs->remove(path.c_str());
+        }
+        log_e("MqttOutbox: can't spool to %s, message kept in RAM", path.c_str());
+    }
+
+    // no flash: the payload is rendered twice, once to get the length
+    class Buffer : public Print {
+    public:
+        Buffer(uint8_t* p, size_t size) : m_p(p), m_size(size) {}
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t* b, size_t len) override {
+            if(len > m_size - m_len) len = m_size - m_len;
+            if(m_p) memcpy(m_p + m_len, b, len);
+            m_len += len;
+            return len;
+        }
+        uint8_t* m_p;
+        size_t   m_size;
+        size_t   m_len = 0;
+    };
+    Buffer   counter(NULL, SIZE_MAX);
+    uint32_t len = writer(counter);
+    uint8_t* data = (uint8_t*)(psramFound() ? ps_malloc(len + 1) : malloc(len + 1));
+    if(!data) { log_e("MqttOutbox: no memory for %u bytes", len); return 0; }
+    Buffer buf(data, len);
+    writer(buf);
+    return enqueue(id, topic, data, len, retained);
+}
+//----------------------------------------------------------------------------------------------------------------------
+MqttOutbox::stats_t MqttOutbox::stats() {
+    portENTER_CRITICAL(&m_mux);
+    stats_t s = m_stats;
+    portEXIT_CRITICAL(&m_mux);
+    s.pending = (m_spoolNext - m_spoolFirst) + (m_queue ? uxQueueMessagesWaiting(m_queue) : 0);
+    s.connected = m_f_connected;
+    return s;
+}
+
+bool MqttOutbox::recent(uint8_t i, delivery_t& d) {
+    portENTER_CRITICAL(&m_mux);
+    bool ok = i < m_recentCount;
+    if(ok) d = m_recent[(m_recentNext + OUTBOX_RECENT - 1 - i) % OUTBOX_RECENT];
+    portEXIT_CRITICAL(&m_mux);
+    return ok;
+}
+
+void MqttOutbox::report(uint32_t id, const char* topic, uint32_t bytes, uint32_t queued, uint16_t attempts, bool ok) {
+    uint32_t latency = queued ? millis() - queued : 0;
+    if(ok) log_i("MqttOutbox: #%u %s, %u bytes, %u attempt(s), %u ms", id, topic, bytes, attempts, latency);
+    else log_e("MqttOutbox: #%u %s dropped after %u attempt(s)", id, topic, attempts);
+    portENTER_CRITICAL(&m_mux);
+    delivery_t& d = m_recent[m_recentNext];
+    d.id = id;
+    d.bytes = bytes;
+    d.latency = latency;
+    d.attempts = attempts;
+    d.ok = ok;
+    strlcpy(d.topic, topic, sizeof(d.topic));
+    m_recentNext = (m_recentNext + 1) % OUTBOX_RECENT;
+    if(m_recentCount < OUTBOX_RECENT) m_recentCount++;
+    if(ok) m_stats.delivered++;
+    else m_stats.dropped++;
+    portEXIT_CRITICAL(&m_mux);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MqttOutbox::outboxTask(void* param) {
+    MqttOutbox* outbox = (MqttOutbox*)param;
+    outbox->run();
+    xSemaphoreGive(outbox->m_done); // the last access to the object, end() may free it from here on
+    vTaskDelete(NULL);
+}
+
+void MqttOutbox::run() {
+    while(m_f_run) {
+        if(!m_client.connected()) {
+            m_f_connected = false;
+            if(millis() - m_lastAttempt < m_backoff || !connect()) { vTaskDelay(50); continue; }
+        }
+        m_client.loop(); // incoming messages, the PubSubClient callback runs in this task
+        int8_t r = sendSpool();
+        if(r == 0) r = sendQueued();
+        if(r < 0) {
+            portENTER_CRITICAL(&m_mux);
+            m_stats.retries++;
+            portEXIT_CRITICAL(&m_mux);
+            m_client.disconnect(); // a half written packet can't be continued, start over with a new connection
+            m_f_connected = false;
+            m_lastAttempt = millis();
+        }
+        if(r == 0) vTaskDelay(20);
+    }
+    if(m_client.connected()) m_client.disconnect();
+    m_f_connected = false;
+}
+
+bool MqttOutbox::connect() {
+    m_lastAttempt = millis();
+    if(m_connect && m_connect(m_client)) {
+        m_f_connected = true;
+        m_backoff = 1000;
+        portENTER_CRITICAL(&m_mux);
+        m_stats.connects++;
+        portEXIT_CRITICAL(&m_mux);
+        return true;
+    }
+    m_backoff = min(m_backoff * 2, OUTBOX_BACKOFF);
+    return false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool MqttOutbox::stream(const char* topic, bool retained, fs::File* file, const uint8_t* data, uint32_t len) {
+    if(!m_client.beginPublish(topic, len, retained)) return false;
+    uint8_t  buf[256];
+    uint32_t left = len;
+    while(left) {
+        size_t n = min(left, (uint32_t)sizeof(buf));
+        if(file) n = file->read(buf, n);
+        else memcpy(buf, data + (len - left), n);
+        if(!n || m_client.write(buf, n) != n) return false;
+        left -= n;
+    }
+    return m_client.endPublish() == 1;
+}
+
+int8_t MqttOutbox::sendSpool() {
+    uint32_t seq = m_spoolFirst;
+    if(seq == m_spoolNext) return 0;
+    String path = spoolPath(seq);
+    File     f = m_fs->open(path.c_str(), FILE_READ);
+    uint32_t hdr[3] = {0, 0, 0};
+    uint8_t  flags[2] = {0, 0};
+    char     topic[OUTBOX_MAX_TOPIC];
+    bool     valid = f && f.read((uint8_t*)hdr, sizeof(hdr)) == sizeof(hdr) && hdr[0] == OUTBOX_MAGIC &&
+                     f.read(flags, 2) == 2 && flags[1] < OUTBOX_MAX_TOPIC && f.read((uint8_t*)topic, flags[1]) == flags[1];
+    if(!valid) { // missing or broken, skip it
+        if(f) f.close();
+        m_fs->remove(path.c_str());
+        m_spoolFirst = seq + 1;
+        return 1;
+    }
+    topic[flags[1]] = '\0';
+    uint32_t len = f.size() - sizeof(hdr) - 2 - flags[1];
+    bool ok = stream(topic, flags[0], &f, NULL, len);
+    f.close();
+    m_spoolTries++;
+    if(!ok && m_client.connected()) m_spoolAttempts++; // a lost connection is not the message's fault
+    if(!ok && m_spoolAttempts < OUTBOX_ATTEMPTS) return -1;
+    if(ok) m_fs->remove(path.c_str());
+    else { // refused again and again, kept out of the way but not deleted
+        String held = m_dir + "/" + String(seq) + ".held";
+        m_fs->rename(path.c_str(), held.c_str());
+        log_e("MqttOutbox: #%u kept as %s", hdr[1], held.c_str());
+    }
+    report(hdr[1], topic, len, seq >= m_bootFirst ? hdr[2] : 0, m_spoolTries, ok);
+    m_spoolAttempts = 0;
+    m_spoolTries = 0;
+    m_spoolFirst = seq + 1;
+    return ok ? 1 : -1;
+}
+
+int8_t MqttOutbox::sendQueued() {
+    item_t it;
+    if(xQueuePeek(m_queue, &it, 0) != pdTRUE) return 0;
+    bool ok = stream(it.topic, it.retained, NULL, it.data, it.len);
+    m_queueTries++;
+    if(!ok && m_client.connected()) m_queueAttempts++;
+    if(!ok && m_queueAttempts < OUTBOX_ATTEMPTS) return -1;
+    xQueueReceive(m_queue, &it, 0);
+    report(it.id, it.topic, it.len, it.queued, m_queueTries, ok);
+    free(it.data);
+    m_queueAttempts = 0;
+    m_queueTries = 0;
+    return ok ? 1 : -1;
+}
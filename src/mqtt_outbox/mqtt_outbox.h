@@ -0,0 +1,120 @@
+// non-blocking MQTT publisher: own task, streamed payloads, outbound queue in flash while the broker is away
+#pragma once
+
+#include "Arduino.h"
+#include <FS.h>
+#include <PubSubClient.h>
+#include <atomic>
+#include <functional>
+
+//  After begin() only the outbox task touches the PubSubClient (connect, loop, publish), the callers only queue:
+//
+//  publish(topic, "pressed")           -> RAM queue (small, OUTBOX_QUEUE items)     --+
+//  publish(topic, [](Print& out) {..}) -> <dir>/<id>.msg in flash, survives a reboot  --+--> outbox task --> broker
+//
+//  Spooled messages go first and in order, a message stays at the head of its lane until it is written completely
+//  (beginPublish / write / endPublish, the payload is streamed in 256 byte pieces and never sits in the MQTT buffer).
+//  While the broker is unreachable the task reconnects with a back-off of 1 ... 30 s, nothing waits for it.
+//
+//  The spool is bounded by the free space of the file system, not by a number of files: below OUTBOX_MIN_FREE a
+//  streamed message goes to the RAM queue instead. Nothing spooled is ever deleted undelivered, a message the broker
+//  keeps refusing is renamed to <id>.held and stays in flash. Low priority messages (log lines) are turned away
+//  while the spool has a backlog or the RAM queue is half full, so they never take the place of a history.
+//
+//  PubSubClient publishes with QoS 0 only, "delivered" means the whole packet was handed to the TCP stack. A message
+//  that fails is repeated, so a subscriber can see it twice (at least once).
+
+class MqttOutbox {
+
+public:
+    typedef std::function<bool(PubSubClient& client)> connect_t; // connect + subscribe, runs in the outbox task
+    typedef std::function<size_t(Print& out)>         writer_t;  // writes the payload, may be called twice
+    typedef std::function<size_t()>                   space_t;   // free bytes of the spool's file system
+
+    enum prio_t : uint8_t { PRIO_NORMAL = 0, PRIO_LOW }; // PRIO_LOW: log lines and the like, turned away first
+
+    struct stats_t {
+        uint32_t queued;
+        uint32_t delivered;
+        uint32_t retries;    // failed attempts, the message was repeated
+        uint32_t dropped;    // queue full, or refused OUTBOX_ATTEMPTS times (spooled ones are kept as .held)
+        uint32_t rejected;   // low priority, turned away while the outbox had a backlog
+        uint32_t pending;
+        uint32_t connects;
+        bool     connected;
+    };
+    struct delivery_t {      // one record per delivered or dropped message, the last OUTBOX_RECENT are kept
+        uint32_t id;
+        uint32_t bytes;
+        uint32_t latency;    // ms from publish() to delivery, 0 if it was queued before the last reboot
+        uint16_t attempts;
+        bool     ok;
+        char     topic[40];
+    };
+
+    MqttOutbox(PubSubClient& client);
+    ~MqttOutbox();
+    bool     begin(connect_t connect, fs::FS* fs = NULL, const char* dir = "/outbox", uint8_t core = 0, UBaseType_t prio = 1);
+    void     setSpoolSpace(space_t freeBytes) { m_spoolSpace = freeBytes; }; // before begin(), none: no limit
+    void     end();
+    uint32_t publish(const char* topic, const char* payload, bool retained = false, prio_t prio = PRIO_NORMAL); // id, 0: dropped
+    uint32_t publish(const char* topic, writer_t writer, bool retained = false);     // id, 0: dropped (one producer)
+    bool     connected() { return m_f_connected; };
+    stats_t  stats();
+    bool     recent(uint8_t i, delivery_t& d); // 0 = newest, false if there is no such record
+
+    static const uint8_t  OUTBOX_QUEUE     = 16;    // small messages in RAM
+    static const uint8_t  OUTBOX_MAX_TOPIC = 64;
+    static const uint32_t OUTBOX_MIN_FREE  = 65536; // bytes the spool leaves free in the file system
+    static const uint8_t  OUTBOX_RECENT    = 8;
+    static const uint32_t OUTBOX_BACKOFF   = 30000; // max. ms between two connection attempts
+    static const uint8_t  OUTBOX_ATTEMPTS  = 20;    // failures with the connection still up (refused), then given up
+    static const uint32_t OUTBOX_MAGIC     = 0x584F424D; // "MBOX"
+
+private:
+    struct item_t {          // RAM lane, the payload is on the heap
+        uint32_t id;
+        uint32_t queued;
+        char     topic[OUTBOX_MAX_TOPIC];
+        uint8_t* data;
+        uint32_t len;
+        bool     retained;
+    };
+
+    static void outboxTask(void* param);
+    void        run();
+    bool        connect();
+    uint32_t    enqueue(uint32_t id, const char* topic, uint8_t* data, uint32_t len, bool retained);
+    int8_t      sendSpool();  // 1: sent or set aside, 0: nothing to do, -1: failed
+    int8_t      sendQueued();
+    bool        stream(const char* topic, bool retained, fs::File* file, const uint8_t* data, uint32_t len);
+    void        report(uint32_t id, const char* topic, uint32_t bytes, uint32_t queued, uint16_t attempts, bool ok);
+    String      spoolPath(uint32_t id);
+    void        scanSpool();
+
+    PubSubClient&         m_client;
+    connect_t             m_connect;
+    fs::FS*               m_fs = NULL;
+    String                m_dir;
+    QueueHandle_t         m_queue = NULL;
+    TaskHandle_t          m_task = NULL;
+    SemaphoreHandle_t     m_done = NULL;     // given by the task right before it deletes itself
+    portMUX_TYPE          m_mux = portMUX_INITIALIZER_UNLOCKED;
+    std::atomic<bool>     m_f_run{false};
+    std::atomic<bool>     m_f_connected{false};
+    std::atomic<uint32_t> m_nextId{1};
+    std::atomic<uint32_t> m_spoolFirst{0};   // ids [m_spoolFirst, m_spoolNext) are files in <dir>
+    std::atomic<uint32_t> m_spoolNext{0};
+    uint32_t              m_bootFirst = 0;   // spooled ids below were queued before this boot
+    space_t               m_spoolSpace;
+    uint16_t              m_spoolAttempts = 0;   // failures of the head message that left the connection up
+    uint16_t              m_queueAttempts = 0;
+    uint16_t              m_spoolTries = 0;      // all attempts, for report()
+    uint16_t              m_queueTries = 0;
+    uint32_t              m_backoff = 1000;
+    uint32_t              m_lastAttempt = 0;
+    stats_t               m_stats = {};
+    delivery_t            m_recent[OUTBOX_RECENT] = {};
+    uint8_t               m_recentNext = 0;
+    uint8_t               m_recentCount = 0;
+};
@@ -33,6 +33,7 @@
 
 #include "celt.h"
 #include "opus_decoder.h"
+#include "../audio_arena/audio_arena.h"
 
 CELTDecoder  *s_celtDec;
 band_ctx_t    s_band_ctx;
@@ -2012,47 +2013,34 @@ int32_t celt_decoder_init(int32_t channels){
 }
 //----------------------------------------------------------------------------------------------------------------------
 
-// save stack arrays in heap, prefer PSRAM
-#ifdef BOARD_HAS_PSRAM
-    #define __heap_caps_malloc(size) heap_caps_malloc(size, MALLOC_CAP_SPIRAM)
-#else
-    #define __heap_caps_malloc(size) heap_caps_malloc(size, MALLOC_CAP_DEFAULT)
-#endif
+// save stack arrays in heap, one region, the scratch buffers of every frame are the hot set
+AudioArena s_celtArena("celt");
 
 bool CELTDecoder_AllocateBuffers(void) {
-    size_t omd = celt_decoder_get_size(2);
-    if(!s_celtDec)              {s_celtDec = (CELTDecoder*)       __heap_caps_malloc(omd);}
-    if(!s_freqBuff)             {s_freqBuff = (int32_t*)          __heap_caps_malloc(960  * sizeof(int32_t));}
-    if(!s_iyBuff)               {s_iyBuff = (int32_t*)            __heap_caps_malloc(176  * sizeof(int32_t));}
-    if(!s_normBuff)             {s_normBuff = (int16_t*)          __heap_caps_malloc(1248 * sizeof(int16_t));}
-    if(!s_XBuff)                {s_XBuff = (int16_t*)             __heap_caps_malloc(1920 * sizeof(int16_t));}
-    if(!s_bits1Buff)            {s_bits1Buff = (int32_t*)         __heap_caps_malloc(21   * sizeof(int32_t));}
-    if(!s_bits2Buff)            {s_bits2Buff = (int32_t*)         __heap_caps_malloc(21   * sizeof(int32_t));}
-    if(!s_threshBuff)           {s_threshBuff = (int32_t*)        __heap_caps_malloc(21   * sizeof(int32_t));}
-    if(!s_trim_offsetBuff)      {s_trim_offsetBuff = (int32_t*)   __heap_caps_malloc(21   * sizeof(int32_t));}
-    if(!s_collapse_masksBuff)   {s_collapse_masksBuff = (uint8_t*)__heap_caps_malloc(42   * sizeof(uint8_t));}
-    if(!s_tmpBuff)              {s_tmpBuff = (int16_t*)           __heap_caps_malloc(176  * sizeof(int16_t));}
-
-    if(!s_celtDec) {
-        CELTDecoder_FreeBuffers();
-        log_e("not enough memory to allocate celtdecoder buffers");
-        return false;
+    if(!s_celtArena.isAllocated()) {
+        size_t omd = celt_decoder_get_size(2);
+        s_celtArena.reset();
+        s_celtArena.add((void**)&s_XBuff,              1920 * sizeof(int16_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_normBuff,           1248 * sizeof(int16_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_freqBuff,           960  * sizeof(int32_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_iyBuff,             176  * sizeof(int32_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_tmpBuff,            176  * sizeof(int16_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_bits1Buff,          21   * sizeof(int32_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_bits2Buff,          21   * sizeof(int32_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_threshBuff,         21   * sizeof(int32_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_trim_offsetBuff,    21   * sizeof(int32_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_collapse_masksBuff, 42   * sizeof(uint8_t), AudioArena::HOT);
+        s_celtArena.add((void**)&s_celtDec,            omd,                    AudioArena::HOT);  // decode memory, history
+        if(!s_celtArena.allocate()) {
+            log_e("not enough memory to allocate celtdecoder buffers");
+            return false;
+        }
     }
     return true;
 }
 //----------------------------------------------------------------------------------------------------------------------
 void CELTDecoder_FreeBuffers(){
-    if(s_celtDec)            { free(s_celtDec);            s_celtDec =            NULL; }
-    if(s_freqBuff)           { free(s_freqBuff),           s_freqBuff =           NULL; }
-    if(s_iyBuff)             { free(s_iyBuff),             s_iyBuff =             NULL; }
-    if(s_normBuff)           { free(s_normBuff),           s_normBuff =           NULL; }
-    if(s_XBuff)              { free(s_XBuff),              s_XBuff =              NULL; }
-    if(s_bits1Buff)          { free(s_bits1Buff),          s_bits1Buff =          NULL; }
-    if(s_bits2Buff)          { free(s_bits2Buff),          s_bits2Buff =          NULL; }
-    if(s_threshBuff)         { free(s_threshBuff),         s_threshBuff =         NULL; }
-    if(s_trim_offsetBuff)    { free(s_trim_offsetBuff),    s_trim_offsetBuff =    NULL; }
-    if(s_collapse_masksBuff) { free(s_collapse_masksBuff), s_collapse_masksBuff = NULL; }
-    if(s_tmpBuff)            { free(s_tmpBuff),            s_tmpBuff =            NULL; }
+    s_celtArena.release(); // all pointers become NULL
 }
 //----------------------------------------------------------------------------------------------------------------------
 void CELTDecoder_ClearBuffer(void){
@@ -0,0 +1,318 @@
+/*
+ * pcm_recorder.cpp
+ *
+ *  records the played PCM without blocking the audio task: lock-free block queue, writer task, WAV or IMA ADPCM,
+ *  rotating numbered files
+ *
+ */
+#include "pcm_recorder.h"
+
+static const int16_t imaStepTab[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,    31,
+    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,   130,   143,
+    157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,   544,   598,   658,
+    724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
+    3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+static const int8_t imaIndexTab[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+PcmRecorder::PcmRecorder() {
+    m_cfg = defaultConfig();
+}
+
+PcmRecorder::~PcmRecorder() {
+    end();
+    if(!m_task) free(m_queue);
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool PcmRecorder::begin(fs::FS& fs, const char* dir, const config_t& cfg) {
+    end();
+    if(m_task) return false; // the old writer did not finish
+    m_cfg = cfg;
+    m_cfg.decimate = constrain(m_cfg.decimate, 1, 4);
+    if(m_cfg.format == REC_ADPCM || m_cfg.channels < 1 || m_cfg.channels > 2) m_cfg.channels = 1;
+    m_cfg.queueBlocks = max(m_cfg.queueBlocks, (uint16_t)4);
+    strlcpy(m_prefix, m_cfg.prefix && *m_cfg.prefix ? m_cfg.prefix : "rec", sizeof(m_prefix));
+    m_cfg.prefix = NULL; // copied, the caller's string need not live on
+
+    free(m_queue);
+    size_t size = m_cfg.queueBlocks * sizeof(block_t);
+    m_queue = (block_t*)(psramFound() ? ps_malloc(size) : malloc(size));
+    if(!m_queue) { log_e("PcmRecorder: no memory for %u blocks", m_cfg.queueBlocks); return false; }
+
+    m_fs = &fs;
+    strlcpy(m_dir, dir && *dir ? dir : "/rec", sizeof(m_dir));
+    size_t l = strlen(m_dir);
+    if(l > 1 && m_dir[l - 1] == '/') m_dir[l - 1] = '\0';
+    scanDir();
+    m_head = 0;
+    m_tail = 0;
+    m_f_stop = false;
+    m_f_session = false;
+    if(xTaskCreatePinnedToCore(taskWrapper, "PcmRecorder", 4096, this, 1, &m_task, tskNO_AFFINITY) != pdPASS) {
+        m_task = NULL;
+        log_e("PcmRecorder: task not created");
+        return false;
+    }
+    return true;
+}
+
+void PcmRecorder::end() {
+    if(!m_task) return;
+    m_f_stop = true;
+    xTaskNotifyGive(m_task);
+    uint32_t t = millis();
+    while(m_task && millis() - t < 3000) vTaskDelay(5); // the writer empties the queue and closes the file
+    if(m_task) log_w("PcmRecorder: writer still busy");
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool PcmRecorder::push(const int16_t* frames, uint16_t n, uint32_t sampleRate) {
+    return enqueue(frames, n, 2, sampleRate, BLK_AUDIO, 0);
+}
+
+bool PcmRecorder::pushMono(const int16_t* samples, size_t n, uint32_t sampleRate) {
+    return enqueue(samples, n, 1, sampleRate, BLK_AUDIO, 0);
+}
+
+bool PcmRecorder::beginSession(uint32_t id) {
+    return enqueue(NULL, 0, 1, 0, BLK_BEGIN, id);
+}
+
+bool PcmRecorder::endSession() {
+    return enqueue(NULL, 0, 1, 0, BLK_END, 0);
+}
+
+bool PcmRecorder::enqueue(const int16_t* pcm, size_t n, uint8_t channels, uint32_t sampleRate, uint8_t kind, uint32_t id) {
+    // audio task, no lock, no wait, no file access
+    if(!m_task || m_f_stop || (kind == BLK_AUDIO && !pcm)) return false;
+    if(kind == BLK_AUDIO && !n) return true;
+    uint16_t perBlock = REC_BLOCK_FRAMES * 2 / channels;
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    do {
+        uint16_t k = min(n, (size_t)perBlock);
+        if(head - m_tail.load(std::memory_order_acquire) >= m_cfg.queueBlocks) {
+            m_dropped += kind == BLK_AUDIO ? (n + perBlock - 1) / perBlock : 1;
+            return false;
+        }
+        block_t& b = m_queue[head % m_cfg.queueBlocks];
+        if(k) memcpy(b.pcm, pcm, k * channels * sizeof(int16_t));
+        b.frames = k;
+        b.channels = channels;
+        b.sampleRate = sampleRate;
+        b.kind = kind;
+        b.id = id;
+        m_head.store(++head, std::memory_order_release);
+        m_blocks++;
+        pcm += k * channels;
+        n -= k;
+    } while(n);
+    if(head - m_tail.load(std::memory_order_relaxed) >= m_cfg.queueBlocks / 2) xTaskNotifyGive(m_task); // else it polls
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PcmRecorder::taskWrapper(void* param) {
+    static_cast<PcmRecorder*>(param)->task();
+}
+
+void PcmRecorder::task() {
+    uint32_t lastBlock = millis();
+    while(true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        if(head - tail > m_stats.maxQueued) m_stats.maxQueued = head - tail;
+        while(tail != head) {
+            writeBlock(m_queue[tail % m_cfg.queueBlocks]);
+            m_tail.store(++tail, std::memory_order_release);
+            lastBlock = millis();
+        }
+        if(m_f_stop) break;
+        if(m_file && m_outLen && millis() - lastBlock > 1000) { // nothing played for a while, make the file complete
+            flushOut();
+            writeHeader();
+            m_file.flush();
+        }
+    }
+    closeFile();
+    m_task = NULL;
+    vTaskDelete(NULL);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PcmRecorder::writeBlock(const block_t& b) {
+    if(b.kind != BLK_AUDIO) { // the session file starts with the next audio block
+        closeFile();
+        m_f_session = b.kind == BLK_BEGIN;
+        m_sessionId = b.id;
+        return;
+    }
+    uint32_t rate = b.sampleRate / m_cfg.decimate;
+    if(m_f_session && m_file && rate != m_rate) return; // one file per session, it can't change the rate
+    if(m_file && (rate != m_rate || (!m_f_session && m_cfg.rotateSec && m_frames >= (uint32_t)m_cfg.rotateSec * m_rate))) closeFile();
+    if(!m_file && !openFile(rate)) return;
+    if(b.channels == 1) for(uint16_t i = 0; i < b.frames; i++) sample(b.pcm[i], b.pcm[i]);
+    else                for(uint16_t i = 0; i < b.frames; i++) sample(b.pcm[2 * i], b.pcm[2 * i + 1]);
+}
+
+void PcmRecorder::sample(int16_t l, int16_t r) {
+    m_decSum[0] += l;
+    m_decSum[1] += r;
+    if(++m_decCount < m_cfg.decimate) return;
+    int16_t s[2] = {(int16_t)(m_decSum[0] / m_cfg.decimate), (int16_t)(m_decSum[1] / m_cfg.decimate)};
+    m_decSum[0] = m_decSum[1] = 0;
+    m_decCount = 0;
+    m_frames++;
+    if(m_cfg.channels == 2) { put(s, 4); return; }
+    int16_t mono = ((int32_t)s[0] + s[1]) / 2;
+    if(m_cfg.format == REC_WAV) { put(&mono, 2); return; }
+    m_adpcm[m_adpcmLen++] = mono;
+    if(m_adpcmLen == ADPCM_SAMPLES) encodeAdpcm();
+}
+
+void PcmRecorder::encodeAdpcm() {
+    // one block: first sample and step index, then 504 samples as 4 bit codes, low nibble first
+    if(!m_adpcmLen) return;
+    while(m_adpcmLen < ADPCM_SAMPLES) { m_adpcm[m_adpcmLen] = m_adpcm[m_adpcmLen - 1]; m_adpcmLen++; } // the fact chunk has the true length
+    uint8_t blk[ADPCM_BLOCK];
+    m_adpcmPred = m_adpcm[0];
+    blk[0] = m_adpcmPred & 0xFF;
+    blk[1] = (m_adpcmPred >> 8) & 0xFF;
+    blk[2] = m_adpcmIndex;
+    blk[3] = 0;
+    for(uint16_t i = 1; i < ADPCM_SAMPLES; i++) {
+        int32_t step = imaStepTab[m_adpcmIndex];
+        int32_t diff = m_adpcm[i] - m_adpcmPred;
+        uint8_t code = 0;
+        if(diff < 0) { code = 8; diff = -diff; }
+        int32_t delta = step >> 3;
+        if(diff >= step) { code |= 4; diff -= step; delta += step; }
+        if(diff >= step >> 1) { code |= 2; diff -= step >> 1; delta += step >> 1; }
+        if(diff >= step >> 2) { code |= 1; delta += step >> 2; }
+        m_adpcmPred += code & 8 ? -delta : delta;
+        m_adpcmPred = constrain(m_adpcmPred, -32768, 32767);
+        m_adpcmIndex = constrain(m_adpcmIndex + imaIndexTab[code & 7], 0, 88);
+        uint8_t& o = blk[4 + (i - 1) / 2];
+        if(i & 1) o = code;
+        else o |= code << 4;
+    }
+    put(blk, ADPCM_BLOCK);
+    m_adpcmLen = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PcmRecorder::put(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    m_dataBytes += len;
+    while(len) {
+        size_t k = min(len, (size_t)(REC_OUT_SIZE - m_outLen));
+        memcpy(m_out + m_outLen, p, k);
+        m_outLen += k;
+        p += k;
+        len -= k;
+        if(m_outLen == REC_OUT_SIZE) flushOut();
+    }
+}
+
+void PcmRecorder::flushOut() {
+    if(!m_outLen || !m_file) { m_outLen = 0; return; }
+    uint32_t t = micros();
+    size_t   w = m_file.write(m_out, m_outLen);
+    t = micros() - t;
+    if(t > m_stats.maxWriteUs) m_stats.maxWriteUs = t;
+    m_stats.bytesWritten += w;
+    if(w != m_outLen) log_e("PcmRecorder: write error %s", m_name);
+    m_outLen = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PcmRecorder::writeHeader() {
+    uint8_t  h[60];
+    uint8_t  n = 0;
+    bool     adpcm = m_cfg.format == REC_ADPCM;
+    uint16_t ch = m_cfg.channels;
+    auto tag = [&](const char* s) { memcpy(h + n, s, 4); n += 4; };
+    auto le16 = [&](uint16_t v) { h[n++] = v; h[n++] = v >> 8; };
+    auto le32 = [&](uint32_t v) { le16(v); le16(v >> 16); };
+
+    uint8_t hdrSize = adpcm ? 60 : 44;
+    tag("RIFF"); le32(hdrSize - 8 + m_dataBytes); tag("WAVE");
+    tag("fmt "); le32(adpcm ? 20 : 16);
+    le16(adpcm ? 0x11 : 1);                                          // IMA ADPCM : PCM
+    le16(ch);
+    le32(m_rate);
+    le32(adpcm ? m_rate * ADPCM_BLOCK / ADPCM_SAMPLES : m_rate * ch * 2); // bytes per second
+    le16(adpcm ? ADPCM_BLOCK : ch * 2);                              // block align
+    le16(adpcm ? 4 : 16);                                            // bits per sample
+    if(adpcm) {
+        le16(2);                                                     // extra format bytes
+        le16(ADPCM_SAMPLES);
+        tag("fact"); le32(4); le32(m_frames);
+    }
+    tag("data"); le32(m_dataBytes);
+
+    m_file.seek(0);
+    m_file.write(h, n);
+    m_file.seek(hdrSize + m_dataBytes);
+}
+
+bool PcmRecorder::openFile(uint32_t sampleRate) {
+    uint32_t seq = m_f_session ? m_sessionId : m_nextSeq;
+    snprintf(m_name, sizeof(m_name), "%s/%s_%05lu.wav", m_dir, m_prefix, (unsigned long)seq);
+    m_file = m_fs->open(m_name, "w");
+    if(!m_file) {
+        log_e("PcmRecorder: can't create %s", m_name);
+        m_name[0] = '\0';
+        return false;
+    }
+    if(seq + 1 > m_nextSeq) m_nextSeq = seq + 1;
+    m_rate = sampleRate;
+    m_frames = 0;
+    m_dataBytes = 0;
+    m_outLen = 0;
+    m_adpcmLen = 0;
+    m_adpcmIndex = 0;
+    m_decCount = 0;
+    m_decSum[0] = m_decSum[1] = 0;
+    writeHeader(); // sizes 0 until the file is closed
+    m_stats.files++;
+    while(m_cfg.keepFiles && m_nextSeq - m_firstSeq > m_cfg.keepFiles) { // oldest first
+        char old[64];
+        snprintf(old, sizeof(old), "%s/%s_%05lu.wav", m_dir, m_prefix, (unsigned long)m_firstSeq++);
+        m_fs->remove(old);
+    }
+    return true;
+}
+
+void PcmRecorder::closeFile() {
+    if(!m_file) return;
+    if(m_cfg.format == REC_ADPCM) encodeAdpcm(); // the last block is padded, the fact chunk has the true length
+    flushOut();
+    writeHeader();
+    m_file.close();
+}
+
+void PcmRecorder::scanDir() {
+    // the numbers go on after a restart, the oldest file is the one to delete first
+    m_firstSeq = m_nextSeq = 0;
+    File d = m_fs->open(m_dir);
+    if(!d || !d.isDirectory()) { m_fs->mkdir(m_dir); return; }
+    bool found = false;
+    for(File f = d.openNextFile(); f; f = d.openNextFile()) {
+        const char*   n = strrchr(f.name(), '/');
+        const char*   p = n ? n + 1 : f.name();
+        size_t        l = strlen(m_prefix);
+        unsigned long seq;
+        if(strncmp(p, m_prefix, l) || p[l] != '_' || sscanf(p + l + 1, "%lu.wav", &seq) != 1) continue;
+        if(!found || seq < m_firstSeq) m_firstSeq = seq;
+        if(!found || seq + 1 > m_nextSeq) m_nextSeq = seq + 1;
+        found = true;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PcmRecorder::getStats(stats_t* stats, bool reset) {
+    m_stats.blocks = m_blocks;
+    m_stats.dropped = m_dropped;
+    if(stats) *stats = m_stats;
+    if(reset) {
+        m_stats = {};
+        m_blocks = 0;
+        m_dropped = 0;
+    }
+}
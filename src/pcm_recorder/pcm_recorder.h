@@ -0,0 +1,118 @@
+// recorder for the played audio: the audio task drops PCM blocks into a lock-free queue, a writer task encodes them
+// (WAV or IMA ADPCM) into rotating files, the audio task never waits for the card
+#pragma once
+
+#include "Arduino.h"
+#include "FS.h"
+#include <atomic>
+
+//  push() is called from playChunk() with the processed frames that go to I2S. It copies them into the next free
+//  block of a single producer / single consumer ring and returns at once, if the ring is full the block is dropped
+//  and counted. The writer task takes the blocks in order:
+//
+//  playChunk() -> push() -> | blk | blk | blk | ... | -> writer task -> downmix, decimate, encode -> <dir>/rec_00042.wav
+//                            head (producer)   tail (consumer)
+//
+//  A file is closed (header sizes written) and the next one opened after rotateSec seconds of audio or when the
+//  sample rate changes. Only the newest keepFiles files are kept, the numbering goes on across restarts.
+//  beginSession(id) and endSession() go through the queue as well, in order with the audio: everything pushed in
+//  between is one file <dir>/<prefix>_<id>.wav, without rotation (a visitor session, its id as the number).
+//  ADPCM is IMA ADPCM in a WAV file (format 0x11, 256 byte blocks, 505 samples), mono, about a quarter of PCM.
+
+class PcmRecorder {
+
+public:
+    enum format_t : uint8_t {REC_WAV = 0, REC_ADPCM = 1};
+    typedef struct {
+        format_t format;
+        uint8_t  channels;       // 1: downmix, 2: as played (WAV only)
+        uint8_t  decimate;       // 1..4, keep every n-th frame (averaged), 44.1 kHz / 3 = 14.7 kHz is enough for speech
+        uint16_t rotateSec;      // 0: one file until end()
+        uint8_t  keepFiles;      // 0: keep all
+        uint16_t queueBlocks;    // REC_BLOCK_FRAMES each, PSRAM if there is some
+        const char* prefix;      // file names <prefix>_00042.wav, NULL: "rec"
+    } config_t;
+    typedef struct {
+        uint32_t blocks;         // taken by push()
+        uint32_t dropped;        // queue was full
+        uint32_t bytesWritten;
+        uint32_t files;
+        uint32_t maxWriteUs;     // slowest file write
+        uint16_t maxQueued;      // high-water mark of the queue
+    } stats_t;
+
+    PcmRecorder();
+    ~PcmRecorder();
+    static config_t defaultConfig() { return {REC_ADPCM, 1, 1, 60, 10, 64, NULL}; };
+    bool        begin(fs::FS& fs, const char* dir, const config_t& cfg = defaultConfig());
+    void        end();                                           // writes what is queued, closes the file
+    bool        push(const int16_t* frames, uint16_t n, uint32_t sampleRate); // stereo frames, false: dropped
+    bool        pushMono(const int16_t* samples, size_t n, uint32_t sampleRate);
+    bool        beginSession(uint32_t id);                       // queued, false: queue full
+    bool        endSession();
+    bool        isRecording() { return m_task != NULL; };
+    const char* currentFile() { return m_name; };
+    void        getStats(stats_t* stats, bool reset = false);
+
+    static const uint16_t REC_BLOCK_FRAMES = 256; // one playChunk()
+
+private:
+    enum : uint8_t {BLK_AUDIO = 0, BLK_BEGIN = 1, BLK_END = 2};
+    typedef struct {
+        uint32_t sampleRate;
+        uint32_t id;             // BLK_BEGIN
+        uint16_t frames;
+        uint8_t  channels;       // 1: mono, up to REC_BLOCK_FRAMES * 2 frames
+        uint8_t  kind;
+        int16_t  pcm[REC_BLOCK_FRAMES * 2];
+    } block_t;
+
+    static const uint16_t REC_OUT_SIZE       = 4096;  // file writes in whole sectors
+    static const uint16_t ADPCM_BLOCK        = 256;
+    static const uint16_t ADPCM_SAMPLES      = 505;
+
+    bool        enqueue(const int16_t* pcm, size_t n, uint8_t channels, uint32_t sampleRate, uint8_t kind, uint32_t id);
+    static void taskWrapper(void* param);
+    void        task();
+    void        writeBlock(const block_t& b);
+    void        sample(int16_t l, int16_t r);
+    void        put(const void* data, size_t len);
+    void        flushOut();
+    bool        openFile(uint32_t sampleRate);
+    void        closeFile();
+    void        writeHeader();
+    void        encodeAdpcm();
+    void        scanDir();
+
+    fs::FS*               m_fs = NULL;
+    char                  m_dir[32] = "";
+    char                  m_name[64] = "";
+    char                  m_prefix[12] = "rec";
+    config_t              m_cfg;
+    block_t*              m_queue = NULL;
+    std::atomic<uint32_t> m_head = {0};      // written by push()
+    std::atomic<uint32_t> m_tail = {0};      // written by the writer
+    std::atomic<bool>     m_f_stop = {false};
+    TaskHandle_t          m_task = NULL;
+
+    File                  m_file;            // writer task only
+    uint32_t              m_rate = 0;        // sample rate of the file (after decimation)
+    uint32_t              m_frames = 0;      // frames in the file
+    uint32_t              m_dataBytes = 0;
+    uint32_t              m_firstSeq = 0;    // oldest file on the card
+    uint32_t              m_nextSeq = 0;
+    uint32_t              m_sessionId = 0;
+    bool                  m_f_session = false; // between BLK_BEGIN and BLK_END, writer task
+    int32_t               m_decSum[2] = {};
+    uint8_t               m_decCount = 0;
+    int16_t               m_adpcm[ADPCM_SAMPLES];
+    uint16_t              m_adpcmLen = 0;
+    int32_t               m_adpcmPred = 0;
+    int8_t                m_adpcmIndex = 0;
+    uint8_t               m_out[REC_OUT_SIZE];
+    uint16_t              m_outLen = 0;
+
+    std::atomic<uint32_t> m_dropped = {0};
+    std::atomic<uint32_t> m_blocks = {0};
+    stats_t               m_stats = {};
+};
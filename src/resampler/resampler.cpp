@@ -0,0 +1,224 @@
+/*
+ * resampler.cpp
+ *
+ *  polyphase sample rate converter for the output stage, keeps the I2S bus at a fixed rate
+ *  interleaved stereo int16_t, Q15 coefficients, Q32.32 position, filter tables cached per rate pair
+ *
+ */
+#include "resampler.h"
+#include <stdlib.h>
+#include <math.h>
+
+static const float RS_KAISER_BETA = 8.0f;  // ~80dB stopband
+static const float RS_ROLLOFF     = 0.90f; // passband edge relative to the lower Nyquist frequency
+
+Resampler::table_t Resampler::s_cache[RS_CACHE] = {};
+
+Resampler::Resampler() {}
+
+Resampler::~Resampler() {
+    if(m_own) free(m_own);
+    if(m_buf) free(m_buf);
+    m_own = NULL;
+    m_coef = NULL;
+    m_buf = NULL;
+}
+//----------------------------------------------------------------------------------------------------------------------
+float Resampler::besselI0(float x) { // zeroth order modified Bessel function of the first kind
+    float sum = 1.0f, term = 1.0f, x2 = x * x / 4.0f;
+    for(int k = 1; k < 32; k++) {
+        term *= x2 / ((float)k * k);
+        sum += term;
+        if(term < sum * 1e-7f) break;
+    }
+    return sum;
+}
+//----------------------------------------------------------------------------------------------------------------------
+uint16_t Resampler::tapsFor(uint32_t inRate, uint32_t outRate) {
+    float ratio = (float)outRate / inRate;
+    uint32_t taps = (uint32_t)ceilf(RS_TAPS / (ratio < 1.0f ? ratio : 1.0f));
+    taps = (taps + 1) & ~1u;
+    return taps > RS_MAX_TAPS ? RS_MAX_TAPS : taps;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Resampler::design(uint32_t inRate, uint32_t outRate, uint16_t taps, int16_t* coef) {
+    // two passes per row (DC gain, then the coefficients), no row buffer on the stack
+    float ratio = (float)outRate / inRate;
+    float fc = RS_ROLLOFF * (ratio < 1.0f ? ratio : 1.0f); // cutoff relative to the input Nyquist frequency
+    float half = taps / 2.0f;
+    float i0b = besselI0(RS_KAISER_BETA);
+    auto tap = [&](int p, int j) {
+        float t = (float)p / RS_PHASES + half - 1 - j; // distance from the output position in input frames
+        float x = t / half;
+        float w = (fabsf(x) < 1.0f) ? besselI0(RS_KAISER_BETA * sqrtf(1.0f - x * x)) / i0b : 0;
+        float s = (t == 0) ? 1.0f : sinf((float)M_PI * fc * t) / ((float)M_PI * fc * t);
+        return fc * s * w;
+    };
+    for(int p = 0; p <= RS_PHASES; p++) {
+        float sum = 0;
+        for(int j = 0; j < taps; j++) sum += tap(p, j);
+        for(int j = 0; j < taps; j++) { // DC gain of every row = 1
+            long c = lroundf(tap(p, j) / sum * 32768.0f);
+            if(c > 32767) c = 32767;
+            if(c < -32768) c = -32768;
+            coef[p * taps + j] = (int16_t)c;
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+const Resampler::table_t* Resampler::lookup(uint32_t inRate, uint32_t outRate) {
+    for(int i = 0; i < RS_CACHE; i++) {
+        const table_t& t = s_cache[i];
+        if(t.state.load(std::memory_order_acquire) == 2 && t.inRate == inRate && t.outRate == outRate) return &t;
+    }
+    return NULL;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Resampler::prepare(uint32_t inRate, uint32_t outRate) {
+    if(inRate == outRate || inRate == 0 || outRate == 0) return true; // bypass, no table
+    if(lookup(inRate, outRate)) return true;
+    for(int i = 0; i < RS_CACHE; i++) { // claim a free slot, other tasks skip it until it is ready
+        table_t& t = s_cache[i];
+        uint8_t expected = 0;
+        if(!t.state.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) continue;
+        uint16_t taps = tapsFor(inRate, outRate);
+        int16_t* coef = (int16_t*)malloc((RS_PHASES + 1) * taps * sizeof(int16_t));
+        if(!coef) { t.state.store(0, std::memory_order_release); return false; }
+        design(inRate, outRate, taps, coef);
+        t.inRate = inRate;
+        t.outRate = outRate;
+        t.taps = taps;
+        t.coef = coef;
+        t.state.store(2, std::memory_order_release);
+        return true;
+    }
+    return false; // cache full
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Resampler::setRates(uint32_t inRate, uint32_t outRate) {
+    if(inRate == m_inRate && outRate == m_outRate) { reset(); return true; } // filter is already designed
+    m_inRate = inRate;
+    m_outRate = outRate;
+    m_f_bypass = (inRate == outRate || inRate == 0 || outRate == 0);
+    if(m_f_bypass) return true;
+
+    if(!m_buf) m_buf = (int16_t*)malloc((RS_MAX_TAPS + RS_BLOCK) * 2 * sizeof(int16_t));
+    m_coef = NULL;
+    const table_t* t = m_buf ? lookup(inRate, outRate) : NULL;
+    if(!t && m_buf && prepare(inRate, outRate)) t = lookup(inRate, outRate); // not prepared: designed here
+    if(t) {
+        m_coef = t->coef;
+        m_taps = t->taps;
+    }
+    else if(m_buf) { // cache full, a table of this instance
+        if(!m_own) m_own = (int16_t*)malloc((RS_PHASES + 1) * RS_MAX_TAPS * sizeof(int16_t));
+        if(m_own) {
+            m_taps = tapsFor(inRate, outRate);
+            design(inRate, outRate, m_taps, m_own);
+            m_coef = m_own;
+        }
+    }
+    if(!m_buf || !m_coef) { m_f_bypass = true; m_inRate = m_outRate = 0; return false; }
+
+    m_step = ((uint64_t)inRate << 32) / outRate;
+    reset();
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Resampler::reset() {
+    m_pos = 0;
+    m_filled = 0;
+    m_padded = 0;
+    m_tail = 0;
+    m_delay.store(0, std::memory_order_relaxed);
+    if(m_f_bypass || !m_buf) return;
+    m_filled = m_taps / 2 - 1; // zero history, the first input frame is in the middle of the first window
+    memset(m_buf, 0, m_filled * 2 * sizeof(int16_t));
+}
+
+void Resampler::flush() {
+    if(m_f_bypass || !m_buf || m_padded || m_tail) return; // already flushed
+    m_tail = m_taps / 2;
+    pad();
+    updateDelay();
+}
+
+size_t Resampler::delayFrames() {
+    return m_f_bypass ? 0 : m_delay.load(std::memory_order_relaxed);
+}
+
+void Resampler::pad() { // as much of the zero tail as fits
+    size_t n = RS_MAX_TAPS + RS_BLOCK - m_filled;
+    if(n > m_tail) n = m_tail;
+    memset(m_buf + m_filled * 2, 0, n * 2 * sizeof(int16_t));
+    m_filled += n;
+    m_padded += n;
+    m_tail -= n;
+}
+
+void Resampler::updateDelay() { // real input frames from the middle of the next window on
+    size_t center = (size_t)(m_pos >> 32) + m_taps / 2 - 1;
+    size_t real = m_filled - m_padded;
+    m_delay.store((real > center ? real - center : 0) + (m_tail ? 1 : 0), std::memory_order_relaxed);
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t Resampler::inputFramesFor(size_t outFrames) {
+    if(m_f_bypass) return outFrames;
+    if(!outFrames) return 0;
+    uint64_t last = m_pos + (uint64_t)(outFrames - 1) * m_step;
+    size_t need = (size_t)(last >> 32) + m_taps;
+    return need > m_filled ? need - m_filled : 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+int16_t* Resampler::getWritePtr(size_t* freeFrames) {
+    *freeFrames = RS_MAX_TAPS + RS_BLOCK - m_filled;
+    return m_buf + m_filled * 2;
+}
+
+void Resampler::framesWritten(size_t frames) {
+    if(frames) m_padded = m_tail = 0; // input after a flush(), the zeros are part of it
+    m_filled += frames;
+    updateDelay();
+}
+//----------------------------------------------------------------------------------------------------------------------
+size_t Resampler::process(int16_t* out, size_t outFrames) {
+    const int phaseBits = 6; // log2(RS_PHASES)
+    size_t n = 0;
+    if(m_tail) pad();
+    while(n < outFrames) {
+        size_t i = (size_t)(m_pos >> 32);
+        if(i + m_taps > m_filled) break; // need more input
+        uint32_t frac = (uint32_t)m_pos;
+        uint32_t p = frac >> (32 - phaseBits);                 // polyphase row
+        int32_t  f = (frac >> (32 - phaseBits - 15)) & 0x7FFF; // Q15 weight between row p and p + 1
+        const int16_t* c0 = m_coef + p * m_taps;
+        const int16_t* c1 = c0 + m_taps;
+        const int16_t* x = m_buf + i * 2;
+        int32_t l0 = 0, l1 = 0, r0 = 0, r1 = 0;
+        for(int j = 0; j < m_taps; j++) {
+            int32_t xl = x[2 * j], xr = x[2 * j + 1];
+            l0 += xl * c0[j];
+            l1 += xl * c1[j];
+            r0 += xr * c0[j];
+            r1 += xr * c1[j];
+        }
+        int64_t l = (int64_t)l0 + ((((int64_t)l1 - l0) * f) >> 15);
+        int64_t r = (int64_t)r0 + ((((int64_t)r1 - r0) * f) >> 15);
+        l = (l + (1 << 14)) >> 15;
+        r = (r + (1 << 14)) >> 15;
+        out[2 * n]     = (int16_t)(l > 32767 ? 32767 : l < -32768 ? -32768 : l);
+        out[2 * n + 1] = (int16_t)(r > 32767 ? 32767 : r < -32768 ? -32768 : r);
+        m_pos += m_step;
+        n++;
+    }
+    size_t used = (size_t)(m_pos >> 32); // drop the frames in front of the next window
+    if(used > m_filled) used = m_filled;
+    if(used) {
+        memmove(m_buf, m_buf + used * 2, (m_filled - used) * 2 * sizeof(int16_t));
+        m_filled -= used;
+        m_pos -= (uint64_t)used << 32;
+        if(m_padded > m_filled) m_padded = m_filled;
+    }
+    updateDelay();
+    return n;
+}
@@ -0,0 +1,80 @@
+// polyphase sample rate converter, interleaved stereo int16_t, fixed point
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+//  windowed sinc (Kaiser), RS_PHASES + 1 polyphase rows of m_taps Q15 coefficients each, the output is linearly
+//  interpolated between the two neighbouring rows. Downsampling lowers the cutoff and widens the filter.
+//
+//  m_buf (input frames)
+//   |<-- m_pos >> 32 -->|<------- m_taps ------->|
+//   ▼                   ▼                        ▼
+//   ---------------------------------------------------------------------------------------------
+//   |   consumed        |  window of the next output frame  |   ...            |<-- free -->|
+//   ---------------------------------------------------------------------------------------------
+//                                                                  m_filled ---▲
+//
+//  The last m_taps / 2 input frames are held back until frames after them arrive (the delay line). At the end of the
+//  input flush() appends that many zero frames, process() then writes the rest, delayFrames() counts down to 0.
+//
+//  The tables are shared by all instances, one per rate pair in a small cache (never freed). setRates() only looks
+//  the pair up, prepare() designs it ahead of time from a task with stack to spare, not from the audio task. A pair
+//  that is not prepared is designed in setRates() (float, no arrays on the stack), if the cache is full into a
+//  table of the instance.
+
+class Resampler {
+
+public:
+    Resampler();
+    ~Resampler();
+    bool     setRates(uint32_t inRate, uint32_t outRate); // table from the cache, false if out of memory
+    static bool prepare(uint32_t inRate, uint32_t outRate); // designs the table of a rate pair into the cache
+    bool     isBypass() { return m_f_bypass; };           // inRate == outRate, nothing to do
+    uint32_t getInRate() { return m_inRate; };
+    uint32_t getOutRate() { return m_outRate; };
+    void     reset();                                     // clear the history, e.g. after a seek
+    size_t   inputFramesFor(size_t outFrames);            // input frames still needed for outFrames
+    int16_t* getWritePtr(size_t* freeFrames);             // append input frames here ...
+    void     framesWritten(size_t frames);                // ... and commit them
+    size_t   process(int16_t* out, size_t outFrames);     // returns the number of frames written to out
+    void     flush();                                     // end of the input: m_taps / 2 zero frames push the rest out
+    size_t   delayFrames();                               // input frames whose output is still to come, any task
+
+    static const uint16_t RS_PHASES   = 64;   // polyphase rows, must be a power of two
+    static const uint16_t RS_TAPS     = 16;   // taps per row for upsampling
+    static const uint16_t RS_MAX_TAPS = 48;   // downsampling widens the filter up to this
+    static const uint16_t RS_BLOCK    = 1024; // max. input frames per block
+    static const uint8_t  RS_CACHE    = 12;   // designed rate pairs
+
+private:
+    struct table_t {
+        std::atomic<uint8_t> state;   // 0 free, 1 being designed, 2 ready
+        uint32_t inRate;
+        uint32_t outRate;
+        uint16_t taps;
+        int16_t* coef;
+    };
+    static table_t s_cache[RS_CACHE];
+    static const table_t* lookup(uint32_t inRate, uint32_t outRate);
+    static uint16_t tapsFor(uint32_t inRate, uint32_t outRate);
+    static void     design(uint32_t inRate, uint32_t outRate, uint16_t taps, int16_t* coef);
+    static float    besselI0(float x);
+    void            pad();
+    void            updateDelay();
+
+    const int16_t* m_coef = NULL;   // (RS_PHASES + 1) * m_taps, Q15, from the cache or m_own
+    int16_t*  m_own       = NULL;   // table of this instance, only when the cache is full
+    int16_t*  m_buf       = NULL;   // (RS_MAX_TAPS + RS_BLOCK) interleaved L/R frames
+    uint32_t  m_inRate    = 0;
+    uint32_t  m_outRate   = 0;
+    uint16_t  m_taps      = RS_TAPS;
+    size_t    m_filled    = 0;      // frames in m_buf
+    size_t    m_padded    = 0;      // zero frames of flush() at the end of m_buf
+    size_t    m_tail      = 0;      // zero frames of flush() still to append
+    std::atomic<size_t> m_delay = {0}; // delayFrames(), updated by the task that feeds and reads
+    uint64_t  m_pos       = 0;      // Q32.32, first frame of the filter window in m_buf
+    uint64_t  m_step      = 0;      // Q32.32, inRate / outRate
+    bool      m_f_bypass  = true;
+};
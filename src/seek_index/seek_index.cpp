@@ -0,0 +1,248 @@
+/*
+ * seek_index.cpp
+ *
+ *  time -> byte offset table of a local audio file, from the MP3 frame headers, the FLAC SEEKTABLE or the m4a stsz
+ *  atom, binary search lookups, cached in a small file next to the audio file
+ *
+ */
+#include "seek_index.h"
+
+SeekIndex::SeekIndex(uint16_t intervalMs, uint16_t maxEntries) {
+    m_intervalStart = max(intervalMs, (uint16_t)1);
+    m_interval = m_intervalStart;
+    m_max = max(maxEntries, (uint16_t)16);
+}
+
+SeekIndex::~SeekIndex() {
+    free(m_entry);
+    free(m_build.buf);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SeekIndex::clear() {
+    free(m_build.buf); // a running build ends here
+    m_build.buf = NULL;
+    m_count = 0;
+    m_interval = m_intervalStart;
+}
+
+bool SeekIndex::alloc() {
+    if(m_entry) return true;
+    size_t size = m_max * sizeof(entry_t);
+    m_entry = (entry_t*)(psramFound() ? ps_malloc(size) : malloc(size));
+    if(!m_entry) log_e("SeekIndex: no memory for %u entries", m_max);
+    return m_entry != NULL;
+}
+
+bool SeekIndex::add(uint32_t ms, uint32_t pos) {
+    if(!alloc()) return false;
+    if(m_count) {
+        const entry_t& last = m_entry[m_count - 1];
+        if(pos <= last.pos || ms < last.ms + m_interval) return true; // too close or out of order
+    }
+    if(m_count == m_max) { // keep every other entry, the first one stays
+        for(uint16_t i = 1; i < m_count / 2; i++) m_entry[i] = m_entry[2 * i];
+        m_count /= 2;
+        m_interval *= 2;
+        if(ms < m_entry[m_count - 1].ms + m_interval) return true;
+    }
+    m_entry[m_count].ms = ms;
+    m_entry[m_count].pos = pos;
+    m_count++;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+const SeekIndex::entry_t* SeekIndex::atTime(uint32_t ms) {
+    if(!m_count) return NULL;
+    uint16_t lo = 0, hi = m_count; // first entry with .ms > ms
+    while(lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if(m_entry[mid].ms <= ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return &m_entry[lo ? lo - 1 : 0];
+}
+
+const SeekIndex::entry_t* SeekIndex::atPos(uint32_t pos) {
+    if(!m_count) return NULL;
+    uint16_t lo = 0, hi = m_count;
+    while(lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if(m_entry[mid].pos <= pos) lo = mid + 1;
+        else hi = mid;
+    }
+    return &m_entry[lo ? lo - 1 : 0];
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool SeekIndex::mp3Frame(const uint8_t* h, uint32_t* len, uint16_t* samples, uint32_t* sampleRate) {
+    static const uint16_t bitrateTab[2][3][15] = { {
+        /* MPEG-1 */
+        { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 }, /* Layer 1 */
+        { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },    /* Layer 2 */
+        { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 },     /* Layer 3 */
+        }, {
+        /* MPEG-2, MPEG-2.5 */
+        { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },    /* Layer 1 */
+        { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },         /* Layer 2 */
+        { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },         /* Layer 3 */
+    }, };
+    static const uint32_t samplerateTab[3] = {44100, 48000, 32000};
+
+    if(h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) return false;
+    uint8_t ver = (h[1] >> 3) & 0x03;     // 0: MPEG-2.5, 1: reserved, 2: MPEG-2, 3: MPEG-1
+    uint8_t layer = 4 - ((h[1] >> 1) & 0x03);
+    uint8_t brIdx = h[2] >> 4;
+    uint8_t srIdx = (h[2] >> 2) & 0x03;
+    uint8_t pad = (h[2] >> 1) & 0x01;
+    if(ver == 1 || layer == 4 || brIdx == 0 || brIdx == 15 || srIdx == 3) return false; // free format is not indexed
+
+    uint32_t br = bitrateTab[ver == 3 ? 0 : 1][layer - 1][brIdx] * 1000;
+    uint32_t sr = samplerateTab[srIdx] >> (ver == 3 ? 0 : ver == 2 ? 1 : 2);
+    if(layer == 1)      { *len = (12 * br / sr + pad) * 4; *samples = 384; }
+    else if(layer == 2) { *len = 144 * br / sr + pad;      *samples = 1152; }
+    else if(ver == 3)   { *len = 144 * br / sr + pad;      *samples = 1152; }
+    else                { *len = 72 * br / sr + pad;       *samples = 576; }
+    *sampleRate = sr;
+    return *len > 4;
+}
+
+bool SeekIndex::beginBuild() {
+    m_build = {};
+    m_build.buf = (uint8_t*)malloc(SEEK_READ);
+    return m_build.buf != NULL;
+}
+
+bool SeekIndex::beginMp3(uint32_t start, uint32_t size) {
+    clear();
+    if(!beginBuild()) return false;
+    m_build.mp3 = true;
+    m_build.first = true;
+    m_build.start = start;
+    m_build.size = size;
+    return true;
+}
+
+bool SeekIndex::beginStsz(uint32_t stszPos, uint32_t entries, uint32_t sampleRate, uint16_t samplesPerFrame) {
+    clear();
+    if(!stszPos || !entries || !sampleRate) return false;
+    if(!beginBuild()) return false;
+    m_build.start = stszPos;
+    m_build.size = entries;
+    m_build.rate = sampleRate;
+    m_build.spf = samplesPerFrame;
+    return true;
+}
+
+int8_t SeekIndex::build(File& file) {
+    if(!m_build.buf) return m_count ? BUILD_DONE : BUILD_FAILED;
+    return m_build.mp3 ? buildMp3(file) : buildStsz(file);
+}
+
+int8_t SeekIndex::endBuild() {
+    free(m_build.buf);
+    m_build.buf = NULL;
+    return m_count ? BUILD_DONE : BUILD_FAILED;
+}
+
+int8_t SeekIndex::buildMp3(File& file) {
+    build_t& b = m_build;
+    bool     read = false;
+
+    while(b.pos + 4 <= b.size) {
+        if(!b.bufLen || b.pos < b.bufStart || b.pos + 4 > b.bufStart + b.bufLen) { // only the headers are needed, the reads follow the frames
+            if(read) return BUILD_MORE; // one read per step
+            file.seek(b.start + b.pos);
+            b.bufLen = file.read(b.buf, min((uint32_t)SEEK_READ, b.size - b.pos));
+            b.bufStart = b.pos;
+            read = true;
+            if(b.bufLen < 4) break;
+        }
+        const uint8_t* h = b.buf + (b.pos - b.bufStart);
+        uint32_t len, sr;
+        uint16_t spf;
+        if(!mp3Frame(h, &len, &spf, &sr) || (b.rate && sr != b.rate)) { // no frame here (junk, ID3v1 tag), search the next one
+            b.pos++;
+            if(++b.lost > 4096) break;
+            continue;
+        }
+        b.lost = 0;
+        b.rate = sr;
+        bool info = false; // Xing/Info/VBRI frame, carries no audio
+        if(b.first) {
+            uint32_t n = min(len, b.bufLen - (b.pos - b.bufStart));
+            for(uint32_t i = 4; i + 4 <= n && i < 48; i++) {
+                if(!memcmp(h + i, "Xing", 4) || !memcmp(h + i, "Info", 4) || !memcmp(h + i, "VBRI", 4)) { info = true; break; }
+            }
+            b.first = false;
+        }
+        if(!info) {
+            if(!add(b.samples * 1000 / b.rate, b.pos)) break;
+            b.samples += spf;
+        }
+        b.pos += len;
+    }
+    return endBuild();
+}
+//----------------------------------------------------------------------------------------------------------------------
+int8_t SeekIndex::buildStsz(File& file) {
+    build_t& b = m_build;
+    uint32_t n = min(b.size - b.pos, (uint32_t)(SEEK_READ / 4));
+    file.seek(b.start + b.pos * 4);
+    if(file.read(b.buf, n * 4) != n * 4) return endBuild();
+    for(uint32_t k = 0; k < n; k++, b.pos++) {
+        if(!add((uint64_t)b.pos * b.spf * 1000 / b.rate, b.offset)) return endBuild();
+        b.offset += (b.buf[4 * k] << 24) | (b.buf[4 * k + 1] << 16) | (b.buf[4 * k + 2] << 8) | b.buf[4 * k + 3];
+    }
+    return b.pos < b.size ? (int8_t)BUILD_MORE : endBuild();
+}
+//----------------------------------------------------------------------------------------------------------------------
+uint16_t SeekIndex::addFlacSeekTable(const uint8_t* data, size_t len, uint32_t sampleRate) {
+    // 18 bytes per seek point: first sample (64 bit), offset to the first frame (64 bit), samples in the frame (16 bit)
+    clear();
+    if(!sampleRate) return 0;
+    for(size_t i = 0; i + 18 <= len; i += 18) {
+        uint64_t sample = 0, offset = 0;
+        for(uint8_t k = 0; k < 8; k++) {
+            sample = (sample << 8) | data[i + k];
+            offset = (offset << 8) | data[i + 8 + k];
+        }
+        if(sample == UINT64_MAX || offset > UINT32_MAX) continue; // placeholder point
+        if(!add(sample * 1000 / sampleRate, offset)) break;
+    }
+    return m_count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SeekIndex::cacheName(char* buf, size_t size, const char* path) {
+    snprintf(buf, size, "%s.sidx", path);
+}
+
+bool SeekIndex::load(fs::FS& fs, const char* path, uint32_t fileSize, uint32_t audioStart, uint32_t date) {
+    char name[256];
+    cacheName(name, sizeof(name), path);
+    if(!fs.exists(name)) return false;
+    File f = fs.open(name, "r");
+    if(!f) return false;
+    fileHeader_t h;
+    bool ok = f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) && !memcmp(h.magic, "SIDX", 4) && h.version == SEEK_VERSION &&
+              h.fileSize == fileSize && h.audioStart == audioStart && h.date == date && h.count && h.count <= m_max;
+    if(ok) ok = alloc();
+    if(ok) ok = f.read((uint8_t*)m_entry, h.count * sizeof(entry_t)) == h.count * sizeof(entry_t);
+    f.close();
+    if(!ok) { clear(); return false; }
+    m_count = h.count;
+    m_interval = h.interval;
+    return true;
+}
+
+bool SeekIndex::save(fs::FS& fs, const char* path, uint32_t fileSize, uint32_t audioStart, uint32_t date) {
+    if(!m_count) return false;
+    char name[256];
+    cacheName(name, sizeof(name), path);
+    File f = fs.open(name, "w");
+    if(!f) { log_w("SeekIndex: can't write %s", name); return false; }
+    fileHeader_t h = {{'S', 'I', 'D', 'X'}, SEEK_VERSION, m_count, fileSize, audioStart, date, m_interval};
+    bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+    if(ok) ok = f.write((const uint8_t*)m_entry, m_count * sizeof(entry_t)) == m_count * sizeof(entry_t);
+    f.close();
+    if(!ok) fs.remove(name); // a short file would never match anyway, don't leave it
+    return ok;
+}
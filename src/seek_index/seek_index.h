@@ -0,0 +1,92 @@
+// time -> byte offset index of a local audio file, built once or taken from the file's own tables, cached beside it
+#pragma once
+
+#include "Arduino.h"
+#include "FS.h"
+
+//  An entry is the start of a frame (MP3 frame, FLAC frame, AAC sample): its time in ms and its offset from the first
+//  audio byte. Both columns grow monotonically, a lookup is a binary search and gives the last entry at or before:
+//
+//  ms:   0    250   500    750  ...
+//  pos:  0   4180  8360  12539  ...       atTime(600) -> {500, 8360}    atPos(9000) -> {500, 8360}
+//
+//  Sources: beginMp3() walks the frame headers once (exact, a Xing/VBRI TOC only has 1% steps), addFlacSeekTable()
+//  takes the SEEKTABLE metadata block, beginStsz() adds up the m4a sample sizes. Entries are at least m_interval ms
+//  apart, when the table is full every other entry is dropped and the interval doubles.
+//
+//  The walks run in steps of one read (SEEK_READ bytes), build() is called until it is done. The caller decides where
+//  and when, the player does it in the read-ahead task on a File of its own and takes no lookups before the end.
+//
+//  save() / load() keep the table in "<file>.sidx", it is valid as long as size, audio start and date of the file match.
+
+class SeekIndex {
+
+public:
+    typedef struct {
+        uint32_t ms;
+        uint32_t pos;     // relative to the first audio byte
+    } entry_t;
+
+    SeekIndex(uint16_t intervalMs = 250, uint16_t maxEntries = 2048);
+    ~SeekIndex();
+    void           clear();                      // keeps the memory
+    bool           add(uint32_t ms, uint32_t pos);
+    const entry_t* atTime(uint32_t ms);          // NULL if empty
+    const entry_t* atPos(uint32_t pos);
+    uint16_t       count() { return m_count; };
+    uint32_t       lastMs() { return m_count ? m_entry[m_count - 1].ms : 0; };
+
+    enum : int8_t {BUILD_FAILED = -1, BUILD_DONE = 0, BUILD_MORE = 1};
+    bool     beginMp3(uint32_t start, uint32_t size);
+    bool     beginStsz(uint32_t stszPos, uint32_t entries, uint32_t sampleRate, uint16_t samplesPerFrame = 1024);
+    int8_t   build(File& file);                  // one read of the walk, BUILD_MORE until the end
+    uint16_t addFlacSeekTable(const uint8_t* data, size_t len, uint32_t sampleRate); // data: first seek point
+    bool     load(fs::FS& fs, const char* path, uint32_t fileSize, uint32_t audioStart, uint32_t date);
+    bool     save(fs::FS& fs, const char* path, uint32_t fileSize, uint32_t audioStart, uint32_t date);
+
+    static bool mp3Frame(const uint8_t* h, uint32_t* len, uint16_t* samples, uint32_t* sampleRate);
+
+private:
+    typedef struct {
+        char     magic[4];    // "SIDX"
+        uint16_t version;
+        uint16_t count;
+        uint32_t fileSize;
+        uint32_t audioStart;
+        uint32_t date;
+        uint32_t interval;
+    } fileHeader_t;
+
+    static const uint16_t SEEK_VERSION = 1;
+    static const uint16_t SEEK_READ    = 4096;  // bytes per read while building
+
+    typedef struct {
+        uint8_t* buf;         // NULL: no build running
+        bool     mp3;         // else stsz
+        bool     first;
+        uint16_t lost;        // bytes skipped since the last frame
+        uint16_t spf;         // samples per frame (stsz)
+        uint32_t start;       // file position of the audio data (mp3) or of the first stsz entry
+        uint32_t size;        // audio bytes (mp3) or stsz entries
+        uint32_t pos;         // next frame (mp3) or next stsz entry
+        uint32_t offset;      // audio offset of the next stsz entry
+        uint32_t bufStart;
+        uint32_t bufLen;
+        uint32_t rate;
+        uint64_t samples;
+    } build_t;
+
+    bool     alloc();
+    bool     beginBuild();
+    int8_t   buildMp3(File& file);
+    int8_t   buildStsz(File& file);
+    int8_t   endBuild();
+    void     cacheName(char* buf, size_t size, const char* path);
+
+    entry_t* m_entry = NULL;     // allocated with the first entry, PSRAM if there is some
+    uint16_t m_count = 0;
+    uint16_t m_max;
+    uint32_t m_interval;
+    uint16_t m_intervalStart;
+    build_t  m_build = {};
+};